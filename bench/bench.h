@@ -0,0 +1,41 @@
+#ifndef __MYUTIL_BENCH_H__
+#define __MYUTIL_BENCH_H__
+
+#define LOG_LEVEL LOG_INFO
+#include "myutil.h"
+
+#include <time.h>
+
+/** get monotonic time in nanoseconds. */
+static inline uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/** print one result line, time cost of count operations. */
+#define BENCH_REPORT(name, count, ns) \
+    LOGI("  %-44s %10lu ops %10.2f ns/op", name, (unsigned long)(count), (double)(ns) / (count))
+
+/** print benchmark suite title. */
+#define BENCH_SUITE(name) do { \
+        LOGI("================================"); \
+        LOGI("Benchmark \"%s\"", name); \
+        LOGI("--------------------------------"); \
+    } while (0)
+
+void bench_skip_list(void);
+void bench_timer_wheel(void);
+void bench_pairing_heap(void);
+void bench_list_foreach(void);
+void bench_spsc_ring(void);
+void bench_thread_pool(void);
+void bench_art(void);
+void bench_flat_map(void);
+void bench_bp_tree(void);
+void bench_bloom_filter(void);
+void bench_async_log(void);
+void bench_bin_log(void);
+
+#endif /* __MYUTIL_BENCH_H__ */
@@ -0,0 +1,120 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct _IntRb
+{
+    RbNode super;
+    uint64_t key;
+} IntRb;
+
+typedef struct _IntArt
+{
+    ArtLeaf super;
+    uint8_t key[8];
+} IntArt;
+
+static int intCompare(RbNodeRef node, void const *key)
+{
+    uint64_t a = DOWN_CAST(node, IntRb)->key, b = *(uint64_t const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* pseudo random 64-bit ids */
+static uint64_t randomKey(int i)
+{
+    return Hash_uint64(i) * 0x9e3779b97f4a7c15ull;
+}
+
+static void benchRbTree(int count, uint64_t *insertNs, uint64_t *findNs)
+{
+    IntRb *items = (IntRb *)malloc(sizeof(IntRb) * count);
+    RbTree tree;
+    size_t found = 0;
+    int i;
+
+    RbTree_init(&tree, intCompare);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+        RbTree_insert(&tree, &items[i].super, &items[i].key);
+    }
+    *insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(count - 1 - i);
+        found += RbTree_find(&tree, &key) != NULL;
+    }
+    *findNs = bench_now() - start;
+
+    if (found != (size_t)count)
+        LOGE("RbTree lost keys");
+    free(items);
+}
+
+static void benchArt(int count, uint64_t *insertNs, uint64_t *findNs, size_t *bytes)
+{
+    IntArt *items = (IntArt *)malloc(sizeof(IntArt) * count);
+    size_t size = (size_t)count * 64 + 0x100000;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    ArtTree tree;
+    size_t found = 0;
+    int i;
+
+    ArtTree_init(&tree, alloc);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        Art_encodeUint64(items[i].key, randomKey(i));
+        ArtLeaf_init(&items[i].super, items[i].key, 8);
+        ArtTree_insert(&tree, &items[i].super);
+    }
+    *insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint8_t key[8];
+        Art_encodeUint64(key, randomKey(count - 1 - i));
+        found += ArtTree_find(&tree, key, 8) != NULL;
+    }
+    *findNs = bench_now() - start;
+
+    if (found != (size_t)count)
+        LOGE("ArtTree lost keys");
+    *bytes = Allocator_capacity(alloc) - Allocator_available(alloc);
+    free(buf);
+    free(items);
+}
+
+void bench_art(void)
+{
+    static int const counts[] = {10000, 1000000};
+    uint64_t insertNs, findNs;
+    size_t bytes;
+    char name[64];
+    size_t i;
+
+    BENCH_SUITE("art");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        benchRbTree(counts[i], &insertNs, &findNs);
+        snprintf(name, sizeof(name), "RbTree insert, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], insertNs);
+        snprintf(name, sizeof(name), "RbTree find, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], findNs);
+
+        benchArt(counts[i], &insertNs, &findNs, &bytes);
+        snprintf(name, sizeof(name), "ArtTree insert, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], insertNs);
+        snprintf(name, sizeof(name), "ArtTree find, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], findNs);
+        LOGI("  %-44s %10.2f bytes/key", "ArtTree inner nodes", (double)bytes / counts[i]);
+    }
+}
@@ -0,0 +1,70 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_ASYNC_LOG_CAPACITY 4096
+
+static void fileSink(void const *data, size_t len, void *arg)
+{
+    fwrite(data, 1, len, (FILE *)arg);
+    fflush((FILE *)arg);
+}
+
+/* line buffered stdout, a write syscall per message on the caller thread. */
+static uint64_t benchSync(FILE *file, int count)
+{
+    int i;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        fprintf(file, "[I] request %d done in %d us\n", i, i % 1000);
+        fflush(file);
+    }
+    return bench_now() - start;
+}
+
+static uint64_t benchAsync(FILE *file, int count, int policy, size_t *dropped)
+{
+    size_t size = BENCH_ASYNC_LOG_CAPACITY * ASYNC_LOG_SLOT_SIZE * 2;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    AsyncLog log;
+    int i;
+
+    AsyncLog_init(&log, alloc, BENCH_ASYNC_LOG_CAPACITY, policy, fileSink, file);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        AsyncLog_write(&log, "[I] ", "request %d done in %d us", i, i % 1000);
+    uint64_t ns = bench_now() - start;
+
+    AsyncLog_flush(&log);
+    *dropped = AsyncLog_dropped(&log);
+    AsyncLog_destroy(&log);
+    free(buf);
+    return ns;
+}
+
+void bench_async_log(void)
+{
+    static int const counts[] = {1000, 100000};
+    FILE *file = fopen("/dev/null", "w");
+    size_t dropped;
+    char name[64];
+    size_t i;
+
+    BENCH_SUITE("async_log");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        snprintf(name, sizeof(name), "fprintf + fflush, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchSync(file, counts[i]));
+        snprintf(name, sizeof(name), "AsyncLog write, block, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchAsync(file, counts[i], ASYNC_LOG_BLOCK, &dropped));
+        snprintf(name, sizeof(name), "AsyncLog write, drop, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchAsync(file, counts[i], ASYNC_LOG_DROP, &dropped));
+        LOGI("  %-44s %10lu", "  dropped", (unsigned long)dropped);
+    }
+    fclose(file);
+}
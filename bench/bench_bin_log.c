@@ -0,0 +1,98 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+static void nullSink(void const *data, size_t len, void *arg)
+{
+    (void)data;
+    *(size_t *)arg += len;
+}
+
+static void benchBinLog(int count)
+{
+    size_t size = (size_t)count * 128 + BIN_LOG_TEXT_SIZE + 1024;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    BinLog log;
+    BinLogWriter writer;
+    size_t bytes = 0;
+    char name[64];
+    int i;
+
+    /* 40 bytes a record, the buffer holds all */
+    if (!BinLog_init(&log, alloc) || !BinLog_attach(&log, &writer, (size_t)count * 40))
+    {
+        LOGE("BinLog init failed");
+        free(buf);
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        BIN_LOG(&writer, "request %d done in %d us", i, i % 1000);
+    snprintf(name, sizeof(name), "BIN_LOG call, n=%d", count);
+    BENCH_REPORT(name, count, bench_now() - start);
+
+    start = bench_now();
+    i = (int)BinLog_format(&log, nullSink, &bytes);
+    snprintf(name, sizeof(name), "BinLog_format, n=%d", i);
+    BENCH_REPORT(name, count, bench_now() - start);
+    if (BinLog_dropped(&log) != 0)
+        LOGI("  %-44s %10lu", "  dropped", (unsigned long)BinLog_dropped(&log));
+
+    BinLog_destroy(&log);
+    free(buf);
+}
+
+static void benchAsyncLog(int count)
+{
+    size_t size = (size_t)count * ASYNC_LOG_SLOT_SIZE * 2;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    AsyncLog log;
+    size_t bytes = 0;
+    char name[64];
+    int i;
+
+    /* ring holds all, so only the producer side is timed */
+    AsyncLog_init(&log, alloc, count, ASYNC_LOG_DROP, nullSink, &bytes);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        AsyncLog_write(&log, "[I] ", "request %d done in %d us", i, i % 1000);
+    snprintf(name, sizeof(name), "AsyncLog_write call, n=%d", count);
+    BENCH_REPORT(name, count, bench_now() - start);
+
+    AsyncLog_destroy(&log);
+    free(buf);
+}
+
+/* the timestamp alone, a large part of BIN_LOG where rdtsc is trapped */
+static uint64_t benchNow(int count)
+{
+    uint64_t sum = 0;
+    int i;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        sum += BinLog_now();
+    uint64_t ns = bench_now() - start;
+
+    if (sum == 0)
+        LOGI("  %-44s", "  timestamp is 0");
+    return ns;
+}
+
+void bench_bin_log(void)
+{
+    static int const counts[] = {1000, 100000};
+    size_t i;
+
+    BENCH_SUITE("bin_log");
+    BENCH_REPORT("BinLog_now", 1000000, benchNow(1000000));
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        benchAsyncLog(counts[i]);
+        benchBinLog(counts[i]);
+    }
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+#define BENCH_BLOOM_FPR 0.01
+
+/* keys added are even, probes of absent keys are odd. */
+static uint64_t keyOf(size_t i)
+{
+    return (uint64_t)i * 2;
+}
+
+static void benchBloomFilter(int count)
+{
+    size_t blocks = BloomFilter_blocksFor(count, BENCH_BLOOM_FPR);
+    size_t size = (blocks + 2) * BLOOM_FILTER_BLOCK_SIZE + 1024;
+    void *buf = malloc(size);
+    uint64_t *probes = (uint64_t *)malloc(sizeof(uint64_t) * count);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    BloomFilter filter;
+    size_t found = 0;
+    char name[64];
+    uint64_t ns;
+    int i;
+
+    BloomFilter_init(&filter, alloc, blocks);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        BloomFilter_add(&filter, keyOf(i));
+    snprintf(name, sizeof(name), "BloomFilter add, n=%d", count);
+    BENCH_REPORT(name, count, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        found += BloomFilter_contains(&filter, keyOf(i));
+    ns = bench_now() - start;
+    snprintf(name, sizeof(name), "BloomFilter contains hit, n=%d", count);
+    BENCH_REPORT(name, count, ns);
+    if (found != (size_t)count)
+        LOGE("BloomFilter lost keys");
+
+    start = bench_now();
+    found = 0;
+    for (i = 0; i < count; i++)
+        found += BloomFilter_contains(&filter, keyOf(i) + 1);
+    ns = bench_now() - start;
+    snprintf(name, sizeof(name), "BloomFilter contains miss, n=%d", count);
+    BENCH_REPORT(name, count, ns);
+    LOGI("  %-44s %10.2f M lookups/s", name, count * 1e3 / ns);
+
+    for (i = 0; i < count; i++)
+        probes[i] = keyOf(i) + 1;
+    start = bench_now();
+    found = BloomFilter_containsBatch(&filter, probes, count, NULL);
+    ns = bench_now() - start;
+    snprintf(name, sizeof(name), "BloomFilter batch miss, n=%d", count);
+    BENCH_REPORT(name, count, ns);
+    LOGI("  %-44s %10.2f M lookups/s", name, count * 1e3 / ns);
+
+    LOGI("  %-44s %10.4f%% measured, %.4f%% estimated, %.2f bits/key", "BloomFilter false positive",
+        found * 100.0 / count, BloomFilter_fpr(count, blocks) * 100, blocks * 512.0 / count);
+
+    BloomFilter_destroy(&filter);
+    free(probes);
+    free(buf);
+}
+
+void bench_bloom_filter(void)
+{
+    static int const counts[] = {10000, 1000000, 10000000};
+    size_t i;
+
+    BENCH_SUITE("bloom_filter");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+        benchBloomFilter(counts[i]);
+}
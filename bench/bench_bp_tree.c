@@ -0,0 +1,186 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct _IntDbList
+{
+    DbList super;
+    uint64_t key;
+} IntDbList;
+
+typedef struct _IntRb
+{
+    RbNode super;
+    uint64_t key;
+} IntRb;
+
+typedef struct _BenchTreeResult
+{
+    uint64_t insertNs;
+    uint64_t findNs;
+    uint64_t scanNs;
+} BenchTreeResult;
+
+static int intCompare(RbNodeRef node, void const *key)
+{
+    uint64_t a = DOWN_CAST(node, IntRb)->key, b = *(uint64_t const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* distinct pseudo random 64-bit ids */
+static uint64_t randomKey(int i)
+{
+    return (uint64_t)i * 0x9e3779b97f4a7c15ull;
+}
+
+/* a permutation of 0 ~ count - 1, lookups in another order than inserts. */
+static int shuffle(int i, int count)
+{
+    return (int)(((uint64_t)i * 7919) % count);
+}
+
+/* insert into a sorted DbList, walk from head to the first greater key. */
+static void benchDbList(int count, BenchTreeResult *result)
+{
+    IntDbList *items = (IntDbList *)malloc(sizeof(IntDbList) * count);
+    IntDbList *item;
+    DbListRef head = NULL;
+    size_t found = 0;
+    int i;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+
+        DbListIter it = DbListIter_new(head);
+        while (DbListIter_next(&it) && DbListIter_curObj(it, IntDbList)->key < items[i].key);
+
+        if (head == NULL || DbListIter_curObj(it, IntDbList)->key < items[i].key)
+            DbList_addToTail(&items[i].super, &head);
+        else if (DbListIter_current(&it) == head)
+            DbList_addToHead(&items[i].super, &head);
+        else
+            DbList_insert(&items[i].super, DbListIter_current(&it));
+    }
+    result->insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(shuffle(i, count));
+        DbListIter it = DbListIter_new(head);
+        while (DbListIter_next(&it) && DbListIter_curObj(it, IntDbList)->key < key);
+        found += DbListIter_curObj(it, IntDbList)->key == key;
+    }
+    result->findNs = bench_now() - start;
+
+    start = bench_now();
+    DBLIST_FOREACH_OBJ(item, head, IntDbList)
+        found += item->key != 0;
+    result->scanNs = bench_now() - start;
+
+    if (found != (size_t)count * 2 - 1)
+        LOGE("sorted DbList lost keys");
+    free(items);
+}
+
+static void benchRbTree(int count, BenchTreeResult *result)
+{
+    IntRb *items = (IntRb *)malloc(sizeof(IntRb) * count);
+    RbTreeIter it;
+    RbTree tree;
+    size_t found = 0;
+    int i;
+
+    RbTree_init(&tree, intCompare);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+        RbTree_insert(&tree, &items[i].super, &items[i].key);
+    }
+    result->insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(shuffle(i, count));
+        found += RbTree_find(&tree, &key) != NULL;
+    }
+    result->findNs = bench_now() - start;
+
+    start = bench_now();
+    it = RbTreeIter_new(&tree);
+    while (RbTreeIter_next(&it))
+        found += RbTreeIter_curObj(it, IntRb)->key != 0;
+    result->scanNs = bench_now() - start;
+
+    if (found != (size_t)count * 2 - 1)
+        LOGE("RbTree lost keys");
+    free(items);
+}
+
+static void benchBpTree(int count, BenchTreeResult *result)
+{
+    size_t size = (size_t)count * 40 + 0x100000;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    BpTreeIter it;
+    BpTree tree;
+    size_t found = 0;
+    int i;
+
+    BpTree_init(&tree, alloc);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        BpTree_insert(&tree, randomKey(i), NULL);
+    result->insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        found += BpTree_find(&tree, randomKey(shuffle(i, count)), NULL);
+    result->findNs = bench_now() - start;
+
+    start = bench_now();
+    BpTreeIter_init(&it, &tree);
+    while (BpTreeIter_next(&it))
+        found += BpTreeIter_key(&it) != 0;
+    result->scanNs = bench_now() - start;
+
+    if (found != (size_t)count * 2 - 1)
+        LOGE("BpTree lost keys");
+    free(buf);
+}
+
+static void report(cstr_t name, int count, BenchTreeResult *result)
+{
+    char line[64];
+
+    snprintf(line, sizeof(line), "%s insert, n=%d", name, count);
+    BENCH_REPORT(line, count, result->insertNs);
+    snprintf(line, sizeof(line), "%s find, n=%d", name, count);
+    BENCH_REPORT(line, count, result->findNs);
+    snprintf(line, sizeof(line), "%s scan, n=%d", name, count);
+    BENCH_REPORT(line, count, result->scanNs);
+}
+
+void bench_bp_tree(void)
+{
+    static int const counts[] = {10000, 1000000};
+    BenchTreeResult result;
+    size_t i;
+
+    BENCH_SUITE("bp_tree");
+    benchDbList(counts[0], &result);
+    report("sorted DbList", counts[0], &result);
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        benchRbTree(counts[i], &result);
+        report("RbTree", counts[i], &result);
+        benchBpTree(counts[i], &result);
+        report("BpTree", counts[i], &result);
+    }
+}
@@ -0,0 +1,165 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct _IntHash
+{
+    HashNode super;
+    uint64_t key;
+    uint64_t value;
+} IntHash;
+
+static inline bool intEqual(uint64_t a, uint64_t b)
+{
+    return a == b;
+}
+
+FLAT_MAP_DEFINE(IntMap, uint64_t, uint64_t, Hash_uint64, intEqual)
+
+typedef struct _BenchHashResult
+{
+    uint64_t insertNs;
+    uint64_t hitNs;
+    uint64_t missNs;
+    uint64_t removeNs;
+    size_t bytes;
+} BenchHashResult;
+
+static bool nodeEqual(HashNodeRef node, void const *key)
+{
+    return DOWN_CAST(node, IntHash)->key == *(uint64_t const *)key;
+}
+
+/* distinct pseudo random 64-bit ids, odd ones for missing keys. */
+static uint64_t randomKey(int i)
+{
+    return ((uint64_t)i * 0x9e3779b97f4a7c15ull) << 1;
+}
+
+/* a permutation of 0 ~ count - 1, lookups in another order than inserts. */
+static int shuffle(int i, int count)
+{
+    return (int)(((uint64_t)i * 7919) % count);
+}
+
+static void benchHashTable(int count, BenchHashResult *result)
+{
+    IntHash *items = (IntHash *)malloc(sizeof(IntHash) * count);
+    size_t size = (size_t)count * 32 + 0x100000;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    HashTable table;
+    size_t found = 0;
+    int i;
+
+    HashTable_init(&table, alloc, 16);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+        items[i].value = i;
+        HashTable_insert(&table, &items[i].super, Hash_uint64(items[i].key));
+    }
+    result->insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(shuffle(i, count));
+        found += HashTable_find(&table, Hash_uint64(key), &key, nodeEqual) != NULL;
+    }
+    result->hitNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(i) | 1;
+        found += HashTable_find(&table, Hash_uint64(key), &key, nodeEqual) != NULL;
+    }
+    result->missNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        uint64_t key = randomKey(i);
+        found -= HashTable_remove(&table, Hash_uint64(key), &key, nodeEqual) != NULL;
+    }
+    result->removeNs = bench_now() - start;
+
+    if (found != 0)
+        LOGE("HashTable lost keys");
+    result->bytes = Allocator_capacity(alloc) - Allocator_available(alloc) + sizeof(IntHash) * count;
+    HashTable_destroy(&table);
+    free(buf);
+    free(items);
+}
+
+static void benchFlatMap(int count, BenchHashResult *result)
+{
+    size_t size = (size_t)count * 80 + 0x100000;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    IntMap map;
+    size_t found = 0;
+    int i;
+
+    IntMap_init(&map, alloc, 0);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+        IntMap_put(&map, randomKey(i), i);
+    result->insertNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        found += IntMap_find(&map, randomKey(shuffle(i, count))) != NULL;
+    result->hitNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        found += IntMap_find(&map, randomKey(i) | 1) != NULL;
+    result->missNs = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        found -= IntMap_remove(&map, randomKey(i), NULL);
+    result->removeNs = bench_now() - start;
+
+    if (found != 0)
+        LOGE("FlatMap lost keys");
+    result->bytes = (map.mask + 1) * (sizeof(IntMapEntry) + 1);
+    IntMap_destroy(&map);
+    free(buf);
+}
+
+static void report(cstr_t name, int count, BenchHashResult *result)
+{
+    char line[64];
+
+    snprintf(line, sizeof(line), "%s insert, n=%d", name, count);
+    BENCH_REPORT(line, count, result->insertNs);
+    snprintf(line, sizeof(line), "%s find hit, n=%d", name, count);
+    BENCH_REPORT(line, count, result->hitNs);
+    snprintf(line, sizeof(line), "%s find miss, n=%d", name, count);
+    BENCH_REPORT(line, count, result->missNs);
+    snprintf(line, sizeof(line), "%s remove, n=%d", name, count);
+    BENCH_REPORT(line, count, result->removeNs);
+    LOGI("  %-44s %10.2f bytes/key", name, (double)result->bytes / count);
+}
+
+void bench_flat_map(void)
+{
+    static int const counts[] = {10000, 1000000};
+    BenchHashResult result;
+    size_t i;
+
+    BENCH_SUITE("flat_map");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        benchHashTable(counts[i], &result);
+        report("HashTable", counts[i], &result);
+        benchFlatMap(counts[i], &result);
+        report("FlatMap", counts[i], &result);
+    }
+}
@@ -0,0 +1,194 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* one node per cache line */
+typedef struct _IntList
+{
+    List super;
+    DbList dbSuper;
+    int i;
+    char padding[36];
+} IntList;
+
+#define BENCH_LIST_COUNT (1 << 20)
+#define BENCH_LIST_WARM (1 << 12)
+#define BENCH_LIST_BATCH 16
+#define BENCH_FLUSH_SIZE (64 << 20)
+
+static char *__flush = NULL;
+static bool __cold = true;
+static volatile uint64_t __sink = 0;
+
+/* evict lists from cache by touching a large buffer. */
+static void flushCache(void)
+{
+    size_t i;
+    for (i = 0; i < BENCH_FLUSH_SIZE && __cold; i += 64)
+        __flush[i]++;
+}
+
+/* some work on every node, a miss of next node could be hidden behind it. */
+static inline uint64_t work(IntList *item)
+{
+    return Hash_uint64(Hash_uint64(Hash_uint64(item->i)));
+}
+
+/* link nodes in a shuffled memory order, so every step is a cache miss. */
+static void initLists(IntList *items, int count, ListRef *head, DbListRef *dbHead)
+{
+    int *order = (int *)malloc(sizeof(int) * count);
+    int i;
+
+    for (i = 0; i < count; i++)
+        order[i] = i;
+    for (i = count - 1; i > 0; i--)
+    {
+        int j = (int)(Hash_uint64(i) % (i + 1));
+        int t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    *head = NULL;
+    *dbHead = NULL;
+    for (i = count - 1; i >= 0; i--)
+    {
+        IntList *item = &items[order[i]];
+        item->i = i;
+        item->super.next = *head;
+        *head = &item->super;
+    }
+    for (i = 0; i < count; i++)
+        DbList_addToTail(&items[order[i]].dbSuper, dbHead);
+
+    free(order);
+}
+
+static uint64_t benchListIter(ListRef head)
+{
+    ListIter it = ListIter_new(head);
+    uint64_t sum = 0;
+
+    flushCache();
+    uint64_t start = bench_now();
+    while (ListIter_next(&it))
+        sum += work(ListIter_curObj(it, IntList));
+    uint64_t ns = bench_now() - start;
+
+    __sink += sum;
+    return ns;
+}
+
+static uint64_t benchListForeach(ListRef head)
+{
+    IntList *obj;
+    uint64_t sum = 0;
+
+    flushCache();
+    uint64_t start = bench_now();
+    LIST_FOREACH_OBJ(obj, head, IntList)
+        sum += work(obj);
+    uint64_t ns = bench_now() - start;
+
+    __sink += sum;
+    return ns;
+}
+
+static uint64_t benchListNextN(ListRef head)
+{
+    ListIter it = ListIter_new(head);
+    ListRef batch[BENCH_LIST_BATCH];
+    uint64_t sum = 0;
+    size_t count, i;
+
+    flushCache();
+    uint64_t start = bench_now();
+    while ((count = ListIter_nextN(&it, batch, BENCH_LIST_BATCH)) > 0)
+    {
+        for (i = 0; i < count; i++)
+            sum += work(DOWN_CAST(batch[i], IntList));
+    }
+    uint64_t ns = bench_now() - start;
+
+    __sink += sum;
+    return ns;
+}
+
+static uint64_t benchDbListIter(DbListRef head)
+{
+    DbListIter it = DbListIter_new(head);
+    uint64_t sum = 0;
+
+    flushCache();
+    uint64_t start = bench_now();
+    while (DbListIter_next(&it))
+        sum += work(DOWN_CAST_FROM(DbListIter_current(&it), IntList, dbSuper));
+    uint64_t ns = bench_now() - start;
+
+    __sink += sum;
+    return ns;
+}
+
+static uint64_t benchDbListForeach(DbListRef head)
+{
+    DbListRef node;
+    uint64_t sum = 0;
+
+    flushCache();
+    uint64_t start = bench_now();
+    DBLIST_FOREACH(node, head)
+        sum += work(DOWN_CAST_FROM(node, IntList, dbSuper));
+    uint64_t ns = bench_now() - start;
+
+    __sink += sum;
+    return ns;
+}
+
+static void benchAll(char const *title, int count)
+{
+    IntList *items = (IntList *)malloc(sizeof(IntList) * count);
+    ListRef head;
+    DbListRef dbHead;
+    char name[64];
+    int repeat = BENCH_LIST_COUNT / count, i;
+    uint64_t ns[5] = {0};
+
+    initLists(items, count, &head, &dbHead);
+    for (i = 0; i < repeat; i++)
+    {
+        ns[0] += benchListIter(head);
+        ns[1] += benchListForeach(head);
+        ns[2] += benchListNextN(head);
+        ns[3] += benchDbListIter(dbHead);
+        ns[4] += benchDbListForeach(dbHead);
+    }
+
+    snprintf(name, sizeof(name), "%s List, ListIter_next", title);
+    BENCH_REPORT(name, BENCH_LIST_COUNT, ns[0]);
+    snprintf(name, sizeof(name), "%s List, LIST_FOREACH_OBJ", title);
+    BENCH_REPORT(name, BENCH_LIST_COUNT, ns[1]);
+    snprintf(name, sizeof(name), "%s List, ListIter_nextN", title);
+    BENCH_REPORT(name, BENCH_LIST_COUNT, ns[2]);
+    snprintf(name, sizeof(name), "%s DbList, DbListIter_next", title);
+    BENCH_REPORT(name, BENCH_LIST_COUNT, ns[3]);
+    snprintf(name, sizeof(name), "%s DbList, DBLIST_FOREACH", title);
+    BENCH_REPORT(name, BENCH_LIST_COUNT, ns[4]);
+
+    free(items);
+}
+
+void bench_list_foreach(void)
+{
+    __flush = (char *)malloc(BENCH_FLUSH_SIZE);
+    memset(__flush, 0, BENCH_FLUSH_SIZE);
+
+    BENCH_SUITE("list_foreach");
+    __cold = true;
+    benchAll("cold", BENCH_LIST_COUNT);
+    __cold = false;
+    benchAll("warm", BENCH_LIST_WARM);
+
+    free(__flush);
+}
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct _IntDbList
+{
+    DbList super;
+    int key;
+} IntDbList;
+
+typedef struct _IntHeap
+{
+    PairNode super;
+    int key;
+} IntHeap;
+
+static int intCompare(PairNodeRef a, PairNodeRef b)
+{
+    int x = DOWN_CAST(a, IntHeap)->key, y = DOWN_CAST(b, IntHeap)->key;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* a pseudo random key sequence */
+static int randomKey(int i)
+{
+    return (int)(Hash_uint64(i) & 0x3fffffff);
+}
+
+/* insert into a sorted DbList, walk from head to the first greater key. */
+static void sortedInsert(IntDbList *item, DbListRef *head)
+{
+    DbListIter it = DbListIter_new(*head);
+    while (DbListIter_next(&it) && DbListIter_curObj(it, IntDbList)->key < item->key);
+
+    if (*head == NULL || DbListIter_curObj(it, IntDbList)->key < item->key)
+        DbList_addToTail(&item->super, head);
+    else if (DbListIter_current(&it) == *head)
+        DbList_addToHead(&item->super, head);
+    else
+        DbList_insert(&item->super, DbListIter_current(&it));
+}
+
+/* insert all, decrease half of the keys, then pop all. */
+static uint64_t benchDbList(int count)
+{
+    IntDbList *items = (IntDbList *)malloc(sizeof(IntDbList) * count);
+    DbListRef head = NULL;
+    int i;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+        sortedInsert(&items[i], &head);
+    }
+    for (i = 0; i < count; i += 2)
+    {
+        DbList_removeFrom(&items[i].super, &head);
+        items[i].key /= 2;
+        sortedInsert(&items[i], &head);
+    }
+    while (head != NULL)
+        DbList_removeFrom(head, &head);
+    uint64_t ns = bench_now() - start;
+
+    free(items);
+    return ns;
+}
+
+static uint64_t benchPairHeap(int count)
+{
+    IntHeap *items = (IntHeap *)malloc(sizeof(IntHeap) * count);
+    PairHeap heap;
+    int i;
+
+    PairHeap_init(&heap, intCompare);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+        PairHeap_insert(&heap, &items[i].super);
+    }
+    for (i = 0; i < count; i += 2)
+    {
+        items[i].key /= 2;
+        PairHeap_decrease(&heap, &items[i].super);
+    }
+    while (PairHeap_pop(&heap) != NULL);
+    uint64_t ns = bench_now() - start;
+
+    free(items);
+    return ns;
+}
+
+void bench_pairing_heap(void)
+{
+    static int const counts[] = {1000, 10000, 30000};
+    char name[64];
+    size_t i;
+
+    BENCH_SUITE("pairing_heap");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        snprintf(name, sizeof(name), "sorted DbList insert/decrease/pop, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchDbList(counts[i]));
+        snprintf(name, sizeof(name), "PairHeap insert/decrease/pop, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchPairHeap(counts[i]));
+    }
+
+    snprintf(name, sizeof(name), "PairHeap insert/decrease/pop, n=%d", 1000000);
+    BENCH_REPORT(name, 1000000, benchPairHeap(1000000));
+}
@@ -0,0 +1,162 @@
+#include "bench.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct _IntDbList
+{
+    DbList super;
+    int key;
+} IntDbList;
+
+typedef struct _IntSkip
+{
+    int key;
+    SkipNode super;
+} IntSkip;
+
+#define BENCH_SKIP_THREADS 4
+
+static int intCompare(SkipNodeRef node, void const *key)
+{
+    int a = DOWN_CAST(node, IntSkip)->key, b = *(int const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* a pseudo random key sequence */
+static int randomKey(int i)
+{
+    return (int)(Hash_uint64(i) & 0x7fffffff);
+}
+
+/* insert into a sorted DbList, walk from head to the first greater key. */
+static uint64_t benchDbList(int count)
+{
+    IntDbList *items = (IntDbList *)malloc(sizeof(IntDbList) * count);
+    DbListRef head = NULL;
+    int i;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].key = randomKey(i);
+
+        DbListIter it = DbListIter_new(head);
+        while (DbListIter_next(&it) && DbListIter_curObj(it, IntDbList)->key < items[i].key);
+
+        if (head == NULL || DbListIter_curObj(it, IntDbList)->key < items[i].key)
+            DbList_addToTail(&items[i].super, &head);
+        else if (DbListIter_current(&it) == head)
+            DbList_addToHead(&items[i].super, &head);
+        else
+            DbList_insert(&items[i].super, DbListIter_current(&it));
+    }
+    uint64_t ns = bench_now() - start;
+
+    free(items);
+    return ns;
+}
+
+static uint64_t benchSkipList(int count)
+{
+    size_t size = count * (sizeof(IntSkip) + sizeof(SkipNodeRef) * 2) + 1024;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    SkipList list;
+    int i;
+
+    SkipList_init(&list, intCompare);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        IntSkip *item = SkipList_new(&list, alloc, IntSkip);
+        if (item == NULL)
+        {
+            LOGE("SkipList bench buffer exhausted");
+            break;
+        }
+        item->key = randomKey(i);
+        SkipList_insert(&list, &item->super, &item->key);
+    }
+    uint64_t ns = bench_now() - start;
+
+    free(buf);
+    return ns;
+}
+
+typedef struct _BenchSkipThread
+{
+    SkipList *list;
+    IntSkip **items;
+    int count;
+} BenchSkipThread;
+
+static void *insertThread(void *arg)
+{
+    BenchSkipThread *ctx = (BenchSkipThread *)arg;
+    int i;
+    for (i = 0; i < ctx->count; i++)
+        SkipList_insert(ctx->list, &ctx->items[i]->super, &ctx->items[i]->key);
+    return NULL;
+}
+
+static uint64_t benchSkipListConcurrent(int count)
+{
+    size_t size = count * (sizeof(IntSkip) + sizeof(SkipNodeRef) * 2) + 1024;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    IntSkip **items = (IntSkip **)malloc(sizeof(IntSkip *) * count);
+    pthread_t threads[BENCH_SKIP_THREADS];
+    BenchSkipThread ctx[BENCH_SKIP_THREADS];
+    SkipList list;
+    int i;
+
+    SkipList_init(&list, intCompare);
+    for (i = 0; i < count; i++)
+    {
+        items[i] = SkipList_new(&list, alloc, IntSkip);
+        if (items[i] == NULL)
+        {
+            LOGE("SkipList bench buffer exhausted");
+            count = i;
+            break;
+        }
+        items[i]->key = randomKey(i);
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < BENCH_SKIP_THREADS; i++)
+    {
+        ctx[i].list = &list;
+        ctx[i].items = items + i * (count / BENCH_SKIP_THREADS);
+        ctx[i].count = count / BENCH_SKIP_THREADS;
+        pthread_create(&threads[i], NULL, insertThread, &ctx[i]);
+    }
+    for (i = 0; i < BENCH_SKIP_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    uint64_t ns = bench_now() - start;
+
+    free(items);
+    free(buf);
+    return ns;
+}
+
+void bench_skip_list(void)
+{
+    static int const counts[] = {1000, 10000, 30000};
+    char name[64];
+    size_t i;
+
+    BENCH_SUITE("skip_list");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        snprintf(name, sizeof(name), "sorted DbList insert, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchDbList(counts[i]));
+        snprintf(name, sizeof(name), "SkipList insert, n=%d", counts[i]);
+        BENCH_REPORT(name, counts[i], benchSkipList(counts[i]));
+    }
+
+    snprintf(name, sizeof(name), "SkipList insert, %d threads, n=%d", BENCH_SKIP_THREADS, 1000000);
+    BENCH_REPORT(name, 1000000, benchSkipListConcurrent(1000000));
+}
@@ -0,0 +1,190 @@
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#define BENCH_RING_CAPACITY 4096
+#define BENCH_RING_BATCH 64
+
+typedef struct _IntList
+{
+    List super;
+    uintptr_t value;
+} IntList;
+
+/* a linked queue under a mutex, one allocation per item. */
+typedef struct _ListQueue
+{
+    pthread_mutex_t lock;
+    ListRef head;
+    ListRef *tail;
+} ListQueue;
+
+typedef struct _BenchRing
+{
+    SpscRing ring;
+    ListQueue queue;
+    size_t count;
+    size_t batch;
+    uintptr_t sum;
+} BenchRing;
+
+static void *ringProducer(void *arg)
+{
+    BenchRing *ctx = (BenchRing *)arg;
+    void *items[BENCH_RING_BATCH];
+    uintptr_t i;
+    size_t j, n;
+
+    if (ctx->batch == 1)
+    {
+        for (i = 1; i <= ctx->count; i++)
+        {
+            while (!SpscRing_push(&ctx->ring, (void *)i))
+                sched_yield();
+        }
+        return NULL;
+    }
+
+    for (i = 1; i <= ctx->count; i += n)
+    {
+        n = MIN(ctx->batch, ctx->count - i + 1);
+        for (j = 0; j < n; j++)
+            items[j] = (void *)(i + j);
+        j = SpscRing_pushN(&ctx->ring, items, n);
+        while (j < n)
+        {
+            sched_yield();
+            j += SpscRing_pushN(&ctx->ring, items + j, n - j);
+        }
+    }
+    return NULL;
+}
+
+static void ringConsumer(BenchRing *ctx)
+{
+    void *items[BENCH_RING_BATCH];
+    size_t i = 0, j, n;
+    void *item;
+
+    while (i < ctx->count)
+    {
+        if (ctx->batch == 1)
+        {
+            if (!SpscRing_pop(&ctx->ring, &item))
+            {
+                sched_yield();
+                continue;
+            }
+            ctx->sum += (uintptr_t)item;
+            i++;
+            continue;
+        }
+
+        n = SpscRing_popN(&ctx->ring, items, ctx->batch);
+        if (n == 0)
+            sched_yield();
+        for (j = 0; j < n; j++)
+            ctx->sum += (uintptr_t)items[j];
+        i += n;
+    }
+}
+
+static uint64_t benchRing(size_t count, size_t batch)
+{
+    static BenchRing ctx;
+    void *buf = malloc(sizeof(void *) * BENCH_RING_CAPACITY + 64);
+    AllocatorRef alloc = StaticAllocator(sizeof(void *) * BENCH_RING_CAPACITY + 64, buf);
+    pthread_t thread;
+
+    SpscRing_init(&ctx.ring, alloc, BENCH_RING_CAPACITY);
+    ctx.count = count;
+    ctx.batch = batch;
+    ctx.sum = 0;
+
+    uint64_t start = bench_now();
+    pthread_create(&thread, NULL, ringProducer, &ctx);
+    ringConsumer(&ctx);
+    pthread_join(thread, NULL);
+    uint64_t ns = bench_now() - start;
+
+    if (ctx.sum != (uintptr_t)count * (count + 1) / 2)
+        LOGE("SpscRing lost items");
+    free(buf);
+    return ns;
+}
+
+static void *queueProducer(void *arg)
+{
+    BenchRing *ctx = (BenchRing *)arg;
+    uintptr_t i;
+
+    for (i = 1; i <= ctx->count; i++)
+    {
+        IntList *item = (IntList *)malloc(sizeof(IntList));
+        item->value = i;
+        item->super.next = NULL;
+
+        pthread_mutex_lock(&ctx->queue.lock);
+        *ctx->queue.tail = &item->super;
+        ctx->queue.tail = &item->super.next;
+        pthread_mutex_unlock(&ctx->queue.lock);
+    }
+    return NULL;
+}
+
+static uint64_t benchListQueue(size_t count)
+{
+    static BenchRing ctx;
+    pthread_t thread;
+    size_t i = 0;
+
+    pthread_mutex_init(&ctx.queue.lock, NULL);
+    ctx.queue.head = NULL;
+    ctx.queue.tail = &ctx.queue.head;
+    ctx.count = count;
+    ctx.sum = 0;
+
+    uint64_t start = bench_now();
+    pthread_create(&thread, NULL, queueProducer, &ctx);
+    while (i < count)
+    {
+        pthread_mutex_lock(&ctx.queue.lock);
+        ListRef node = ctx.queue.head;
+        if (node != NULL)
+        {
+            ctx.queue.head = node->next;
+            if (ctx.queue.head == NULL)
+                ctx.queue.tail = &ctx.queue.head;
+        }
+        pthread_mutex_unlock(&ctx.queue.lock);
+
+        if (node == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        ctx.sum += DOWN_CAST(node, IntList)->value;
+        free(node);
+        i++;
+    }
+    pthread_join(thread, NULL);
+    uint64_t ns = bench_now() - start;
+
+    pthread_mutex_destroy(&ctx.queue.lock);
+    return ns;
+}
+
+void bench_spsc_ring(void)
+{
+    char name[64];
+
+    BENCH_SUITE("spsc_ring");
+    snprintf(name, sizeof(name), "locked List queue, n=%d", 1000000);
+    BENCH_REPORT(name, 1000000, benchListQueue(1000000));
+    snprintf(name, sizeof(name), "SpscRing push/pop, n=%d", 10000000);
+    BENCH_REPORT(name, 10000000, benchRing(10000000, 1));
+    snprintf(name, sizeof(name), "SpscRing batch %d, n=%d", BENCH_RING_BATCH, 10000000);
+    BENCH_REPORT(name, 10000000, benchRing(10000000, BENCH_RING_BATCH));
+}
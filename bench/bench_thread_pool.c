@@ -0,0 +1,82 @@
+#include "bench.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#define BENCH_POOL_THREADS 4
+
+static void addOne(void *arg)
+{
+    __atomic_fetch_add((int *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void *addOneThread(void *arg)
+{
+    addOne(arg);
+    return NULL;
+}
+
+/* one thread per task, created and joined in batches of pool size. */
+static uint64_t benchCreate(int count)
+{
+    pthread_t threads[BENCH_POOL_THREADS];
+    int i, j, sum = 0;
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i += BENCH_POOL_THREADS)
+    {
+        for (j = 0; j < BENCH_POOL_THREADS; j++)
+            pthread_create(&threads[j], NULL, addOneThread, &sum);
+        for (j = 0; j < BENCH_POOL_THREADS; j++)
+            pthread_join(threads[j], NULL);
+    }
+    uint64_t ns = bench_now() - start;
+
+    if (sum != count)
+        LOGE("pthread create lost tasks");
+    return ns;
+}
+
+/* submit in batches and wait, so workers park and wake every batch. */
+static uint64_t benchPool(int count, int batch)
+{
+    ThreadWork *works = (ThreadWork *)malloc(sizeof(ThreadWork) * batch);
+    size_t size = 4096;
+    void *buf = malloc(size);
+    AllocatorRef alloc = StaticAllocator(size, buf);
+    ThreadGroup group;
+    ThreadPool pool;
+    int i, j, sum = 0;
+
+    ThreadPool_init(&pool, alloc, BENCH_POOL_THREADS);
+    ThreadGroup_init(&group);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < count; i += batch)
+    {
+        for (j = 0; j < batch; j++)
+            ThreadPool_submit(&pool, &works[j], addOne, &sum, &group);
+        ThreadPool_wait(&pool, &group);
+    }
+    uint64_t ns = bench_now() - start;
+
+    ThreadPool_destroy(&pool);
+    if (sum != count)
+        LOGE("ThreadPool lost tasks");
+    free(buf);
+    free(works);
+    return ns;
+}
+
+void bench_thread_pool(void)
+{
+    char name[64];
+
+    BENCH_SUITE("thread_pool");
+    snprintf(name, sizeof(name), "pthread create per task, n=%d", 20000);
+    BENCH_REPORT(name, 20000, benchCreate(20000));
+    snprintf(name, sizeof(name), "ThreadPool batch %d, n=%d", BENCH_POOL_THREADS, 20000);
+    BENCH_REPORT(name, 20000, benchPool(20000, BENCH_POOL_THREADS));
+    snprintf(name, sizeof(name), "ThreadPool batch %d, n=%d", 1000, 1000000);
+    BENCH_REPORT(name, 1000000, benchPool(1000000, 1000));
+}
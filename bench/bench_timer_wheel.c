@@ -0,0 +1,112 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct _RbTimer
+{
+    RbNode super;
+    uint64_t expires;
+} RbTimer;
+
+#define BENCH_TIMER_COUNT 1000000
+#define BENCH_TIMER_SPAN (1 << 16)
+
+static size_t __fired = 0;
+
+static int timerCompare(RbNodeRef node, void const *key)
+{
+    uint64_t a = DOWN_CAST(node, RbTimer)->expires, b = *(uint64_t const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static void onExpire(TimerRef timer)
+{
+    (void)timer;
+    __fired++;
+}
+
+static uint64_t randomExpires(int i)
+{
+    return Hash_uint64(i) % BENCH_TIMER_SPAN + 1;
+}
+
+/* timers ordered by expiry in a RbTree, the usual timer queue. */
+static void benchRbTree(int count)
+{
+    RbTimer *items = (RbTimer *)malloc(sizeof(RbTimer) * count);
+    RbTree tree;
+    uint64_t start, now;
+    int i;
+
+    RbTree_init(&tree, timerCompare);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        items[i].expires = randomExpires(i);
+        RbTree_insert(&tree, &items[i].super, &items[i].expires);
+    }
+    BENCH_REPORT("RbTree schedule", count, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        if (i % 10 != 0)
+            RbTree_erase(&tree, &items[i].super);
+    }
+    BENCH_REPORT("RbTree cancel 90%", count - count / 10, bench_now() - start);
+
+    __fired = 0;
+    start = bench_now();
+    for (now = 0; now <= BENCH_TIMER_SPAN; now++)
+    {
+        RbNodeRef first;
+        while ((first = RbTree_first(&tree)) != NULL && DOWN_CAST(first, RbTimer)->expires <= now)
+        {
+            RbTree_erase(&tree, first);
+            __fired++;
+        }
+    }
+    BENCH_REPORT("RbTree expire 10%", __fired, bench_now() - start);
+
+    free(items);
+}
+
+static void benchTimerWheel(int count)
+{
+    Timer *items = (Timer *)malloc(sizeof(Timer) * count);
+    TimerWheel wheel;
+    uint64_t start;
+    int i;
+
+    TimerWheel_init(&wheel, 0);
+    for (i = 0; i < count; i++)
+        Timer_init(&items[i]);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+        TimerWheel_schedule(&wheel, &items[i], randomExpires(i), onExpire);
+    BENCH_REPORT("TimerWheel schedule", count, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        if (i % 10 != 0)
+            TimerWheel_cancel(&wheel, &items[i]);
+    }
+    BENCH_REPORT("TimerWheel cancel 90%", count - count / 10, bench_now() - start);
+
+    __fired = 0;
+    start = bench_now();
+    TimerWheel_advance(&wheel, BENCH_TIMER_SPAN);
+    BENCH_REPORT("TimerWheel expire 10%", __fired, bench_now() - start);
+
+    free(items);
+}
+
+void bench_timer_wheel(void)
+{
+    BENCH_SUITE("timer_wheel");
+    benchRbTree(BENCH_TIMER_COUNT);
+    benchTimerWheel(BENCH_TIMER_COUNT);
+}
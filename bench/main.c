@@ -0,0 +1,18 @@
+#include "bench.h"
+
+int main(void)
+{
+    bench_skip_list();
+    bench_timer_wheel();
+    bench_pairing_heap();
+    bench_list_foreach();
+    bench_spsc_ring();
+    bench_thread_pool();
+    bench_art();
+    bench_flat_map();
+    bench_bp_tree();
+    bench_bloom_filter();
+    bench_async_log();
+    bench_bin_log();
+    return 0;
+}
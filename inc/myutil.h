@@ -30,6 +30,27 @@
 #include "myutil/allocator.h"
 #include "myutil/list.h"
 #include "myutil/double_list.h"
+#include "myutil/rcu.h"
+#include "myutil/hash_table.h"
+#include "myutil/lru_cache.h"
+#include "myutil/skip_list.h"
+#include "myutil/rb_tree.h"
+#include "myutil/timer_wheel.h"
+#include "myutil/pairing_heap.h"
+#include "myutil/thread_pool.h"
+#include "myutil/offset_list.h"
+#include "myutil/spsc_ring.h"
+#include "myutil/task_scheduler.h"
+#include "myutil/art.h"
+#include "myutil/bitset.h"
+#include "myutil/vector.h"
+#include "myutil/flat_map.h"
+#include "myutil/bp_tree.h"
+#include "myutil/bloom_filter.h"
+#include "myutil/string_pool.h"
+#include "myutil/rope.h"
+#include "myutil/async_log.h"
+#include "myutil/bin_log.h"
 
 #include "myutil/test.h"
 
@@ -80,12 +80,15 @@ static inline void *Allocator_alloc(AllocatorRef self, size_t size)
 /**
  * Free memory to allocator.
  * 
+ * Do nothing if the allocator cannot free, e.g. static allocator.
+ * 
  * @param self: the allocator.
  * @param p: the memory pointer to be free.
  */
 static inline void Allocator_free(AllocatorRef self, void *p)
 {
-    self->vt->free(self, p);
+    if (self->vt->free != NULL)
+        self->vt->free(self, p);
 };
 
 /** 
@@ -0,0 +1,240 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file art.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_ART_H__
+#define __MYUTIL_ART_H__
+
+#include "types.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  ArtLeaf interface
+ * ------------------------------------------------------------------------ */
+
+#define ART_MAX_KEY_LEN     64  /**< max key length in bytes */
+#define ART_MAX_PREFIX_LEN  8   /**< prefix bytes stored in inner nodes */
+
+/**
+ * Class ArtLeaf.
+ * 
+ * A leaf of adaptive radix tree, embedded in user object. The key memory
+ * belongs to user and must stay unchanged while the leaf is in a tree.
+ * 
+ * Keys are compared as bytes, and no key may be a prefix of another one,
+ * so use fixed length keys, or strings with the terminating '\0'.
+ */
+typedef struct _ArtLeaf
+{
+    uint8_t const *key;         /**< key bytes */
+    size_t keyLen;              /**< key length */
+} ArtLeaf, *ArtLeafRef;
+
+/**
+ * Init leaf key.
+ * 
+ * @param self: the ArtLeaf object to be init.
+ * @param key: the key bytes.
+ * @param keyLen: the key length, up to ART_MAX_KEY_LEN.
+ */
+static inline void ArtLeaf_init(ArtLeafRef self, void const *key, size_t keyLen)
+{
+    self->key = (uint8_t const *)key;
+    self->keyLen = keyLen;
+};
+
+/**
+ * Encode an integer as a big endian key, so keys are ordered as integers.
+ * 
+ * @param key: the 8 bytes buffer of key.
+ * @param value: the integer.
+ */
+static inline void Art_encodeUint64(uint8_t key[8], uint64_t value)
+{
+    int i;
+    for (i = 7; i >= 0; i--, value >>= 8)
+        key[i] = (uint8_t)value;
+};
+
+/* ---------------------------------------------------------------------------
+ *  ArtTree interface
+ * ------------------------------------------------------------------------ */
+
+struct _ArtNode;
+
+/**
+ * Class ArtTree.
+ * 
+ * An intrusive adaptive radix tree. Inner nodes grow and shrink between 4,
+ * 16, 48 and 256 children, and single child paths are compressed into
+ * node prefixes. Lookup is O(key length) regardless of count.
+ */
+typedef struct _ArtTree
+{
+    void *root;                 /**< root node or tagged leaf */
+    size_t count;               /**< leaf count */
+    AllocatorRef allocator;     /**< allocator of inner nodes */
+} ArtTree, *ArtTreeRef;
+
+/**
+ * Init tree.
+ * 
+ * @param self: the ArtTree object to be init.
+ * @param allocator: the allocator of inner nodes.
+ */
+static inline void ArtTree_init(ArtTreeRef self, AllocatorRef allocator)
+{
+    self->root = NULL;
+    self->count = 0;
+    self->allocator = allocator;
+};
+
+/**
+ * Release all inner nodes, leaves are left to user.
+ * 
+ * @param self: the ArtTree object.
+ */
+void ArtTree_destroy(ArtTreeRef self);
+
+/**
+ * Get leaf count.
+ * 
+ * @param self: the ArtTree object.
+ * @return the count of leaves.
+ */
+static inline size_t ArtTree_count(ArtTreeRef self)
+{
+    return self->count;
+};
+
+/**
+ * Insert a leaf if its key is absent.
+ * 
+ * The count grows only when leaf is linked, re-inserting a leaf already
+ * in the tree returns it and changes nothing.
+ * 
+ * @param self: the ArtTree object.
+ * @param leaf: the leaf to insert.
+ * @return leaf if inserted, the existing leaf of same key, or NULL if
+ *      allocation failed, the key is too long, or it is a prefix of
+ *      another key or the reverse.
+ */
+ArtLeafRef ArtTree_insert(ArtTreeRef self, ArtLeafRef leaf);
+
+/**
+ * Remove the leaf of a key.
+ * 
+ * @param self: the ArtTree object.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ * @return the removed leaf, or NULL if not found.
+ */
+ArtLeafRef ArtTree_remove(ArtTreeRef self, void const *key, size_t keyLen);
+
+/**
+ * Find the leaf of a key.
+ * 
+ * @param self: the ArtTree object.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ * @return the leaf, or NULL if not found.
+ */
+ArtLeafRef ArtTree_find(ArtTreeRef self, void const *key, size_t keyLen);
+
+/**
+ * Get the leaf of the smallest key.
+ * 
+ * @param self: the ArtTree object.
+ * @return the first leaf, or NULL if empty.
+ */
+ArtLeafRef ArtTree_first(ArtTreeRef self);
+
+/* ---------------------------------------------------------------------------
+ *  ArtIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class ArtIter.
+ * 
+ * An in-order tree iterator, keeping the path of inner nodes. The tree
+ * must not be changed while iterating.
+ */
+typedef struct _ArtIter
+{
+    struct
+    {
+        struct _ArtNode *node;  /**< inner node */
+        size_t pos;             /**< next child position */
+    } stack[ART_MAX_KEY_LEN + 1];
+    size_t depth;               /**< stack depth */
+    ArtLeafRef current;         /**< current leaf, NULL before start */
+    ArtLeafRef pending;         /**< the leaf first next() moves to */
+} ArtIter, *ArtIterRef;
+
+/**
+ * Init iterator before the first leaf.
+ * 
+ * @param self: the ArtIter object to be init.
+ * @param tree: the ArtTree to travel.
+ */
+void ArtIter_init(ArtIterRef self, ArtTreeRef tree);
+
+/**
+ * Init iterator before the first leaf whose key is not less than key.
+ * 
+ * @param self: the ArtIter object to be init.
+ * @param tree: the ArtTree to travel.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ */
+void ArtIter_seek(ArtIterRef self, ArtTreeRef tree, void const *key, size_t keyLen);
+
+/**
+ * Move iterator to next leaf in key order.
+ * 
+ * @param self: the ArtIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool ArtIter_next(ArtIterRef self);
+
+/**
+ * Get current leaf.
+ * 
+ * @param self: the ArtIter object pointer.
+ * @return the current leaf.
+ */
+static inline ArtLeafRef ArtIter_current(ArtIterRef self)
+{
+    return self->current;
+};
+
+/** fast down cast helper to get current object */
+#define ArtIter_curObj(iter, type) (DOWN_CAST(ArtIter_current(&iter), type))
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_ART_H__ */
@@ -0,0 +1,150 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file async_log.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_ASYNC_LOG_H__
+#define __MYUTIL_ASYNC_LOG_H__
+
+#include "types.h"
+#include "allocator.h"
+
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  AsyncLog interface
+ * ------------------------------------------------------------------------ */
+
+#define ASYNC_LOG_DROP      0       /**< drop messages while the ring is full */
+#define ASYNC_LOG_BLOCK     1       /**< wait for room while the ring is full */
+
+#define ASYNC_LOG_SLOT_SIZE 256     /**< bytes of a ring slot, longer messages are truncated */
+#define ASYNC_LOG_BATCH     64      /**< max messages of one sink write */
+
+/** sink of formatted messages, called by the flusher thread only. */
+typedef void (*AsyncLogSink)(void const *data, size_t len, void *arg);
+
+struct _AsyncLogCore;
+
+/**
+ * Class AsyncLog.
+ * 
+ * An asynchronous log backend. Producer threads format messages straight
+ * into the slots of a bounded lock-free MPSC ring, and a flusher thread
+ * copies ready slots out in batches and writes each batch by one sink call,
+ * so a slow sink never stalls producers until the ring is full. The flusher
+ * parks on a futex while the ring is empty, producers only make a syscall
+ * when it is parked.
+ * 
+ * Define LOG_ASYNC before including myutil.h to route LOGE, LOGW, LOGI and
+ * LOGD into the default AsyncLog, see AsyncLog_setDefault.
+ */
+typedef struct _AsyncLog
+{
+    AllocatorRef allocator;         /**< allocator of core */
+    struct _AsyncLogCore *core;     /**< ring and flusher thread */
+    size_t capacity;                /**< slot count */
+    int policy;                     /**< ASYNC_LOG_DROP or ASYNC_LOG_BLOCK */
+} AsyncLog, *AsyncLogRef;
+
+/**
+ * Init log and start the flusher thread.
+ * 
+ * @param self: the AsyncLog object to be init.
+ * @param allocator: the allocator of ring.
+ * @param capacity: the min count of queued messages, rounded up to power of 2.
+ * @param policy: ASYNC_LOG_DROP or ASYNC_LOG_BLOCK.
+ * @param sink: the sink of messages, or NULL for stdout.
+ * @param arg: the argument of sink.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool AsyncLog_init(AsyncLogRef self, AllocatorRef allocator, size_t capacity, int policy,
+    AsyncLogSink sink, void *arg);
+
+/**
+ * Write queued messages, stop the flusher thread and release ring.
+ * 
+ * No thread could write to the log during or after the call.
+ * 
+ * @param self: the AsyncLog object.
+ */
+void AsyncLog_destroy(AsyncLogRef self);
+
+/**
+ * Format a message into the ring, a newline is appended.
+ * 
+ * @param self: the AsyncLog object.
+ * @param prefix: the text in front of message, or NULL.
+ * @param format: the printf format.
+ * @param args: the arguments of format.
+ * @return false if the message is dropped by a full ring.
+ */
+bool AsyncLog_vwrite(AsyncLogRef self, char const *prefix, char const *format, va_list args);
+
+/**
+ * Format a message into the ring, a newline is appended.
+ * 
+ * @param self: the AsyncLog object.
+ * @param prefix: the text in front of message, or NULL.
+ * @param format: the printf format.
+ * @return false if the message is dropped by a full ring.
+ */
+bool AsyncLog_write(AsyncLogRef self, char const *prefix, char const *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * Wait until all messages written before the call are passed to sink.
+ * 
+ * @param self: the AsyncLog object.
+ */
+void AsyncLog_flush(AsyncLogRef self);
+
+/**
+ * Get the count of dropped messages.
+ * 
+ * @param self: the AsyncLog object.
+ * @return the count of messages dropped by a full ring.
+ */
+size_t AsyncLog_dropped(AsyncLogRef self);
+
+/**
+ * Set the log used by LOG macros when LOG_ASYNC is defined.
+ * 
+ * @param self: the AsyncLog object, or NULL to print synchronously.
+ */
+void AsyncLog_setDefault(AsyncLogRef self);
+
+/**
+ * Format a message into the default log, or print it if there is none.
+ * 
+ * @param prefix: the text in front of message.
+ * @param format: the printf format.
+ */
+void AsyncLog_print(char const *prefix, char const *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_ASYNC_LOG_H__ */
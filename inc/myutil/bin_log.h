@@ -0,0 +1,325 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bin_log.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_BIN_LOG_H__
+#define __MYUTIL_BIN_LOG_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+#include "list.h"
+#include "async_log.h"
+
+#include <string.h>
+#if !defined(__x86_64__) && !defined(__i386__)
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  BinLog interface
+ * ------------------------------------------------------------------------ */
+
+#define BIN_LOG_MAX_ARGS    16      /**< max arguments of a BIN_LOG call */
+#define BIN_LOG_LINE_SIZE   512     /**< max bytes of a formatted line, longer are truncated */
+#define BIN_LOG_TEXT_SIZE   0x4000  /**< bytes of formatted text per sink call */
+
+#define BIN_LOG_INT         1       /**< signed integer argument, 8 bytes */
+#define BIN_LOG_UINT        2       /**< unsigned integer argument, 8 bytes */
+#define BIN_LOG_DOUBLE      3       /**< floating point argument, 8 bytes */
+#define BIN_LOG_STRING      4       /**< string argument, length and copied text */
+#define BIN_LOG_POINTER     5       /**< pointer argument, 8 bytes */
+
+/** static description of a BIN_LOG call site, its address is the format id. */
+typedef struct _BinLogFormat
+{
+    char const *format;                 /**< printf format */
+    uint32_t argc;                      /**< argument count */
+    uint8_t types[BIN_LOG_MAX_ARGS];    /**< argument types, BIN_LOG_INT etc. */
+} BinLogFormat;
+
+/** record header in writer buffer, arguments follow in 8 byte slots. */
+typedef struct _BinLogRecord
+{
+    uint32_t size;                      /**< bytes of record, 0 to wrap to buffer start */
+    uint32_t reserved;                  /**< unused */
+    BinLogFormat const *format;         /**< format id */
+    uint64_t time;                      /**< BinLog_now() of the call */
+} BinLogRecord;
+
+/**
+ * Class BinLogWriter.
+ * 
+ * A single producer byte ring of binary records, usually one per thread.
+ * The producer only reserves bytes, stores raw arguments and publishes by
+ * one index update, formatting happens in BinLog_format.
+ */
+typedef struct _BinLogWriter
+{
+    List super;                 /**< node of attached writers */
+    void *memory;               /**< allocated memory of buffer */
+    uint8_t *buffer;            /**< ring buffer, 8 byte aligned */
+    size_t mask;                /**< buffer size - 1 */
+
+    /* written by producer */
+    CACHE_ALIGNED size_t head;  /**< end of published records */
+    size_t pending;             /**< end of the record being written */
+    size_t tailCache;           /**< last seen tail */
+    size_t dropped;             /**< count of records dropped by a full buffer */
+
+    /* written by consumer */
+    CACHE_ALIGNED size_t tail;  /**< start of unread records */
+    size_t headCache;           /**< last seen head */
+} CACHE_ALIGNED BinLogWriter, *BinLogWriterRef;
+
+/**
+ * Class BinLog.
+ * 
+ * A deferred binary log. BIN_LOG stores the address of a static format
+ * description, a timestamp and raw arguments into the writer of calling
+ * thread, argument types are encoded at compile time. Records of all
+ * writers are formatted later, by time order, in a consumer thread calling
+ * BinLog_format. A record is dropped when its writer is full.
+ */
+typedef struct _BinLog
+{
+    ListRef writers;            /**< attached writers */
+    char *text;                 /**< formatted text buffer */
+    uint64_t startTime;         /**< BinLog_now() at init */
+    uint64_t startNs;           /**< monotonic ns at init */
+    double ticksPerNs;          /**< rate of BinLog_now() */
+    AllocatorRef allocator;     /**< allocator of buffers */
+} BinLog, *BinLogRef;
+
+/**
+ * Get the timestamp of records, cpu ticks where available.
+ * 
+ * @return the timestamp.
+ */
+static inline uint64_t BinLog_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+};
+
+/**
+ * Init log.
+ * 
+ * @param self: the BinLog object to be init.
+ * @param allocator: the allocator of text and writer buffers.
+ * @return true if success, false if allocation failed.
+ */
+bool BinLog_init(BinLogRef self, AllocatorRef allocator);
+
+/**
+ * Release log and buffers of all writers.
+ * 
+ * @param self: the BinLog object.
+ */
+void BinLog_destroy(BinLogRef self);
+
+/**
+ * Attach a writer to log.
+ * 
+ * Writers are never detached, they must stay valid until BinLog_destroy.
+ * The allocator is called, so attach is not thread safe unless allocator is.
+ * 
+ * @param self: the BinLog object.
+ * @param writer: the BinLogWriter object to be init.
+ * @param size: the min bytes of buffer, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool BinLog_attach(BinLogRef self, BinLogWriterRef writer, size_t size);
+
+/**
+ * Format all published records by time order and pass text to sink.
+ * 
+ * Only one thread could call it at a time.
+ * 
+ * @param self: the BinLog object.
+ * @param sink: the sink of formatted lines.
+ * @param arg: the argument of sink.
+ * @return the count of formatted records.
+ */
+size_t BinLog_format(BinLogRef self, AsyncLogSink sink, void *arg);
+
+/**
+ * Get the count of dropped records.
+ * 
+ * @param self: the BinLog object.
+ * @return the count of records dropped by full writers.
+ */
+size_t BinLog_dropped(BinLogRef self);
+
+/**
+ * Reserve a record, producer only.
+ * 
+ * @param self: the BinLogWriter object.
+ * @param format: the format id.
+ * @param args: the bytes of arguments, multiple of 8.
+ * @return the argument slots, or NULL if buffer is full.
+ */
+static inline uint64_t *BinLogWriter_begin(BinLogWriterRef self, BinLogFormat const *format, size_t args)
+{
+    size_t size = sizeof(BinLogRecord) + args;
+    size_t head = self->head, capacity = self->mask + 1;
+    size_t pad = capacity - (head & self->mask);
+    BinLogRecord *record;
+
+    /* a record never wraps, skip the rest of buffer if it does not fit. */
+    if (pad >= size)
+        pad = 0;
+    if (head + pad + size - self->tailCache > capacity)
+    {
+        self->tailCache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        if (head + pad + size - self->tailCache > capacity)
+        {
+            __atomic_store_n(&self->dropped, self->dropped + 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+
+    if (pad != 0)
+    {
+        ((BinLogRecord *)(self->buffer + (head & self->mask)))->size = 0;
+        head += pad;
+    }
+    record = (BinLogRecord *)(self->buffer + (head & self->mask));
+    record->size = (uint32_t)size;
+    record->format = format;
+    record->time = BinLog_now();
+    self->pending = head + size;
+    return (uint64_t *)(record + 1);
+};
+
+/**
+ * Publish the reserved record, producer only.
+ * 
+ * @param self: the BinLogWriter object.
+ */
+static inline void BinLogWriter_commit(BinLogWriterRef self)
+{
+    __atomic_store_n(&self->head, self->pending, __ATOMIC_RELEASE);
+};
+
+/** @cond DO_NOT_DOCUMENT */
+static inline uint64_t *BinLog_putInt(uint64_t *p, int64_t v)
+{
+    *p = (uint64_t)v;
+    return p + 1;
+};
+
+static inline uint64_t *BinLog_putUint(uint64_t *p, uint64_t v)
+{
+    *p = v;
+    return p + 1;
+};
+
+static inline uint64_t *BinLog_putDouble(uint64_t *p, double v)
+{
+    memcpy(p, &v, sizeof(v));
+    return p + 1;
+};
+
+static inline uint64_t *BinLog_putPointer(uint64_t *p, void const *v)
+{
+    *p = (uint64_t)(uintptr_t)v;
+    return p + 1;
+};
+
+/* length slot, or UINT64_MAX for NULL, then text with '\0' padded to 8. */
+static inline uint64_t *BinLog_putString(uint64_t *p, char const *s)
+{
+    size_t len;
+
+    if (s == NULL)
+    {
+        *p = UINT64_MAX;
+        return p + 1;
+    }
+    len = strlen(s);
+    *p = len;
+    memcpy(p + 1, s, len + 1);
+    return p + 1 + ALIGN(len + 1, 8) / 8;
+};
+
+static inline size_t BinLog_stringSize(char const *s)
+{
+    return s == NULL ? 0 : ALIGN(strlen(s) + 1, 8);
+};
+
+static inline void __myutil_bin_log_check(char const *format, ...) __attribute__((format(printf, 1, 2)));
+static inline void __myutil_bin_log_check(char const *format, ...)
+{
+    (void)format;
+};
+
+#define __MYUTIL_BIN_LOG_SELECT(x, i, u, d, s, p) _Generic((x), \
+    char: i, signed char: i, short: i, int: i, long: i, long long: i, \
+    unsigned char: u, unsigned short: u, unsigned int: u, unsigned long: u, unsigned long long: u, _Bool: u, \
+    float: d, double: d, long double: d, \
+    char *: s, char const *: s, \
+    default: p)
+#define __MYUTIL_BIN_LOG_TYPE(x) \
+    __MYUTIL_BIN_LOG_SELECT(x, BIN_LOG_INT, BIN_LOG_UINT, BIN_LOG_DOUBLE, BIN_LOG_STRING, BIN_LOG_POINTER),
+#define __MYUTIL_BIN_LOG_SIZE(x) \
+    + BinLog_stringSize(__MYUTIL_BIN_LOG_SELECT(x, NULL, NULL, NULL, (x), NULL))
+#define __MYUTIL_BIN_LOG_PUT(p, x) \
+    p = __MYUTIL_BIN_LOG_SELECT(x, BinLog_putInt, BinLog_putUint, BinLog_putDouble, BinLog_putString, BinLog_putPointer)(p, x);
+/** @endcond */
+
+/** log a record into writer, formatted later by BinLog_format.
+ * 
+ * The format must be a string literal, checked against arguments like
+ * printf. Integers, floating points, strings and pointers are supported,
+ * strings are copied and evaluated twice, other arguments once.
+ * 
+ * @param writer: the BinLogWriter of calling thread.
+ * @param format: the printf format.
+ */
+#define BIN_LOG(writer, format, ...) do { \
+        static BinLogFormat const __myutil_bin_log_format = { \
+            format, ARG_COUNT(__VA_ARGS__), { ARG_LIST(__MYUTIL_BIN_LOG_TYPE, ##__VA_ARGS__) } }; \
+        _Static_assert(ARG_COUNT(__VA_ARGS__) <= BIN_LOG_MAX_ARGS, "too many arguments of BIN_LOG"); \
+        if (0) \
+            __myutil_bin_log_check(format, ##__VA_ARGS__); \
+        uint64_t *__myutil_bin_log_p = BinLogWriter_begin((writer), &__myutil_bin_log_format, \
+            8 * ARG_COUNT(__VA_ARGS__) ARG_LIST(__MYUTIL_BIN_LOG_SIZE, ##__VA_ARGS__)); \
+        if (__myutil_bin_log_p != NULL) \
+        { \
+            ARG_LIST1(__MYUTIL_BIN_LOG_PUT, __myutil_bin_log_p, ##__VA_ARGS__) \
+            BinLogWriter_commit(writer); \
+        } \
+    } while (0)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_BIN_LOG_H__ */
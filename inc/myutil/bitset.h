@@ -0,0 +1,214 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bitset.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_BITSET_H__
+#define __MYUTIL_BITSET_H__
+
+#include "types.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Bitset interface
+ * ------------------------------------------------------------------------ */
+
+#define BITSET_NONE ((size_t)-1)    /**< not found result of find and select */
+
+/**
+ * Class Bitset.
+ * 
+ * A fixed size bitset of 64-bit words. Bits beyond size are kept zero.
+ * 
+ * Rank and select use an index of per 512 bits counts after
+ * Bitset_buildRank, it must be rebuilt after the bitset is changed.
+ */
+typedef struct _Bitset
+{
+    uint64_t *words;            /**< bit words, bit i in word i / 64 */
+    size_t bits;                /**< bit count */
+    size_t length;              /**< word count */
+    uint32_t *ranks;            /**< set bits before each 512 bits block, or NULL */
+    AllocatorRef allocator;     /**< allocator of words and ranks */
+} Bitset, *BitsetRef;
+
+/**
+ * Init bitset with all bits cleared.
+ * 
+ * @param self: the Bitset object to be init.
+ * @param allocator: the allocator of words.
+ * @param bits: the bit count.
+ * @return true if success, false if allocation failed.
+ */
+bool Bitset_init(BitsetRef self, AllocatorRef allocator, size_t bits);
+
+/**
+ * Release words and rank index.
+ * 
+ * @param self: the Bitset object.
+ */
+void Bitset_destroy(BitsetRef self);
+
+/**
+ * Get bit count.
+ * 
+ * @param self: the Bitset object.
+ * @return the count of bits.
+ */
+static inline size_t Bitset_size(BitsetRef self)
+{
+    return self->bits;
+};
+
+/**
+ * Set a bit.
+ * 
+ * @param self: the Bitset object.
+ * @param i: the bit index, less than size.
+ */
+static inline void Bitset_set(BitsetRef self, size_t i)
+{
+    self->words[i >> 6] |= (uint64_t)1 << (i & 63);
+};
+
+/**
+ * Clear a bit.
+ * 
+ * @param self: the Bitset object.
+ * @param i: the bit index, less than size.
+ */
+static inline void Bitset_clear(BitsetRef self, size_t i)
+{
+    self->words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+};
+
+/**
+ * Test a bit.
+ * 
+ * @param self: the Bitset object.
+ * @param i: the bit index, less than size.
+ * @return true if the bit is set.
+ */
+static inline bool Bitset_test(BitsetRef self, size_t i)
+{
+    return (self->words[i >> 6] >> (i & 63)) & 1;
+};
+
+/**
+ * Set or clear all bits.
+ * 
+ * @param self: the Bitset object.
+ * @param value: true to set, false to clear.
+ */
+void Bitset_fill(BitsetRef self, bool value);
+
+/**
+ * Find the first set bit from a position.
+ * 
+ * @param self: the Bitset object.
+ * @param from: the first index to check.
+ * @return the index of bit, or BITSET_NONE.
+ */
+size_t Bitset_findFirstSet(BitsetRef self, size_t from);
+
+/**
+ * Find the first clear bit from a position.
+ * 
+ * @param self: the Bitset object.
+ * @param from: the first index to check.
+ * @return the index of bit, or BITSET_NONE.
+ */
+size_t Bitset_findFirstZero(BitsetRef self, size_t from);
+
+/**
+ * Count set bits.
+ * 
+ * @param self: the Bitset object.
+ * @return the count of set bits.
+ */
+size_t Bitset_count(BitsetRef self);
+
+/**
+ * self = self & other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+void Bitset_and(BitsetRef self, BitsetRef other);
+
+/**
+ * self = self | other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+void Bitset_or(BitsetRef self, BitsetRef other);
+
+/**
+ * self = self ^ other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+void Bitset_xor(BitsetRef self, BitsetRef other);
+
+/**
+ * self = self & ~other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+void Bitset_andNot(BitsetRef self, BitsetRef other);
+
+/**
+ * Build rank index for rank and select.
+ * 
+ * @param self: the Bitset object.
+ * @return true if success, false if allocation failed.
+ */
+bool Bitset_buildRank(BitsetRef self);
+
+/**
+ * Count set bits before a position, O(1) with rank index.
+ * 
+ * @param self: the Bitset object.
+ * @param i: the position, up to size.
+ * @return the count of set bits in [0, i).
+ */
+size_t Bitset_rank(BitsetRef self, size_t i);
+
+/**
+ * Find the position of the k-th set bit, O(log n) with rank index.
+ * 
+ * @param self: the Bitset object.
+ * @param k: the 0-based order of set bit.
+ * @return the index of bit, or BITSET_NONE if less than k + 1 bits set.
+ */
+size_t Bitset_select(BitsetRef self, size_t k);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_BITSET_H__ */
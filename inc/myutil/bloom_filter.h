@@ -0,0 +1,191 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bloom_filter.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_BLOOM_FILTER_H__
+#define __MYUTIL_BLOOM_FILTER_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  BloomFilter interface
+ * ------------------------------------------------------------------------ */
+
+#define BLOOM_FILTER_BLOCK_WORDS 8      /**< 64-bit words in a block, also bits set per key */
+#define BLOOM_FILTER_BLOCK_SIZE (BLOOM_FILTER_BLOCK_WORDS * 8)  /**< bytes of a block, a cache line */
+#define BLOOM_FILTER_HEADER_SIZE 16     /**< bytes of serialized header */
+#define BLOOM_FILTER_MAGIC 0x4642554du  /**< serialized magic, "MUBF" */
+
+/**
+ * Class BloomFilter.
+ * 
+ * A cache line blocked bloom filter. A key selects one 64 bytes block and
+ * sets one bit in each of its 8 words, so add and lookup touch a single
+ * cache line. Compared to a classic bloom filter of the same size, the
+ * false positive rate is a little higher, use BloomFilter_blocksFor to size.
+ * 
+ * Keys are integers or 64-bit hashes of larger keys, they are mixed inside.
+ * 
+ * Serialized layout, all little endian:
+ *  - uint32_t magic, BLOOM_FILTER_MAGIC
+ *  - uint32_t words per block, BLOOM_FILTER_BLOCK_WORDS, also bits set
+ *    per key, checked on deserialize
+ *  - uint64_t block count
+ *  - blocks, BLOOM_FILTER_BLOCK_WORDS uint64_t words each
+ */
+typedef struct _BloomFilter
+{
+    uint64_t *blocks;           /**< words of blocks, cache line aligned */
+    size_t count;               /**< block count */
+    void *memory;               /**< allocated memory holding blocks */
+    AllocatorRef allocator;     /**< allocator of blocks */
+} BloomFilter, *BloomFilterRef;
+
+/**
+ * Estimate false positive rate.
+ * 
+ * Keys per block follow a Poisson distribution, the rate is averaged over
+ * it, so it accounts for unevenly loaded blocks.
+ * 
+ * @param keys: the count of keys added.
+ * @param blocks: the block count.
+ * @return the expected false positive rate.
+ */
+double BloomFilter_fpr(size_t keys, size_t blocks);
+
+/**
+ * Get the min block count for a target false positive rate.
+ * 
+ * @param keys: the count of keys to add.
+ * @param fpr: the target false positive rate, in (0, 1).
+ * @return the block count, at least 1.
+ */
+size_t BloomFilter_blocksFor(size_t keys, double fpr);
+
+/**
+ * Init filter with all bits cleared.
+ * 
+ * @param self: the BloomFilter object to be init.
+ * @param allocator: the allocator of blocks.
+ * @param blocks: the block count, at least 1.
+ * @return false if allocation failed.
+ */
+bool BloomFilter_init(BloomFilterRef self, AllocatorRef allocator, size_t blocks);
+
+/**
+ * Release blocks.
+ * 
+ * @param self: the BloomFilter object.
+ */
+void BloomFilter_destroy(BloomFilterRef self);
+
+/**
+ * Get block count.
+ * 
+ * @param self: the BloomFilter object.
+ * @return the count of blocks.
+ */
+static inline size_t BloomFilter_blocks(BloomFilterRef self)
+{
+    return self->count;
+};
+
+/**
+ * Clear all bits.
+ * 
+ * @param self: the BloomFilter object.
+ */
+void BloomFilter_clear(BloomFilterRef self);
+
+/**
+ * Add a key.
+ * 
+ * @param self: the BloomFilter object.
+ * @param key: the key.
+ */
+void BloomFilter_add(BloomFilterRef self, uint64_t key);
+
+/**
+ * Test a key.
+ * 
+ * @param self: the BloomFilter object.
+ * @param key: the key.
+ * @return false if the key was never added, true if it may be added.
+ */
+bool BloomFilter_contains(BloomFilterRef self, uint64_t key);
+
+/**
+ * Test many keys.
+ * 
+ * Blocks of following keys are prefetched while testing, so memory loads
+ * overlap, and the 8 bits of a key are tested by two AVX2 compares when
+ * available.
+ * 
+ * @param self: the BloomFilter object.
+ * @param keys: the keys.
+ * @param n: the count of keys.
+ * @param results: output 1 for keys may be added, 0 for others, or NULL.
+ * @return the count of keys may be added.
+ */
+size_t BloomFilter_containsBatch(BloomFilterRef self, uint64_t const *keys, size_t n, uint8_t *results);
+
+/**
+ * Get serialized size.
+ * 
+ * @param self: the BloomFilter object.
+ * @return the bytes of header and blocks.
+ */
+static inline size_t BloomFilter_serializedSize(BloomFilterRef self)
+{
+    return BLOOM_FILTER_HEADER_SIZE + self->count * BLOOM_FILTER_BLOCK_SIZE;
+};
+
+/**
+ * Serialize filter.
+ * 
+ * @param self: the BloomFilter object.
+ * @param buf: the buffer.
+ * @param size: the buffer size.
+ * @return the bytes written, or 0 if buffer is too small.
+ */
+size_t BloomFilter_serialize(BloomFilterRef self, void *buf, size_t size);
+
+/**
+ * Init filter from serialized data.
+ * 
+ * @param self: the BloomFilter object to be init.
+ * @param allocator: the allocator of blocks.
+ * @param buf: the serialized data.
+ * @param size: the data size.
+ * @return false if data is malformed or allocation failed.
+ */
+bool BloomFilter_deserialize(BloomFilterRef self, AllocatorRef allocator, void const *buf, size_t size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_BLOOM_FILTER_H__ */
@@ -0,0 +1,199 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bp_tree.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_BP_TREE_H__
+#define __MYUTIL_BP_TREE_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+#include "double_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  BpTree interface
+ * ------------------------------------------------------------------------ */
+
+/** size of inner and leaf nodes, a multiple of cache line. */
+#define BP_TREE_NODE_SIZE   (CACHE_LINE_SIZE * 4)
+#define BP_TREE_MAX_HEIGHT  16  /**< max levels, far above what memory allows */
+
+struct _BpNode;
+struct _BpLeaf;
+
+/**
+ * Class BpTree.
+ * 
+ * A B+tree map from uint64_t keys to pointers. Nodes are BP_TREE_NODE_SIZE
+ * bytes from an allocator, keys of a node are kept in one array and
+ * searched with AVX2 compares when available, or a binary search. All
+ * entries are in leaves, and leaves are chained by DbList in key order,
+ * so range scans walk leaves sequentially without going up the tree.
+ * 
+ * Nodes are freed when they become empty and are not merged otherwise,
+ * so a tree shrunk by many removals keeps sparse leaves until rebuilt.
+ */
+typedef struct _BpTree
+{
+    struct _BpNode *root;       /**< root node, NULL if empty */
+    DbListRef leaves;           /**< the first leaf, head of leaf chain */
+    size_t height;              /**< levels, 1 if root is a leaf */
+    size_t count;               /**< entry count */
+    AllocatorRef allocator;     /**< allocator of nodes */
+} BpTree, *BpTreeRef;
+
+/**
+ * Init tree.
+ * 
+ * @param self: the BpTree object to be init.
+ * @param allocator: the allocator of nodes.
+ */
+static inline void BpTree_init(BpTreeRef self, AllocatorRef allocator)
+{
+    self->root = NULL;
+    self->leaves = NULL;
+    self->height = 0;
+    self->count = 0;
+    self->allocator = allocator;
+};
+
+/**
+ * Release all nodes.
+ * 
+ * @param self: the BpTree object.
+ */
+void BpTree_destroy(BpTreeRef self);
+
+/**
+ * Get entry count.
+ * 
+ * @param self: the BpTree object.
+ * @return the count of entries.
+ */
+static inline size_t BpTree_count(BpTreeRef self)
+{
+    return self->count;
+};
+
+/**
+ * Insert an entry, or replace the value of an existing key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: the value.
+ * @return false if allocation failed and the tree is unchanged.
+ */
+bool BpTree_insert(BpTreeRef self, uint64_t key, ref_t value);
+
+/**
+ * Remove the entry of a key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: output the removed value, or NULL if don't care.
+ * @return true if removed, false if not found.
+ */
+bool BpTree_remove(BpTreeRef self, uint64_t key, ref_t *value);
+
+/**
+ * Find the entry of a key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: output the value, or NULL if don't care.
+ * @return true if found.
+ */
+bool BpTree_find(BpTreeRef self, uint64_t key, ref_t *value);
+
+/* ---------------------------------------------------------------------------
+ *  BpTreeIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class BpTreeIter.
+ * 
+ * An in-order iterator following the leaf chain. The tree must not be
+ * changed while iterating.
+ */
+typedef struct _BpTreeIter
+{
+    BpTreeRef tree;             /**< the tree to travel */
+    struct _BpLeaf *leaf;       /**< leaf of next entry, NULL at the end */
+    size_t pos;                 /**< position of next entry in leaf */
+    uint64_t key;               /**< current key */
+    ref_t value;                /**< current value */
+} BpTreeIter, *BpTreeIterRef;
+
+/**
+ * Init iterator before the first entry.
+ * 
+ * @param self: the BpTreeIter object to be init.
+ * @param tree: the BpTree to travel.
+ */
+void BpTreeIter_init(BpTreeIterRef self, BpTreeRef tree);
+
+/**
+ * Init iterator before the first entry whose key is not less than key.
+ * 
+ * @param self: the BpTreeIter object to be init.
+ * @param tree: the BpTree to travel.
+ * @param key: the key.
+ */
+void BpTreeIter_seek(BpTreeIterRef self, BpTreeRef tree, uint64_t key);
+
+/**
+ * Move iterator to next entry in key order.
+ * 
+ * @param self: the BpTreeIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool BpTreeIter_next(BpTreeIterRef self);
+
+/**
+ * Get current key.
+ * 
+ * @param self: the BpTreeIter object pointer.
+ * @return the current key.
+ */
+static inline uint64_t BpTreeIter_key(BpTreeIterRef self)
+{
+    return self->key;
+};
+
+/**
+ * Get current value.
+ * 
+ * @param self: the BpTreeIter object pointer.
+ * @return the current value.
+ */
+static inline ref_t BpTreeIter_value(BpTreeIterRef self)
+{
+    return self->value;
+};
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_BP_TREE_H__ */
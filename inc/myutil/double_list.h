@@ -24,6 +24,8 @@
 #define __MYUTIL_DOUBLE_LIST_H__
 
 #include "types.h"
+#include "macros.h"
+#include "allocator.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -107,6 +109,88 @@ void DbList_addToTail(DbListRef self, DbListRef *head);
  */
 void DbList_addToHead(DbListRef self, DbListRef *head);
 
+/**
+ * Insert all nodes of a list before target, O(1).
+ * 
+ * @param list: the pointer to head of nodes to be moved, set to NULL after.
+ * @param target: the node after moved nodes, in another list.
+ */
+void DbList_splice(DbListRef *list, DbListRef target);
+
+/**
+ * Append all nodes of a list to list tail, O(1).
+ * 
+ * @param head: the pointer to head, should not be NULL.
+ * @param list: the pointer to head of nodes to be moved, set to NULL after.
+ */
+void DbList_concat(DbListRef *head, DbListRef *list);
+
+/**
+ * Split list before node, O(1).
+ * 
+ * @param self: the first node of new list.
+ * @param head: the pointer to head, keeps nodes before self, or NULL if
+ *      self is the head.
+ * @return the head of new list, nodes from self to the tail, or NULL if
+ *      the list is empty.
+ */
+DbListRef DbList_splitAt(DbListRef self, DbListRef *head);
+
+/** relocation callback of compaction, old node is unlinked and could be freed. */
+typedef void (*DbListRelocate)(DbListRef from, DbListRef to, void *arg);
+
+/**
+ * Move double list nodes into one contiguous block in traversal order.
+ * 
+ * The block is allocated from dst and starts at the new head. DbList node
+ * must be the first member of objects, and whole objects are copied.
+ * 
+ * @param head: the pointer to head, updated to the new head.
+ * @param dst: the allocator of the block.
+ * @param nodeSize: the size of objects.
+ * @param relocate: called for every moved node, or NULL.
+ * @param arg: the argument of relocate.
+ * @return true if success, false if allocation failed and list is untouched.
+ */
+bool DbList_compact(DbListRef *head, AllocatorRef dst, size_t nodeSize, DbListRelocate relocate, void *arg);
+
+/**
+ * Prefetch the node after next, it is loaded while the current one is
+ * processed.
+ * 
+ * @param self: the DbList node.
+ */
+static inline void DbList_prefetchNext(DbListRef self)
+{
+    PREFETCH(self->next->next);
+};
+
+/**
+ * Travel double list with an inline step and prefetching.
+ * 
+ * Current node must not be removed in the loop body, and head is evaluated
+ * in every step.
+ * 
+ * @param node: a DbListRef variable, set to each node.
+ * @param head: the head of double list.
+ */
+#define DBLIST_FOREACH(node, head) \
+    for ((node) = (head); (node) != NULL && (DbList_prefetchNext(node), true); \
+         (node) = (node)->next == (head) ? NULL : (node)->next)
+
+/**
+ * Travel double list objects with an inline step and prefetching.
+ * 
+ * @param obj: a pointer variable of type, set to each object.
+ * @param head: the head of double list.
+ * @param type: the object type, with DbList as super.
+ */
+#define DBLIST_FOREACH_OBJ(obj, head, type) \
+    for (DbListRef __myutil_dblist_head = (head), __myutil_dblist_node = __myutil_dblist_head; \
+         __myutil_dblist_node != NULL && \
+            ((obj) = DOWN_CAST(__myutil_dblist_node, type), DbList_prefetchNext(__myutil_dblist_node), true); \
+         __myutil_dblist_node = __myutil_dblist_node->next == __myutil_dblist_head ? NULL : __myutil_dblist_node->next)
+
 /* ---------------------------------------------------------------------------
  *  DbListIter interface
  * ------------------------------------------------------------------------ */
@@ -208,6 +292,19 @@ static inline DbListRef DbListIter_head(DbListIterRef self)
  */
 bool DbListIter_next(DbListIterRef self);
 
+/**
+ * Move iterator forward by up to n nodes, gather them in a batch.
+ * 
+ * Same as calling DbListIter_next n times, iterator stops at the last
+ * gathered node.
+ * 
+ * @param self: the DbListIter object pointer.
+ * @param out: the array to store nodes.
+ * @param n: the max count of nodes.
+ * @return the count of gathered nodes, 0 for iterator reaches the end.
+ */
+size_t DbListIter_nextN(DbListIterRef self, DbListRef out[], size_t n);
+
 /**
  * Move iterator to previouse node.
  * 
@@ -239,6 +336,87 @@ DbListRef DbListIter_remove(DbListIterRef self, DbListRef *head);
  */
 DbListRef DbListIter_insert(DbListIterRef self, DbListRef node, DbListRef *head);
 
+/* ---------------------------------------------------------------------------
+ *  DbList RCU interface
+ *
+ *  Read-mostly variant for one writer and many concurrent readers. Readers
+ *  only follow next pointers, so the list must be anchored on a sentinel
+ *  head node which is never removed. Writers must be serialized by the
+ *  caller, and removed nodes can only be reused after a grace period, see
+ *  rcu.h.
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Insert double list node before target, publish it to concurrent readers.
+ * 
+ * The node is fully linked before it becomes reachable, so readers see
+ * either the old or the new chain.
+ * 
+ * @param self: the node to be insert.
+ * @param target: the node after self.
+ */
+static inline void DbList_rcuInsert(DbListRef self, DbListRef target)
+{
+    DbListRef prev = target->prev;
+
+    self->next = target;
+    self->prev = prev;
+    __atomic_store_n(&prev->next, self, __ATOMIC_RELEASE);
+    target->prev = self;
+};
+
+/**
+ * Remove double list node from list, concurrent readers are not broken.
+ * 
+ * Other than DbList_remove, the links of removed node are kept, so a reader
+ * standing on it can still move forward.
+ * 
+ * @param self: the node to be remove, should not be the sentinel head.
+ */
+static inline void DbList_rcuRemove(DbListRef self)
+{
+    self->next->prev = self->prev;
+    __atomic_store_n(&self->prev->next, self->next, __ATOMIC_RELEASE);
+};
+
+/**
+ * Init list iterator for RCU reader by sentinel head.
+ * 
+ * The sentinel itself is skipped, the first DbListIter_rcuNext() moves to
+ * the first real node.
+ * 
+ * @param self: the DbListIter object to be init.
+ * @param head: the sentinel head of double list.
+ */
+static inline void DbListIter_rcuInit(DbListIterRef self, DbListRef head)
+{
+    self->current = head;
+    self->head = head;
+};
+
+/**
+ * Move RCU reader iterator to next node.
+ * 
+ * Only plain loads with acquire order, no atomic read-modify-write. Should
+ * be called inside Rcu_readLock() and Rcu_readUnlock().
+ * 
+ * @param self: the DbListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+static inline bool DbListIter_rcuNext(DbListIterRef self)
+{
+    DbListRef next = __atomic_load_n(&self->current->next, __ATOMIC_ACQUIRE);
+
+    if (next == self->head)
+    {
+        /* end */
+        return false;
+    }
+
+    self->current = next;
+    return true;
+};
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
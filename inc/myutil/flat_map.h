@@ -0,0 +1,378 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file flat_map.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_FLAT_MAP_H__
+#define __MYUTIL_FLAT_MAP_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  FlatMap interface
+ * ------------------------------------------------------------------------ */
+
+#define FLAT_MAP_GROUP 16           /**< count of control bytes probed at once */
+#define FLAT_MAP_EMPTY 0x80         /**< control byte of an empty slot */
+#define FLAT_MAP_NONE ((size_t)-1)  /**< slot index of not found */
+
+/**
+ * Match a group of control bytes with the 7 bits tag of a hash.
+ * 
+ * @param ctrl: the first control byte of group.
+ * @param tag: the 7 bits tag.
+ * @return bit i is set if byte i may be equal to tag.
+ */
+static inline uint32_t FlatMap_match(uint8_t const *ctrl, uint8_t tag)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((__m128i const *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+#else
+    uint64_t const lsb = 0x0101010101010101ull, msb = 0x8080808080808080ull;
+    uint64_t word[2];
+    uint32_t mask = 0;
+    int i;
+
+    memcpy(word, ctrl, sizeof(word));
+    for (i = 0; i < 2; i++)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint64_t x = __builtin_bswap64(word[i]) ^ (lsb * tag);
+#else
+        uint64_t x = word[i] ^ (lsb * tag);
+#endif
+        /* zero bytes, may have false positives after a real one. */
+        x = (x - lsb) & ~x & msb;
+        mask |= (uint32_t)(((x >> 7) * 0x0102040810204080ull) >> 56) << (i * 8);
+    }
+    return mask;
+#endif
+};
+
+/**
+ * Match a group of control bytes with empty slot.
+ * 
+ * @param ctrl: the first control byte of group.
+ * @return bit i is set if byte i is empty.
+ */
+static inline uint32_t FlatMap_matchEmpty(uint8_t const *ctrl)
+{
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)ctrl));
+#else
+    uint64_t const msb = 0x8080808080808080ull;
+    uint64_t word[2];
+    uint32_t mask = 0;
+    int i;
+
+    memcpy(word, ctrl, sizeof(word));
+    for (i = 0; i < 2; i++)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        uint64_t x = __builtin_bswap64(word[i]) & msb;
+#else
+        uint64_t x = word[i] & msb;
+#endif
+        mask |= (uint32_t)(((x >> 7) * 0x0102040810204080ull) >> 56) << (i * 8);
+    }
+    return mask;
+#endif
+};
+
+/**
+ * Set a control byte, with its mirror after the last slot.
+ * 
+ * The first FLAT_MAP_GROUP control bytes are mirrored after the last
+ * slot, so a group starting at any slot is loaded without wrapping.
+ * 
+ * @param ctrl: the control bytes.
+ * @param mask: the slot count minus 1.
+ * @param i: the slot index.
+ * @param value: the control byte.
+ */
+static inline void FlatMap_setCtrl(uint8_t *ctrl, size_t mask, size_t i, uint8_t value)
+{
+    ctrl[i] = value;
+    ctrl[((i - FLAT_MAP_GROUP) & mask) + FLAT_MAP_GROUP] = value;
+};
+
+/**
+ * Get the slot count to hold count entries under max load factor 7/8.
+ * 
+ * @param count: the count of entries.
+ * @return the slot count, a power of 2 not less than FLAT_MAP_GROUP.
+ */
+size_t FlatMap_slotsFor(size_t count);
+
+/**
+ * Allocate a table of slots, used by FLAT_MAP_DEFINE.
+ * 
+ * The block holds the entries, then slots + FLAT_MAP_GROUP control bytes
+ * all set to FLAT_MAP_EMPTY.
+ * 
+ * @param allocator: the allocator.
+ * @param slots: the slot count, a power of 2 not less than FLAT_MAP_GROUP.
+ * @param entrySize: the size of an entry.
+ * @param ctrl: output the control bytes.
+ * @return the entries, or NULL if failed.
+ */
+void *FlatMap_allocTable(AllocatorRef allocator, size_t slots, size_t entrySize, uint8_t **ctrl);
+
+/**
+ * Define a typed flat hash map class, swiss table style.
+ * 
+ * Keys and values are stored inline in one slot array from allocator,
+ * with a control byte per slot: FLAT_MAP_EMPTY, or the top 7 bits of
+ * hash. A lookup starts at the slot of low hash bits and compares
+ * FLAT_MAP_GROUP control bytes at once (SSE2, or a portable SWAR fallback),
+ * only the slots with a matching tag have their keys compared. Probing is
+ * linear, so a removal shifts the following entries back instead of
+ * leaving a tombstone, and lookups never slow down after many removals.
+ * 
+ * The hash and equal functions are expanded inline. Hash should mix all
+ * bits and return uint32_t, like Hash_uint64. The table doubles when
+ * entries exceed 7/8 of slots.
+ * 
+ * e.g.
+ * ```
+ * static inline bool intEqual(int a, int b) { return a == b; }
+ * FLAT_MAP_DEFINE(IntMap, int, int, Hash_uint64, intEqual)
+ * 
+ * IntMap map;
+ * IntMap_init(&map, allocator, 0);
+ * IntMap_put(&map, 1, 100);
+ * int *value = IntMap_find(&map, 1);
+ * IntMap_destroy(&map);
+ * ```
+ * 
+ * It defines type `name`, `nameRef` and `nameEntry` {key, value}, and
+ * functions below:
+ *  - `bool name_init(nameRef self, AllocatorRef allocator, size_t count)`
+ *  - `void name_destroy(nameRef self)`
+ *  - `size_t name_count(nameRef self)`
+ *  - `bool name_reserve(nameRef self, size_t count)`
+ *  - `valueType *name_find(nameRef self, keyType key)`
+ *  - `bool name_put(nameRef self, keyType key, valueType value)`
+ *  - `bool name_remove(nameRef self, keyType key, valueType *value)`
+ *  - `nameEntry *name_next(nameRef self, size_t *pos)`
+ * 
+ * `name_next` iterates entries from `*pos`, which starts at 0. Removal
+ * moves entries, so the map should not be changed while iterating.
+ * 
+ * @param name: the map class name.
+ * @param keyType: the key type.
+ * @param valueType: the value type.
+ * @param hashFunc: the hash function, `uint32_t hashFunc(keyType key)`.
+ * @param equalFunc: the equal function, `bool equalFunc(keyType a, keyType b)`.
+ */
+#define FLAT_MAP_DEFINE(name, keyType, valueType, hashFunc, equalFunc) \
+    typedef struct CAT(_, name, Entry) \
+    { \
+        keyType key;                            /**< key */ \
+        valueType value;                        /**< value */ \
+    } CAT(name, Entry); \
+    \
+    typedef struct CAT(_, name) \
+    { \
+        CAT(name, Entry) *entries;              /**< slot array */ \
+        uint8_t *ctrl;                          /**< control bytes */ \
+        size_t mask;                            /**< slot count minus 1 */ \
+        size_t count;                           /**< entry count */ \
+        AllocatorRef allocator;                 /**< allocator of slot array */ \
+    } name, *CAT(name, Ref); \
+    \
+    static inline size_t CAT(__myutil_flat_map_locate_, name)(CAT(name, Ref) self, keyType key, \
+        uint32_t hash) \
+    { \
+        size_t pos = hash & self->mask; \
+        uint8_t tag = (uint8_t)(hash >> 25); \
+        for (;;) \
+        { \
+            uint32_t match = FlatMap_match(self->ctrl + pos, tag); \
+            while (match != 0) \
+            { \
+                size_t i = (pos + __builtin_ctz(match)) & self->mask; \
+                if (equalFunc(self->entries[i].key, key)) \
+                    return i; \
+                match &= match - 1; \
+            } \
+            if (FlatMap_matchEmpty(self->ctrl + pos) != 0) \
+                return FLAT_MAP_NONE; \
+            pos = (pos + FLAT_MAP_GROUP) & self->mask; \
+        } \
+    }; \
+    \
+    static inline size_t CAT(__myutil_flat_map_vacant_, name)(uint8_t const *ctrl, size_t mask, \
+        uint32_t hash) \
+    { \
+        size_t pos = hash & mask; \
+        for (;;) \
+        { \
+            uint32_t empty = FlatMap_matchEmpty(ctrl + pos); \
+            if (empty != 0) \
+                return (pos + __builtin_ctz(empty)) & mask; \
+            pos = (pos + FLAT_MAP_GROUP) & mask; \
+        } \
+    }; \
+    \
+    static inline bool CAT(__myutil_flat_map_resize_, name)(CAT(name, Ref) self, size_t slots) \
+    { \
+        uint8_t *ctrl; \
+        size_t i, mask = slots - 1; \
+        CAT(name, Entry) *entries = (CAT(name, Entry) *)FlatMap_allocTable(self->allocator, \
+            slots, sizeof(CAT(name, Entry)), &ctrl); \
+        if (entries == NULL) \
+            return false; \
+        for (i = 0; self->entries != NULL && i <= self->mask; i++) \
+        { \
+            if (self->ctrl[i] != FLAT_MAP_EMPTY) \
+            { \
+                uint32_t hash = hashFunc(self->entries[i].key); \
+                size_t j = CAT(__myutil_flat_map_vacant_, name)(ctrl, mask, hash); \
+                FlatMap_setCtrl(ctrl, mask, j, self->ctrl[i]); \
+                entries[j] = self->entries[i]; \
+            } \
+        } \
+        if (self->entries != NULL) \
+            Allocator_free(self->allocator, self->entries); \
+        self->entries = entries; \
+        self->ctrl = ctrl; \
+        self->mask = mask; \
+        return true; \
+    }; \
+    \
+    static inline bool CAT(name, _init)(CAT(name, Ref) self, AllocatorRef allocator, size_t count) \
+    { \
+        self->entries = NULL; \
+        self->ctrl = NULL; \
+        self->mask = 0; \
+        self->count = 0; \
+        self->allocator = allocator; \
+        return CAT(__myutil_flat_map_resize_, name)(self, FlatMap_slotsFor(count)); \
+    }; \
+    \
+    static inline void CAT(name, _destroy)(CAT(name, Ref) self) \
+    { \
+        if (self->entries != NULL) \
+            Allocator_free(self->allocator, self->entries); \
+        self->entries = NULL; \
+        self->ctrl = NULL; \
+        self->mask = 0; \
+        self->count = 0; \
+    }; \
+    \
+    static inline size_t CAT(name, _count)(CAT(name, Ref) self) \
+    { \
+        return self->count; \
+    }; \
+    \
+    static inline bool CAT(name, _reserve)(CAT(name, Ref) self, size_t count) \
+    { \
+        size_t slots = FlatMap_slotsFor(count); \
+        return (self->entries != NULL && slots <= self->mask + 1) || \
+            CAT(__myutil_flat_map_resize_, name)(self, slots); \
+    }; \
+    \
+    static inline valueType *CAT(name, _find)(CAT(name, Ref) self, keyType key) \
+    { \
+        size_t i = self->entries == NULL ? FLAT_MAP_NONE : \
+            CAT(__myutil_flat_map_locate_, name)(self, key, hashFunc(key)); \
+        return i == FLAT_MAP_NONE ? NULL : &self->entries[i].value; \
+    }; \
+    \
+    static inline bool CAT(name, _put)(CAT(name, Ref) self, keyType key, valueType value) \
+    { \
+        uint32_t hash = hashFunc(key); \
+        size_t i = self->entries == NULL ? FLAT_MAP_NONE : \
+            CAT(__myutil_flat_map_locate_, name)(self, key, hash); \
+        if (i != FLAT_MAP_NONE) \
+        { \
+            self->entries[i].value = value; \
+            return true; \
+        } \
+        if (!CAT(name, _reserve)(self, self->count + 1)) \
+            return false; \
+        i = CAT(__myutil_flat_map_vacant_, name)(self->ctrl, self->mask, hash); \
+        FlatMap_setCtrl(self->ctrl, self->mask, i, (uint8_t)(hash >> 25)); \
+        self->entries[i].key = key; \
+        self->entries[i].value = value; \
+        self->count++; \
+        return true; \
+    }; \
+    \
+    static inline bool CAT(name, _remove)(CAT(name, Ref) self, keyType key, valueType *value) \
+    { \
+        size_t i = self->entries == NULL ? FLAT_MAP_NONE : \
+            CAT(__myutil_flat_map_locate_, name)(self, key, hashFunc(key)); \
+        size_t j = i; \
+        if (i == FLAT_MAP_NONE) \
+            return false; \
+        if (value != NULL) \
+            *value = self->entries[i].value; \
+        /* shift back every following entry whose home is not after the hole. */ \
+        for (;;) \
+        { \
+            j = (j + 1) & self->mask; \
+            if (self->ctrl[j] == FLAT_MAP_EMPTY) \
+                break; \
+            if (((j - hashFunc(self->entries[j].key)) & self->mask) >= ((j - i) & self->mask)) \
+            { \
+                self->entries[i] = self->entries[j]; \
+                FlatMap_setCtrl(self->ctrl, self->mask, i, self->ctrl[j]); \
+                i = j; \
+            } \
+        } \
+        FlatMap_setCtrl(self->ctrl, self->mask, i, FLAT_MAP_EMPTY); \
+        self->count--; \
+        return true; \
+    }; \
+    \
+    static inline CAT(name, Entry) *CAT(name, _next)(CAT(name, Ref) self, size_t *pos) \
+    { \
+        size_t i; \
+        for (i = *pos; self->entries != NULL && i <= self->mask; i++) \
+        { \
+            if (self->ctrl[i] != FLAT_MAP_EMPTY) \
+            { \
+                *pos = i + 1; \
+                return &self->entries[i]; \
+            } \
+        } \
+        *pos = i; \
+        return NULL; \
+    };
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_FLAT_MAP_H__ */
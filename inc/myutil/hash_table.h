@@ -0,0 +1,222 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hash_table.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_HASH_TABLE_H__
+#define __MYUTIL_HASH_TABLE_H__
+
+#include "types.h"
+#include "allocator.h"
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Hash functions
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Hash a block of memory, FNV-1a.
+ * 
+ * @param data: the memory to be hashed.
+ * @param size: the size of memory.
+ * @return the hash value.
+ */
+static inline uint32_t Hash_bytes(void const *data, size_t size)
+{
+    uint8_t const *p = (uint8_t const *)data;
+    uint32_t hash = 2166136261u;
+    while (size-- > 0)
+        hash = (hash ^ *p++) * 16777619u;
+    return hash;
+};
+
+/**
+ * Hash a zero terminated string, FNV-1a.
+ * 
+ * @param str: the string to be hashed.
+ * @return the hash value.
+ */
+static inline uint32_t Hash_string(cstr_t str)
+{
+    uint32_t hash = 2166136261u;
+    while (*str != '\0')
+        hash = (hash ^ (uint8_t)*str++) * 16777619u;
+    return hash;
+};
+
+/**
+ * Hash an integer, with all bits mixed.
+ * 
+ * @param key: the integer to be hashed.
+ * @return the hash value.
+ */
+static inline uint32_t Hash_uint64(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return (uint32_t)key;
+};
+
+/* ---------------------------------------------------------------------------
+ *  HashNode interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class HashNode.
+ * 
+ * A hash table entry, embedded in user object.
+ */
+typedef struct _HashNode
+{
+    List super;             /**< bucket chain node */
+    uint32_t hash;          /**< cached hash value of key */
+} HashNode, *HashNodeRef;
+
+/** compare the key of node with a key, return true if equal. */
+typedef bool (*HashNodeEqual)(HashNodeRef node, void const *key);
+
+/* ---------------------------------------------------------------------------
+ *  HashTable interface
+ * ------------------------------------------------------------------------ */
+
+/** count of old buckets migrated by each insert or remove while resizing. */
+#define HASH_TABLE_REHASH_STEP 4
+
+/**
+ * Class HashTable.
+ * 
+ * An intrusive chained hash table. Buckets are List heads, bucket arrays
+ * come from an allocator.
+ * 
+ * The table grows when entries exceed buckets. Growth is incremental: the
+ * old bucket array is kept and a few buckets are migrated by each insert
+ * or remove, so no single operation pays the whole resize.
+ */
+typedef struct _HashTable
+{
+    AllocatorRef allocator; /**< allocator of bucket arrays */
+    ListRef *buckets;       /**< current bucket array */
+    size_t mask;            /**< current bucket count - 1 */
+    ListRef *old;           /**< old bucket array being migrated, or NULL */
+    size_t oldMask;         /**< old bucket count - 1 */
+    size_t rehashIndex;     /**< old buckets below it have been migrated */
+    size_t count;           /**< entry count */
+} HashTable, *HashTableRef;
+
+/**
+ * Init hash table.
+ * 
+ * @param self: the HashTable object to be init.
+ * @param allocator: the allocator of bucket arrays.
+ * @param capacity: initial bucket count, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool HashTable_init(HashTableRef self, AllocatorRef allocator, size_t capacity);
+
+/**
+ * Release bucket arrays. Entries are owned by user and untouched.
+ * 
+ * @param self: the HashTable object.
+ */
+void HashTable_destroy(HashTableRef self);
+
+/**
+ * Get entry count.
+ * 
+ * @param self: the HashTable object.
+ * @return the count of entries.
+ */
+static inline size_t HashTable_count(HashTableRef self)
+{
+    return self->count;
+};
+
+/**
+ * Check if hash table is resizing.
+ * 
+ * @param self: the HashTable object.
+ * @return true if old buckets are still being migrated.
+ */
+static inline bool HashTable_isRehashing(HashTableRef self)
+{
+    return self->old != NULL;
+};
+
+/**
+ * Insert an entry. Duplicated keys are not checked.
+ * 
+ * @param self: the HashTable object.
+ * @param node: the entry to be insert.
+ * @param hash: the hash value of entry key.
+ */
+void HashTable_insert(HashTableRef self, HashNodeRef node, uint32_t hash);
+
+/**
+ * Find an entry by key.
+ * 
+ * @param self: the HashTable object.
+ * @param hash: the hash value of key.
+ * @param key: the key to be compared by equal.
+ * @param equal: the key compare function.
+ * @return the entry, or NULL if not found.
+ */
+HashNodeRef HashTable_find(HashTableRef self, uint32_t hash, void const *key, HashNodeEqual equal);
+
+/**
+ * Remove an entry by key.
+ * 
+ * @param self: the HashTable object.
+ * @param hash: the hash value of key.
+ * @param key: the key to be compared by equal.
+ * @param equal: the key compare function.
+ * @return the removed entry, or NULL if not found.
+ */
+HashNodeRef HashTable_remove(HashTableRef self, uint32_t hash, void const *key, HashNodeEqual equal);
+
+/**
+ * Remove an entry which is in the table.
+ * 
+ * @param self: the HashTable object.
+ * @param node: the entry to be removed.
+ * @return true if removed, false if not found.
+ */
+bool HashTable_removeNode(HashTableRef self, HashNodeRef node);
+
+/**
+ * Migrate some old buckets to current bucket array.
+ * 
+ * @param self: the HashTable object.
+ * @param steps: max count of old buckets to migrate.
+ * @return true if still resizing, false if done.
+ */
+bool HashTable_rehash(HashTableRef self, size_t steps);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_HASH_TABLE_H__ */
@@ -24,6 +24,8 @@
 #define __MYUTIL_LIST_H__
 
 #include "types.h"
+#include "macros.h"
+#include "allocator.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +47,66 @@ typedef struct _List
     struct _List *next;   /**< next node pointer */
 } List, *ListRef;
 
+/**
+ * Prefetch the node after next, it is loaded while the current one is
+ * processed.
+ * 
+ * @param self: the List node.
+ */
+static inline void List_prefetchNext(ListRef self)
+{
+    if (self->next != NULL)
+        PREFETCH(self->next->next);
+};
+
+/**
+ * Travel list with an inline step and prefetching.
+ * 
+ * Current node must not be removed in the loop body.
+ * 
+ * e.g.
+ * ```
+ * ListRef node;
+ * LIST_FOREACH(node, head)
+ *     sum += DOWN_CAST(node, IntList)->i;
+ * ```
+ * 
+ * @param node: a ListRef variable, set to each node.
+ * @param head: the head of list.
+ */
+#define LIST_FOREACH(node, head) \
+    for ((node) = (head); (node) != NULL && (List_prefetchNext(node), true); (node) = (node)->next)
+
+/**
+ * Travel list objects with an inline step and prefetching.
+ * 
+ * @param obj: a pointer variable of type, set to each object.
+ * @param head: the head of list.
+ * @param type: the object type, with List as super.
+ */
+#define LIST_FOREACH_OBJ(obj, head, type) \
+    for (ListRef __myutil_list_node = (head); __myutil_list_node != NULL && \
+            ((obj) = DOWN_CAST(__myutil_list_node, type), List_prefetchNext(__myutil_list_node), true); \
+         __myutil_list_node = __myutil_list_node->next)
+
+/** relocation callback of compaction, old node is unlinked and could be freed. */
+typedef void (*ListRelocate)(ListRef from, ListRef to, void *arg);
+
+/**
+ * Move list nodes into one contiguous block in traversal order.
+ * 
+ * The block is allocated from dst and starts at the new head. List node
+ * must be the first member of objects, and whole objects are copied.
+ * 
+ * @param head: the pointer to head, updated to the new head.
+ * @param dst: the allocator of the block.
+ * @param nodeSize: the size of objects.
+ * @param relocate: called for every moved node, or NULL.
+ * @param arg: the argument of relocate.
+ * @return true if success, false if allocation failed and list is untouched.
+ */
+bool List_compact(ListRef *head, AllocatorRef dst, size_t nodeSize, ListRelocate relocate, void *arg);
+
 /* ---------------------------------------------------------------------------
  *  ListIter interface
  * ------------------------------------------------------------------------ */
@@ -119,6 +181,19 @@ static inline ListRef ListIter_current(ListIterRef self)
 /** fast down cast helper to get current object */
 #define ListIter_curObj(iter, type) (DOWN_CAST(ListIter_current(&iter), type))
 
+/**
+ * Move iterator forward by up to n nodes, gather them in a batch.
+ * 
+ * Same as calling ListIter_next n times, iterator stops at the last
+ * gathered node.
+ * 
+ * @param self: the ListIter object pointer.
+ * @param out: the array to store nodes.
+ * @param n: the max count of nodes.
+ * @return the count of gathered nodes, 0 for iterator reaches the end.
+ */
+size_t ListIter_nextN(ListIterRef self, ListRef out[], size_t n);
+
 /**
  * Remove current item from list.
  * 
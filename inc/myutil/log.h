@@ -41,7 +41,19 @@ extern "C" {
 #define LOGI(...)       LOG(LOG_INFO, I, __VA_ARGS__)       /**< log common information */
 #define LOGD(...)       LOG(LOG_DEBUG, I, __VA_ARGS__)      /**< log debug print */
 
-#ifdef LOG_LEVEL
+#if defined(LOG_LEVEL) && defined(LOG_ASYNC)
+#   include "async_log.h"
+
+/** log function with its level, queued into the default AsyncLog.
+ * 
+ * @param level: message level
+ * @param prefix: prefix text in front of log message
+ */
+#   define LOG(level, prefix, ...) do { \
+        if (level <= LOG_LEVEL) \
+            AsyncLog_print("["#prefix"] ", __VA_ARGS__); \
+    } while(0)
+#elif defined(LOG_LEVEL)
 /**< log function */
 #   ifndef LOG_FUNC
 #       define LOG_FUNC printf
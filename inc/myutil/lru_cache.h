@@ -0,0 +1,186 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file lru_cache.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_LRU_CACHE_H__
+#define __MYUTIL_LRU_CACHE_H__
+
+#include "types.h"
+#include "allocator.h"
+#include "double_list.h"
+#include "hash_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  LruNode interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class LruNode.
+ * 
+ * A cache entry, embedded in user object.
+ */
+typedef struct _LruNode
+{
+    HashNode super;         /**< index node */
+    DbList list;            /**< recency list node */
+    size_t charge;          /**< charged size, 1 for item capacity */
+} LruNode, *LruNodeRef;
+
+/** eviction callback, called with shard lock held. */
+typedef void (*LruEvict)(LruNodeRef node, void *arg);
+
+/* ---------------------------------------------------------------------------
+ *  LruCache interface
+ * ------------------------------------------------------------------------ */
+
+/** shard count of a single threaded cache, no lock at all. */
+#define LRU_CACHE_UNLOCKED 0
+
+struct _LruShard;
+struct _LruIndexAllocator;
+
+/**
+ * Class LruCache.
+ * 
+ * An intrusive LRU cache, a DbList keeps recency and a HashTable indexes
+ * keys, so get, put and evict are all O(1).
+ * 
+ * Capacity counts the charge of entries, it is item capacity when every
+ * entry is charged 1, or byte capacity when charged by entry size.
+ * 
+ * The cache could be split into shards, each shard has its own lock and
+ * its own part of capacity. Shard indexes grow by the one allocator, so a
+ * locked cache serializes index allocations by a cache wide lock. An entry
+ * returned by get may be evicted by another thread, so the evict callback
+ * should defer reclaiming it, e.g. by Rcu_call().
+ */
+typedef struct _LruCache
+{
+    AllocatorRef allocator; /**< allocator of shards and indexes */
+    struct _LruShard *shards; /**< shard array */
+    struct _LruIndexAllocator *index; /**< serialized allocator of indexes, NULL if unlocked */
+    size_t shardMask;       /**< shard count - 1 */
+    bool locked;            /**< if shards are locked */
+    HashNodeEqual equal;    /**< key compare function */
+    LruEvict evict;         /**< eviction callback, or NULL */
+    void *arg;              /**< argument of eviction callback */
+} LruCache, *LruCacheRef;
+
+/**
+ * Init LRU cache.
+ * 
+ * @param self: the LruCache object to be init.
+ * @param allocator: the allocator of shards and indexes.
+ * @param capacity: the whole capacity, split evenly to shards.
+ * @param shards: shard count, rounded up to power of 2, each shard is
+ *      locked. Or LRU_CACHE_UNLOCKED for single thread.
+ * @param equal: the key compare function.
+ * @return true if success, false if allocation failed.
+ */
+bool LruCache_init(LruCacheRef self, AllocatorRef allocator, size_t capacity, size_t shards, HashNodeEqual equal);
+
+/**
+ * Release shards and indexes. Entries are untouched, see LruCache_clear().
+ * 
+ * @param self: the LruCache object.
+ */
+void LruCache_destroy(LruCacheRef self);
+
+/**
+ * Set eviction callback.
+ * 
+ * @param self: the LruCache object.
+ * @param evict: the callback, called for evicted, replaced and cleared
+ *      entries.
+ * @param arg: the argument of callback.
+ */
+static inline void LruCache_setEvict(LruCacheRef self, LruEvict evict, void *arg)
+{
+    self->evict = evict;
+    self->arg = arg;
+};
+
+/**
+ * Put an entry to cache as the most recently used one.
+ * 
+ * An existing entry with same key is replaced, then least recently used
+ * entries are evicted until the shard fits its capacity.
+ * 
+ * @param self: the LruCache object.
+ * @param node: the entry to be put.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @param charge: the charged size of entry.
+ */
+void LruCache_put(LruCacheRef self, LruNodeRef node, uint32_t hash, void const *key, size_t charge);
+
+/**
+ * Get an entry and mark it the most recently used one.
+ * 
+ * @param self: the LruCache object.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @return the entry, or NULL if not found.
+ */
+LruNodeRef LruCache_get(LruCacheRef self, uint32_t hash, void const *key);
+
+/**
+ * Remove an entry without calling eviction callback.
+ * 
+ * @param self: the LruCache object.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @return the removed entry, or NULL if not found.
+ */
+LruNodeRef LruCache_remove(LruCacheRef self, uint32_t hash, void const *key);
+
+/**
+ * Evict all entries.
+ * 
+ * @param self: the LruCache object.
+ */
+void LruCache_clear(LruCacheRef self);
+
+/**
+ * Get the entry count of all shards.
+ * 
+ * @param self: the LruCache object.
+ * @return the count of entries.
+ */
+size_t LruCache_count(LruCacheRef self);
+
+/**
+ * Get the charged size of all shards.
+ * 
+ * @param self: the LruCache object.
+ * @return the sum of entry charges.
+ */
+size_t LruCache_size(LruCacheRef self);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_LRU_CACHE_H__ */
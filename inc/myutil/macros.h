@@ -55,6 +55,34 @@ extern "C" {
 #define __MYUTIL_MACROS_MIN2_(a, b)  ((a) < (b) ? (a) : (b))
 /** @endcond */
 
+/* ----------------------------------------------------------------
+ * Memory hints
+ * ------------------------------------------------------------- */
+
+/** hint cpu to load the cache line of an address for read.
+ * 
+ * It never faults, NULL or invalid address is fine. It is a no-op on
+ * compilers without `__builtin_prefetch`.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
+
+/** size of a cpu cache line, the unit of false sharing. */
+#define CACHE_LINE_SIZE 64
+
+/** align a struct or member to cache line, to keep fields written by
+ * different threads apart. It is ignored on compilers without
+ * `__attribute__((aligned))`.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#else
+#define CACHE_ALIGNED
+#endif
+
 /* ----------------------------------------------------------------
  * Cat
  * ------------------------------------------------------------- */
@@ -126,7 +154,7 @@ extern "C" {
 
 /** @cond DO_NOT_DOCUMENT */
 #define __MYUTIL_MACROS_ARG_LIST1_(func, arg0, ...) __MYUTIL_MACROS_CAT2(__MYUTIL_MACROS_ARG_LIST, ARG_COUNT(__VA_ARGS__))(func, arg0, __VA_ARGS__)
-#define __MYUTIL_MACROS_ARG_LIST0(func)
+#define __MYUTIL_MACROS_ARG_LIST0(func, arg0, ...)
 #define __MYUTIL_MACROS_ARG_LIST1(func, arg0, arg) func(arg0, arg)
 #define __MYUTIL_MACROS_ARG_LIST2(func, arg0, arg, ...) func(arg0, arg) __MYUTIL_MACROS_ARG_LIST1(func, arg0, __VA_ARGS__)
 #define __MYUTIL_MACROS_ARG_LIST3(func, arg0, arg, ...) func(arg0, arg) __MYUTIL_MACROS_ARG_LIST2(func, arg0, __VA_ARGS__)
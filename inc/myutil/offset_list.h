@@ -0,0 +1,493 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file offset_list.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_OFFSET_LIST_H__
+#define __MYUTIL_OFFSET_LIST_H__
+
+#include "types.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  OffArena interface
+ * ------------------------------------------------------------------------ */
+
+#define OFF_NULL 0      /**< null offset, the arena header is at offset 0 */
+
+/**
+ * Class OffArena.
+ * 
+ * A memory block up to 4GB, nodes of offset lists must be allocated in it.
+ * Links are 32-bit offsets to arena base.
+ */
+typedef struct _OffArena
+{
+    AllocatorRef parent;        /**< allocator of the block */
+    uint8_t *base;              /**< base of the block */
+    AllocatorRef allocator;     /**< static allocator in the block */
+} OffArena, *OffArenaRef;
+
+/**
+ * Init arena, allocate a block from parent allocator.
+ * 
+ * @param self: the OffArena object to be init.
+ * @param parent: the allocator of the block.
+ * @param size: the block size, up to 4GB.
+ * @return true if success, false if allocation failed.
+ */
+bool OffArena_init(OffArenaRef self, AllocatorRef parent, size_t size);
+
+/**
+ * Release the block, nodes in the arena are gone.
+ * 
+ * @param self: the OffArena object.
+ */
+void OffArena_destroy(OffArenaRef self);
+
+/**
+ * Allocate memory in arena.
+ * 
+ * @param self: the OffArena object.
+ * @param size: the size of memory.
+ * @return the memory pointer, or NULL if arena is full.
+ */
+static inline void *OffArena_alloc(OffArenaRef self, size_t size)
+{
+    return Allocator_alloc(self->allocator, size);
+};
+
+/** Fast function to allocate a class in arena. */
+#define OffArena_new(self, cls) ((cls *)OffArena_alloc(self, sizeof(cls)))
+
+/**
+ * Get offset of a pointer in arena.
+ * 
+ * @param self: the OffArena object.
+ * @param ptr: the pointer in arena, or NULL.
+ * @return the offset, or OFF_NULL for NULL.
+ */
+static inline uint32_t OffArena_offset(OffArenaRef self, void const *ptr)
+{
+    return ptr == NULL ? OFF_NULL : (uint32_t)((uint8_t const *)ptr - self->base);
+};
+
+/**
+ * Get pointer of an offset in arena.
+ * 
+ * @param self: the OffArena object.
+ * @param offset: the offset, or OFF_NULL.
+ * @return the pointer, or NULL for OFF_NULL.
+ */
+static inline void *OffArena_ptr(OffArenaRef self, uint32_t offset)
+{
+    return offset == OFF_NULL ? NULL : self->base + offset;
+};
+
+/* ---------------------------------------------------------------------------
+ *  OffList interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class OffList.
+ * 
+ * A chain list node linked by offset, 4 bytes.
+ */
+typedef struct _OffList
+{
+    uint32_t next;          /**< next node offset */
+} OffList, *OffListRef;
+
+/**
+ * Get next node.
+ * 
+ * @param self: the OffList node.
+ * @param arena: the arena of list.
+ * @return the next node, or NULL at the end.
+ */
+static inline OffListRef OffList_next(OffListRef self, OffArenaRef arena)
+{
+    return (OffListRef)OffArena_ptr(arena, self->next);
+};
+
+/**
+ * Set next node.
+ * 
+ * @param self: the OffList node.
+ * @param arena: the arena of list.
+ * @param next: the next node, or NULL.
+ */
+static inline void OffList_setNext(OffListRef self, OffArenaRef arena, OffListRef next)
+{
+    self->next = OffArena_offset(arena, next);
+};
+
+/* ---------------------------------------------------------------------------
+ *  OffListIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class OffListIter.
+ * 
+ * An offset list iterator.
+ */
+typedef struct _OffListIter
+{
+    OffArenaRef arena;
+    OffListRef current;
+    OffListRef prev;
+} OffListIter, *OffListIterRef;
+
+/**
+ * Init offset list iterator by list head.
+ * 
+ * @param self: the OffListIter object to be init.
+ * @param arena: the arena of list.
+ * @param head: the head of list.
+ */
+static inline void OffListIter_init(OffListIterRef self, OffArenaRef arena, OffListRef head)
+{
+    self->arena = arena;
+    self->current = self->prev = head;
+};
+
+/**
+ * New offset list iterator by list head.
+ * 
+ * @param arena: the arena of list.
+ * @param head: the head of list.
+ * 
+ * @return a OffListIter object start with head.
+ */
+static inline OffListIter OffListIter_new(OffArenaRef arena, OffListRef head)
+{
+    OffListIter iter;
+    OffListIter_init(&iter, arena, head);
+    return iter;
+};
+
+/**
+ * check if iterator has next node.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+static inline bool OffListIter_hasNext(OffListIterRef self)
+{
+    return self->current != NULL && self->current->next != OFF_NULL;
+};
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool OffListIter_next(OffListIterRef self);
+
+/**
+ * Get current list node.
+ * 
+ * @param self: the OffListIter object pointer.
+ * 
+ * @return a pointer to current list.
+ */
+static inline OffListRef OffListIter_current(OffListIterRef self)
+{
+    return self->current;
+};
+
+/** fast down cast helper to get current object */
+#define OffListIter_curObj(iter, type) (DOWN_CAST(OffListIter_current(&iter), type))
+
+/**
+ * Remove current item from list.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to removed node.
+ */
+OffListRef OffListIter_remove(OffListIterRef self, OffListRef *head);
+
+/**
+ * Insert new node to current position.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @param node: the node to be insert, in the same arena.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to inserted node, or NULL if failed.
+ */
+OffListRef OffListIter_insert(OffListIterRef self, OffListRef node, OffListRef *head);
+
+/* ---------------------------------------------------------------------------
+ *  OffDbList interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class OffDbList.
+ * 
+ * A double chain list node linked by offset, 8 bytes.
+ */
+typedef struct _OffDbList
+{
+    uint32_t next;          /**< next node offset */
+    uint32_t prev;          /**< prev node offset */
+} OffDbList, *OffDbListRef;
+
+/**
+ * Get next node.
+ * 
+ * @param self: the OffDbList node.
+ * @param arena: the arena of list.
+ * @return the next node.
+ */
+static inline OffDbListRef OffDbList_next(OffDbListRef self, OffArenaRef arena)
+{
+    return (OffDbListRef)OffArena_ptr(arena, self->next);
+};
+
+/**
+ * Get previous node.
+ * 
+ * @param self: the OffDbList node.
+ * @param arena: the arena of list.
+ * @return the previous node.
+ */
+static inline OffDbListRef OffDbList_prev(OffDbListRef self, OffArenaRef arena)
+{
+    return (OffDbListRef)OffArena_ptr(arena, self->prev);
+};
+
+/**
+ * Init double list node as a single node ring.
+ * 
+ * @param self: the OffDbList node to be init.
+ * @param arena: the arena of list.
+ */
+static inline void OffDbList_init(OffDbListRef self, OffArenaRef arena)
+{
+    self->next = self->prev = OffArena_offset(arena, self);
+};
+
+/**
+ * Remove double list node from list.
+ * 
+ * @param self: the OffDbList node to be remove.
+ * @param arena: the arena of list.
+ */
+static inline void OffDbList_remove(OffDbListRef self, OffArenaRef arena)
+{
+    OffDbList_next(self, arena)->prev = self->prev;
+    OffDbList_prev(self, arena)->next = self->next;
+    self->next = self->prev = OFF_NULL;
+};
+
+/**
+ * Insert double list node before target.
+ * 
+ * @param self: the OffDbList node to be insert.
+ * @param arena: the arena of list.
+ * @param target: the node after self.
+ */
+static inline void OffDbList_insert(OffDbListRef self, OffArenaRef arena, OffDbListRef target)
+{
+    uint32_t offset = OffArena_offset(arena, self);
+    self->next = OffArena_offset(arena, target);
+    self->prev = target->prev;
+    OffDbList_prev(target, arena)->next = offset;
+    target->prev = offset;
+};
+
+/**
+ * Remove double list node from list, update head if needed.
+ * 
+ * @param self: the OffDbList node to be remove.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_removeFrom(OffDbListRef self, OffArenaRef arena, OffDbListRef *head);
+
+/**
+ * Add double list node to list tail.
+ * 
+ * @param self: the OffDbList node to be insert.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_addToTail(OffDbListRef self, OffArenaRef arena, OffDbListRef *head);
+
+/**
+ * Add double list node to list head.
+ * 
+ * @param self: the OffDbList node to be insert.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_addToHead(OffDbListRef self, OffArenaRef arena, OffDbListRef *head);
+
+/* ---------------------------------------------------------------------------
+ *  OffDbListIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class OffDbListIter.
+ * 
+ * An offset double list iterator.
+ */
+typedef struct _OffDbListIter
+{
+    OffArenaRef arena;
+    OffDbListRef current;
+    OffDbListRef head;
+} OffDbListIter, *OffDbListIterRef;
+
+/**
+ * Init list iterator by double list head.
+ * 
+ * @param self: the OffDbListIter object to be init.
+ * @param arena: the arena of list.
+ * @param head: the head of double list.
+ */
+static inline void OffDbListIter_init(OffDbListIterRef self, OffArenaRef arena, OffDbListRef head)
+{
+    self->arena = arena;
+    self->current = head;
+    self->head = NULL;
+};
+
+/**
+ * New list iterator by double list head.
+ * 
+ * @param arena: the arena of list.
+ * @param head: the head of double list.
+ * 
+ * @return a OffDbListIter object start with head.
+ */
+static inline OffDbListIter OffDbListIter_new(OffArenaRef arena, OffDbListRef head)
+{
+    OffDbListIter iter;
+    OffDbListIter_init(&iter, arena, head);
+    return iter;
+};
+
+/**
+ * check if iterator has previous node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the head, otherwise true.
+ */
+static inline bool OffDbListIter_hasPrev(OffDbListIterRef self)
+{
+    return self->current != NULL && self->current != self->head;
+};
+
+/**
+ * check if iterator has next node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+static inline bool OffDbListIter_hasNext(OffDbListIterRef self)
+{
+    return self->current != NULL && OffDbList_next(self->current, self->arena) != self->head;
+};
+
+/**
+ * Get current list node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * 
+ * @return a pointer to current list.
+ */
+static inline OffDbListRef OffDbListIter_current(OffDbListIterRef self)
+{
+    return self->current;
+};
+
+/** fast down cast helper to get current object */
+#define OffDbListIter_curObj(iter, type) (DOWN_CAST(OffDbListIter_current(&iter), type))
+
+/**
+ * Get head node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * 
+ * @return a pointer to head node.
+ */
+static inline OffDbListRef OffDbListIter_head(OffDbListIterRef self)
+{
+    return self->head == NULL ? self->current : self->head;
+};
+
+/** fast down cast helper to get head object */
+#define OffDbListIter_headObj(iter, type) (DOWN_CAST(OffDbListIter_head(&iter), type))
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool OffDbListIter_next(OffDbListIterRef self);
+
+/**
+ * Move iterator to previouse node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the head, otherwise true.
+ */
+bool OffDbListIter_prev(OffDbListIterRef self);
+
+/**
+ * Remove current item from double list.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to removed node.
+ */
+OffDbListRef OffDbListIter_remove(OffDbListIterRef self, OffDbListRef *head);
+
+/**
+ * Insert new node to current position of double list.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @param node: the node to be insert, in the same arena.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to inserted node.
+ */
+OffDbListRef OffDbListIter_insert(OffDbListIterRef self, OffDbListRef node, OffDbListRef *head);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_OFFSET_LIST_H__ */
@@ -0,0 +1,150 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pairing_heap.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_PAIRING_HEAP_H__
+#define __MYUTIL_PAIRING_HEAP_H__
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  PairNode interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class PairNode.
+ * 
+ * A pairing heap node, embedded in user object. Children are linked as
+ * siblings, and prev of the leftmost child points to its parent.
+ */
+typedef struct _PairNode
+{
+    struct _PairNode *child;    /**< leftmost child */
+    struct _PairNode *next;     /**< right sibling */
+    struct _PairNode *prev;     /**< left sibling, or parent */
+} PairNode, *PairNodeRef;
+
+/** compare the keys of two nodes, return <0, 0 or >0 like strcmp. */
+typedef int (*PairNodeCompare)(PairNodeRef a, PairNodeRef b);
+
+/* ---------------------------------------------------------------------------
+ *  PairHeap interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class PairHeap.
+ * 
+ * An intrusive min pairing heap. Insert, merge and decrease-key are O(1),
+ * pop and remove are amortized O(log n).
+ */
+typedef struct _PairHeap
+{
+    PairNodeRef root;           /**< the min node */
+    PairNodeCompare compare;    /**< key compare function */
+    size_t count;               /**< node count */
+} PairHeap, *PairHeapRef;
+
+/**
+ * Init pairing heap.
+ * 
+ * @param self: the PairHeap object to be init.
+ * @param compare: the key compare function.
+ */
+static inline void PairHeap_init(PairHeapRef self, PairNodeCompare compare)
+{
+    self->root = NULL;
+    self->compare = compare;
+    self->count = 0;
+};
+
+/**
+ * Get node count.
+ * 
+ * @param self: the PairHeap object.
+ * @return the count of nodes.
+ */
+static inline size_t PairHeap_count(PairHeapRef self)
+{
+    return self->count;
+};
+
+/**
+ * Get the min node.
+ * 
+ * @param self: the PairHeap object.
+ * @return the min node, or NULL if empty.
+ */
+static inline PairNodeRef PairHeap_min(PairHeapRef self)
+{
+    return self->root;
+};
+
+/**
+ * Insert a node.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node to be insert.
+ */
+void PairHeap_insert(PairHeapRef self, PairNodeRef node);
+
+/**
+ * Move all nodes of other heap into this one, other becomes empty.
+ * 
+ * Both heaps must use the same compare function.
+ * 
+ * @param self: the PairHeap object.
+ * @param other: the heap to be merged.
+ */
+void PairHeap_merge(PairHeapRef self, PairHeapRef other);
+
+/**
+ * Remove the min node.
+ * 
+ * @param self: the PairHeap object.
+ * @return the min node, or NULL if empty.
+ */
+PairNodeRef PairHeap_pop(PairHeapRef self);
+
+/**
+ * Restore heap order after the key of node decreased.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node with a smaller key.
+ */
+void PairHeap_decrease(PairHeapRef self, PairNodeRef node);
+
+/**
+ * Remove a node.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node to be removed.
+ */
+void PairHeap_remove(PairHeapRef self, PairNodeRef node);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_PAIRING_HEAP_H__ */
@@ -0,0 +1,288 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rb_tree.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_RB_TREE_H__
+#define __MYUTIL_RB_TREE_H__
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  RbNode interface
+ * ------------------------------------------------------------------------ */
+
+#define RB_RED      0   /**< red node color */
+#define RB_BLACK    1   /**< black node color */
+
+/**
+ * Class RbNode.
+ * 
+ * A red-black tree node, embedded in user object. The color is packed in
+ * the lowest bit of parent pointer, so a node is 3 words.
+ */
+typedef struct _RbNode
+{
+    uintptr_t parentColor;      /**< parent pointer | color */
+    struct _RbNode *left;       /**< left child */
+    struct _RbNode *right;      /**< right child */
+} RbNode, *RbNodeRef;
+
+/** compare the key of node with a key, return <0, 0 or >0 like strcmp. */
+typedef int (*RbNodeCompare)(RbNodeRef node, void const *key);
+
+/**
+ * Get parent node.
+ * 
+ * @param self: the RbNode object.
+ * @return the parent, or NULL for root.
+ */
+static inline RbNodeRef RbNode_parent(RbNodeRef self)
+{
+    return (RbNodeRef)(self->parentColor & ~(uintptr_t)1);
+};
+
+/**
+ * Get node color.
+ * 
+ * @param self: the RbNode object.
+ * @return RB_RED or RB_BLACK.
+ */
+static inline int RbNode_color(RbNodeRef self)
+{
+    return (int)(self->parentColor & 1);
+};
+
+/**
+ * Get in-order next node.
+ * 
+ * @param self: the RbNode object.
+ * @return the next node, or NULL if self is the last one.
+ */
+RbNodeRef RbNode_next(RbNodeRef self);
+
+/**
+ * Get in-order previous node.
+ * 
+ * @param self: the RbNode object.
+ * @return the previous node, or NULL if self is the first one.
+ */
+RbNodeRef RbNode_prev(RbNodeRef self);
+
+/* ---------------------------------------------------------------------------
+ *  RbTree interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class RbTree.
+ * 
+ * An intrusive red-black tree, insert, erase and lookup are O(log n).
+ */
+typedef struct _RbTree
+{
+    RbNodeRef root;             /**< root node */
+    RbNodeCompare compare;      /**< key compare function */
+    size_t count;               /**< node count */
+} RbTree, *RbTreeRef;
+
+/**
+ * Init red-black tree.
+ * 
+ * @param self: the RbTree object to be init.
+ * @param compare: the key compare function.
+ */
+static inline void RbTree_init(RbTreeRef self, RbNodeCompare compare)
+{
+    self->root = NULL;
+    self->compare = compare;
+    self->count = 0;
+};
+
+/**
+ * Get node count.
+ * 
+ * @param self: the RbTree object.
+ * @return the count of nodes.
+ */
+static inline size_t RbTree_count(RbTreeRef self)
+{
+    return self->count;
+};
+
+/**
+ * Insert a node. Duplicated keys are kept, the new one last.
+ * 
+ * @param self: the RbTree object.
+ * @param node: the node to be insert.
+ * @param key: the key of node.
+ */
+void RbTree_insert(RbTreeRef self, RbNodeRef node, void const *key);
+
+/**
+ * Erase a node from tree.
+ * 
+ * @param self: the RbTree object.
+ * @param node: the node in tree to be erased.
+ */
+void RbTree_erase(RbTreeRef self, RbNodeRef node);
+
+/**
+ * Find a node with equal key.
+ * 
+ * @param self: the RbTree object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if not found.
+ */
+RbNodeRef RbTree_find(RbTreeRef self, void const *key);
+
+/**
+ * Find the first node whose key is not less than key.
+ * 
+ * @param self: the RbTree object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if all keys are less.
+ */
+RbNodeRef RbTree_lowerBound(RbTreeRef self, void const *key);
+
+/**
+ * Get the first node.
+ * 
+ * @param self: the RbTree object.
+ * @return the node with the least key, or NULL if empty.
+ */
+RbNodeRef RbTree_first(RbTreeRef self);
+
+/**
+ * Get the last node.
+ * 
+ * @param self: the RbTree object.
+ * @return the node with the greatest key, or NULL if empty.
+ */
+RbNodeRef RbTree_last(RbTreeRef self);
+
+/* ---------------------------------------------------------------------------
+ *  RbTreeIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class RbTreeIter.
+ * 
+ * An in-order tree iterator.
+ */
+typedef struct _RbTreeIter
+{
+    RbNodeRef current;          /**< current node, NULL before start */
+    RbNodeRef next;             /**< the node first next() moves to */
+    RbNodeRef prev;             /**< the node first prev() moves to */
+} RbTreeIter, *RbTreeIterRef;
+
+/**
+ * Init iterator before the first node.
+ * 
+ * @param self: the RbTreeIter object to be init.
+ * @param tree: the tree.
+ */
+static inline void RbTreeIter_init(RbTreeIterRef self, RbTreeRef tree)
+{
+    self->current = NULL;
+    self->next = RbTree_first(tree);
+    self->prev = RbTree_last(tree);
+};
+
+/**
+ * New iterator before the first node.
+ * 
+ * @param tree: the tree.
+ * @return a RbTreeIter object.
+ */
+static inline RbTreeIter RbTreeIter_new(RbTreeRef tree)
+{
+    RbTreeIter iter;
+    RbTreeIter_init(&iter, tree);
+    return iter;
+};
+
+/**
+ * Init iterator before the first node whose key is not less than key.
+ * 
+ * Then next() moves to the lower bound, prev() moves to the greatest node
+ * less than key.
+ * 
+ * @param self: the RbTreeIter object to be init.
+ * @param tree: the tree.
+ * @param key: the start key.
+ */
+static inline void RbTreeIter_seek(RbTreeIterRef self, RbTreeRef tree, void const *key)
+{
+    self->current = NULL;
+    self->next = RbTree_lowerBound(tree, key);
+    self->prev = self->next != NULL ? RbNode_prev(self->next) : RbTree_last(tree);
+};
+
+/**
+ * check if iterator has next node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+static inline bool RbTreeIter_hasNext(RbTreeIterRef self)
+{
+    return self->current == NULL ? self->next != NULL : RbNode_next(self->current) != NULL;
+};
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool RbTreeIter_next(RbTreeIterRef self);
+
+/**
+ * Move iterator to previous node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a booean, false for iterator reaches the head, otherwise true.
+ */
+bool RbTreeIter_prev(RbTreeIterRef self);
+
+/**
+ * Get current node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a pointer to current node.
+ */
+static inline RbNodeRef RbTreeIter_current(RbTreeIterRef self)
+{
+    return self->current;
+};
+
+/** fast down cast helper to get current object */
+#define RbTreeIter_curObj(iter, type) (DOWN_CAST(RbTreeIter_current(&iter), type))
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_RB_TREE_H__ */
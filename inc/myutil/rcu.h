@@ -0,0 +1,179 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rcu.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_RCU_H__
+#define __MYUTIL_RCU_H__
+
+#include "types.h"
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  RcuReader interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class RcuReader.
+ * 
+ * Per reader thread state. A reader publishes the epoch it observed when
+ * entering a read section, and 0 when it leaves. Only plain stores and a
+ * fence are used, no atomic read-modify-write.
+ */
+typedef struct _RcuReader
+{
+    List super;             /**< chain node of registered readers */
+    uint64_t epoch;         /**< epoch observed by read lock, 0 if offline */
+    uint32_t nesting;       /**< read lock nesting, owned by reader thread */
+} RcuReader, *RcuReaderRef;
+
+/* ---------------------------------------------------------------------------
+ *  RcuHead interface
+ * ------------------------------------------------------------------------ */
+
+struct _RcuHead;
+
+/** callback to reclaim an object after grace period. */
+typedef void (*RcuCallback)(struct _RcuHead *head);
+
+/**
+ * Class RcuHead.
+ * 
+ * Deferred reclamation record, embedded in user object.
+ */
+typedef struct _RcuHead
+{
+    List super;             /**< chain node of pending callbacks */
+    RcuCallback func;       /**< reclaim callback */
+} RcuHead, *RcuHeadRef;
+
+/* ---------------------------------------------------------------------------
+ *  Rcu interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class Rcu.
+ * 
+ * An epoch based RCU domain. Readers never block writers, a writer waits
+ * for a grace period, after which no reader can still hold a reference to
+ * a removed node.
+ * 
+ * Writer side functions (register, unregister, synchronize, call and
+ * reclaim) must be serialized by caller.
+ */
+typedef struct _Rcu
+{
+    uint64_t epoch;         /**< global epoch, starts from 1 */
+    ListRef readers;        /**< registered readers */
+    ListRef callbacks;      /**< pending reclaim callbacks */
+} Rcu, *RcuRef;
+
+/**
+ * Init RCU domain.
+ * 
+ * @param self: the Rcu object to be init.
+ */
+void Rcu_init(RcuRef self);
+
+/**
+ * Register a reader to RCU domain.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader to be registered.
+ */
+void Rcu_register(RcuRef self, RcuReaderRef reader);
+
+/**
+ * Unregister a reader from RCU domain. The reader should be offline.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader to be unregistered.
+ */
+void Rcu_unregister(RcuRef self, RcuReaderRef reader);
+
+/**
+ * Enter a read section, could be nested.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader of current thread.
+ */
+static inline void Rcu_readLock(RcuRef self, RcuReaderRef reader)
+{
+    if (reader->nesting++ == 0)
+    {
+        __atomic_store_n(&reader->epoch, 
+            __atomic_load_n(&self->epoch, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        /* epoch must be visible before any list load. */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+};
+
+/**
+ * Leave a read section.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader of current thread.
+ */
+static inline void Rcu_readUnlock(RcuRef self, RcuReaderRef reader)
+{
+    (void)self;
+    if (--reader->nesting == 0)
+        __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+};
+
+/**
+ * Wait for a grace period.
+ * 
+ * After return, every reader which may have seen a node removed before the
+ * call has left its read section.
+ * 
+ * @param self: the Rcu object.
+ */
+void Rcu_synchronize(RcuRef self);
+
+/**
+ * Queue a callback to be run after next grace period.
+ * 
+ * @param self: the Rcu object.
+ * @param head: the reclaim record embedded in removed object.
+ * @param func: the callback.
+ */
+void Rcu_call(RcuRef self, RcuHeadRef head, RcuCallback func);
+
+/**
+ * Wait one grace period for all queued callbacks, then run them.
+ * 
+ * Removals are batched, so one grace period is shared by all callbacks
+ * queued since last reclaim.
+ * 
+ * @param self: the Rcu object.
+ * @return the count of callbacks run.
+ */
+size_t Rcu_reclaim(RcuRef self);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_RCU_H__ */
@@ -0,0 +1,190 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file rope.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_ROPE_H__
+#define __MYUTIL_ROPE_H__
+
+#include "types.h"
+#include "allocator.h"
+#include "list.h"
+
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Rope interface
+ * ------------------------------------------------------------------------ */
+
+#define ROPE_CHUNK_SIZE 4096    /**< min bytes of chunks allocated for copies */
+
+/** release external memory appended by Rope_appendRef, when no rope uses it. */
+typedef void (*RopeRelease)(void *data, void *arg);
+
+struct _RopeChunk;
+
+/**
+ * Class Rope.
+ * 
+ * A byte buffer made of segments, each one a range of a refcounted chunk.
+ * Segments are chained by List and allocated from an allocator.
+ * 
+ * Existing memory is appended without copy as an external chunk, slices
+ * share chunks with the source rope, and the content is exported as an
+ * iovec array for writev. Copied bytes fill the last chunk while it is
+ * not shared. A chunk is freed, or its release callback is called, when
+ * the last segment referencing it is dropped, from any rope.
+ * 
+ * Chunk refcounts are atomic, so ropes sharing chunks can be used by
+ * different threads, but a rope itself is not thread safe.
+ */
+typedef struct _Rope
+{
+    ListRef head;               /**< the first segment */
+    ListRef tail;               /**< the last segment */
+    size_t length;              /**< total bytes */
+    size_t count;               /**< segment count */
+    AllocatorRef allocator;     /**< allocator of segments and chunks */
+} Rope, *RopeRef;
+
+/**
+ * Init an empty rope.
+ * 
+ * @param self: the Rope object to be init.
+ * @param allocator: the allocator of segments and chunks.
+ */
+static inline void Rope_init(RopeRef self, AllocatorRef allocator)
+{
+    self->head = NULL;
+    self->tail = NULL;
+    self->length = 0;
+    self->count = 0;
+    self->allocator = allocator;
+};
+
+/**
+ * Drop all segments, the rope is empty after.
+ * 
+ * @param self: the Rope object.
+ */
+void Rope_clear(RopeRef self);
+
+/**
+ * Release all segments.
+ * 
+ * @param self: the Rope object.
+ */
+static inline void Rope_destroy(RopeRef self)
+{
+    Rope_clear(self);
+};
+
+/**
+ * Get byte count.
+ * 
+ * @param self: the Rope object.
+ * @return the total bytes.
+ */
+static inline size_t Rope_length(RopeRef self)
+{
+    return self->length;
+};
+
+/**
+ * Get segment count, the iovec entries to export all bytes.
+ * 
+ * @param self: the Rope object.
+ * @return the count of segments.
+ */
+static inline size_t Rope_segments(RopeRef self)
+{
+    return self->count;
+};
+
+/**
+ * Append a copy of bytes.
+ * 
+ * @param self: the Rope object.
+ * @param data: the bytes.
+ * @param len: the length of bytes.
+ * @return false if allocation failed and the rope is unchanged.
+ */
+bool Rope_append(RopeRef self, void const *data, size_t len);
+
+/**
+ * Append existing memory without copy, O(1).
+ * 
+ * @param self: the Rope object.
+ * @param data: the memory, unchanged until released.
+ * @param len: the length of memory.
+ * @param release: called when no rope uses the memory, or NULL.
+ * @param arg: the argument of release.
+ * @return false if allocation failed, the memory is not released then.
+ */
+bool Rope_appendRef(RopeRef self, void const *data, size_t len, RopeRelease release, void *arg);
+
+/**
+ * Append a range of another rope without copy, sharing its chunks.
+ * 
+ * @param self: the Rope object to append to.
+ * @param src: the source rope, could not be self.
+ * @param offset: the first byte of range.
+ * @param len: the length of range, clamped to the end of src.
+ * @return false if allocation failed and the rope is unchanged.
+ */
+bool Rope_slice(RopeRef self, RopeRef src, size_t offset, size_t len);
+
+/**
+ * Drop bytes from the front, e.g. what writev has written.
+ * 
+ * @param self: the Rope object.
+ * @param len: the bytes to drop, clamped to length.
+ */
+void Rope_consume(RopeRef self, size_t len);
+
+/**
+ * Export the first segments as iovec entries.
+ * 
+ * @param self: the Rope object.
+ * @param iov: the iovec array.
+ * @param max: the size of iovec array.
+ * @return the count of entries filled.
+ */
+size_t Rope_iovec(RopeRef self, struct iovec *iov, size_t max);
+
+/**
+ * Copy bytes out.
+ * 
+ * @param self: the Rope object.
+ * @param offset: the first byte to copy.
+ * @param buf: the buffer.
+ * @param len: the buffer size.
+ * @return the bytes copied.
+ */
+size_t Rope_copy(RopeRef self, size_t offset, void *buf, size_t len);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_ROPE_H__ */
@@ -0,0 +1,210 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file skip_list.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_SKIP_LIST_H__
+#define __MYUTIL_SKIP_LIST_H__
+
+#include "types.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** max height of skip list tower. */
+#define SKIP_LIST_MAX_HEIGHT 16
+
+/* ---------------------------------------------------------------------------
+ *  SkipNode interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class SkipNode.
+ * 
+ * A skip list node with its tower of links, embedded as the last member of
+ * user object. The tower is extended to node height when the object is
+ * allocated by SkipList_new().
+ */
+typedef struct _SkipNode
+{
+    uint32_t height;            /**< tower height */
+    struct _SkipNode *next[1];  /**< tower of next links, level 0 first */
+} SkipNode, *SkipNodeRef;
+
+/** compare the key of node with a key, return <0, 0 or >0 like strcmp. */
+typedef int (*SkipNodeCompare)(SkipNodeRef node, void const *key);
+
+/* ---------------------------------------------------------------------------
+ *  SkipList interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class SkipList.
+ * 
+ * An intrusive ordered skip list. Insert and find are lock-free, many
+ * threads could insert and find concurrently. Remove is not, it should be
+ * exclusive to all other operations.
+ */
+typedef struct _SkipList
+{
+    SkipNodeRef heads[SKIP_LIST_MAX_HEIGHT];    /**< head links of each level */
+    uint32_t height;            /**< current max height of nodes */
+    uint64_t seed;              /**< random seed of node height */
+    SkipNodeCompare compare;    /**< key compare function */
+} SkipList, *SkipListRef;
+
+/**
+ * Init skip list.
+ * 
+ * @param self: the SkipList object to be init.
+ * @param compare: the key compare function.
+ */
+void SkipList_init(SkipListRef self, SkipNodeCompare compare);
+
+/**
+ * Allocate an object embedded skip node, with a random tower height.
+ * 
+ * @param self: the SkipList object.
+ * @param allocator: the allocator, should be thread safe if called
+ *      concurrently.
+ * @param size: the object size.
+ * @param offset: the offset of skip node in object, should be the last one.
+ * @return the object pointer, or NULL if allocation failed.
+ */
+void *SkipList_alloc(SkipListRef self, AllocatorRef allocator, size_t size, size_t offset);
+
+/** Fast function to allocate an object whose skip node is `super`, the last member. */
+#define SkipList_new(self, allocator, type) \
+    ((type *)SkipList_alloc(self, allocator, sizeof(type), (size_t)&(((type *)0)->super)))
+
+/**
+ * Insert a node, lock-free. Duplicated keys are kept, the new one first.
+ * 
+ * @param self: the SkipList object.
+ * @param node: the node to be insert.
+ * @param key: the key of node.
+ */
+void SkipList_insert(SkipListRef self, SkipNodeRef node, void const *key);
+
+/**
+ * Find the first node whose key is not less than key, lock-free.
+ * 
+ * @param self: the SkipList object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if all keys are less.
+ */
+SkipNodeRef SkipList_lowerBound(SkipListRef self, void const *key);
+
+/**
+ * Find a node with equal key, lock-free.
+ * 
+ * @param self: the SkipList object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if not found.
+ */
+SkipNodeRef SkipList_find(SkipListRef self, void const *key);
+
+/**
+ * Remove a node from list, should be exclusive to all other operations.
+ * 
+ * @param self: the SkipList object.
+ * @param node: the node to be removed.
+ * @param key: the key of node.
+ * @return true if removed, false if not found.
+ */
+bool SkipList_remove(SkipListRef self, SkipNodeRef node, void const *key);
+
+/* ---------------------------------------------------------------------------
+ *  SkipListIter interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class SkipListIter.
+ * 
+ * An ordered iterator along level 0 of skip list.
+ */
+typedef struct _SkipListIter
+{
+    SkipNodeRef current;    /**< current node */
+    SkipNodeRef next;       /**< next node */
+} SkipListIter, *SkipListIterRef;
+
+/**
+ * Init iterator before the first node.
+ * 
+ * @param self: the SkipListIter object to be init.
+ * @param list: the skip list.
+ */
+static inline void SkipListIter_init(SkipListIterRef self, SkipListRef list)
+{
+    self->current = NULL;
+    self->next = __atomic_load_n(&list->heads[0], __ATOMIC_ACQUIRE);
+};
+
+/**
+ * Init iterator before the first node whose key is not less than key.
+ * 
+ * @param self: the SkipListIter object to be init.
+ * @param list: the skip list.
+ * @param key: the start key of range.
+ */
+static inline void SkipListIter_seek(SkipListIterRef self, SkipListRef list, void const *key)
+{
+    self->current = NULL;
+    self->next = SkipList_lowerBound(list, key);
+};
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the SkipListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+static inline bool SkipListIter_next(SkipListIterRef self)
+{
+    self->current = self->next;
+    if (self->current == NULL)
+        return false;
+
+    self->next = __atomic_load_n(&self->current->next[0], __ATOMIC_ACQUIRE);
+    return true;
+};
+
+/**
+ * Get current node.
+ * 
+ * @param self: the SkipListIter object pointer.
+ * @return a pointer to current node.
+ */
+static inline SkipNodeRef SkipListIter_current(SkipListIterRef self)
+{
+    return self->current;
+};
+
+/** fast down cast helper to get current object */
+#define SkipListIter_curObj(iter, type) (DOWN_CAST(SkipListIter_current(&iter), type))
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_SKIP_LIST_H__ */
@@ -0,0 +1,177 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file spsc_ring.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_SPSC_RING_H__
+#define __MYUTIL_SPSC_RING_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  SpscRing interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class SpscRing.
+ * 
+ * A bounded lock-free ring of pointers, for one producer thread and one
+ * consumer thread. Indices run freely and are masked into a power of two
+ * slot array. Each side caches the index of the other side, and reloads it
+ * only when the ring looks full or empty, so the shared cache lines move
+ * once per batch instead of once per item.
+ */
+typedef struct _SpscRing
+{
+    /* read only after init */
+    void **slots;               /**< slot array */
+    size_t mask;                /**< slot count - 1 */
+    AllocatorRef allocator;     /**< allocator of slots */
+
+    /* written by producer */
+    CACHE_ALIGNED size_t head;  /**< next index to write */
+    size_t tailCache;           /**< last seen tail */
+
+    /* written by consumer */
+    CACHE_ALIGNED size_t tail;  /**< next index to read */
+    size_t headCache;           /**< last seen head */
+} CACHE_ALIGNED SpscRing, *SpscRingRef;
+
+/**
+ * Init ring, allocate slots.
+ * 
+ * @param self: the SpscRing object to be init.
+ * @param allocator: the allocator of slots.
+ * @param capacity: the min count of items, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool SpscRing_init(SpscRingRef self, AllocatorRef allocator, size_t capacity);
+
+/**
+ * Release slots, the ring must not be used by any thread.
+ * 
+ * @param self: the SpscRing object.
+ */
+void SpscRing_destroy(SpscRingRef self);
+
+/**
+ * Get the slot count.
+ * 
+ * @param self: the SpscRing object.
+ * @return the max count of items.
+ */
+static inline size_t SpscRing_capacity(SpscRingRef self)
+{
+    return self->mask + 1;
+};
+
+/**
+ * Get the item count, only a hint while both sides are running.
+ * 
+ * @param self: the SpscRing object.
+ * @return the count of queued items.
+ */
+static inline size_t SpscRing_count(SpscRingRef self)
+{
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&self->head, __ATOMIC_ACQUIRE) - tail;
+};
+
+/**
+ * Enqueue an item, producer only.
+ * 
+ * @param self: the SpscRing object.
+ * @param item: the item pointer.
+ * @return true if success, false if ring is full.
+ */
+static inline bool SpscRing_push(SpscRingRef self, void *item)
+{
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+
+    if (head - self->tailCache > self->mask)
+    {
+        self->tailCache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        if (head - self->tailCache > self->mask)
+            return false;
+    }
+
+    self->slots[head & self->mask] = item;
+    __atomic_store_n(&self->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+};
+
+/**
+ * Dequeue an item, consumer only.
+ * 
+ * @param self: the SpscRing object.
+ * @param item: output of the item pointer.
+ * @return true if success, false if ring is empty.
+ */
+static inline bool SpscRing_pop(SpscRingRef self, void **item)
+{
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+
+    if (tail == self->headCache)
+    {
+        self->headCache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+        if (tail == self->headCache)
+            return false;
+    }
+
+    *item = self->slots[tail & self->mask];
+    __atomic_store_n(&self->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+};
+
+/**
+ * Enqueue up to n items, producer only.
+ * 
+ * Items are published together by one index update.
+ * 
+ * @param self: the SpscRing object.
+ * @param items: the item pointers.
+ * @param n: the count of items.
+ * @return the count of enqueued items, from the start of items.
+ */
+size_t SpscRing_pushN(SpscRingRef self, void *const items[], size_t n);
+
+/**
+ * Dequeue up to n items, consumer only.
+ * 
+ * Slots are released together by one index update.
+ * 
+ * @param self: the SpscRing object.
+ * @param items: the array to store item pointers.
+ * @param n: the max count of items.
+ * @return the count of dequeued items.
+ */
+size_t SpscRing_popN(SpscRingRef self, void *items[], size_t n);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_SPSC_RING_H__ */
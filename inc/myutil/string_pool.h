@@ -0,0 +1,160 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file string_pool.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_STRING_POOL_H__
+#define __MYUTIL_STRING_POOL_H__
+
+#include "types.h"
+#include "allocator.h"
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  StringPool interface
+ * ------------------------------------------------------------------------ */
+
+#define STRING_POOL_CHUNK_SIZE 0x10000  /**< default bytes of an arena chunk */
+
+struct _StringPoolSlot;
+
+/**
+ * Class StringPool.
+ * 
+ * A string interner. Every distinct string is copied once into arena
+ * chunks from an allocator and never moves, so its handle is a stable
+ * `cstr_t` and two interned strings are equal if and only if their
+ * handles are equal.
+ * 
+ * Handles are found through an open addressing index of hashes and
+ * handles, probing compares the stored hashes first and touches string
+ * bytes only on a hash match. Strings are never removed, the arena is
+ * released as a whole by StringPool_destroy.
+ */
+typedef struct _StringPool
+{
+    struct _StringPoolSlot *slots;  /**< index slots */
+    size_t mask;                    /**< slot count minus 1 */
+    size_t count;                   /**< string count */
+    ListRef chunks;                 /**< arena chunks, current one first */
+    size_t chunkSize;               /**< bytes of a regular chunk */
+    AllocatorRef allocator;         /**< allocator of index and chunks */
+} StringPool, *StringPoolRef;
+
+/**
+ * Init pool.
+ * 
+ * @param self: the StringPool object to be init.
+ * @param allocator: the allocator of index and chunks.
+ * @param chunkSize: the bytes of arena chunks, 0 for STRING_POOL_CHUNK_SIZE.
+ * @return false if allocation failed.
+ */
+bool StringPool_init(StringPoolRef self, AllocatorRef allocator, size_t chunkSize);
+
+/**
+ * Release index and all strings, handles become invalid.
+ * 
+ * @param self: the StringPool object.
+ */
+void StringPool_destroy(StringPoolRef self);
+
+/**
+ * Get string count.
+ * 
+ * @param self: the StringPool object.
+ * @return the count of distinct strings.
+ */
+static inline size_t StringPool_count(StringPoolRef self)
+{
+    return self->count;
+};
+
+/**
+ * Get the length of an interned string, O(1).
+ * 
+ * @param handle: the interned string.
+ * @return the length in bytes.
+ */
+static inline size_t StringPool_length(cstr_t handle)
+{
+    return ((uint32_t const *)handle)[-1];
+};
+
+/**
+ * Get the hash of an interned string, Hash_bytes of its bytes.
+ * 
+ * @param handle: the interned string.
+ * @return the hash value.
+ */
+static inline uint32_t StringPool_hash(cstr_t handle)
+{
+    return ((uint32_t const *)handle)[-2];
+};
+
+/**
+ * Intern bytes as a zero terminated string.
+ * 
+ * @param self: the StringPool object.
+ * @param data: the bytes.
+ * @param len: the length of bytes.
+ * @return the handle, or NULL if allocation failed.
+ */
+cstr_t StringPool_internBytes(StringPoolRef self, void const *data, size_t len);
+
+/**
+ * Intern a zero terminated string.
+ * 
+ * @param self: the StringPool object.
+ * @param str: the string.
+ * @return the handle, or NULL if allocation failed.
+ */
+cstr_t StringPool_intern(StringPoolRef self, cstr_t str);
+
+/**
+ * Intern many strings.
+ * 
+ * The index grows once for all strings, and the slots of following
+ * strings are prefetched while interning.
+ * 
+ * @param self: the StringPool object.
+ * @param strs: the zero terminated strings.
+ * @param n: the count of strings.
+ * @param handles: output the handles, NULL for allocation failures.
+ * @return the count of strings interned.
+ */
+size_t StringPool_internBatch(StringPoolRef self, cstr_t const *strs, size_t n, cstr_t *handles);
+
+/**
+ * Find the handle of a string without interning it.
+ * 
+ * @param self: the StringPool object.
+ * @param str: the string.
+ * @return the handle, or NULL if not interned.
+ */
+cstr_t StringPool_find(StringPoolRef self, cstr_t str);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_STRING_POOL_H__ */
@@ -0,0 +1,256 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file task_scheduler.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_TASK_SCHEDULER_H__
+#define __MYUTIL_TASK_SCHEDULER_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  WsDeque interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class WsDeque.
+ * 
+ * A bounded Chase-Lev work-stealing deque of pointers. The owner thread
+ * pushes and takes at the bottom in LIFO order, other threads steal from
+ * the top in FIFO order. Only the last item is contended.
+ */
+typedef struct _WsDeque
+{
+    int64_t top;                                    /**< next index to steal */
+    uint8_t pad0[CACHE_LINE_SIZE - sizeof(int64_t)];  /**< keep top and bottom apart */
+    int64_t bottom;                                 /**< next index to push */
+    uint8_t pad1[CACHE_LINE_SIZE - sizeof(int64_t)];  /**< keep bottom and slots apart */
+    void **slots;                                   /**< slot array */
+    int64_t mask;                                   /**< slot count - 1 */
+    AllocatorRef allocator;                         /**< allocator of slots */
+} WsDeque, *WsDequeRef;
+
+/**
+ * Init deque, allocate slots.
+ * 
+ * @param self: the WsDeque object to be init.
+ * @param allocator: the allocator of slots.
+ * @param capacity: the min count of items, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool WsDeque_init(WsDequeRef self, AllocatorRef allocator, size_t capacity);
+
+/**
+ * Release slots, the deque must not be used by any thread.
+ * 
+ * @param self: the WsDeque object.
+ */
+void WsDeque_destroy(WsDequeRef self);
+
+/**
+ * Get the item count, only a hint while others are stealing.
+ * 
+ * @param self: the WsDeque object.
+ * @return the count of items.
+ */
+static inline size_t WsDeque_count(WsDequeRef self)
+{
+    int64_t top = __atomic_load_n(&self->top, __ATOMIC_ACQUIRE);
+    int64_t bottom = __atomic_load_n(&self->bottom, __ATOMIC_ACQUIRE);
+    return bottom > top ? (size_t)(bottom - top) : 0;
+};
+
+/**
+ * Push an item at bottom, owner only.
+ * 
+ * @param self: the WsDeque object.
+ * @param item: the item pointer, not NULL.
+ * @return true if success, false if deque is full.
+ */
+bool WsDeque_push(WsDequeRef self, void *item);
+
+/**
+ * Take the last pushed item, owner only.
+ * 
+ * @param self: the WsDeque object.
+ * @return the item pointer, or NULL if empty.
+ */
+void *WsDeque_take(WsDequeRef self);
+
+/**
+ * Steal the first pushed item, any thread.
+ * 
+ * @param self: the WsDeque object.
+ * @return the item pointer, or NULL if empty or another thread won it.
+ */
+void *WsDeque_steal(WsDequeRef self);
+
+/* ---------------------------------------------------------------------------
+ *  TaskScheduler interface
+ * ------------------------------------------------------------------------ */
+
+struct _TaskWorker;
+struct _TaskSchedulerCore;
+
+/** task function, run by a worker, fork children by the worker. */
+typedef void (*TaskFunc)(struct _TaskWorker *worker, void *arg);
+
+/**
+ * Class TaskGroup.
+ * 
+ * A group of forked tasks to join.
+ */
+typedef struct _TaskGroup
+{
+    size_t pending;         /**< count of unfinished tasks */
+} TaskGroup, *TaskGroupRef;
+
+/**
+ * Init task group.
+ * 
+ * @param self: the TaskGroup object to be init.
+ */
+static inline void TaskGroup_init(TaskGroupRef self)
+{
+    self->pending = 0;
+};
+
+/**
+ * Class Task.
+ * 
+ * A forked task record, allocated from the arena of the forking worker
+ * and recycled through its free list.
+ */
+typedef struct _Task
+{
+    List super;                 /**< free list node */
+    TaskFunc func;              /**< task function */
+    void *arg;                  /**< argument of func */
+    TaskGroupRef group;         /**< group to join */
+    struct _TaskWorker *owner;  /**< worker owning the record */
+} Task, *TaskRef;
+
+/**
+ * Class TaskWorker.
+ * 
+ * A worker of scheduler, worker 0 is the thread calling TaskScheduler_run.
+ */
+typedef struct _TaskWorker
+{
+    WsDeque deque;                      /**< forked tasks */
+    AllocatorRef arena;                 /**< allocator of task records */
+    ListRef free;                       /**< recycled records, owner only */
+    ListRef remote;                     /**< records returned by other workers */
+    struct _TaskSchedulerCore *core;    /**< scheduler core */
+    size_t index;                       /**< worker index */
+    uint64_t seed;                      /**< random victim seed */
+} TaskWorker, *TaskWorkerRef;
+
+/**
+ * Fork a task into a group.
+ * 
+ * The task is pushed to the worker deque, to be run by itself or stolen by
+ * others. It runs inline if no record is available.
+ * 
+ * @param self: the current TaskWorker.
+ * @param group: the group to join.
+ * @param func: the task function.
+ * @param arg: the argument of func.
+ */
+void TaskWorker_fork(TaskWorkerRef self, TaskGroupRef group, TaskFunc func, void *arg);
+
+/**
+ * Wait until all tasks of group are done, run own or stolen tasks meanwhile.
+ * 
+ * A task must join all its forked tasks before it returns.
+ * 
+ * @param self: the current TaskWorker.
+ * @param group: the group to join.
+ */
+void TaskWorker_join(TaskWorkerRef self, TaskGroupRef group);
+
+/**
+ * Class TaskScheduler.
+ * 
+ * A fork/join scheduler with per-worker deques and random victim stealing.
+ */
+typedef struct _TaskScheduler
+{
+    AllocatorRef allocator;             /**< allocator of core */
+    struct _TaskSchedulerCore *core;    /**< workers and threads */
+    size_t workers;                     /**< worker count */
+} TaskScheduler, *TaskSchedulerRef;
+
+/**
+ * Init scheduler and start worker threads.
+ * 
+ * Every worker owns an arena of task records and its deque slots, carved
+ * from allocator.
+ * 
+ * @param self: the TaskScheduler object to be init.
+ * @param allocator: the allocator of core and arenas.
+ * @param workers: the worker count including caller, at least 1.
+ * @param tasks: the max count of outstanding records per worker.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool TaskScheduler_init(TaskSchedulerRef self, AllocatorRef allocator, size_t workers, size_t tasks);
+
+/**
+ * Stop worker threads and release core.
+ * 
+ * @param self: the TaskScheduler object.
+ */
+void TaskScheduler_destroy(TaskSchedulerRef self);
+
+/**
+ * Get worker count.
+ * 
+ * @param self: the TaskScheduler object.
+ * @return the count of workers.
+ */
+static inline size_t TaskScheduler_workers(TaskSchedulerRef self)
+{
+    return self->workers;
+};
+
+/**
+ * Run a root task in the caller thread as worker 0, return when it is done.
+ * 
+ * Other workers steal while it runs and sleep after. Only one thread may
+ * run at a time.
+ * 
+ * @param self: the TaskScheduler object.
+ * @param func: the root task function.
+ * @param arg: the argument of func.
+ */
+void TaskScheduler_run(TaskSchedulerRef self, TaskFunc func, void *arg);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_TASK_SCHEDULER_H__ */
@@ -0,0 +1,186 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file thread_pool.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_THREAD_POOL_H__
+#define __MYUTIL_THREAD_POOL_H__
+
+#include "types.h"
+#include "allocator.h"
+#include "list.h"
+#include "double_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  ThreadWork interface
+ * ------------------------------------------------------------------------ */
+
+/** work function, run by a worker thread. */
+typedef void (*ThreadFunc)(void *arg);
+
+/**
+ * Class ThreadGroup.
+ * 
+ * A group of submitted works to wait for.
+ */
+typedef struct _ThreadGroup
+{
+    size_t pending;         /**< count of unfinished works */
+} ThreadGroup, *ThreadGroupRef;
+
+/**
+ * Init thread group.
+ * 
+ * @param self: the ThreadGroup object to be init.
+ */
+static inline void ThreadGroup_init(ThreadGroupRef self)
+{
+    self->pending = 0;
+};
+
+/**
+ * Class ThreadWork.
+ * 
+ * A work item, embedded in user object or standalone, so submission needs
+ * no allocation. It must stay valid until the work is done.
+ */
+typedef struct _ThreadWork
+{
+    List super;             /**< queue node */
+    ThreadFunc func;        /**< work function */
+    void *arg;              /**< argument of func */
+    ThreadGroupRef group;   /**< group of work, or NULL */
+} ThreadWork, *ThreadWorkRef;
+
+/* ---------------------------------------------------------------------------
+ *  ThreadPool interface
+ * ------------------------------------------------------------------------ */
+
+struct _ThreadPoolCore;
+
+/**
+ * Class ThreadPool.
+ * 
+ * A fixed size pool of worker threads, starting works in submission order.
+ * Submission pushes the work to a lock-free stack and only makes a syscall
+ * when a worker is parked. Workers pop ready works one by one under a
+ * short lock. Idle workers and group waiters park on futexes.
+ */
+typedef struct _ThreadPool
+{
+    AllocatorRef allocator;         /**< allocator of core */
+    struct _ThreadPoolCore *core;   /**< threads and queue */
+    size_t threads;                 /**< worker count */
+} ThreadPool, *ThreadPoolRef;
+
+/**
+ * Init thread pool and start workers.
+ * 
+ * @param self: the ThreadPool object to be init.
+ * @param allocator: the allocator of pool core.
+ * @param threads: the worker count, at least 1.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool ThreadPool_init(ThreadPoolRef self, AllocatorRef allocator, size_t threads);
+
+/**
+ * Stop workers after queued works are done, and release pool core.
+ * 
+ * @param self: the ThreadPool object.
+ */
+void ThreadPool_destroy(ThreadPoolRef self);
+
+/**
+ * Get worker count.
+ * 
+ * @param self: the ThreadPool object.
+ * @return the count of workers.
+ */
+static inline size_t ThreadPool_threads(ThreadPoolRef self)
+{
+    return self->threads;
+};
+
+/**
+ * Submit a work.
+ * 
+ * @param self: the ThreadPool object.
+ * @param work: the work item.
+ * @param func: the work function.
+ * @param arg: the argument of func.
+ * @param group: the group to join, or NULL.
+ */
+void ThreadPool_submit(ThreadPoolRef self, ThreadWorkRef work, ThreadFunc func, void *arg, ThreadGroupRef group);
+
+/**
+ * Wait until all works of group are done.
+ * 
+ * @param self: the ThreadPool object.
+ * @param group: the group to wait for.
+ */
+void ThreadPool_wait(ThreadPoolRef self, ThreadGroupRef group);
+
+/* ---------------------------------------------------------------------------
+ *  Parallel interface
+ * ------------------------------------------------------------------------ */
+
+#define PARALLEL_MAX_SEGMENTS 64    /**< max segment count of a parallel travel */
+
+/**
+ * segment function of parallel travel.
+ * 
+ * segment is the head of an independent ring, travel it by DbListIter or
+ * DBLIST_FOREACH. Nodes must not be added or removed.
+ */
+typedef void (*DbListSegmentFunc)(DbListRef segment, size_t index, void *arg);
+
+/** reduce function of parallel travel, called by segment order. */
+typedef void (*DbListReduceFunc)(size_t index, void *arg);
+
+/**
+ * Travel a double list in parallel.
+ * 
+ * The list is cut into rings of nearly equal length by one walk, which
+ * marks every stride-th node, then each cut steps less than a stride from
+ * its nearest mark. Each ring is run as a work on the pool, then rings are
+ * linked back in order. The list must not be touched by others during the
+ * call.
+ * 
+ * @param head: the head of double list.
+ * @param pool: the ThreadPool to run segments.
+ * @param segments: the segment count, up to PARALLEL_MAX_SEGMENTS, or 0
+ *      for worker count.
+ * @param func: the segment function.
+ * @param reduce: the reduce function called in caller thread, or NULL.
+ * @param arg: the argument of func and reduce.
+ * @return the count of segments run.
+ */
+size_t DbList_parallelForEach(DbListRef head, ThreadPoolRef pool, size_t segments,
+    DbListSegmentFunc func, DbListReduceFunc reduce, void *arg);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_THREAD_POOL_H__ */
@@ -0,0 +1,157 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file timer_wheel.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_TIMER_WHEEL_H__
+#define __MYUTIL_TIMER_WHEEL_H__
+
+#include "types.h"
+#include "double_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_WHEEL_BITS    6                               /**< bits of ticks per level, slots fit a uint64_t bitmap */
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)         /**< slot count per level */
+#define TIMER_WHEEL_LEVELS  5                               /**< level count */
+#define TIMER_WHEEL_RANGE   (1ull << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))   /**< max ticks ahead */
+
+/* ---------------------------------------------------------------------------
+ *  Timer interface
+ * ------------------------------------------------------------------------ */
+
+struct _Timer;
+
+/** timer expiry callback. */
+typedef void (*TimerCallback)(struct _Timer *timer);
+
+/**
+ * Class Timer.
+ * 
+ * A timer, embedded in user object.
+ */
+typedef struct _Timer
+{
+    DbList super;           /**< slot list node */
+    DbListRef *slot;        /**< the slot linked in, NULL if not pending */
+    uint64_t expires;       /**< expiry tick */
+    TimerCallback callback; /**< expiry callback */
+} Timer, *TimerRef;
+
+/**
+ * Init timer.
+ * 
+ * @param self: the Timer object to be init.
+ */
+static inline void Timer_init(TimerRef self)
+{
+    self->slot = NULL;
+};
+
+/**
+ * Check if timer is scheduled and not expired.
+ * 
+ * @param self: the Timer object.
+ * @return true if pending.
+ */
+static inline bool Timer_isPending(TimerRef self)
+{
+    return self->slot != NULL;
+};
+
+/* ---------------------------------------------------------------------------
+ *  TimerWheel interface
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Class TimerWheel.
+ * 
+ * A hashed hierarchical timer wheel. Slots are DbList heads, so schedule
+ * and cancel are O(1). Each tick runs one slot of level 0, and timers of
+ * higher levels cascade down when lower level wraps. Empty slots are
+ * skipped by a bitmap per level.
+ */
+typedef struct _TimerWheel
+{
+    uint64_t now;           /**< current tick */
+    size_t count;           /**< pending timer count */
+    uint64_t bitmap[TIMER_WHEEL_LEVELS];    /**< non-empty slots per level */
+    DbListRef slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];     /**< slot lists */
+} TimerWheel, *TimerWheelRef;
+
+/**
+ * Init timer wheel.
+ * 
+ * @param self: the TimerWheel object to be init.
+ * @param now: current tick.
+ */
+void TimerWheel_init(TimerWheelRef self, uint64_t now);
+
+/**
+ * Get pending timer count.
+ * 
+ * @param self: the TimerWheel object.
+ * @return the count of pending timers.
+ */
+static inline size_t TimerWheel_count(TimerWheelRef self)
+{
+    return self->count;
+};
+
+/**
+ * Schedule a timer, a pending timer is rescheduled.
+ * 
+ * A timer expired before now runs on next tick. A timer later than
+ * TIMER_WHEEL_RANGE ticks is cascaded once more per range.
+ * 
+ * @param self: the TimerWheel object.
+ * @param timer: the timer.
+ * @param expires: the expiry tick.
+ * @param callback: the expiry callback.
+ */
+void TimerWheel_schedule(TimerWheelRef self, TimerRef timer, uint64_t expires, TimerCallback callback);
+
+/**
+ * Cancel a timer.
+ * 
+ * @param self: the TimerWheel object.
+ * @param timer: the timer.
+ * @return true if the timer was pending.
+ */
+bool TimerWheel_cancel(TimerWheelRef self, TimerRef timer);
+
+/**
+ * Move wheel forward, run callbacks of expired timers.
+ * 
+ * Callbacks could schedule or cancel any timer.
+ * 
+ * @param self: the TimerWheel object.
+ * @param now: the new current tick.
+ * @return the count of expired timers.
+ */
+size_t TimerWheel_advance(TimerWheelRef self, uint64_t now);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_TIMER_WHEEL_H__ */
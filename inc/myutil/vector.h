@@ -0,0 +1,186 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file vector.h
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#ifndef __MYUTIL_VECTOR_H__
+#define __MYUTIL_VECTOR_H__
+
+#include "types.h"
+#include "macros.h"
+#include "allocator.h"
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Vector interface
+ * ------------------------------------------------------------------------ */
+
+#define VECTOR_INLINE_BYTES 64  /**< bytes of inline small buffer */
+
+/** count of inline elements of a type, at least 1. */
+#define VECTOR_INLINE_COUNT(type) \
+    (sizeof(type) >= VECTOR_INLINE_BYTES ? 1 : VECTOR_INLINE_BYTES / sizeof(type))
+
+/**
+ * Grow vector storage to hold at least need elements, used by VECTOR_DEFINE.
+ * 
+ * Capacity is doubled until enough, elements are moved to the new block
+ * and the old heap block is freed.
+ * 
+ * @param allocator: the allocator of heap block.
+ * @param heap: the pointer to heap block, NULL for inline storage.
+ * @param small: the inline storage.
+ * @param capacity: the pointer to element capacity.
+ * @param count: the count of elements to move.
+ * @param need: the min capacity.
+ * @param size: the element size.
+ * @return true if success, false if allocation failed and nothing changed.
+ */
+bool Vector_grow(AllocatorRef allocator, void **heap, void *small, size_t *capacity,
+    size_t count, size_t need, size_t size);
+
+/**
+ * Define a typed vector class.
+ * 
+ * Elements are kept in an inline buffer of VECTOR_INLINE_BYTES first, so
+ * a few elements need no allocation, then in a heap block from allocator
+ * growing geometrically. The object does not point into itself, it could
+ * be moved by copy.
+ * 
+ * e.g.
+ * ```
+ * VECTOR_DEFINE(IntVector, int)
+ * 
+ * IntVector v;
+ * IntVector_init(&v, allocator);
+ * IntVector_push(&v, 1);
+ * int x = *IntVector_at(&v, 0);
+ * IntVector_destroy(&v);
+ * ```
+ * 
+ * It defines type `name` and `nameRef`, and functions below:
+ *  - `void name_init(nameRef self, AllocatorRef allocator)`
+ *  - `void name_destroy(nameRef self)`
+ *  - `size_t name_count(nameRef self)`
+ *  - `size_t name_capacity(nameRef self)`
+ *  - `type *name_data(nameRef self)`
+ *  - `type *name_at(nameRef self, size_t i)`
+ *  - `bool name_reserve(nameRef self, size_t capacity)`
+ *  - `bool name_push(nameRef self, type value)`
+ *  - `bool name_pop(nameRef self, type *value)`
+ *  - `bool name_append(nameRef self, type const *values, size_t n)`
+ *  - `void name_clear(nameRef self)`
+ * 
+ * @param name: the vector class name.
+ * @param type: the element type.
+ */
+#define VECTOR_DEFINE(name, type) \
+    typedef struct CAT(_, name) \
+    { \
+        type *heap;                             /**< heap block, NULL for inline */ \
+        size_t count;                           /**< element count */ \
+        size_t capacity;                        /**< element capacity */ \
+        AllocatorRef allocator;                 /**< allocator of heap block */ \
+        type small[VECTOR_INLINE_COUNT(type)];  /**< inline storage */ \
+    } name, *CAT(name, Ref); \
+    \
+    static inline void CAT(name, _init)(CAT(name, Ref) self, AllocatorRef allocator) \
+    { \
+        self->heap = NULL; \
+        self->count = 0; \
+        self->capacity = VECTOR_INLINE_COUNT(type); \
+        self->allocator = allocator; \
+    }; \
+    \
+    static inline void CAT(name, _destroy)(CAT(name, Ref) self) \
+    { \
+        if (self->heap != NULL) \
+            Allocator_free(self->allocator, self->heap); \
+        CAT(name, _init)(self, self->allocator); \
+    }; \
+    \
+    static inline size_t CAT(name, _count)(CAT(name, Ref) self) \
+    { \
+        return self->count; \
+    }; \
+    \
+    static inline size_t CAT(name, _capacity)(CAT(name, Ref) self) \
+    { \
+        return self->capacity; \
+    }; \
+    \
+    static inline type *CAT(name, _data)(CAT(name, Ref) self) \
+    { \
+        return self->heap != NULL ? self->heap : self->small; \
+    }; \
+    \
+    static inline type *CAT(name, _at)(CAT(name, Ref) self, size_t i) \
+    { \
+        return CAT(name, _data)(self) + i; \
+    }; \
+    \
+    static inline bool CAT(name, _reserve)(CAT(name, Ref) self, size_t capacity) \
+    { \
+        return capacity <= self->capacity || Vector_grow(self->allocator, (void **)&self->heap, \
+            self->small, &self->capacity, self->count, capacity, sizeof(type)); \
+    }; \
+    \
+    static inline bool CAT(name, _push)(CAT(name, Ref) self, type value) \
+    { \
+        if (self->count == self->capacity && !CAT(name, _reserve)(self, self->count + 1)) \
+            return false; \
+        CAT(name, _data)(self)[self->count++] = value; \
+        return true; \
+    }; \
+    \
+    static inline bool CAT(name, _pop)(CAT(name, Ref) self, type *value) \
+    { \
+        if (self->count == 0) \
+            return false; \
+        self->count--; \
+        if (value != NULL) \
+            *value = CAT(name, _data)(self)[self->count]; \
+        return true; \
+    }; \
+    \
+    static inline bool CAT(name, _append)(CAT(name, Ref) self, type const *values, size_t n) \
+    { \
+        if (!CAT(name, _reserve)(self, self->count + n)) \
+            return false; \
+        memcpy(CAT(name, _data)(self) + self->count, values, sizeof(type) * n); \
+        self->count += n; \
+        return true; \
+    }; \
+    \
+    static inline void CAT(name, _clear)(CAT(name, Ref) self) \
+    { \
+        self->count = 0; \
+    };
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __MYUTIL_VECTOR_H__ */
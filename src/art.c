@@ -0,0 +1,890 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file art.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  ArtNode implements
+ * ------------------------------------------------------------------------ */
+
+#define ART_NODE4   0
+#define ART_NODE16  1
+#define ART_NODE48  2
+#define ART_NODE256 3
+
+/** header of inner nodes */
+typedef struct _ArtNode
+{
+    uint8_t type;                           /**< node type */
+    uint16_t count;                         /**< child count */
+    uint32_t prefixLen;                     /**< compressed path length */
+    uint8_t prefix[ART_MAX_PREFIX_LEN];     /**< first bytes of path */
+} ArtNode;
+
+typedef struct _ArtNode4
+{
+    ArtNode super;
+    uint8_t keys[4];                        /**< sorted key bytes */
+    void *children[4];
+} ArtNode4;
+
+typedef struct _ArtNode16
+{
+    ArtNode super;
+    uint8_t keys[16];                       /**< sorted key bytes */
+    void *children[16];
+} ArtNode16;
+
+typedef struct _ArtNode48
+{
+    ArtNode super;
+    uint8_t index[256];                     /**< slot + 1 of key byte, 0 for none */
+    void *children[48];
+} ArtNode48;
+
+typedef struct _ArtNode256
+{
+    ArtNode super;
+    void *children[256];
+} ArtNode256;
+
+/* leaves are tagged by the lowest pointer bit */
+#define __MYUTIL_ART_IS_LEAF(p)  (((uintptr_t)(p) & 1) != 0)
+#define __MYUTIL_ART_LEAF(p)     ((ArtLeafRef)((uintptr_t)(p) & ~(uintptr_t)1))
+#define __MYUTIL_ART_TAG(leaf)   ((void *)((uintptr_t)(leaf) | 1))
+
+static size_t const __myutil_art_nodeSize[] = {
+    sizeof(ArtNode4), sizeof(ArtNode16), sizeof(ArtNode48), sizeof(ArtNode256),
+};
+
+static ArtNode *__myutil_art_newNode(AllocatorRef allocator, uint8_t type)
+{
+    ArtNode *node = (ArtNode *)Allocator_alloc(allocator, __myutil_art_nodeSize[type]);
+    if (node == NULL)
+        return NULL;
+
+    memset(node, 0, __myutil_art_nodeSize[type]);
+    node->type = type;
+    return node;
+}
+
+static void __myutil_art_copyHeader(ArtNode *to, ArtNode *from)
+{
+    to->count = from->count;
+    to->prefixLen = from->prefixLen;
+    memcpy(to->prefix, from->prefix, MIN(from->prefixLen, ART_MAX_PREFIX_LEN));
+}
+
+static bool __myutil_art_leafMatch(ArtLeafRef leaf, uint8_t const *key, size_t keyLen)
+{
+    return leaf->keyLen == keyLen && memcmp(leaf->key, key, keyLen) == 0;
+}
+
+/* find the position of key byte in node 16, or count if none. */
+static int __myutil_art_find16(ArtNode16 *node, uint8_t c)
+{
+#if defined(__SSE2__)
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((__m128i const *)node->keys));
+    int bits = _mm_movemask_epi8(cmp) & ((1 << node->super.count) - 1);
+    return bits != 0 ? __builtin_ctz(bits) : node->super.count;
+#else
+    int i;
+    for (i = 0; i < node->super.count && node->keys[i] != c; i++);
+    return i;
+#endif
+}
+
+/* find the first position whose key byte is greater than c in node 16. */
+static int __myutil_art_upper16(ArtNode16 *node, uint8_t c)
+{
+#if defined(__SSE2__)
+    /* bytes are signed in sse2, flip the sign bit to compare unsigned */
+    __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i keys = _mm_xor_si128(_mm_loadu_si128((__m128i const *)node->keys), bias);
+    __m128i cmp = _mm_cmpgt_epi8(keys, _mm_xor_si128(_mm_set1_epi8((char)c), bias));
+    int bits = _mm_movemask_epi8(cmp) & ((1 << node->super.count) - 1);
+    return bits != 0 ? __builtin_ctz(bits) : node->super.count;
+#else
+    int i;
+    for (i = 0; i < node->super.count && node->keys[i] <= c; i++);
+    return i;
+#endif
+}
+
+/* get the pointer to child slot of key byte, or NULL. */
+static void **__myutil_art_findChild(ArtNode *node, uint8_t c)
+{
+    int i;
+
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ArtNode4 *n = (ArtNode4 *)node;
+        for (i = 0; i < node->count; i++)
+        {
+            if (n->keys[i] == c)
+                return &n->children[i];
+        }
+        return NULL;
+    }
+    case ART_NODE16:
+    {
+        ArtNode16 *n = (ArtNode16 *)node;
+        i = __myutil_art_find16(n, c);
+        return i < node->count ? &n->children[i] : NULL;
+    }
+    case ART_NODE48:
+    {
+        ArtNode48 *n = (ArtNode48 *)node;
+        return n->index[c] != 0 ? &n->children[n->index[c] - 1] : NULL;
+    }
+    default:
+    {
+        ArtNode256 *n = (ArtNode256 *)node;
+        return n->children[c] != NULL ? &n->children[c] : NULL;
+    }
+    }
+}
+
+/* get the child at or after pos, move pos after it. */
+static void *__myutil_art_childFrom(ArtNode *node, size_t *pos)
+{
+    switch (node->type)
+    {
+    case ART_NODE4:
+        return *pos < node->count ? ((ArtNode4 *)node)->children[(*pos)++] : NULL;
+    case ART_NODE16:
+        return *pos < node->count ? ((ArtNode16 *)node)->children[(*pos)++] : NULL;
+    case ART_NODE48:
+    {
+        ArtNode48 *n = (ArtNode48 *)node;
+        for (; *pos < 256; (*pos)++)
+        {
+            if (n->index[*pos] != 0)
+                return n->children[n->index[(*pos)++] - 1];
+        }
+        return NULL;
+    }
+    default:
+    {
+        ArtNode256 *n = (ArtNode256 *)node;
+        for (; *pos < 256; (*pos)++)
+        {
+            if (n->children[*pos] != NULL)
+                return n->children[(*pos)++];
+        }
+        return NULL;
+    }
+    }
+}
+
+/* get the child of key byte c, set pos after c for iteration. */
+static void *__myutil_art_seekChild(ArtNode *node, uint8_t c, size_t *pos)
+{
+    size_t i;
+
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ArtNode4 *n = (ArtNode4 *)node;
+        for (i = 0; i < node->count && n->keys[i] < c; i++);
+        *pos = i < node->count && n->keys[i] == c ? i + 1 : i;
+        return *pos > i ? n->children[i] : NULL;
+    }
+    case ART_NODE16:
+    {
+        ArtNode16 *n = (ArtNode16 *)node;
+        *pos = __myutil_art_upper16(n, c);
+        return *pos > 0 && n->keys[*pos - 1] == c ? n->children[*pos - 1] : NULL;
+    }
+    default:
+    {
+        void **slot = __myutil_art_findChild(node, c);
+        *pos = (size_t)c + 1;
+        return slot == NULL ? NULL : *slot;
+    }
+    }
+}
+
+static ArtLeafRef __myutil_art_minimum(void *node)
+{
+    while (node != NULL && !__MYUTIL_ART_IS_LEAF(node))
+    {
+        size_t pos = 0;
+        node = __myutil_art_childFrom((ArtNode *)node, &pos);
+    }
+    return node == NULL ? NULL : __MYUTIL_ART_LEAF(node);
+}
+
+/* count of matched prefix bytes, beyond stored bytes by the minimum leaf. */
+static size_t __myutil_art_prefixMismatch(ArtNode *node, uint8_t const *key, size_t keyLen, size_t depth)
+{
+    size_t max = MIN(node->prefixLen, keyLen - depth);
+    size_t i, stored = MIN(max, ART_MAX_PREFIX_LEN);
+    ArtLeafRef leaf;
+
+    for (i = 0; i < stored; i++)
+    {
+        if (node->prefix[i] != key[depth + i])
+            return i;
+    }
+    if (i == max)
+        return i;
+
+    leaf = __myutil_art_minimum(node);
+    for (; i < max; i++)
+    {
+        if (leaf->key[depth + i] != key[depth + i])
+            return i;
+    }
+    return i;
+}
+
+static void __myutil_art_add4(ArtNode4 *node, uint8_t c, void *child)
+{
+    int i;
+
+    for (i = 0; i < node->super.count && node->keys[i] < c; i++);
+    memmove(node->keys + i + 1, node->keys + i, node->super.count - i);
+    memmove(node->children + i + 1, node->children + i, sizeof(void *) * (node->super.count - i));
+    node->keys[i] = c;
+    node->children[i] = child;
+    node->super.count++;
+}
+
+/* add a child, grow node into the next type if full. */
+static bool __myutil_art_addChild(AllocatorRef allocator, void **ref, ArtNode *node, uint8_t c, void *child)
+{
+    int i;
+
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ArtNode4 *n = (ArtNode4 *)node;
+        if (node->count < 4)
+        {
+            __myutil_art_add4(n, c, child);
+            return true;
+        }
+
+        ArtNode16 *grown = (ArtNode16 *)__myutil_art_newNode(allocator, ART_NODE16);
+        if (grown == NULL)
+            return false;
+        __myutil_art_copyHeader(&grown->super, node);
+        memcpy(grown->keys, n->keys, 4);
+        memcpy(grown->children, n->children, sizeof(void *) * 4);
+        *ref = grown;
+        Allocator_free(allocator, node);
+        node = &grown->super;
+    }
+    /* fall through */
+    case ART_NODE16:
+    {
+        ArtNode16 *n = (ArtNode16 *)node;
+        if (node->count < 16)
+        {
+            i = __myutil_art_upper16(n, c);
+            memmove(n->keys + i + 1, n->keys + i, node->count - i);
+            memmove(n->children + i + 1, n->children + i, sizeof(void *) * (node->count - i));
+            n->keys[i] = c;
+            n->children[i] = child;
+            node->count++;
+            return true;
+        }
+
+        ArtNode48 *grown = (ArtNode48 *)__myutil_art_newNode(allocator, ART_NODE48);
+        if (grown == NULL)
+            return false;
+        __myutil_art_copyHeader(&grown->super, node);
+        memcpy(grown->children, n->children, sizeof(void *) * 16);
+        for (i = 0; i < 16; i++)
+            grown->index[n->keys[i]] = (uint8_t)(i + 1);
+        *ref = grown;
+        Allocator_free(allocator, node);
+        node = &grown->super;
+    }
+    /* fall through */
+    case ART_NODE48:
+    {
+        ArtNode48 *n = (ArtNode48 *)node;
+        if (node->count < 48)
+        {
+            /* slots are compact, removal moves the last one */
+            n->children[node->count] = child;
+            n->index[c] = (uint8_t)(node->count + 1);
+            node->count++;
+            return true;
+        }
+
+        ArtNode256 *grown = (ArtNode256 *)__myutil_art_newNode(allocator, ART_NODE256);
+        if (grown == NULL)
+            return false;
+        __myutil_art_copyHeader(&grown->super, node);
+        for (i = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+                grown->children[i] = n->children[n->index[i] - 1];
+        }
+        *ref = grown;
+        Allocator_free(allocator, node);
+        node = &grown->super;
+    }
+    /* fall through */
+    default:
+        ((ArtNode256 *)node)->children[c] = child;
+        node->count++;
+        return true;
+    }
+}
+
+/* replace a node of single child by the child, join the paths. */
+static void __myutil_art_collapse(AllocatorRef allocator, void **ref, ArtNode *node)
+{
+    size_t pos = 0;
+    void *child = __myutil_art_childFrom(node, &pos);
+
+    if (!__MYUTIL_ART_IS_LEAF(child))
+    {
+        ArtNode *inner = (ArtNode *)child;
+        uint8_t prefix[ART_MAX_PREFIX_LEN];
+        size_t len = MIN(node->prefixLen, ART_MAX_PREFIX_LEN);
+
+        /* key byte of child, pos is after it */
+        if (node->type == ART_NODE4 || node->type == ART_NODE16)
+            pos = node->type == ART_NODE4 ? ((ArtNode4 *)node)->keys[0] : ((ArtNode16 *)node)->keys[0];
+        else
+            pos--;
+
+        memcpy(prefix, node->prefix, len);
+        if (len < ART_MAX_PREFIX_LEN)
+            prefix[len++] = (uint8_t)pos;
+        memcpy(prefix + len, inner->prefix, MIN(inner->prefixLen, ART_MAX_PREFIX_LEN - len));
+        memcpy(inner->prefix, prefix, ART_MAX_PREFIX_LEN);
+        inner->prefixLen += node->prefixLen + 1;
+    }
+    *ref = child;
+    Allocator_free(allocator, node);
+}
+
+/* remove a child, shrink node into the previous type if sparse. */
+static void __myutil_art_removeChild(AllocatorRef allocator, void **ref, ArtNode *node, uint8_t c, void **slot)
+{
+    int i, j;
+
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ArtNode4 *n = (ArtNode4 *)node;
+        i = (int)(slot - n->children);
+        memmove(n->keys + i, n->keys + i + 1, node->count - i - 1);
+        memmove(n->children + i, n->children + i + 1, sizeof(void *) * (node->count - i - 1));
+        node->count--;
+        if (node->count == 1)
+            __myutil_art_collapse(allocator, ref, node);
+        return;
+    }
+    case ART_NODE16:
+    {
+        ArtNode16 *n = (ArtNode16 *)node;
+        i = (int)(slot - n->children);
+        memmove(n->keys + i, n->keys + i + 1, node->count - i - 1);
+        memmove(n->children + i, n->children + i + 1, sizeof(void *) * (node->count - i - 1));
+        node->count--;
+        if (node->count > 3)
+            return;
+
+        ArtNode4 *shrunk = (ArtNode4 *)__myutil_art_newNode(allocator, ART_NODE4);
+        if (shrunk == NULL)
+        {
+            /* keep the sparse node, but never with a single child */
+            if (node->count == 1)
+                __myutil_art_collapse(allocator, ref, node);
+            return;
+        }
+        __myutil_art_copyHeader(&shrunk->super, node);
+        memcpy(shrunk->keys, n->keys, node->count);
+        memcpy(shrunk->children, n->children, sizeof(void *) * node->count);
+        *ref = shrunk;
+        Allocator_free(allocator, node);
+        return;
+    }
+    case ART_NODE48:
+    {
+        ArtNode48 *n = (ArtNode48 *)node;
+        int last = node->count - 1;
+
+        /* move the last slot into the hole */
+        i = n->index[c] - 1;
+        n->index[c] = 0;
+        if (i != last)
+        {
+            for (j = 0; n->index[j] != last + 1; j++);
+            n->children[i] = n->children[last];
+            n->index[j] = (uint8_t)(i + 1);
+        }
+        n->children[last] = NULL;
+        node->count--;
+        if (node->count > 12)
+            return;
+
+        ArtNode16 *shrunk = (ArtNode16 *)__myutil_art_newNode(allocator, ART_NODE16);
+        if (shrunk == NULL)
+        {
+            if (node->count == 1)
+                __myutil_art_collapse(allocator, ref, node);
+            return;
+        }
+        __myutil_art_copyHeader(&shrunk->super, node);
+        for (i = 0, j = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+            {
+                shrunk->keys[j] = (uint8_t)i;
+                shrunk->children[j++] = n->children[n->index[i] - 1];
+            }
+        }
+        *ref = shrunk;
+        Allocator_free(allocator, node);
+        return;
+    }
+    default:
+    {
+        ArtNode256 *n = (ArtNode256 *)node;
+        n->children[c] = NULL;
+        node->count--;
+        if (node->count > 37)
+            return;
+
+        ArtNode48 *shrunk = (ArtNode48 *)__myutil_art_newNode(allocator, ART_NODE48);
+        if (shrunk == NULL)
+        {
+            if (node->count == 1)
+                __myutil_art_collapse(allocator, ref, node);
+            return;
+        }
+        __myutil_art_copyHeader(&shrunk->super, node);
+        for (i = 0, j = 0; i < 256; i++)
+        {
+            if (n->children[i] != NULL)
+            {
+                shrunk->children[j] = n->children[i];
+                shrunk->index[i] = (uint8_t)++j;
+            }
+        }
+        *ref = shrunk;
+        Allocator_free(allocator, node);
+        return;
+    }
+    }
+}
+
+static void __myutil_art_destroy(AllocatorRef allocator, void *node)
+{
+    size_t pos = 0;
+    void *child;
+
+    if (node == NULL || __MYUTIL_ART_IS_LEAF(node))
+        return;
+
+    while ((child = __myutil_art_childFrom((ArtNode *)node, &pos)) != NULL)
+        __myutil_art_destroy(allocator, child);
+    Allocator_free(allocator, node);
+}
+
+/* ---------------------------------------------------------------------------
+ *  ArtTree implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Release all inner nodes, leaves are left to user.
+ * 
+ * @param self: the ArtTree object.
+ */
+void ArtTree_destroy(ArtTreeRef self)
+{
+    __myutil_art_destroy(self->allocator, self->root);
+    self->root = NULL;
+    self->count = 0;
+}
+
+/* inserted is set only when leaf is linked into the tree. */
+static ArtLeafRef __myutil_art_insert(AllocatorRef allocator, void **ref, ArtLeafRef leaf, size_t depth, bool *inserted)
+{
+    uint8_t const *key = leaf->key;
+    void *node = *ref;
+
+    if (node == NULL)
+    {
+        *ref = __MYUTIL_ART_TAG(leaf);
+        *inserted = true;
+        return leaf;
+    }
+
+    if (__MYUTIL_ART_IS_LEAF(node))
+    {
+        ArtLeafRef other = __MYUTIL_ART_LEAF(node);
+        size_t max = MIN(other->keyLen, leaf->keyLen), lcp;
+
+        if (__myutil_art_leafMatch(other, key, leaf->keyLen))
+            return other;
+
+        /* split into a node 4 on the first different byte */
+        for (lcp = depth; lcp < max && other->key[lcp] == key[lcp]; lcp++);
+        if (lcp == max)
+            return NULL;
+
+        ArtNode4 *split = (ArtNode4 *)__myutil_art_newNode(allocator, ART_NODE4);
+        if (split == NULL)
+            return NULL;
+        split->super.prefixLen = (uint32_t)(lcp - depth);
+        memcpy(split->super.prefix, key + depth, MIN(lcp - depth, ART_MAX_PREFIX_LEN));
+        __myutil_art_add4(split, other->key[lcp], node);
+        __myutil_art_add4(split, key[lcp], __MYUTIL_ART_TAG(leaf));
+        *ref = split;
+        *inserted = true;
+        return leaf;
+    }
+
+    ArtNode *inner = (ArtNode *)node;
+    if (inner->prefixLen != 0)
+    {
+        size_t diff = __myutil_art_prefixMismatch(inner, key, leaf->keyLen, depth);
+        if (diff < inner->prefixLen)
+        {
+            if (depth + diff >= leaf->keyLen)
+                return NULL;
+
+            /* split the prefix by a new parent */
+            ArtNode4 *split = (ArtNode4 *)__myutil_art_newNode(allocator, ART_NODE4);
+            if (split == NULL)
+                return NULL;
+            split->super.prefixLen = (uint32_t)diff;
+            memcpy(split->super.prefix, inner->prefix, MIN(diff, ART_MAX_PREFIX_LEN));
+
+            if (inner->prefixLen <= ART_MAX_PREFIX_LEN)
+            {
+                __myutil_art_add4(split, inner->prefix[diff], inner);
+                inner->prefixLen -= diff + 1;
+                memmove(inner->prefix, inner->prefix + diff + 1, inner->prefixLen);
+            }
+            else
+            {
+                ArtLeafRef min = __myutil_art_minimum(inner);
+                __myutil_art_add4(split, min->key[depth + diff], inner);
+                inner->prefixLen -= diff + 1;
+                memcpy(inner->prefix, min->key + depth + diff + 1, MIN(inner->prefixLen, ART_MAX_PREFIX_LEN));
+            }
+            __myutil_art_add4(split, key[depth + diff], __MYUTIL_ART_TAG(leaf));
+            *ref = split;
+            *inserted = true;
+            return leaf;
+        }
+        depth += inner->prefixLen;
+    }
+
+    if (depth >= leaf->keyLen)
+        return NULL;
+
+    void **child = __myutil_art_findChild(inner, key[depth]);
+    if (child != NULL)
+        return __myutil_art_insert(allocator, child, leaf, depth + 1, inserted);
+    if (!__myutil_art_addChild(allocator, ref, inner, key[depth], __MYUTIL_ART_TAG(leaf)))
+        return NULL;
+    *inserted = true;
+    return leaf;
+}
+
+/**
+ * Insert a leaf if its key is absent.
+ * 
+ * The count grows only when leaf is linked, re-inserting a leaf already
+ * in the tree returns it and changes nothing.
+ * 
+ * @param self: the ArtTree object.
+ * @param leaf: the leaf to insert.
+ * @return leaf if inserted, the existing leaf of same key, or NULL if
+ *      allocation failed, the key is too long, or it is a prefix of
+ *      another key or the reverse.
+ */
+ArtLeafRef ArtTree_insert(ArtTreeRef self, ArtLeafRef leaf)
+{
+    ArtLeafRef result;
+    bool inserted = false;
+
+    if (leaf->keyLen == 0 || leaf->keyLen > ART_MAX_KEY_LEN)
+        return NULL;
+
+    result = __myutil_art_insert(self->allocator, &self->root, leaf, 0, &inserted);
+    if (inserted)
+        self->count++;
+    return result;
+}
+
+/**
+ * Remove the leaf of a key.
+ * 
+ * @param self: the ArtTree object.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ * @return the removed leaf, or NULL if not found.
+ */
+ArtLeafRef ArtTree_remove(ArtTreeRef self, void const *key, size_t keyLen)
+{
+    uint8_t const *bytes = (uint8_t const *)key;
+    void **ref = &self->root;
+    size_t depth = 0;
+    ArtLeafRef leaf;
+
+    if (*ref == NULL)
+        return NULL;
+
+    if (__MYUTIL_ART_IS_LEAF(*ref))
+    {
+        leaf = __MYUTIL_ART_LEAF(*ref);
+        if (!__myutil_art_leafMatch(leaf, bytes, keyLen))
+            return NULL;
+        *ref = NULL;
+        self->count--;
+        return leaf;
+    }
+
+    while (true)
+    {
+        ArtNode *node = (ArtNode *)*ref;
+        void **child;
+
+        if (node->prefixLen != 0)
+        {
+            if (__myutil_art_prefixMismatch(node, bytes, keyLen, depth) != node->prefixLen)
+                return NULL;
+            depth += node->prefixLen;
+        }
+        if (depth >= keyLen)
+            return NULL;
+
+        child = __myutil_art_findChild(node, bytes[depth]);
+        if (child == NULL)
+            return NULL;
+
+        if (__MYUTIL_ART_IS_LEAF(*child))
+        {
+            leaf = __MYUTIL_ART_LEAF(*child);
+            if (!__myutil_art_leafMatch(leaf, bytes, keyLen))
+                return NULL;
+            __myutil_art_removeChild(self->allocator, ref, node, bytes[depth], child);
+            self->count--;
+            return leaf;
+        }
+
+        ref = child;
+        depth++;
+    }
+}
+
+/**
+ * Find the leaf of a key.
+ * 
+ * @param self: the ArtTree object.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ * @return the leaf, or NULL if not found.
+ */
+ArtLeafRef ArtTree_find(ArtTreeRef self, void const *key, size_t keyLen)
+{
+    uint8_t const *bytes = (uint8_t const *)key;
+    void *node = self->root;
+    size_t depth = 0;
+
+    while (node != NULL)
+    {
+        if (__MYUTIL_ART_IS_LEAF(node))
+        {
+            ArtLeafRef leaf = __MYUTIL_ART_LEAF(node);
+            return __myutil_art_leafMatch(leaf, bytes, keyLen) ? leaf : NULL;
+        }
+
+        /* only stored prefix bytes are checked, the leaf check covers the rest */
+        ArtNode *inner = (ArtNode *)node;
+        if (inner->prefixLen != 0)
+        {
+            size_t i, stored = MIN(inner->prefixLen, ART_MAX_PREFIX_LEN);
+            if (depth + inner->prefixLen >= keyLen)
+                return NULL;
+            for (i = 0; i < stored; i++)
+            {
+                if (inner->prefix[i] != bytes[depth + i])
+                    return NULL;
+            }
+            depth += inner->prefixLen;
+        }
+        if (depth >= keyLen)
+            return NULL;
+
+        void **child = __myutil_art_findChild(inner, bytes[depth]);
+        node = child == NULL ? NULL : *child;
+        depth++;
+    }
+    return NULL;
+}
+
+/**
+ * Get the leaf of the smallest key.
+ * 
+ * @param self: the ArtTree object.
+ * @return the first leaf, or NULL if empty.
+ */
+ArtLeafRef ArtTree_first(ArtTreeRef self)
+{
+    return __myutil_art_minimum(self->root);
+}
+
+/* ---------------------------------------------------------------------------
+ *  ArtIter implements
+ * ------------------------------------------------------------------------ */
+
+static void __myutil_art_push(ArtIterRef self, ArtNode *node, size_t pos)
+{
+    self->stack[self->depth].node = node;
+    self->stack[self->depth].pos = pos;
+    self->depth++;
+}
+
+/**
+ * Init iterator before the first leaf.
+ * 
+ * @param self: the ArtIter object to be init.
+ * @param tree: the ArtTree to travel.
+ */
+void ArtIter_init(ArtIterRef self, ArtTreeRef tree)
+{
+    self->depth = 0;
+    self->current = self->pending = NULL;
+
+    if (tree->root == NULL)
+        return;
+    if (__MYUTIL_ART_IS_LEAF(tree->root))
+        self->pending = __MYUTIL_ART_LEAF(tree->root);
+    else
+        __myutil_art_push(self, (ArtNode *)tree->root, 0);
+}
+
+/**
+ * Init iterator before the first leaf whose key is not less than key.
+ * 
+ * @param self: the ArtIter object to be init.
+ * @param tree: the ArtTree to travel.
+ * @param key: the key bytes.
+ * @param keyLen: the key length.
+ */
+void ArtIter_seek(ArtIterRef self, ArtTreeRef tree, void const *key, size_t keyLen)
+{
+    uint8_t const *bytes = (uint8_t const *)key;
+    void *node = tree->root;
+    size_t depth = 0, i, pos;
+
+    self->depth = 0;
+    self->current = self->pending = NULL;
+
+    while (node != NULL)
+    {
+        if (__MYUTIL_ART_IS_LEAF(node))
+        {
+            ArtLeafRef leaf = __MYUTIL_ART_LEAF(node);
+            int cmp = memcmp(leaf->key, bytes, MIN(leaf->keyLen, keyLen));
+            if (cmp > 0 || (cmp == 0 && leaf->keyLen >= keyLen))
+                self->pending = leaf;
+            return;
+        }
+
+        /* full prefix is in every leaf below */
+        ArtNode *inner = (ArtNode *)node;
+        if (inner->prefixLen != 0)
+        {
+            ArtLeafRef min = __myutil_art_minimum(inner);
+            for (i = 0; i < inner->prefixLen; i++)
+            {
+                if (depth + i >= keyLen || min->key[depth + i] > bytes[depth + i])
+                {
+                    __myutil_art_push(self, inner, 0);
+                    return;
+                }
+                if (min->key[depth + i] < bytes[depth + i])
+                    return;
+            }
+            depth += inner->prefixLen;
+        }
+        if (depth >= keyLen)
+        {
+            __myutil_art_push(self, inner, 0);
+            return;
+        }
+
+        node = __myutil_art_seekChild(inner, bytes[depth], &pos);
+        __myutil_art_push(self, inner, pos);
+        depth++;
+    }
+}
+
+/**
+ * Move iterator to next leaf in key order.
+ * 
+ * @param self: the ArtIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool ArtIter_next(ArtIterRef self)
+{
+    if (self->pending != NULL)
+    {
+        self->current = self->pending;
+        self->pending = NULL;
+        return true;
+    }
+
+    while (self->depth > 0)
+    {
+        ArtNode *node = self->stack[self->depth - 1].node;
+        void *child = __myutil_art_childFrom(node, &self->stack[self->depth - 1].pos);
+
+        if (child == NULL)
+            self->depth--;
+        else if (__MYUTIL_ART_IS_LEAF(child))
+        {
+            self->current = __MYUTIL_ART_LEAF(child);
+            return true;
+        }
+        else
+            __myutil_art_push(self, (ArtNode *)child, 0);
+    }
+
+    self->current = NULL;
+    return false;
+}
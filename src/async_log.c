@@ -0,0 +1,384 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file async_log.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  AsyncLog implements
+ * ------------------------------------------------------------------------ */
+
+/** a ring slot, holding one formatted message */
+typedef struct _AsyncLogSlot
+{
+    size_t seq;                 /**< index + 1 when ready, index + capacity when free */
+    uint32_t length;            /**< bytes of text */
+    char text[ASYNC_LOG_SLOT_SIZE - sizeof(size_t) - sizeof(uint32_t)];
+} AsyncLogSlot;
+
+/** private part of AsyncLog */
+typedef struct _AsyncLogCore
+{
+    /* read only after init */
+    void *memory;               /**< allocated block, core is aligned in it */
+    AsyncLogSlot *slots;        /**< slot array */
+    size_t mask;                /**< slot count - 1 */
+    char *batch;                /**< batch buffer of flusher */
+    AsyncLogSink sink;          /**< sink of messages */
+    void *arg;                  /**< argument of sink */
+    pthread_t thread;           /**< flusher thread */
+
+    /* shared by producers and flusher */
+    bool stop;                  /**< flusher quits on empty ring */
+    uint32_t wake;              /**< futex word, bumped to wake parked flusher */
+    uint32_t parked;            /**< flusher is parked */
+    uint32_t done;              /**< futex word, bumped after a batch is written */
+    uint32_t waiters;           /**< count of parked flush callers */
+
+    /* written by producers */
+    CACHE_ALIGNED size_t head;  /**< next index to claim */
+    size_t dropped;             /**< count of dropped messages */
+
+    /* written by flusher */
+    CACHE_ALIGNED size_t tail;  /**< next index to read */
+    size_t written;             /**< count of messages passed to sink */
+} AsyncLogCore;
+
+static AsyncLogRef __myutil_async_log_default = NULL;
+
+/* park on a futex word while it equals value, may return spuriously. */
+static void __myutil_async_log_futexWait(uint32_t *word, uint32_t value)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    if (__atomic_load_n(word, __ATOMIC_ACQUIRE) == value)
+        sched_yield();
+#endif
+}
+
+/* bump a futex word and wake up to count threads parked on it. */
+static void __myutil_async_log_futexWake(uint32_t *word, int count)
+{
+    __atomic_fetch_add(word, 1, __ATOMIC_SEQ_CST);
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#endif
+}
+
+static void __myutil_async_log_stdout(void const *data, size_t len, void *arg)
+{
+    (void)arg;
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+}
+
+/* copy ready slots out and write them by one sink call, return the count. */
+static size_t __myutil_async_log_drain(AsyncLogCore *core)
+{
+    size_t tail = core->tail, len = 0, n;
+
+    for (n = 0; n < ASYNC_LOG_BATCH; n++, tail++)
+    {
+        AsyncLogSlot *slot = &core->slots[tail & core->mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != tail + 1)
+            break;
+
+        memcpy(core->batch + len, slot->text, slot->length);
+        len += slot->length;
+        __atomic_store_n(&slot->seq, tail + core->mask + 1, __ATOMIC_RELEASE);
+    }
+    if (n == 0)
+        return 0;
+
+    core->tail = tail;
+    core->sink(core->batch, len, core->arg);
+
+    __atomic_store_n(&core->written, tail, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&core->waiters, __ATOMIC_SEQ_CST) != 0)
+        __myutil_async_log_futexWake(&core->done, INT_MAX);
+    return n;
+}
+
+static void *__myutil_async_log_flusher(void *arg)
+{
+    AsyncLogCore *core = (AsyncLogCore *)arg;
+
+    while (true)
+    {
+        /* load stop first, messages queued before stop are drained after. */
+        bool stop = __atomic_load_n(&core->stop, __ATOMIC_SEQ_CST);
+        if (__myutil_async_log_drain(core) > 0)
+            continue;
+        if (stop)
+            break;
+
+        /* announce parking before the last check, producers check parked
+         * after publishing, so one side always sees the other. */
+        uint32_t wake = __atomic_load_n(&core->wake, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&core->parked, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&core->slots[core->tail & core->mask].seq, __ATOMIC_SEQ_CST) != core->tail + 1 &&
+            !__atomic_load_n(&core->stop, __ATOMIC_SEQ_CST))
+            __myutil_async_log_futexWait(&core->wake, wake);
+        __atomic_store_n(&core->parked, 0, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+/**
+ * Init log and start the flusher thread.
+ * 
+ * @param self: the AsyncLog object to be init.
+ * @param allocator: the allocator of ring.
+ * @param capacity: the min count of queued messages, rounded up to power of 2.
+ * @param policy: ASYNC_LOG_DROP or ASYNC_LOG_BLOCK.
+ * @param sink: the sink of messages, or NULL for stdout.
+ * @param arg: the argument of sink.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool AsyncLog_init(AsyncLogRef self, AllocatorRef allocator, size_t capacity, int policy,
+    AsyncLogSink sink, void *arg)
+{
+    AsyncLogCore *core;
+    size_t slots = 2, i;
+    void *memory;
+
+    while (slots < capacity)
+        slots <<= 1;
+
+    self->allocator = allocator;
+    self->capacity = slots;
+    self->policy = policy;
+    self->core = NULL;
+
+    /* allocator memory is not cache aligned, align core and slots in it. */
+    memory = Allocator_alloc(allocator, CACHE_LINE_SIZE + ALIGN(sizeof(AsyncLogCore), CACHE_LINE_SIZE) +
+        sizeof(AsyncLogSlot) * slots + ASYNC_LOG_SLOT_SIZE * ASYNC_LOG_BATCH);
+    if (memory == NULL)
+        return false;
+
+    core = (AsyncLogCore *)ALIGN((uintptr_t)memory, CACHE_LINE_SIZE);
+    core->memory = memory;
+    core->slots = (AsyncLogSlot *)((uint8_t *)core + ALIGN(sizeof(AsyncLogCore), CACHE_LINE_SIZE));
+    core->mask = slots - 1;
+    core->batch = (char *)(core->slots + slots);
+    core->sink = sink != NULL ? sink : __myutil_async_log_stdout;
+    core->arg = arg;
+    core->stop = false;
+    core->wake = core->parked = 0;
+    core->done = core->waiters = 0;
+    core->head = core->dropped = 0;
+    core->tail = core->written = 0;
+    for (i = 0; i < slots; i++)
+        core->slots[i].seq = i;
+
+    if (pthread_create(&core->thread, NULL, __myutil_async_log_flusher, core) != 0)
+    {
+        Allocator_free(allocator, memory);
+        return false;
+    }
+    self->core = core;
+    return true;
+}
+
+/**
+ * Write queued messages, stop the flusher thread and release ring.
+ * 
+ * No thread could write to the log during or after the call.
+ * 
+ * @param self: the AsyncLog object.
+ */
+void AsyncLog_destroy(AsyncLogRef self)
+{
+    AsyncLogCore *core = self->core;
+    AsyncLogRef expected = self;
+
+    if (core == NULL)
+        return;
+
+    __atomic_compare_exchange_n(&__myutil_async_log_default, &expected, NULL,
+        false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&core->stop, true, __ATOMIC_SEQ_CST);
+    __myutil_async_log_futexWake(&core->wake, 1);
+    pthread_join(core->thread, NULL);
+
+    Allocator_free(self->allocator, core->memory);
+    self->core = NULL;
+}
+
+/**
+ * Format a message into the ring, a newline is appended.
+ * 
+ * @param self: the AsyncLog object.
+ * @param prefix: the text in front of message, or NULL.
+ * @param format: the printf format.
+ * @param args: the arguments of format.
+ * @return false if the message is dropped by a full ring.
+ */
+bool AsyncLog_vwrite(AsyncLogRef self, char const *prefix, char const *format, va_list args)
+{
+    AsyncLogCore *core = self->core;
+    size_t pos = __atomic_load_n(&core->head, __ATOMIC_RELAXED);
+    size_t room = sizeof(core->slots[0].text) - 1, len = 0;
+    AsyncLogSlot *slot;
+    int n;
+
+    /* claim a slot */
+    while (true)
+    {
+        slot = &core->slots[pos & core->mask];
+        intptr_t diff = (intptr_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&core->head, &pos, pos + 1,
+                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* the slot of one lap ago is not read yet, the ring is full. */
+            if (self->policy == ASYNC_LOG_DROP)
+            {
+                __atomic_fetch_add(&core->dropped, 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            sched_yield();
+            pos = __atomic_load_n(&core->head, __ATOMIC_RELAXED);
+        }
+        else
+            pos = __atomic_load_n(&core->head, __ATOMIC_RELAXED);
+    }
+
+    /* format in place, truncated to the slot, keep room for newline. */
+    if (prefix != NULL)
+    {
+        len = MIN(strlen(prefix), room);
+        memcpy(slot->text, prefix, len);
+    }
+    n = vsnprintf(slot->text + len, room - len + 1, format, args);
+    if (n > 0)
+        len += MIN((size_t)n, room - len);
+    slot->text[len++] = '\n';
+    slot->length = (uint32_t)len;
+
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_SEQ_CST);
+    /* only the first producer seeing the flusher parked makes a syscall. */
+    if (__atomic_load_n(&core->parked, __ATOMIC_SEQ_CST) != 0 &&
+        __atomic_exchange_n(&core->parked, 0, __ATOMIC_SEQ_CST) != 0)
+        __myutil_async_log_futexWake(&core->wake, 1);
+    return true;
+}
+
+/**
+ * Format a message into the ring, a newline is appended.
+ * 
+ * @param self: the AsyncLog object.
+ * @param prefix: the text in front of message, or NULL.
+ * @param format: the printf format.
+ * @return false if the message is dropped by a full ring.
+ */
+bool AsyncLog_write(AsyncLogRef self, char const *prefix, char const *format, ...)
+{
+    va_list args;
+    bool ret;
+
+    va_start(args, format);
+    ret = AsyncLog_vwrite(self, prefix, format, args);
+    va_end(args);
+    return ret;
+}
+
+/**
+ * Wait until all messages written before the call are passed to sink.
+ * 
+ * @param self: the AsyncLog object.
+ */
+void AsyncLog_flush(AsyncLogRef self)
+{
+    AsyncLogCore *core = self->core;
+    size_t target = __atomic_load_n(&core->head, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&core->written, __ATOMIC_SEQ_CST) < target)
+    {
+        uint32_t done = __atomic_load_n(&core->done, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&core->waiters, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&core->written, __ATOMIC_SEQ_CST) < target)
+            __myutil_async_log_futexWait(&core->done, done);
+        __atomic_fetch_sub(&core->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Get the count of dropped messages.
+ * 
+ * @param self: the AsyncLog object.
+ * @return the count of messages dropped by a full ring.
+ */
+size_t AsyncLog_dropped(AsyncLogRef self)
+{
+    return __atomic_load_n(&self->core->dropped, __ATOMIC_RELAXED);
+}
+
+/**
+ * Set the log used by LOG macros when LOG_ASYNC is defined.
+ * 
+ * @param self: the AsyncLog object, or NULL to print synchronously.
+ */
+void AsyncLog_setDefault(AsyncLogRef self)
+{
+    __atomic_store_n(&__myutil_async_log_default, self, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Format a message into the default log, or print it if there is none.
+ * 
+ * @param prefix: the text in front of message.
+ * @param format: the printf format.
+ */
+void AsyncLog_print(char const *prefix, char const *format, ...)
+{
+    AsyncLogRef self = __atomic_load_n(&__myutil_async_log_default, __ATOMIC_ACQUIRE);
+    va_list args;
+
+    va_start(args, format);
+    if (self != NULL)
+        AsyncLog_vwrite(self, prefix, format, args);
+    else
+    {
+        fputs(prefix, stdout);
+        vprintf(format, args);
+        putchar('\n');
+    }
+    va_end(args);
+}
@@ -0,0 +1,317 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bin_log.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ---------------------------------------------------------------------------
+ *  BinLog implements
+ * ------------------------------------------------------------------------ */
+
+static uint64_t __myutil_bin_log_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* the first unread record of writer, or NULL if empty. */
+static BinLogRecord *__myutil_bin_log_peek(BinLogWriterRef writer)
+{
+    size_t tail = writer->tail;
+    BinLogRecord *record;
+
+    if (tail == writer->headCache)
+    {
+        writer->headCache = __atomic_load_n(&writer->head, __ATOMIC_ACQUIRE);
+        if (tail == writer->headCache)
+            return NULL;
+    }
+
+    /* padding and the record after it are published together. */
+    record = (BinLogRecord *)(writer->buffer + (tail & writer->mask));
+    if (record->size == 0)
+    {
+        tail += writer->mask + 1 - (tail & writer->mask);
+        __atomic_store_n(&writer->tail, tail, __ATOMIC_RELEASE);
+        record = (BinLogRecord *)writer->buffer;
+    }
+    return record;
+}
+
+/* check the conversion fits the argument type. */
+static bool __myutil_bin_log_fits(uint8_t type, char conv)
+{
+    switch (type)
+    {
+    case BIN_LOG_INT:
+    case BIN_LOG_UINT:
+        return strchr("diouxXc", conv) != NULL;
+    case BIN_LOG_DOUBLE:
+        return strchr("fFeEgGaA", conv) != NULL;
+    case BIN_LOG_STRING:
+        return conv == 's';
+    default:
+        return conv == 'p';
+    }
+}
+
+/* format one record as printf would, return the bytes written. */
+static size_t __myutil_bin_log_formatArgs(BinLogRecord const *record, char *out, size_t size)
+{
+    BinLogFormat const *format = record->format;
+    uint64_t const *arg = (uint64_t const *)(record + 1);
+    char const *p = format->format;
+    char spec[32];
+    size_t len = 0, i = 0;
+
+    while (*p != '\0' && len + 1 < size)
+    {
+        char const *start = p, *end;
+        size_t n;
+        int ret = 0;
+
+        if (*p != '%' || p[1] == '%')
+        {
+            /* literal text */
+            if (*p == '%')
+                p++;
+            out[len++] = *p++;
+            continue;
+        }
+
+        /* flags, width and precision are kept, length is from type. */
+        p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL)
+            p++;
+        end = p;
+        while (*p != '\0' && strchr("hlLqjzt", *p) != NULL)
+            p++;
+        if (*p == '\0' || i >= format->argc || (size_t)(end - start) > sizeof(spec) - 4)
+            break;
+
+        n = end - start;
+        memcpy(spec, start, n);
+        if (!__myutil_bin_log_fits(format->types[i], *p))
+            spec[n++] = "?dugsp"[format->types[i]];
+        else
+        {
+            if ((format->types[i] == BIN_LOG_INT || format->types[i] == BIN_LOG_UINT) && *p != 'c')
+            {
+                spec[n++] = 'l';
+                spec[n++] = 'l';
+            }
+            spec[n++] = *p;
+        }
+        spec[n] = '\0';
+        p++;
+
+        switch (format->types[i++])
+        {
+        case BIN_LOG_INT:
+            ret = snprintf(out + len, size - len, spec, (long long)*arg++);
+            break;
+        case BIN_LOG_UINT:
+            ret = snprintf(out + len, size - len, spec, (unsigned long long)*arg++);
+            break;
+        case BIN_LOG_DOUBLE:
+        {
+            double v;
+            memcpy(&v, arg++, sizeof(v));
+            ret = snprintf(out + len, size - len, spec, v);
+            break;
+        }
+        case BIN_LOG_STRING:
+            if (*arg == UINT64_MAX)
+            {
+                ret = snprintf(out + len, size - len, spec, "(null)");
+                arg++;
+            }
+            else
+            {
+                ret = snprintf(out + len, size - len, spec, (char const *)(arg + 1));
+                arg += 1 + ALIGN(*arg + 1, 8) / 8;
+            }
+            break;
+        default:
+            ret = snprintf(out + len, size - len, spec, (void *)(uintptr_t)*arg++);
+            break;
+        }
+        if (ret > 0)
+            len += MIN((size_t)ret, size - 1 - len);
+    }
+    return len;
+}
+
+/**
+ * Init log.
+ * 
+ * @param self: the BinLog object to be init.
+ * @param allocator: the allocator of text and writer buffers.
+ * @return true if success, false if allocation failed.
+ */
+bool BinLog_init(BinLogRef self, AllocatorRef allocator)
+{
+    self->writers = NULL;
+    self->allocator = allocator;
+    self->startTime = BinLog_now();
+    self->startNs = __myutil_bin_log_ns();
+    self->ticksPerNs = 1.0;
+    self->text = (char *)Allocator_alloc(allocator, BIN_LOG_TEXT_SIZE);
+    return self->text != NULL;
+}
+
+/**
+ * Release log and buffers of all writers.
+ * 
+ * @param self: the BinLog object.
+ */
+void BinLog_destroy(BinLogRef self)
+{
+    ListRef node;
+
+    for (node = self->writers; node != NULL; node = node->next)
+        Allocator_free(self->allocator, DOWN_CAST(node, BinLogWriter)->memory);
+    self->writers = NULL;
+
+    if (self->text != NULL)
+        Allocator_free(self->allocator, self->text);
+    self->text = NULL;
+}
+
+/**
+ * Attach a writer to log.
+ * 
+ * Writers are never detached, they must stay valid until BinLog_destroy.
+ * The allocator is called, so attach is not thread safe unless allocator is.
+ * 
+ * @param self: the BinLog object.
+ * @param writer: the BinLogWriter object to be init.
+ * @param size: the min bytes of buffer, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool BinLog_attach(BinLogRef self, BinLogWriterRef writer, size_t size)
+{
+    size_t capacity = 256;
+
+    while (capacity < size)
+        capacity <<= 1;
+
+    /* allocator aligns to 4 bytes, keep 8 byte slots aligned. */
+    writer->memory = Allocator_alloc(self->allocator, capacity + 8);
+    if (writer->memory == NULL)
+        return false;
+
+    writer->buffer = (uint8_t *)ALIGN((uintptr_t)writer->memory, 8);
+
+    writer->mask = capacity - 1;
+    writer->head = writer->pending = writer->tailCache = 0;
+    writer->dropped = 0;
+    writer->tail = writer->headCache = 0;
+
+    writer->super.next = __atomic_load_n(&self->writers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&self->writers, &writer->super.next, &writer->super,
+            true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return true;
+}
+
+/**
+ * Format all published records by time order and pass text to sink.
+ * 
+ * Only one thread could call it at a time.
+ * 
+ * @param self: the BinLog object.
+ * @param sink: the sink of formatted lines.
+ * @param arg: the argument of sink.
+ * @return the count of formatted records.
+ */
+size_t BinLog_format(BinLogRef self, AsyncLogSink sink, void *arg)
+{
+    uint64_t now = BinLog_now(), ns = __myutil_bin_log_ns();
+    size_t count = 0, len = 0;
+
+    if (ns > self->startNs && now > self->startTime)
+        self->ticksPerNs = (double)(now - self->startTime) / (ns - self->startNs);
+
+    while (true)
+    {
+        ListRef node = __atomic_load_n(&self->writers, __ATOMIC_ACQUIRE);
+        BinLogWriterRef writer = NULL;
+        BinLogRecord *record = NULL;
+        char *line;
+        size_t n;
+        uint64_t us;
+
+        /* the oldest record among writers */
+        for (; node != NULL; node = node->next)
+        {
+            BinLogRecord *r = __myutil_bin_log_peek(DOWN_CAST(node, BinLogWriter));
+            if (r != NULL && (record == NULL || (int64_t)(r->time - record->time) < 0))
+            {
+                record = r;
+                writer = DOWN_CAST(node, BinLogWriter);
+            }
+        }
+        if (record == NULL)
+            break;
+
+        if (len + BIN_LOG_LINE_SIZE > BIN_LOG_TEXT_SIZE)
+        {
+            sink(self->text, len, arg);
+            len = 0;
+        }
+
+        /* seconds since init, then message, truncated to a line */
+        line = self->text + len;
+        us = (uint64_t)((double)(record->time - self->startTime) / self->ticksPerNs / 1000);
+        n = snprintf(line, BIN_LOG_LINE_SIZE, "[%lu.%06lu] ",
+            (unsigned long)(us / 1000000), (unsigned long)(us % 1000000));
+        n += __myutil_bin_log_formatArgs(record, line + n, BIN_LOG_LINE_SIZE - 1 - n);
+        line[n++] = '\n';
+        len += n;
+
+        __atomic_store_n(&writer->tail, writer->tail + record->size, __ATOMIC_RELEASE);
+        count++;
+    }
+
+    if (len > 0)
+        sink(self->text, len, arg);
+    return count;
+}
+
+/**
+ * Get the count of dropped records.
+ * 
+ * @param self: the BinLog object.
+ * @return the count of records dropped by full writers.
+ */
+size_t BinLog_dropped(BinLogRef self)
+{
+    ListRef node = __atomic_load_n(&self->writers, __ATOMIC_ACQUIRE);
+    size_t dropped = 0;
+
+    for (; node != NULL; node = node->next)
+        dropped += __atomic_load_n(&DOWN_CAST(node, BinLogWriter)->dropped, __ATOMIC_RELAXED);
+    return dropped;
+}
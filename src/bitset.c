@@ -0,0 +1,367 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bitset.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#define BITSET_BLOCK_WORDS 8    /* words per rank block, 512 bits */
+
+/* ---------------------------------------------------------------------------
+ *  Bitset implements
+ * ------------------------------------------------------------------------ */
+
+/* clear the bits beyond size in the last word. */
+static void __myutil_bitset_trim(BitsetRef self)
+{
+    if (self->bits == 0)
+        self->words[0] = 0;
+    else if ((self->bits & 63) != 0)
+        self->words[self->length - 1] &= ((uint64_t)1 << (self->bits & 63)) - 1;
+}
+
+/* position of the k-th set bit in a word, k less than popcount. */
+static unsigned __myutil_bitset_selectWord(uint64_t word, unsigned k)
+{
+#if defined(__BMI2__)
+    return (unsigned)__builtin_ctzll(_pdep_u64((uint64_t)1 << k, word));
+#else
+    for (; k > 0; k--)
+        word &= word - 1;
+    return (unsigned)__builtin_ctzll(word);
+#endif
+}
+
+/* count set bits of words [0, n). */
+static size_t __myutil_bitset_popcount(uint64_t const *words, size_t n)
+{
+    size_t i = 0, count = 0;
+
+#if defined(__AVX2__)
+    /* nibble lookup by shuffle, summed by sad into 4 lanes */
+    __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((__m256i const *)(words + i));
+        __m256i bytes = _mm256_add_epi8(
+            _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+            _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    count = (size_t)_mm256_extract_epi64(sum, 0) + (size_t)_mm256_extract_epi64(sum, 1) +
+            (size_t)_mm256_extract_epi64(sum, 2) + (size_t)_mm256_extract_epi64(sum, 3);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    for (; i + 2 <= n; i += 2)
+        count += vaddlvq_u8(vcntq_u8(vld1q_u8((uint8_t const *)(words + i))));
+#endif
+
+    for (; i < n; i++)
+        count += (size_t)__builtin_popcountll(words[i]);
+    return count;
+}
+
+/** @cond DO_NOT_DOCUMENT */
+#if defined(__AVX2__)
+#define __MYUTIL_BITSET_BULK(a, b, avx, neon, op) \
+    for (; i + 4 <= n; i += 4) \
+        _mm256_storeu_si256((__m256i *)(a + i), avx( \
+            _mm256_loadu_si256((__m256i const *)(a + i)), _mm256_loadu_si256((__m256i const *)(b + i))));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define __MYUTIL_BITSET_BULK(a, b, avx, neon, op) \
+    for (; i + 2 <= n; i += 2) \
+        vst1q_u64(a + i, neon(vld1q_u64(a + i), vld1q_u64(b + i)));
+#else
+#define __MYUTIL_BITSET_BULK(a, b, avx, neon, op)
+#endif
+
+/* vector loop on common words, then the remaining ones by scalar op */
+#define __MYUTIL_BITSET_BULK_IMPL(name, avx, neon, op) \
+    void name(BitsetRef self, BitsetRef other) \
+    { \
+        uint64_t *a = self->words; \
+        uint64_t const *b = other->words; \
+        size_t i = 0, n = MIN(self->length, other->length); \
+        __MYUTIL_BITSET_BULK(a, b, avx, neon, op) \
+        for (; i < n; i++) \
+            a[i] = op(a[i], b[i]); \
+        __myutil_bitset_trim(self); \
+    }
+
+#define __MYUTIL_BITSET_AND(x, y) ((x) & (y))
+#define __MYUTIL_BITSET_OR(x, y) ((x) | (y))
+#define __MYUTIL_BITSET_XOR(x, y) ((x) ^ (y))
+#define __MYUTIL_BITSET_ANDNOT(x, y) ((x) & ~(y))
+
+/* andnot intrinsics negate the first operand */
+#define __MYUTIL_BITSET_AVX_ANDNOT(x, y) _mm256_andnot_si256(y, x)
+/** @endcond */
+
+/**
+ * Init bitset with all bits cleared.
+ * 
+ * @param self: the Bitset object to be init.
+ * @param allocator: the allocator of words.
+ * @param bits: the bit count.
+ * @return true if success, false if allocation failed.
+ */
+bool Bitset_init(BitsetRef self, AllocatorRef allocator, size_t bits)
+{
+    self->length = MAX((bits + 63) >> 6, 1);
+    self->words = (uint64_t *)Allocator_alloc(allocator, sizeof(uint64_t) * self->length);
+    if (self->words == NULL)
+        return false;
+
+    memset(self->words, 0, sizeof(uint64_t) * self->length);
+    self->bits = bits;
+    self->ranks = NULL;
+    self->allocator = allocator;
+    return true;
+}
+
+/**
+ * Release words and rank index.
+ * 
+ * @param self: the Bitset object.
+ */
+void Bitset_destroy(BitsetRef self)
+{
+    if (self->ranks != NULL)
+        Allocator_free(self->allocator, self->ranks);
+    Allocator_free(self->allocator, self->words);
+    self->words = NULL;
+    self->ranks = NULL;
+}
+
+/**
+ * Set or clear all bits.
+ * 
+ * @param self: the Bitset object.
+ * @param value: true to set, false to clear.
+ */
+void Bitset_fill(BitsetRef self, bool value)
+{
+    memset(self->words, value ? 0xff : 0, sizeof(uint64_t) * self->length);
+    __myutil_bitset_trim(self);
+}
+
+/**
+ * Find the first set bit from a position.
+ * 
+ * @param self: the Bitset object.
+ * @param from: the first index to check.
+ * @return the index of bit, or BITSET_NONE.
+ */
+size_t Bitset_findFirstSet(BitsetRef self, size_t from)
+{
+    size_t i = from >> 6;
+    uint64_t word;
+
+    if (from >= self->bits)
+        return BITSET_NONE;
+
+    /* mask bits before from in the first word */
+    word = self->words[i] & (~(uint64_t)0 << (from & 63));
+    while (word == 0)
+    {
+        if (++i >= self->length)
+            return BITSET_NONE;
+        word = self->words[i];
+    }
+    return (i << 6) + (size_t)__builtin_ctzll(word);
+}
+
+/**
+ * Find the first clear bit from a position.
+ * 
+ * @param self: the Bitset object.
+ * @param from: the first index to check.
+ * @return the index of bit, or BITSET_NONE.
+ */
+size_t Bitset_findFirstZero(BitsetRef self, size_t from)
+{
+    size_t i = from >> 6, index;
+    uint64_t word;
+
+    if (from >= self->bits)
+        return BITSET_NONE;
+
+    word = ~self->words[i] & (~(uint64_t)0 << (from & 63));
+    while (word == 0)
+    {
+        if (++i >= self->length)
+            return BITSET_NONE;
+        word = ~self->words[i];
+    }
+
+    /* bits beyond size are zero but not part of set */
+    index = (i << 6) + (size_t)__builtin_ctzll(word);
+    return index < self->bits ? index : BITSET_NONE;
+}
+
+/**
+ * Count set bits.
+ * 
+ * @param self: the Bitset object.
+ * @return the count of set bits.
+ */
+size_t Bitset_count(BitsetRef self)
+{
+    return __myutil_bitset_popcount(self->words, self->length);
+}
+
+/**
+ * self = self & other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+__MYUTIL_BITSET_BULK_IMPL(Bitset_and, _mm256_and_si256, vandq_u64, __MYUTIL_BITSET_AND)
+
+/**
+ * self = self | other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+__MYUTIL_BITSET_BULK_IMPL(Bitset_or, _mm256_or_si256, vorrq_u64, __MYUTIL_BITSET_OR)
+
+/**
+ * self = self ^ other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+__MYUTIL_BITSET_BULK_IMPL(Bitset_xor, _mm256_xor_si256, veorq_u64, __MYUTIL_BITSET_XOR)
+
+/**
+ * self = self & ~other, on the common words of bitsets.
+ * 
+ * @param self: the Bitset object.
+ * @param other: another Bitset, usually of same size.
+ */
+__MYUTIL_BITSET_BULK_IMPL(Bitset_andNot, __MYUTIL_BITSET_AVX_ANDNOT, vbicq_u64, __MYUTIL_BITSET_ANDNOT)
+
+/**
+ * Build rank index for rank and select.
+ * 
+ * @param self: the Bitset object.
+ * @return true if success, false if allocation failed.
+ */
+bool Bitset_buildRank(BitsetRef self)
+{
+    size_t blocks = (self->length + BITSET_BLOCK_WORDS - 1) / BITSET_BLOCK_WORDS, i;
+    uint32_t count = 0;
+
+    if (self->ranks == NULL)
+    {
+        /* one more entry for the total */
+        self->ranks = (uint32_t *)Allocator_alloc(self->allocator, sizeof(uint32_t) * (blocks + 1));
+        if (self->ranks == NULL)
+            return false;
+    }
+
+    for (i = 0; i < blocks; i++)
+    {
+        self->ranks[i] = count;
+        count += (uint32_t)__myutil_bitset_popcount(self->words + i * BITSET_BLOCK_WORDS,
+            MIN(BITSET_BLOCK_WORDS, self->length - i * BITSET_BLOCK_WORDS));
+    }
+    self->ranks[blocks] = count;
+    return true;
+}
+
+/**
+ * Count set bits before a position, O(1) with rank index.
+ * 
+ * @param self: the Bitset object.
+ * @param i: the position, up to size.
+ * @return the count of set bits in [0, i).
+ */
+size_t Bitset_rank(BitsetRef self, size_t i)
+{
+    size_t word = i >> 6, start = 0, count = 0;
+
+    if (self->ranks != NULL)
+    {
+        start = (word / BITSET_BLOCK_WORDS) * BITSET_BLOCK_WORDS;
+        count = self->ranks[word / BITSET_BLOCK_WORDS];
+    }
+    count += __myutil_bitset_popcount(self->words + start, word - start);
+    if ((i & 63) != 0)
+        count += (size_t)__builtin_popcountll(self->words[word] & (((uint64_t)1 << (i & 63)) - 1));
+    return count;
+}
+
+/**
+ * Find the position of the k-th set bit, O(log n) with rank index.
+ * 
+ * @param self: the Bitset object.
+ * @param k: the 0-based order of set bit.
+ * @return the index of bit, or BITSET_NONE if less than k + 1 bits set.
+ */
+size_t Bitset_select(BitsetRef self, size_t k)
+{
+    size_t i = 0, count;
+
+    if (self->ranks != NULL)
+    {
+        size_t low = 0, high = (self->length + BITSET_BLOCK_WORDS - 1) / BITSET_BLOCK_WORDS;
+
+        if (k >= self->ranks[high])
+            return BITSET_NONE;
+
+        /* the last block whose rank is not greater than k */
+        while (high - low > 1)
+        {
+            size_t mid = (low + high) / 2;
+            if (self->ranks[mid] <= k)
+                low = mid;
+            else
+                high = mid;
+        }
+        i = low * BITSET_BLOCK_WORDS;
+        k -= self->ranks[low];
+    }
+
+    for (; i < self->length; i++)
+    {
+        count = (size_t)__builtin_popcountll(self->words[i]);
+        if (k < count)
+            return (i << 6) + __myutil_bitset_selectWord(self->words[i], (unsigned)k);
+        k -= count;
+    }
+    return BITSET_NONE;
+}
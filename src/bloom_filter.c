@@ -0,0 +1,362 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bloom_filter.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  BloomFilter implements
+ * ------------------------------------------------------------------------ */
+
+/* keys hashed and prefetched ahead by BloomFilter_containsBatch */
+#define __MYUTIL_BLOOM_FILTER_BATCH 16
+
+/* odd multipliers, one per word, spreading a hash to 8 bit positions */
+static uint32_t const __myutil_bloom_filter_salts[BLOOM_FILTER_BLOCK_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+/* 64-bit finalizer of murmur3, all bits mixed. */
+static inline uint64_t __myutil_bloom_filter_mix(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+/* high half of hash selects the block, low half the bits. */
+static inline uint64_t *__myutil_bloom_filter_block(BloomFilterRef self, uint64_t hash)
+{
+    return self->blocks + (size_t)(((hash >> 32) * self->count) >> 32) * BLOOM_FILTER_BLOCK_WORDS;
+}
+
+static inline bool __myutil_bloom_filter_test(uint64_t const *block, uint32_t hash)
+{
+#if defined(__AVX2__)
+    __m256i salts = _mm256_loadu_si256((__m256i const *)__myutil_bloom_filter_salts);
+    __m256i pos = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)hash), salts), 26);
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i lo = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(pos)));
+    __m256i hi = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pos, 1)));
+
+    return _mm256_testc_si256(_mm256_loadu_si256((__m256i const *)block), lo) &
+        _mm256_testc_si256(_mm256_loadu_si256((__m256i const *)(block + 4)), hi);
+#else
+    uint64_t all = 1;
+    int i;
+
+    /* no early exit, a miss is as unpredictable as a hit. */
+    for (i = 0; i < BLOOM_FILTER_BLOCK_WORDS; i++)
+        all &= block[i] >> ((hash * __myutil_bloom_filter_salts[i]) >> 26);
+    return all != 0;
+#endif
+}
+
+/* e^-x for x >= 0, halved into a short series then squared back. */
+static double __myutil_bloom_filter_exp(double x)
+{
+    double term = 1, sum = 1;
+    int i, halves = 0;
+
+    while (x > 0.0625)
+    {
+        x /= 2;
+        halves++;
+    }
+    for (i = 1; i < 10; i++)
+    {
+        term *= -x / i;
+        sum += term;
+    }
+    while (halves-- > 0)
+        sum *= sum;
+    return sum;
+}
+
+static void __myutil_bloom_filter_put(uint8_t *p, uint64_t value, int bytes)
+{
+    int i;
+    for (i = 0; i < bytes; i++, value >>= 8)
+        p[i] = (uint8_t)value;
+}
+
+static uint64_t __myutil_bloom_filter_get(uint8_t const *p, int bytes)
+{
+    uint64_t value = 0;
+    while (bytes-- > 0)
+        value = (value << 8) | p[bytes];
+    return value;
+}
+
+/**
+ * Estimate false positive rate.
+ * 
+ * Keys per block follow a Poisson distribution, the rate is averaged over
+ * it, so it accounts for unevenly loaded blocks.
+ * 
+ * @param keys: the count of keys added.
+ * @param blocks: the block count.
+ * @return the expected false positive rate.
+ */
+double BloomFilter_fpr(size_t keys, size_t blocks)
+{
+    double lambda = (double)keys / MAX(blocks, (size_t)1);
+    double p, empty = 1, sum = 0;
+    size_t x;
+
+    /* so crowded that blocks are nearly full, Poisson terms underflow. */
+    if (lambda > 256)
+    {
+        for (x = 0; x < 256; x++)
+            empty *= 63.0 / 64;
+        return 1 - empty * empty * empty * empty * empty * empty * empty * empty;
+    }
+
+    /* sum P(x keys in a block) * P(8 bits of a probe are set by x keys) */
+    p = __myutil_bloom_filter_exp(lambda);
+    for (x = 0; x <= lambda || p > 1e-15; x++)
+    {
+        double one = 1 - empty;
+        double one2 = one * one, one4 = one2 * one2;
+        sum += p * one4 * one4;
+        p *= lambda / (x + 1);
+        empty *= 63.0 / 64;
+    }
+    return sum;
+}
+
+/**
+ * Get the min block count for a target false positive rate.
+ * 
+ * @param keys: the count of keys to add.
+ * @param fpr: the target false positive rate, in (0, 1).
+ * @return the block count, at least 1.
+ */
+size_t BloomFilter_blocksFor(size_t keys, double fpr)
+{
+    size_t lo = 1, hi = 1;
+
+    while (BloomFilter_fpr(keys, hi) > fpr && hi < ((size_t)1 << (sizeof(size_t) * 8 - 2)))
+        hi *= 2;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (BloomFilter_fpr(keys, mid) > fpr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * Init filter with all bits cleared.
+ * 
+ * @param self: the BloomFilter object to be init.
+ * @param allocator: the allocator of blocks.
+ * @param blocks: the block count, at least 1.
+ * @return false if allocation failed.
+ */
+bool BloomFilter_init(BloomFilterRef self, AllocatorRef allocator, size_t blocks)
+{
+    self->blocks = NULL;
+    self->count = 0;
+    self->memory = NULL;
+    self->allocator = allocator;
+
+    /* block index is a 32-bit fraction of count. */
+    if (blocks == 0 || (uint64_t)blocks > UINT32_MAX)
+        return false;
+
+    self->memory = Allocator_alloc(allocator, (blocks + 1) * BLOOM_FILTER_BLOCK_SIZE);
+    if (self->memory == NULL)
+        return false;
+
+    self->blocks = (uint64_t *)ALIGN((uintptr_t)self->memory, (uintptr_t)BLOOM_FILTER_BLOCK_SIZE);
+    self->count = blocks;
+    BloomFilter_clear(self);
+    return true;
+}
+
+/**
+ * Release blocks.
+ * 
+ * @param self: the BloomFilter object.
+ */
+void BloomFilter_destroy(BloomFilterRef self)
+{
+    if (self->memory != NULL)
+        Allocator_free(self->allocator, self->memory);
+    self->blocks = NULL;
+    self->count = 0;
+    self->memory = NULL;
+}
+
+/**
+ * Clear all bits.
+ * 
+ * @param self: the BloomFilter object.
+ */
+void BloomFilter_clear(BloomFilterRef self)
+{
+    memset(self->blocks, 0, self->count * BLOOM_FILTER_BLOCK_SIZE);
+}
+
+/**
+ * Add a key.
+ * 
+ * @param self: the BloomFilter object.
+ * @param key: the key.
+ */
+void BloomFilter_add(BloomFilterRef self, uint64_t key)
+{
+    uint64_t hash = __myutil_bloom_filter_mix(key);
+    uint64_t *block = __myutil_bloom_filter_block(self, hash);
+    int i;
+
+    for (i = 0; i < BLOOM_FILTER_BLOCK_WORDS; i++)
+        block[i] |= 1ull << (((uint32_t)hash * __myutil_bloom_filter_salts[i]) >> 26);
+}
+
+/**
+ * Test a key.
+ * 
+ * @param self: the BloomFilter object.
+ * @param key: the key.
+ * @return false if the key was never added, true if it may be added.
+ */
+bool BloomFilter_contains(BloomFilterRef self, uint64_t key)
+{
+    uint64_t hash = __myutil_bloom_filter_mix(key);
+    return __myutil_bloom_filter_test(__myutil_bloom_filter_block(self, hash), (uint32_t)hash);
+}
+
+/**
+ * Test many keys.
+ * 
+ * Blocks of following keys are prefetched while testing, so memory loads
+ * overlap, and the 8 bits of a key are tested by two AVX2 compares when
+ * available.
+ * 
+ * @param self: the BloomFilter object.
+ * @param keys: the keys.
+ * @param n: the count of keys.
+ * @param results: output 1 for keys may be added, 0 for others, or NULL.
+ * @return the count of keys may be added.
+ */
+size_t BloomFilter_containsBatch(BloomFilterRef self, uint64_t const *keys, size_t n, uint8_t *results)
+{
+    uint64_t hashes[__MYUTIL_BLOOM_FILTER_BATCH];
+    uint64_t *blocks[__MYUTIL_BLOOM_FILTER_BATCH];
+    size_t i, j, m, found = 0;
+
+    for (i = 0; i < n; i += m)
+    {
+        m = MIN(n - i, (size_t)__MYUTIL_BLOOM_FILTER_BATCH);
+        for (j = 0; j < m; j++)
+        {
+            hashes[j] = __myutil_bloom_filter_mix(keys[i + j]);
+            blocks[j] = __myutil_bloom_filter_block(self, hashes[j]);
+            PREFETCH(blocks[j]);
+        }
+        for (j = 0; j < m; j++)
+        {
+            bool hit = __myutil_bloom_filter_test(blocks[j], (uint32_t)hashes[j]);
+            if (results != NULL)
+                results[i + j] = hit;
+            found += hit;
+        }
+    }
+    return found;
+}
+
+/**
+ * Serialize filter.
+ * 
+ * @param self: the BloomFilter object.
+ * @param buf: the buffer.
+ * @param size: the buffer size.
+ * @return the bytes written, or 0 if buffer is too small.
+ */
+size_t BloomFilter_serialize(BloomFilterRef self, void *buf, size_t size)
+{
+    uint8_t *p = (uint8_t *)buf;
+    size_t i, words = self->count * BLOOM_FILTER_BLOCK_WORDS;
+
+    if (size < BloomFilter_serializedSize(self))
+        return 0;
+
+    __myutil_bloom_filter_put(p, BLOOM_FILTER_MAGIC, 4);
+    /* words per block, a filter is only read back with the same block layout */
+    __myutil_bloom_filter_put(p + 4, BLOOM_FILTER_BLOCK_WORDS, 4);
+    __myutil_bloom_filter_put(p + 8, self->count, 8);
+    p += BLOOM_FILTER_HEADER_SIZE;
+
+    for (i = 0; i < words; i++, p += 8)
+        __myutil_bloom_filter_put(p, self->blocks[i], 8);
+    return BloomFilter_serializedSize(self);
+}
+
+/**
+ * Init filter from serialized data.
+ * 
+ * @param self: the BloomFilter object to be init.
+ * @param allocator: the allocator of blocks.
+ * @param buf: the serialized data.
+ * @param size: the data size.
+ * @return false if data is malformed or allocation failed.
+ */
+bool BloomFilter_deserialize(BloomFilterRef self, AllocatorRef allocator, void const *buf, size_t size)
+{
+    uint8_t const *p = (uint8_t const *)buf;
+    uint64_t blocks;
+    size_t i;
+
+    /* an empty filter on failure, safe to destroy. */
+    BloomFilter_init(self, allocator, 0);
+    if (size < BLOOM_FILTER_HEADER_SIZE ||
+        __myutil_bloom_filter_get(p, 4) != BLOOM_FILTER_MAGIC ||
+        __myutil_bloom_filter_get(p + 4, 4) != BLOOM_FILTER_BLOCK_WORDS)
+        return false;
+
+    blocks = __myutil_bloom_filter_get(p + 8, 8);
+    if (blocks == 0 || blocks > UINT32_MAX ||
+        size != BLOOM_FILTER_HEADER_SIZE + blocks * BLOOM_FILTER_BLOCK_SIZE)
+        return false;
+
+    if (!BloomFilter_init(self, allocator, (size_t)blocks))
+        return false;
+
+    p += BLOOM_FILTER_HEADER_SIZE;
+    for (i = 0; i < self->count * BLOOM_FILTER_BLOCK_WORDS; i++, p += 8)
+        self->blocks[i] = __myutil_bloom_filter_get(p, 8);
+    return true;
+}
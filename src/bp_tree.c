@@ -0,0 +1,485 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file bp_tree.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  BpNode implements
+ * ------------------------------------------------------------------------ */
+
+/** header of inner and leaf nodes */
+typedef struct _BpNode
+{
+    uint32_t count;                         /**< key count */
+    uint32_t leaf;                          /**< non-zero for leaf */
+} BpNode;
+
+#define __MYUTIL_BP_TREE_INNER_KEYS \
+    ((BP_TREE_NODE_SIZE - sizeof(BpNode) - sizeof(void *)) / (sizeof(uint64_t) + sizeof(void *)))
+#define __MYUTIL_BP_TREE_LEAF_KEYS \
+    ((BP_TREE_NODE_SIZE - sizeof(BpNode) - sizeof(DbList)) / (sizeof(uint64_t) + sizeof(ref_t)))
+
+/** inner node, keys[i] is the lower bound of children[i + 1] */
+typedef struct _BpInner
+{
+    BpNode super;
+    uint64_t keys[__MYUTIL_BP_TREE_INNER_KEYS];
+    BpNode *children[__MYUTIL_BP_TREE_INNER_KEYS + 1];
+} BpInner;
+
+/** leaf node, chained in key order */
+typedef struct _BpLeaf
+{
+    BpNode super;
+    DbList link;                            /**< sibling links */
+    uint64_t keys[__MYUTIL_BP_TREE_LEAF_KEYS];
+    ref_t values[__MYUTIL_BP_TREE_LEAF_KEYS];
+} BpLeaf;
+
+/**
+ * Count keys less than key, or not greater than key if upper.
+ * 
+ * With AVX2, 4 keys are compared at once as signed integers after the
+ * sign bits are flipped, stopping at the first group not all less.
+ */
+static inline size_t __myutil_bp_tree_rank(uint64_t const *keys, size_t n, uint64_t key, bool upper)
+{
+#if defined(__AVX2__)
+    __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi64x((int64_t)key), sign);
+    __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    size_t i, rank = 0;
+
+    for (i = 0; i < n; i += 4)
+    {
+        /* lanes past the last key are neither loaded nor counted. */
+        __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x((int64_t)(n - i)), lanes);
+        __m256i v = _mm256_xor_si256(_mm256_maskload_epi64((long long const *)(keys + i), valid), sign);
+        __m256i less = upper ? _mm256_andnot_si256(_mm256_cmpgt_epi64(v, k), valid) :
+            _mm256_and_si256(_mm256_cmpgt_epi64(k, v), valid);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(less));
+        rank += __builtin_popcount(mask);
+        if (mask != 0xf)
+            break;
+    }
+    return rank;
+#else
+    size_t lo = 0, len = n;
+
+    while (len > 0)
+    {
+        size_t half = len / 2;
+        if (upper ? keys[lo + half] <= key : keys[lo + half] < key)
+        {
+            lo += half + 1;
+            len -= half + 1;
+        }
+        else
+        {
+            len = half;
+        }
+    }
+    return lo;
+#endif
+}
+
+static BpNode *__myutil_bp_tree_alloc(AllocatorRef allocator, bool leaf)
+{
+    BpNode *node = (BpNode *)Allocator_alloc(allocator, BP_TREE_NODE_SIZE);
+    if (node != NULL)
+    {
+        node->count = 0;
+        node->leaf = leaf;
+    }
+    return node;
+}
+
+static void __myutil_bp_tree_free(BpTreeRef self, BpNode *node)
+{
+    size_t i;
+    if (!node->leaf)
+    {
+        BpInner *inner = (BpInner *)node;
+        for (i = 0; i <= inner->super.count; i++)
+            __myutil_bp_tree_free(self, inner->children[i]);
+    }
+    Allocator_free(self->allocator, node);
+}
+
+/* descend to the leaf of key, recording inner nodes and child slots. */
+static BpLeaf *__myutil_bp_tree_descend(BpTreeRef self, uint64_t key, BpInner **path, size_t *slots,
+    size_t *depth)
+{
+    BpNode *node = self->root;
+    *depth = 0;
+    while (!node->leaf)
+    {
+        BpInner *inner = (BpInner *)node;
+        size_t i = __myutil_bp_tree_rank(inner->keys, inner->super.count, key, true);
+        if (path != NULL)
+        {
+            path[*depth] = inner;
+            slots[*depth] = i;
+        }
+        (*depth)++;
+        node = inner->children[i];
+
+        /* fetch all lines of the child together, not one per search step. */
+        for (i = CACHE_LINE_SIZE; i < BP_TREE_NODE_SIZE; i += CACHE_LINE_SIZE)
+            PREFETCH((uint8_t *)node + i);
+    }
+    return (BpLeaf *)node;
+}
+
+static void __myutil_bp_tree_leafInsert(BpLeaf *leaf, size_t pos, uint64_t key, ref_t value)
+{
+    size_t n = leaf->super.count - pos;
+    memmove(leaf->keys + pos + 1, leaf->keys + pos, sizeof(uint64_t) * n);
+    memmove(leaf->values + pos + 1, leaf->values + pos, sizeof(ref_t) * n);
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    leaf->super.count++;
+}
+
+/* insert key at slot and child at slot + 1. */
+static void __myutil_bp_tree_innerInsert(BpInner *inner, size_t slot, uint64_t key, BpNode *child)
+{
+    size_t n = inner->super.count - slot;
+    memmove(inner->keys + slot + 1, inner->keys + slot, sizeof(uint64_t) * n);
+    memmove(inner->children + slot + 2, inner->children + slot + 1, sizeof(BpNode *) * n);
+    inner->keys[slot] = key;
+    inner->children[slot + 1] = child;
+    inner->super.count++;
+}
+
+/* split a full leaf into right, then insert the entry, return right. */
+static BpLeaf *__myutil_bp_tree_splitLeaf(BpLeaf *leaf, BpLeaf *right, size_t pos, uint64_t key, ref_t value)
+{
+    size_t mid = __MYUTIL_BP_TREE_LEAF_KEYS / 2;
+
+    right->super.count = __MYUTIL_BP_TREE_LEAF_KEYS - mid;
+    memcpy(right->keys, leaf->keys + mid, sizeof(uint64_t) * right->super.count);
+    memcpy(right->values, leaf->values + mid, sizeof(ref_t) * right->super.count);
+    leaf->super.count = mid;
+
+    if (pos <= mid)
+        __myutil_bp_tree_leafInsert(leaf, pos, key, value);
+    else
+        __myutil_bp_tree_leafInsert(right, pos - mid, key, value);
+
+    DbList_insert(&right->link, leaf->link.next);
+    return right;
+}
+
+/* split a full inner into right while inserting key and child, return the
+ * key moved up. */
+static uint64_t __myutil_bp_tree_splitInner(BpInner *inner, BpInner *right, size_t slot, uint64_t key,
+    BpNode *child)
+{
+    uint64_t keys[__MYUTIL_BP_TREE_INNER_KEYS + 1];
+    BpNode *children[__MYUTIL_BP_TREE_INNER_KEYS + 2];
+    size_t total = __MYUTIL_BP_TREE_INNER_KEYS + 1, mid = total / 2;
+
+    memcpy(keys, inner->keys, sizeof(uint64_t) * slot);
+    keys[slot] = key;
+    memcpy(keys + slot + 1, inner->keys + slot, sizeof(uint64_t) * (total - 1 - slot));
+    memcpy(children, inner->children, sizeof(BpNode *) * (slot + 1));
+    children[slot + 1] = child;
+    memcpy(children + slot + 2, inner->children + slot + 1, sizeof(BpNode *) * (total - 1 - slot));
+
+    inner->super.count = mid;
+    memcpy(inner->keys, keys, sizeof(uint64_t) * mid);
+    memcpy(inner->children, children, sizeof(BpNode *) * (mid + 1));
+
+    right->super.count = total - mid - 1;
+    memcpy(right->keys, keys + mid + 1, sizeof(uint64_t) * right->super.count);
+    memcpy(right->children, children + mid + 1, sizeof(BpNode *) * (right->super.count + 1));
+    return keys[mid];
+}
+
+/* ---------------------------------------------------------------------------
+ *  BpTree implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Release all nodes.
+ * 
+ * @param self: the BpTree object.
+ */
+void BpTree_destroy(BpTreeRef self)
+{
+    if (self->root != NULL)
+        __myutil_bp_tree_free(self, self->root);
+    BpTree_init(self, self->allocator);
+}
+
+/**
+ * Insert an entry, or replace the value of an existing key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: the value.
+ * @return false if allocation failed and the tree is unchanged.
+ */
+bool BpTree_insert(BpTreeRef self, uint64_t key, ref_t value)
+{
+    BpInner *path[BP_TREE_MAX_HEIGHT];
+    size_t slots[BP_TREE_MAX_HEIGHT];
+    BpNode *spare[BP_TREE_MAX_HEIGHT + 1];
+    size_t depth, pos, need, i;
+    BpNode *child;
+    BpLeaf *leaf;
+
+    if (self->root == NULL)
+    {
+        leaf = (BpLeaf *)__myutil_bp_tree_alloc(self->allocator, true);
+        if (leaf == NULL)
+            return false;
+        __myutil_bp_tree_leafInsert(leaf, 0, key, value);
+        DbList_addToTail(&leaf->link, &self->leaves);
+        self->root = &leaf->super;
+        self->height = 1;
+        self->count = 1;
+        return true;
+    }
+
+    leaf = __myutil_bp_tree_descend(self, key, path, slots, &depth);
+    pos = __myutil_bp_tree_rank(leaf->keys, leaf->super.count, key, false);
+    if (pos < leaf->super.count && leaf->keys[pos] == key)
+    {
+        leaf->values[pos] = value;
+        return true;
+    }
+
+    if (leaf->super.count < __MYUTIL_BP_TREE_LEAF_KEYS)
+    {
+        __myutil_bp_tree_leafInsert(leaf, pos, key, value);
+        self->count++;
+        return true;
+    }
+
+    /* allocate all nodes of the split first, so failure changes nothing:
+     * a leaf, one per full inner up the path, and a root if all are full. */
+    need = 1;
+    while (need <= depth && path[depth - need]->super.count == __MYUTIL_BP_TREE_INNER_KEYS)
+        need++;
+    if (need > depth)
+        need++;
+    if (need > BP_TREE_MAX_HEIGHT)
+        return false;
+    for (i = 0; i < need; i++)
+    {
+        spare[i] = __myutil_bp_tree_alloc(self->allocator, i == 0);
+        if (spare[i] == NULL)
+        {
+            while (i-- > 0)
+                Allocator_free(self->allocator, spare[i]);
+            return false;
+        }
+    }
+
+    child = &__myutil_bp_tree_splitLeaf(leaf, (BpLeaf *)spare[0], pos, key, value)->super;
+    key = ((BpLeaf *)child)->keys[0];
+    self->count++;
+
+    for (i = 1; depth > 0; i++)
+    {
+        BpInner *inner = path[--depth];
+        if (inner->super.count < __MYUTIL_BP_TREE_INNER_KEYS)
+        {
+            __myutil_bp_tree_innerInsert(inner, slots[depth], key, child);
+            return true;
+        }
+        key = __myutil_bp_tree_splitInner(inner, (BpInner *)spare[i], slots[depth], key, child);
+        child = spare[i];
+    }
+
+    /* the root was split, grow a level. */
+    ((BpInner *)spare[i])->children[0] = self->root;
+    __myutil_bp_tree_innerInsert((BpInner *)spare[i], 0, key, child);
+    self->root = spare[i];
+    self->height++;
+    return true;
+}
+
+/**
+ * Remove the entry of a key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: output the removed value, or NULL if don't care.
+ * @return true if removed, false if not found.
+ */
+bool BpTree_remove(BpTreeRef self, uint64_t key, ref_t *value)
+{
+    BpInner *path[BP_TREE_MAX_HEIGHT];
+    size_t slots[BP_TREE_MAX_HEIGHT];
+    size_t depth, pos, n;
+    BpLeaf *leaf;
+
+    if (self->root == NULL)
+        return false;
+
+    leaf = __myutil_bp_tree_descend(self, key, path, slots, &depth);
+    pos = __myutil_bp_tree_rank(leaf->keys, leaf->super.count, key, false);
+    if (pos == leaf->super.count || leaf->keys[pos] != key)
+        return false;
+
+    if (value != NULL)
+        *value = leaf->values[pos];
+    n = leaf->super.count - pos - 1;
+    memmove(leaf->keys + pos, leaf->keys + pos + 1, sizeof(uint64_t) * n);
+    memmove(leaf->values + pos, leaf->values + pos + 1, sizeof(ref_t) * n);
+    leaf->super.count--;
+    self->count--;
+    if (leaf->super.count > 0)
+        return true;
+
+    /* drop the empty leaf, and every ancestor left without children. */
+    DbList_removeFrom(&leaf->link, &self->leaves);
+    Allocator_free(self->allocator, leaf);
+    for (;;)
+    {
+        BpInner *inner;
+        size_t slot;
+
+        if (depth == 0)
+        {
+            BpTree_init(self, self->allocator);
+            return true;
+        }
+
+        inner = path[--depth];
+        slot = slots[depth];
+        if (inner->super.count > 0)
+        {
+            size_t k = slot > 0 ? slot - 1 : 0;
+            n = inner->super.count;
+            memmove(inner->keys + k, inner->keys + k + 1, sizeof(uint64_t) * (n - k - 1));
+            memmove(inner->children + slot, inner->children + slot + 1, sizeof(BpNode *) * (n - slot));
+            inner->super.count--;
+            break;
+        }
+        Allocator_free(self->allocator, inner);
+    }
+
+    /* a root with a single child is replaced by the child. */
+    while (!self->root->leaf && self->root->count == 0)
+    {
+        BpNode *root = self->root;
+        self->root = ((BpInner *)root)->children[0];
+        self->height--;
+        Allocator_free(self->allocator, root);
+    }
+    return true;
+}
+
+/**
+ * Find the entry of a key.
+ * 
+ * @param self: the BpTree object.
+ * @param key: the key.
+ * @param value: output the value, or NULL if don't care.
+ * @return true if found.
+ */
+bool BpTree_find(BpTreeRef self, uint64_t key, ref_t *value)
+{
+    BpLeaf *leaf;
+    size_t depth, pos;
+
+    if (self->root == NULL)
+        return false;
+
+    leaf = __myutil_bp_tree_descend(self, key, NULL, NULL, &depth);
+    pos = __myutil_bp_tree_rank(leaf->keys, leaf->super.count, key, false);
+    if (pos == leaf->super.count || leaf->keys[pos] != key)
+        return false;
+    if (value != NULL)
+        *value = leaf->values[pos];
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+ *  BpTreeIter implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Init iterator before the first entry.
+ * 
+ * @param self: the BpTreeIter object to be init.
+ * @param tree: the BpTree to travel.
+ */
+void BpTreeIter_init(BpTreeIterRef self, BpTreeRef tree)
+{
+    self->tree = tree;
+    self->leaf = tree->leaves == NULL ? NULL : DOWN_CAST_FROM(tree->leaves, BpLeaf, link);
+    self->pos = 0;
+    self->key = 0;
+    self->value = NULL;
+}
+
+/**
+ * Init iterator before the first entry whose key is not less than key.
+ * 
+ * @param self: the BpTreeIter object to be init.
+ * @param tree: the BpTree to travel.
+ * @param key: the key.
+ */
+void BpTreeIter_seek(BpTreeIterRef self, BpTreeRef tree, uint64_t key)
+{
+    size_t depth;
+
+    BpTreeIter_init(self, tree);
+    if (tree->root == NULL)
+        return;
+
+    self->leaf = __myutil_bp_tree_descend(tree, key, NULL, NULL, &depth);
+    self->pos = __myutil_bp_tree_rank(self->leaf->keys, self->leaf->super.count, key, false);
+}
+
+/**
+ * Move iterator to next entry in key order.
+ * 
+ * @param self: the BpTreeIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool BpTreeIter_next(BpTreeIterRef self)
+{
+    while (self->leaf != NULL && self->pos >= self->leaf->super.count)
+    {
+        DbListRef next = self->leaf->link.next;
+        self->leaf = next == self->tree->leaves ? NULL : DOWN_CAST_FROM(next, BpLeaf, link);
+        self->pos = 0;
+    }
+    if (self->leaf == NULL)
+        return false;
+
+    self->key = self->leaf->keys[self->pos];
+    self->value = self->leaf->values[self->pos];
+    self->pos++;
+    return true;
+}
@@ -22,6 +22,8 @@
 
 #include "myutil.h"
 
+#include <string.h>
+
 /**
  * Remove double list node from list, update head if needed.
  * 
@@ -51,7 +53,7 @@ void DbList_removeFrom(DbListRef self, DbListRef *head)
  * @param self: the ListIter object to be insert.
  * @param target: the node after self.
  */
-static inline void DbList_addToTail(DbListRef self, DbListRef *head)
+void DbList_addToTail(DbListRef self, DbListRef *head)
 {
     if (*head == NULL)
     {
@@ -70,7 +72,7 @@ static inline void DbList_addToTail(DbListRef self, DbListRef *head)
  * @param self: the ListIter object to be insert.
  * @param target: the node after self.
  */
-static inline void DbList_addToHead(DbListRef self, DbListRef *head)
+void DbList_addToHead(DbListRef self, DbListRef *head)
 {
     if (*head == NULL)
     {
@@ -83,6 +85,127 @@ static inline void DbList_addToHead(DbListRef self, DbListRef *head)
     *head = self;
 }
 
+/**
+ * Insert all nodes of a list before target, O(1).
+ * 
+ * @param list: the pointer to head of nodes to be moved, set to NULL after.
+ * @param target: the node after moved nodes, in another list.
+ */
+void DbList_splice(DbListRef *list, DbListRef target)
+{
+    DbListRef first = *list, last;
+
+    if (first == NULL)
+        return;
+
+    last = first->prev;
+    first->prev = target->prev;
+    target->prev->next = first;
+    last->next = target;
+    target->prev = last;
+    *list = NULL;
+}
+
+/**
+ * Append all nodes of a list to list tail, O(1).
+ * 
+ * @param head: the pointer to head, should not be NULL.
+ * @param list: the pointer to head of nodes to be moved, set to NULL after.
+ */
+void DbList_concat(DbListRef *head, DbListRef *list)
+{
+    if (*head == NULL)
+    {
+        *head = *list;
+        *list = NULL;
+    }
+    else
+    {
+        /* before head is the tail of circular list */
+        DbList_splice(list, *head);
+    }
+}
+
+/**
+ * Split list before node, O(1).
+ * 
+ * @param self: the first node of new list.
+ * @param head: the pointer to head, keeps nodes before self, or NULL if
+ *      self is the head.
+ * @return the head of new list, nodes from self to the tail, or NULL if
+ *      the list is empty.
+ */
+DbListRef DbList_splitAt(DbListRef self, DbListRef *head)
+{
+    DbListRef first = *head, tail, before;
+
+    if (first == NULL)
+        return NULL;
+
+    if (self == first)
+    {
+        *head = NULL;
+        return self;
+    }
+
+    tail = first->prev;
+    before = self->prev;
+
+    /* close both rings */
+    before->next = first;
+    first->prev = before;
+    tail->next = self;
+    self->prev = tail;
+    return self;
+}
+
+/**
+ * Move double list nodes into one contiguous block in traversal order.
+ * 
+ * The block is allocated from dst and starts at the new head. DbList node
+ * must be the first member of objects, and whole objects are copied.
+ * 
+ * @param head: the pointer to head, updated to the new head.
+ * @param dst: the allocator of the block.
+ * @param nodeSize: the size of objects.
+ * @param relocate: called for every moved node, or NULL.
+ * @param arg: the argument of relocate.
+ * @return true if success, false if allocation failed and list is untouched.
+ */
+bool DbList_compact(DbListRef *head, AllocatorRef dst, size_t nodeSize, DbListRelocate relocate, void *arg)
+{
+    size_t stride = ALIGN(nodeSize, sizeof(void *)), count = 0, i;
+    DbListRef node;
+    uint8_t *block;
+
+    DBLIST_FOREACH(node, *head)
+        count++;
+    if (count == 0)
+        return true;
+
+    block = (uint8_t *)Allocator_alloc(dst, stride * count);
+    if (block == NULL)
+        return false;
+
+    /* links of new nodes are by index, old links are read before relocate. */
+    node = *head;
+    for (i = 0; i < count; i++)
+    {
+        DbListRef next = node->next, to = (DbListRef)(block + stride * i);
+
+        memcpy(to, node, nodeSize);
+        to->next = (DbListRef)(block + stride * (i + 1 == count ? 0 : i + 1));
+        to->prev = (DbListRef)(block + stride * (i == 0 ? count - 1 : i - 1));
+        if (relocate != NULL)
+            relocate(node, to, arg);
+
+        node = next;
+    }
+
+    *head = (DbListRef)block;
+    return true;
+}
+
 /**
  * Move iterator to next node.
  * 
@@ -109,6 +232,36 @@ bool DbListIter_next(DbListIter *self)
     return true;
 }
 
+/**
+ * Move iterator forward by up to n nodes, gather them in a batch.
+ * 
+ * Same as calling DbListIter_next n times, iterator stops at the last
+ * gathered node.
+ * 
+ * @param self: the DbListIter object pointer.
+ * @param out: the array to store nodes.
+ * @param n: the max count of nodes.
+ * @return the count of gathered nodes, 0 for iterator reaches the end.
+ */
+size_t DbListIter_nextN(DbListIterRef self, DbListRef out[], size_t n)
+{
+    if (n == 0 || !DbListIter_next(self))
+        return 0;
+
+    DbListRef current = self->current;
+    size_t count = 0;
+
+    out[count++] = current;
+    while (count < n && current->next != self->head)
+    {
+        current = current->next;
+        out[count++] = current;
+    }
+
+    self->current = current;
+    return count;
+}
+
 /**
  * Move iterator to previouse node.
  * 
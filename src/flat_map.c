@@ -0,0 +1,65 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file flat_map.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  FlatMap implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Get the slot count to hold count entries under max load factor 7/8.
+ * 
+ * @param count: the count of entries.
+ * @return the slot count, a power of 2 not less than FLAT_MAP_GROUP.
+ */
+size_t FlatMap_slotsFor(size_t count)
+{
+    size_t slots = FLAT_MAP_GROUP;
+    while (count > slots - slots / 8)
+        slots *= 2;
+    return slots;
+}
+
+/**
+ * Allocate a table of slots, used by FLAT_MAP_DEFINE.
+ * 
+ * The block holds the entries, then slots + FLAT_MAP_GROUP control bytes
+ * all set to FLAT_MAP_EMPTY.
+ * 
+ * @param allocator: the allocator.
+ * @param slots: the slot count, a power of 2 not less than FLAT_MAP_GROUP.
+ * @param entrySize: the size of an entry.
+ * @param ctrl: output the control bytes.
+ * @return the entries, or NULL if failed.
+ */
+void *FlatMap_allocTable(AllocatorRef allocator, size_t slots, size_t entrySize, uint8_t **ctrl)
+{
+    void *entries = Allocator_alloc(allocator, slots * entrySize + slots + FLAT_MAP_GROUP);
+    if (entries == NULL)
+        return NULL;
+
+    *ctrl = (uint8_t *)entries + slots * entrySize;
+    memset(*ctrl, FLAT_MAP_EMPTY, slots + FLAT_MAP_GROUP);
+    return entries;
+}
@@ -0,0 +1,234 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hash_table.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  HashTable implements
+ * ------------------------------------------------------------------------ */
+
+static ListRef *__myutil_hash_table_allocBuckets(AllocatorRef allocator, size_t count)
+{
+    ListRef *buckets = (ListRef *)Allocator_alloc(allocator, sizeof(ListRef) * count);
+    if (buckets != NULL)
+        memset(buckets, 0, sizeof(ListRef) * count);
+    return buckets;
+}
+
+/* get the bucket where entries of hash live, old bucket if not migrated. */
+static inline ListRef *__myutil_hash_table_bucket(HashTableRef self, uint32_t hash)
+{
+    if (self->old != NULL)
+    {
+        size_t index = hash & self->oldMask;
+        if (index >= self->rehashIndex)
+            return &self->old[index];
+    }
+    return &self->buckets[hash & self->mask];
+}
+
+/* start an incremental resize to double bucket count. */
+static void __myutil_hash_table_grow(HashTableRef self)
+{
+    size_t count = (self->mask + 1) << 1;
+    ListRef *buckets = __myutil_hash_table_allocBuckets(self->allocator, count);
+
+    /* allocate failed, keep going with longer chains. */
+    if (buckets == NULL)
+        return;
+
+    self->old = self->buckets;
+    self->oldMask = self->mask;
+    self->rehashIndex = 0;
+    self->buckets = buckets;
+    self->mask = count - 1;
+}
+
+/**
+ * Init hash table.
+ * 
+ * @param self: the HashTable object to be init.
+ * @param allocator: the allocator of bucket arrays.
+ * @param capacity: initial bucket count, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool HashTable_init(HashTableRef self, AllocatorRef allocator, size_t capacity)
+{
+    size_t count = 1;
+    while (count < capacity)
+        count <<= 1;
+
+    self->allocator = allocator;
+    self->buckets = __myutil_hash_table_allocBuckets(allocator, count);
+    self->mask = count - 1;
+    self->old = NULL;
+    self->oldMask = 0;
+    self->rehashIndex = 0;
+    self->count = 0;
+
+    return self->buckets != NULL;
+}
+
+/**
+ * Release bucket arrays. Entries are owned by user and untouched.
+ * 
+ * @param self: the HashTable object.
+ */
+void HashTable_destroy(HashTableRef self)
+{
+    if (self->old != NULL)
+        Allocator_free(self->allocator, self->old);
+    if (self->buckets != NULL)
+        Allocator_free(self->allocator, self->buckets);
+
+    self->old = self->buckets = NULL;
+    self->count = 0;
+}
+
+/**
+ * Migrate some old buckets to current bucket array.
+ * 
+ * @param self: the HashTable object.
+ * @param steps: max count of old buckets to migrate.
+ * @return true if still resizing, false if done.
+ */
+bool HashTable_rehash(HashTableRef self, size_t steps)
+{
+    while (self->old != NULL && steps-- > 0)
+    {
+        ListRef node = self->old[self->rehashIndex];
+        while (node != NULL)
+        {
+            ListRef next = node->next;
+            ListRef *bucket = &self->buckets[DOWN_CAST(node, HashNode)->hash & self->mask];
+            node->next = *bucket;
+            *bucket = node;
+            node = next;
+        }
+        self->old[self->rehashIndex] = NULL;
+
+        if (++self->rehashIndex > self->oldMask)
+        {
+            /* all migrated */
+            Allocator_free(self->allocator, self->old);
+            self->old = NULL;
+        }
+    }
+
+    return self->old != NULL;
+}
+
+/**
+ * Insert an entry. Duplicated keys are not checked.
+ * 
+ * @param self: the HashTable object.
+ * @param node: the entry to be insert.
+ * @param hash: the hash value of entry key.
+ */
+void HashTable_insert(HashTableRef self, HashNodeRef node, uint32_t hash)
+{
+    if (self->old == NULL && self->count > self->mask)
+        __myutil_hash_table_grow(self);
+    HashTable_rehash(self, HASH_TABLE_REHASH_STEP);
+
+    ListRef *bucket = __myutil_hash_table_bucket(self, hash);
+    node->hash = hash;
+    node->super.next = *bucket;
+    *bucket = &node->super;
+    self->count++;
+}
+
+/**
+ * Find an entry by key.
+ * 
+ * @param self: the HashTable object.
+ * @param hash: the hash value of key.
+ * @param key: the key to be compared by equal.
+ * @param equal: the key compare function.
+ * @return the entry, or NULL if not found.
+ */
+HashNodeRef HashTable_find(HashTableRef self, uint32_t hash, void const *key, HashNodeEqual equal)
+{
+    ListRef node = *__myutil_hash_table_bucket(self, hash);
+    for (; node != NULL; node = node->next)
+    {
+        HashNodeRef entry = DOWN_CAST(node, HashNode);
+        if (entry->hash == hash && equal(entry, key))
+            return entry;
+    }
+    return NULL;
+}
+
+/**
+ * Remove an entry by key.
+ * 
+ * @param self: the HashTable object.
+ * @param hash: the hash value of key.
+ * @param key: the key to be compared by equal.
+ * @param equal: the key compare function.
+ * @return the removed entry, or NULL if not found.
+ */
+HashNodeRef HashTable_remove(HashTableRef self, uint32_t hash, void const *key, HashNodeEqual equal)
+{
+    HashTable_rehash(self, HASH_TABLE_REHASH_STEP);
+
+    ListRef *link = __myutil_hash_table_bucket(self, hash);
+    for (; *link != NULL; link = &(*link)->next)
+    {
+        HashNodeRef entry = DOWN_CAST(*link, HashNode);
+        if (entry->hash == hash && equal(entry, key))
+        {
+            *link = entry->super.next;
+            entry->super.next = NULL;
+            self->count--;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Remove an entry which is in the table.
+ * 
+ * @param self: the HashTable object.
+ * @param node: the entry to be removed.
+ * @return true if removed, false if not found.
+ */
+bool HashTable_removeNode(HashTableRef self, HashNodeRef node)
+{
+    HashTable_rehash(self, HASH_TABLE_REHASH_STEP);
+
+    ListRef *link = __myutil_hash_table_bucket(self, node->hash);
+    for (; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == &node->super)
+        {
+            *link = node->super.next;
+            node->super.next = NULL;
+            self->count--;
+            return true;
+        }
+    }
+    return false;
+}
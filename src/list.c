@@ -22,6 +22,57 @@
 
 #include "myutil.h"
 
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  List implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Move list nodes into one contiguous block in traversal order.
+ * 
+ * The block is allocated from dst and starts at the new head. List node
+ * must be the first member of objects, and whole objects are copied.
+ * 
+ * @param head: the pointer to head, updated to the new head.
+ * @param dst: the allocator of the block.
+ * @param nodeSize: the size of objects.
+ * @param relocate: called for every moved node, or NULL.
+ * @param arg: the argument of relocate.
+ * @return true if success, false if allocation failed and list is untouched.
+ */
+bool List_compact(ListRef *head, AllocatorRef dst, size_t nodeSize, ListRelocate relocate, void *arg)
+{
+    size_t stride = ALIGN(nodeSize, sizeof(void *)), count = 0;
+    ListRef node;
+    uint8_t *block;
+
+    LIST_FOREACH(node, *head)
+        count++;
+    if (count == 0)
+        return true;
+
+    block = (uint8_t *)Allocator_alloc(dst, stride * count);
+    if (block == NULL)
+        return false;
+
+    node = *head;
+    *head = (ListRef)block;
+    while (node != NULL)
+    {
+        ListRef next = node->next, to = (ListRef)block;
+
+        memcpy(to, node, nodeSize);
+        to->next = next == NULL ? NULL : (ListRef)(block + stride);
+        if (relocate != NULL)
+            relocate(node, to, arg);
+
+        node = next;
+        block += stride;
+    }
+    return true;
+}
+
 /* ---------------------------------------------------------------------------
  *  ListIter implements
  * ------------------------------------------------------------------------ */
@@ -54,6 +105,38 @@ bool ListIter_next(ListIter *self)
     return self->current != NULL;
 }
 
+/**
+ * Move iterator forward by up to n nodes, gather them in a batch.
+ * 
+ * Same as calling ListIter_next n times, iterator stops at the last
+ * gathered node.
+ * 
+ * @param self: the ListIter object pointer.
+ * @param out: the array to store nodes.
+ * @param n: the max count of nodes.
+ * @return the count of gathered nodes, 0 for iterator reaches the end.
+ */
+size_t ListIter_nextN(ListIterRef self, ListRef out[], size_t n)
+{
+    if (n == 0 || !ListIter_next(self))
+        return 0;
+
+    ListRef prev = self->prev, current = self->current;
+    size_t count = 0;
+
+    out[count++] = current;
+    while (count < n && current->next != NULL)
+    {
+        prev = current;
+        current = current->next;
+        out[count++] = current;
+    }
+
+    self->prev = prev;
+    self->current = current;
+    return count;
+}
+
 /**
  * Remove current item from list. 
  * 
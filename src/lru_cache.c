@@ -0,0 +1,368 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file lru_cache.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <pthread.h>
+
+/** LRU cache shard, a part of cache with its own lock. */
+typedef struct _LruShard
+{
+    pthread_mutex_t lock;   /**< shard lock */
+    HashTable table;        /**< key index */
+    DbListRef head;         /**< the most recently used entry */
+    size_t capacity;        /**< capacity of shard */
+    size_t size;            /**< charged size */
+} LruShard;
+
+/** allocator of shard indexes, serializes calls to the cache allocator. */
+typedef struct _LruIndexAllocator
+{
+    Allocator super;        /**< allocator interface */
+    AllocatorRef base;      /**< the cache allocator */
+    pthread_mutex_t lock;   /**< held during each call of base */
+} LruIndexAllocator;
+
+static void *__myutil_lru_cache_indexAlloc(AllocatorRef self, size_t size)
+{
+    LruIndexAllocator *self_ = DOWN_CAST(self, LruIndexAllocator);
+    void *p;
+
+    pthread_mutex_lock(&self_->lock);
+    p = Allocator_alloc(self_->base, size);
+    pthread_mutex_unlock(&self_->lock);
+    return p;
+}
+
+static void __myutil_lru_cache_indexFree(AllocatorRef self, void *p)
+{
+    LruIndexAllocator *self_ = DOWN_CAST(self, LruIndexAllocator);
+
+    pthread_mutex_lock(&self_->lock);
+    Allocator_free(self_->base, p);
+    pthread_mutex_unlock(&self_->lock);
+}
+
+static size_t __myutil_lru_cache_indexCapacity(AllocatorRef self)
+{
+    return Allocator_capacity(DOWN_CAST(self, LruIndexAllocator)->base);
+}
+
+static size_t __myutil_lru_cache_indexAvailable(AllocatorRef self)
+{
+    return Allocator_available(DOWN_CAST(self, LruIndexAllocator)->base);
+}
+
+static Allocator_vt const __lruIndexAllocator_vt = {
+    .alloc = __myutil_lru_cache_indexAlloc,
+    .free = __myutil_lru_cache_indexFree,
+    .capacity = __myutil_lru_cache_indexCapacity,
+    .available = __myutil_lru_cache_indexAvailable,
+};
+
+static inline LruShard *__myutil_lru_cache_shard(LruCacheRef self, uint32_t hash)
+{
+    /* high bits, low bits are used by bucket index. */
+    return &self->shards[(hash >> 16) & self->shardMask];
+}
+
+static inline void __myutil_lru_cache_lock(LruCacheRef self, LruShard *shard)
+{
+    if (self->locked)
+        pthread_mutex_lock(&shard->lock);
+}
+
+static inline void __myutil_lru_cache_unlock(LruCacheRef self, LruShard *shard)
+{
+    if (self->locked)
+        pthread_mutex_unlock(&shard->lock);
+}
+
+/* release the index allocator after all indexes are destroyed. */
+static void __myutil_lru_cache_releaseIndex(LruCacheRef self)
+{
+    if (self->index == NULL)
+        return;
+
+    pthread_mutex_destroy(&self->index->lock);
+    Allocator_free(self->allocator, self->index);
+    self->index = NULL;
+}
+
+/* unlink an entry from both index and recency list. */
+static void __myutil_lru_cache_unlink(LruShard *shard, LruNodeRef node)
+{
+    HashTable_removeNode(&shard->table, &node->super);
+    DbList_removeFrom(&node->list, &shard->head);
+    shard->size -= node->charge;
+}
+
+/* evict least recently used entries until shard fits its capacity. */
+static void __myutil_lru_cache_trim(LruCacheRef self, LruShard *shard)
+{
+    while (shard->size > shard->capacity && shard->head != NULL && shard->head->prev != shard->head)
+    {
+        /* tail is the least recently used one. */
+        LruNodeRef victim = DOWN_CAST_FROM(shard->head->prev, LruNode, list);
+        __myutil_lru_cache_unlink(shard, victim);
+        if (self->evict != NULL)
+            self->evict(victim, self->arg);
+    }
+}
+
+/**
+ * Init LRU cache.
+ * 
+ * @param self: the LruCache object to be init.
+ * @param allocator: the allocator of shards and indexes.
+ * @param capacity: the whole capacity, split evenly to shards.
+ * @param shards: shard count, rounded up to power of 2, each shard is
+ *      locked. Or LRU_CACHE_UNLOCKED for single thread.
+ * @param equal: the key compare function.
+ * @return true if success, false if allocation failed.
+ */
+bool LruCache_init(LruCacheRef self, AllocatorRef allocator, size_t capacity, size_t shards, HashNodeEqual equal)
+{
+    AllocatorRef indexAllocator = allocator;
+    size_t count = 1, i;
+    while (count < shards)
+        count <<= 1;
+
+    self->allocator = allocator;
+    self->shardMask = count - 1;
+    self->locked = shards != LRU_CACHE_UNLOCKED;
+    self->equal = equal;
+    self->evict = NULL;
+    self->arg = NULL;
+    self->index = NULL;
+
+    if (self->locked)
+    {
+        /* indexes of shards grow in parallel, the allocator may not be thread safe */
+        self->index = Allocator_new(allocator, LruIndexAllocator);
+        if (self->index == NULL)
+            return false;
+        self->index->super.vt = &__lruIndexAllocator_vt;
+        self->index->base = allocator;
+        pthread_mutex_init(&self->index->lock, NULL);
+        indexAllocator = &self->index->super;
+    }
+
+    self->shards = (LruShard *)Allocator_alloc(allocator, sizeof(LruShard) * count);
+    if (self->shards == NULL)
+    {
+        __myutil_lru_cache_releaseIndex(self);
+        return false;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        LruShard *shard = &self->shards[i];
+        shard->head = NULL;
+        shard->size = 0;
+        shard->capacity = MAX(capacity / count, 1);
+        if (self->locked)
+            pthread_mutex_init(&shard->lock, NULL);
+
+        if (!HashTable_init(&shard->table, indexAllocator, MIN(shard->capacity, 1024)))
+        {
+            /* roll back initialized shards */
+            do
+            {
+                if (self->locked)
+                    pthread_mutex_destroy(&self->shards[i].lock);
+                HashTable_destroy(&self->shards[i].table);
+            } while (i-- > 0);
+            Allocator_free(allocator, self->shards);
+            self->shards = NULL;
+            __myutil_lru_cache_releaseIndex(self);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Release shards and indexes. Entries are untouched, see LruCache_clear().
+ * 
+ * @param self: the LruCache object.
+ */
+void LruCache_destroy(LruCacheRef self)
+{
+    size_t i;
+
+    if (self->shards == NULL)
+        return;
+
+    for (i = 0; i <= self->shardMask; i++)
+    {
+        HashTable_destroy(&self->shards[i].table);
+        if (self->locked)
+            pthread_mutex_destroy(&self->shards[i].lock);
+    }
+
+    Allocator_free(self->allocator, self->shards);
+    self->shards = NULL;
+    __myutil_lru_cache_releaseIndex(self);
+}
+
+/**
+ * Put an entry to cache as the most recently used one.
+ * 
+ * @param self: the LruCache object.
+ * @param node: the entry to be put.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @param charge: the charged size of entry.
+ */
+void LruCache_put(LruCacheRef self, LruNodeRef node, uint32_t hash, void const *key, size_t charge)
+{
+    LruShard *shard = __myutil_lru_cache_shard(self, hash);
+    __myutil_lru_cache_lock(self, shard);
+
+    /* replace existing one */
+    HashNodeRef old = HashTable_remove(&shard->table, hash, key, self->equal);
+    if (old != NULL)
+    {
+        LruNodeRef oldNode = DOWN_CAST(old, LruNode);
+        DbList_removeFrom(&oldNode->list, &shard->head);
+        shard->size -= oldNode->charge;
+        if (self->evict != NULL && oldNode != node)
+            self->evict(oldNode, self->arg);
+    }
+
+    node->charge = charge;
+    HashTable_insert(&shard->table, &node->super, hash);
+    DbList_addToHead(&node->list, &shard->head);
+    shard->size += charge;
+
+    __myutil_lru_cache_trim(self, shard);
+    __myutil_lru_cache_unlock(self, shard);
+}
+
+/**
+ * Get an entry and mark it the most recently used one.
+ * 
+ * @param self: the LruCache object.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @return the entry, or NULL if not found.
+ */
+LruNodeRef LruCache_get(LruCacheRef self, uint32_t hash, void const *key)
+{
+    LruShard *shard = __myutil_lru_cache_shard(self, hash);
+    __myutil_lru_cache_lock(self, shard);
+
+    HashNodeRef found = HashTable_find(&shard->table, hash, key, self->equal);
+    LruNodeRef node = NULL;
+    if (found != NULL)
+    {
+        node = DOWN_CAST(found, LruNode);
+        if (shard->head != &node->list)
+        {
+            /* move to head */
+            DbList_removeFrom(&node->list, &shard->head);
+            DbList_addToHead(&node->list, &shard->head);
+        }
+    }
+
+    __myutil_lru_cache_unlock(self, shard);
+    return node;
+}
+
+/**
+ * Remove an entry without calling eviction callback.
+ * 
+ * @param self: the LruCache object.
+ * @param hash: the hash value of key.
+ * @param key: the key of entry.
+ * @return the removed entry, or NULL if not found.
+ */
+LruNodeRef LruCache_remove(LruCacheRef self, uint32_t hash, void const *key)
+{
+    LruShard *shard = __myutil_lru_cache_shard(self, hash);
+    __myutil_lru_cache_lock(self, shard);
+
+    HashNodeRef found = HashTable_remove(&shard->table, hash, key, self->equal);
+    LruNodeRef node = NULL;
+    if (found != NULL)
+    {
+        node = DOWN_CAST(found, LruNode);
+        DbList_removeFrom(&node->list, &shard->head);
+        shard->size -= node->charge;
+    }
+
+    __myutil_lru_cache_unlock(self, shard);
+    return node;
+}
+
+/**
+ * Evict all entries.
+ * 
+ * @param self: the LruCache object.
+ */
+void LruCache_clear(LruCacheRef self)
+{
+    size_t i;
+    for (i = 0; i <= self->shardMask; i++)
+    {
+        LruShard *shard = &self->shards[i];
+        __myutil_lru_cache_lock(self, shard);
+        while (shard->head != NULL)
+        {
+            LruNodeRef victim = DOWN_CAST_FROM(shard->head->prev, LruNode, list);
+            __myutil_lru_cache_unlink(shard, victim);
+            if (self->evict != NULL)
+                self->evict(victim, self->arg);
+        }
+        __myutil_lru_cache_unlock(self, shard);
+    }
+}
+
+/**
+ * Get the entry count of all shards.
+ * 
+ * @param self: the LruCache object.
+ * @return the count of entries.
+ */
+size_t LruCache_count(LruCacheRef self)
+{
+    size_t i, count = 0;
+    for (i = 0; i <= self->shardMask; i++)
+        count += __atomic_load_n(&self->shards[i].table.count, __ATOMIC_RELAXED);
+    return count;
+}
+
+/**
+ * Get the charged size of all shards.
+ * 
+ * @param self: the LruCache object.
+ * @return the sum of entry charges.
+ */
+size_t LruCache_size(LruCacheRef self)
+{
+    size_t i, size = 0;
+    for (i = 0; i <= self->shardMask; i++)
+        size += __atomic_load_n(&self->shards[i].size, __ATOMIC_RELAXED);
+    return size;
+}
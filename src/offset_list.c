@@ -0,0 +1,386 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file offset_list.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+/* ---------------------------------------------------------------------------
+ *  OffArena implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Init arena, allocate a block from parent allocator.
+ * 
+ * @param self: the OffArena object to be init.
+ * @param parent: the allocator of the block.
+ * @param size: the block size, up to 4GB.
+ * @return true if success, false if allocation failed.
+ */
+bool OffArena_init(OffArenaRef self, AllocatorRef parent, size_t size)
+{
+    if ((uint64_t)size > UINT32_MAX)
+        return false;
+
+    self->parent = parent;
+    self->base = (uint8_t *)Allocator_alloc(parent, size);
+    if (self->base == NULL)
+        return false;
+
+    /* the static allocator header takes offset 0, no node could be there. */
+    self->allocator = StaticAllocator(size, self->base);
+    if (self->allocator == NULL)
+    {
+        Allocator_free(parent, self->base);
+        self->base = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Release the block, nodes in the arena are gone.
+ * 
+ * @param self: the OffArena object.
+ */
+void OffArena_destroy(OffArenaRef self)
+{
+    if (self->base == NULL)
+        return;
+
+    Allocator_free(self->parent, self->base);
+    self->base = NULL;
+    self->allocator = NULL;
+}
+
+/* ---------------------------------------------------------------------------
+ *  OffListIter implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool OffListIter_next(OffListIterRef self)
+{
+    if (self->current == NULL)
+    {
+        /* at the end */
+        return false;
+    }
+
+    if (self->current == self->prev)
+    {
+        /* initial status, move to first one */
+        self->prev = NULL;
+    }
+    else
+    {
+        /* move to next node */
+        self->prev = self->current;
+        self->current = OffList_next(self->current, self->arena);
+    }
+
+    return self->current != NULL;
+}
+
+/**
+ * Remove current item from list.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to removed node.
+ */
+OffListRef OffListIter_remove(OffListIterRef self, OffListRef *head)
+{
+    if (self->current == NULL ||
+        (self->current == self->prev && !OffListIter_next(self)))
+    {
+        /* initial status or end */
+        return NULL;
+    }
+
+    OffListRef node = self->current;
+    self->current = OffList_next(node, self->arena);
+    if (self->prev == NULL)
+    {
+        /* head status */
+        if (head != NULL)
+            *head = self->current;
+    }
+    else
+    {
+        /* normal status */
+        self->prev->next = node->next;
+    }
+
+    return node;
+}
+
+/**
+ * Insert new node to current position.
+ * 
+ * @param self: the OffListIter object pointer.
+ * @param node: the node to be insert, in the same arena.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to inserted node, or NULL if failed.
+ */
+OffListRef OffListIter_insert(OffListIterRef self, OffListRef node, OffListRef *head)
+{
+    if (self->current == self->prev && !OffListIter_next(self))
+    {
+        /* initial status */
+        return NULL;
+    }
+
+    /* link node before current, */
+    OffList_setNext(node, self->arena, self->current);
+
+    if (self->prev == NULL)
+    {
+        /* head */
+        if (head != NULL)
+            *head = node;
+    }
+    else
+    {
+        /* normal or end */
+        OffList_setNext(self->prev, self->arena, node);
+    }
+    self->current = node;
+
+    return node;
+}
+
+/* ---------------------------------------------------------------------------
+ *  OffDbList implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Remove double list node from list, update head if needed.
+ * 
+ * @param self: the OffDbList node to be remove.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_removeFrom(OffDbListRef self, OffArenaRef arena, OffDbListRef *head)
+{
+    if (OffDbList_next(self, arena) == self)
+    {
+        *head = NULL;
+        self->next = self->prev = OFF_NULL;
+    }
+    else
+    {
+        if (*head == self)
+            *head = OffDbList_next(self, arena);
+        OffDbList_remove(self, arena);
+    }
+}
+
+/**
+ * Add double list node to list tail.
+ * 
+ * @param self: the OffDbList node to be insert.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_addToTail(OffDbListRef self, OffArenaRef arena, OffDbListRef *head)
+{
+    if (*head == NULL)
+    {
+        OffDbList_init(self, arena);
+        *head = self;
+    }
+    else
+    {
+        OffDbList_insert(self, arena, *head);
+    }
+}
+
+/**
+ * Add double list node to list head.
+ * 
+ * @param self: the OffDbList node to be insert.
+ * @param arena: the arena of list.
+ * @param head: the pointer to head, should not be NULL.
+ */
+void OffDbList_addToHead(OffDbListRef self, OffArenaRef arena, OffDbListRef *head)
+{
+    if (*head == NULL)
+        OffDbList_init(self, arena);
+    else
+        OffDbList_insert(self, arena, *head);
+    *head = self;
+}
+
+/* ---------------------------------------------------------------------------
+ *  OffDbListIter implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool OffDbListIter_next(OffDbListIterRef self)
+{
+    if (self->head == NULL)
+    {
+        /* initial status or empty */
+        self->head = self->current;
+        return self->current != NULL;
+    }
+
+    OffDbListRef next = OffDbList_next(self->current, self->arena);
+    if (next == self->head)
+    {
+        /* end */
+        return false;
+    }
+
+    /* move to next */
+    self->current = next;
+    return true;
+}
+
+/**
+ * Move iterator to previouse node.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @return a booean, false for iterator reaches the head, otherwise true.
+ */
+bool OffDbListIter_prev(OffDbListIterRef self)
+{
+    if (self->current == self->head)
+    {
+        /* head or empty */
+        return false;
+    }
+
+    if (self->head == NULL)
+    {
+        /* initial status */
+        self->head = self->current;
+        /* do not return */
+    }
+
+    /* move previous */
+    self->current = OffDbList_prev(self->current, self->arena);
+    return true;
+}
+
+/**
+ * Remove current item from double list.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to removed node.
+ */
+OffDbListRef OffDbListIter_remove(OffDbListIterRef self, OffDbListRef *head)
+{
+    if (self->head == NULL && !OffDbListIter_next(self))
+    {
+        /* inital status, or empty */
+        return NULL;
+    }
+
+    OffDbListRef node = self->current;
+    if (OffDbList_next(node, self->arena) == node)
+    {
+        /* the only one. */
+        self->head = self->current = NULL;
+        if (head != NULL)
+            *head = NULL;
+        node->next = node->prev = OFF_NULL;
+        return node;
+    }
+
+    /* move iter to next. */
+    self->current = OffDbList_next(node, self->arena);
+
+    /* remove node from list. */
+    OffDbList_remove(node, self->arena);
+
+    if (self->head == node)
+    {
+        /* head */
+        self->head = self->current;
+        if (head != NULL)
+            *head = self->head;
+    }
+
+    return node;
+}
+
+/**
+ * Insert new node to current position of double list.
+ * 
+ * @param self: the OffDbListIter object pointer.
+ * @param node: the node to be insert, in the same arena.
+ * @param head: the head pointer which be may updated after removal. 
+ *      Or NULL if don't care.
+ * 
+ * @return a pointer to inserted node.
+ */
+OffDbListRef OffDbListIter_insert(OffDbListIterRef self, OffDbListRef node, OffDbListRef *head)
+{
+    if (self->head == NULL && !OffDbListIter_next(self))
+    {
+        /* inital status, no item in list. */
+        OffDbList_init(node, self->arena);
+        self->current = node;
+        self->head = self->current;
+        return node;
+    }
+
+    OffDbListRef current = self->current;
+
+    /* link node to double list. */
+    OffDbList_insert(node, self->arena, current);
+
+    if (self->head == current)
+    {
+        /* head */
+        if (head == NULL)
+        {
+            /* if head is not specified, insert node in tail. Do not move
+             iterator. */
+            return node;
+        }
+
+        /* move head to new node. */
+        self->head = node;
+        *head = node;
+    }
+
+    /* move current to node */
+    self->current = node;
+    return node;
+}
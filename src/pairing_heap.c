@@ -0,0 +1,187 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pairing_heap.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+/* ---------------------------------------------------------------------------
+ *  PairHeap implements
+ * ------------------------------------------------------------------------ */
+
+/* link two root nodes, the larger one becomes leftmost child. */
+static PairNodeRef __myutil_pairing_heap_meld(PairHeapRef self, PairNodeRef a, PairNodeRef b)
+{
+    if (a == NULL)
+        return b;
+    if (b == NULL)
+        return a;
+
+    if (self->compare(b, a) < 0)
+    {
+        PairNodeRef t = a;
+        a = b;
+        b = t;
+    }
+
+    b->next = a->child;
+    if (a->child != NULL)
+        a->child->prev = b;
+    b->prev = a;
+    a->child = b;
+    return a;
+}
+
+/* two pass combine of siblings: meld pairs left to right, then fold them
+ * right to left. */
+static PairNodeRef __myutil_pairing_heap_combine(PairHeapRef self, PairNodeRef first)
+{
+    PairNodeRef stack = NULL, root;
+
+    while (first != NULL)
+    {
+        PairNodeRef a = first, b = first->next;
+
+        first = b == NULL ? NULL : b->next;
+        a->next = a->prev = NULL;
+        if (b != NULL)
+        {
+            b->next = b->prev = NULL;
+            a = __myutil_pairing_heap_meld(self, a, b);
+        }
+
+        /* push, reuse next as stack link */
+        a->next = stack;
+        stack = a;
+    }
+
+    if (stack == NULL)
+        return NULL;
+
+    root = stack;
+    stack = stack->next;
+    root->next = NULL;
+    while (stack != NULL)
+    {
+        PairNodeRef node = stack;
+        stack = node->next;
+        node->next = NULL;
+        root = __myutil_pairing_heap_meld(self, root, node);
+    }
+    return root;
+}
+
+/* cut a non-root node with its subtree from the sibling list. */
+static void __myutil_pairing_heap_cut(PairNodeRef node)
+{
+    if (node->prev->child == node)
+        node->prev->child = node->next;
+    else
+        node->prev->next = node->next;
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+    node->next = node->prev = NULL;
+}
+
+/**
+ * Insert a node.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node to be insert.
+ */
+void PairHeap_insert(PairHeapRef self, PairNodeRef node)
+{
+    node->child = node->next = node->prev = NULL;
+    self->root = __myutil_pairing_heap_meld(self, self->root, node);
+    self->count++;
+}
+
+/**
+ * Move all nodes of other heap into this one, other becomes empty.
+ * 
+ * Both heaps must use the same compare function.
+ * 
+ * @param self: the PairHeap object.
+ * @param other: the heap to be merged.
+ */
+void PairHeap_merge(PairHeapRef self, PairHeapRef other)
+{
+    self->root = __myutil_pairing_heap_meld(self, self->root, other->root);
+    self->count += other->count;
+    other->root = NULL;
+    other->count = 0;
+}
+
+/**
+ * Remove the min node.
+ * 
+ * @param self: the PairHeap object.
+ * @return the min node, or NULL if empty.
+ */
+PairNodeRef PairHeap_pop(PairHeapRef self)
+{
+    PairNodeRef root = self->root;
+
+    if (root == NULL)
+        return NULL;
+
+    self->root = __myutil_pairing_heap_combine(self, root->child);
+    root->child = NULL;
+    self->count--;
+    return root;
+}
+
+/**
+ * Restore heap order after the key of node decreased.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node with a smaller key.
+ */
+void PairHeap_decrease(PairHeapRef self, PairNodeRef node)
+{
+    if (node == self->root)
+        return;
+
+    __myutil_pairing_heap_cut(node);
+    self->root = __myutil_pairing_heap_meld(self, self->root, node);
+}
+
+/**
+ * Remove a node.
+ * 
+ * @param self: the PairHeap object.
+ * @param node: the node to be removed.
+ */
+void PairHeap_remove(PairHeapRef self, PairNodeRef node)
+{
+    PairNodeRef sub;
+
+    if (node == self->root)
+    {
+        PairHeap_pop(self);
+        return;
+    }
+
+    __myutil_pairing_heap_cut(node);
+    sub = __myutil_pairing_heap_combine(self, node->child);
+    node->child = NULL;
+    self->root = __myutil_pairing_heap_meld(self, self->root, sub);
+    self->count--;
+}
@@ -0,0 +1,502 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rb_tree.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+/* ---------------------------------------------------------------------------
+ *  RbNode implements
+ * ------------------------------------------------------------------------ */
+
+static inline bool __myutil_rb_tree_isBlack(RbNodeRef node)
+{
+    /* NULL leaves are black */
+    return node == NULL || RbNode_color(node) == RB_BLACK;
+}
+
+static inline void __myutil_rb_tree_setParent(RbNodeRef node, RbNodeRef parent)
+{
+    node->parentColor = (uintptr_t)parent | (node->parentColor & 1);
+}
+
+static inline void __myutil_rb_tree_setColor(RbNodeRef node, int color)
+{
+    node->parentColor = (node->parentColor & ~(uintptr_t)1) | (uintptr_t)color;
+}
+
+/* replace child of parent, or root if parent is NULL. */
+static inline void __myutil_rb_tree_replaceChild(RbTreeRef self, RbNodeRef parent, RbNodeRef old, RbNodeRef node)
+{
+    if (parent == NULL)
+        self->root = node;
+    else if (parent->left == old)
+        parent->left = node;
+    else
+        parent->right = node;
+}
+
+static void __myutil_rb_tree_rotateLeft(RbTreeRef self, RbNodeRef x)
+{
+    RbNodeRef y = x->right;
+
+    x->right = y->left;
+    if (y->left != NULL)
+        __myutil_rb_tree_setParent(y->left, x);
+
+    __myutil_rb_tree_setParent(y, RbNode_parent(x));
+    __myutil_rb_tree_replaceChild(self, RbNode_parent(x), x, y);
+
+    y->left = x;
+    __myutil_rb_tree_setParent(x, y);
+}
+
+static void __myutil_rb_tree_rotateRight(RbTreeRef self, RbNodeRef x)
+{
+    RbNodeRef y = x->left;
+
+    x->left = y->right;
+    if (y->right != NULL)
+        __myutil_rb_tree_setParent(y->right, x);
+
+    __myutil_rb_tree_setParent(y, RbNode_parent(x));
+    __myutil_rb_tree_replaceChild(self, RbNode_parent(x), x, y);
+
+    y->right = x;
+    __myutil_rb_tree_setParent(x, y);
+}
+
+/**
+ * Get in-order next node.
+ * 
+ * @param self: the RbNode object.
+ * @return the next node, or NULL if self is the last one.
+ */
+RbNodeRef RbNode_next(RbNodeRef self)
+{
+    RbNodeRef parent;
+
+    if (self->right != NULL)
+    {
+        /* the left most one of right sub tree */
+        self = self->right;
+        while (self->left != NULL)
+            self = self->left;
+        return self;
+    }
+
+    /* go up until coming from a left child */
+    while ((parent = RbNode_parent(self)) != NULL && self == parent->right)
+        self = parent;
+    return parent;
+}
+
+/**
+ * Get in-order previous node.
+ * 
+ * @param self: the RbNode object.
+ * @return the previous node, or NULL if self is the first one.
+ */
+RbNodeRef RbNode_prev(RbNodeRef self)
+{
+    RbNodeRef parent;
+
+    if (self->left != NULL)
+    {
+        /* the right most one of left sub tree */
+        self = self->left;
+        while (self->right != NULL)
+            self = self->right;
+        return self;
+    }
+
+    /* go up until coming from a right child */
+    while ((parent = RbNode_parent(self)) != NULL && self == parent->left)
+        self = parent;
+    return parent;
+}
+
+/* ---------------------------------------------------------------------------
+ *  RbTree implements
+ * ------------------------------------------------------------------------ */
+
+static void __myutil_rb_tree_insertFixup(RbTreeRef self, RbNodeRef node)
+{
+    RbNodeRef parent, grand, uncle;
+
+    while ((parent = RbNode_parent(node)) != NULL && RbNode_color(parent) == RB_RED)
+    {
+        /* red parent is never root, grand exists. */
+        grand = RbNode_parent(parent);
+        if (parent == grand->left)
+        {
+            uncle = grand->right;
+            if (!__myutil_rb_tree_isBlack(uncle))
+            {
+                /* recolor and move up */
+                __myutil_rb_tree_setColor(parent, RB_BLACK);
+                __myutil_rb_tree_setColor(uncle, RB_BLACK);
+                __myutil_rb_tree_setColor(grand, RB_RED);
+                node = grand;
+                continue;
+            }
+
+            if (node == parent->right)
+            {
+                __myutil_rb_tree_rotateLeft(self, parent);
+                node = parent;
+                parent = RbNode_parent(node);
+            }
+            __myutil_rb_tree_setColor(parent, RB_BLACK);
+            __myutil_rb_tree_setColor(grand, RB_RED);
+            __myutil_rb_tree_rotateRight(self, grand);
+        }
+        else
+        {
+            uncle = grand->left;
+            if (!__myutil_rb_tree_isBlack(uncle))
+            {
+                /* recolor and move up */
+                __myutil_rb_tree_setColor(parent, RB_BLACK);
+                __myutil_rb_tree_setColor(uncle, RB_BLACK);
+                __myutil_rb_tree_setColor(grand, RB_RED);
+                node = grand;
+                continue;
+            }
+
+            if (node == parent->left)
+            {
+                __myutil_rb_tree_rotateRight(self, parent);
+                node = parent;
+                parent = RbNode_parent(node);
+            }
+            __myutil_rb_tree_setColor(parent, RB_BLACK);
+            __myutil_rb_tree_setColor(grand, RB_RED);
+            __myutil_rb_tree_rotateLeft(self, grand);
+        }
+    }
+
+    __myutil_rb_tree_setColor(self->root, RB_BLACK);
+}
+
+/* node may be NULL leaf, so its parent is passed. */
+static void __myutil_rb_tree_eraseFixup(RbTreeRef self, RbNodeRef node, RbNodeRef parent)
+{
+    RbNodeRef sibling;
+
+    while (node != self->root && __myutil_rb_tree_isBlack(node))
+    {
+        if (node == parent->left)
+        {
+            sibling = parent->right;
+            if (!__myutil_rb_tree_isBlack(sibling))
+            {
+                __myutil_rb_tree_setColor(sibling, RB_BLACK);
+                __myutil_rb_tree_setColor(parent, RB_RED);
+                __myutil_rb_tree_rotateLeft(self, parent);
+                sibling = parent->right;
+            }
+
+            if (__myutil_rb_tree_isBlack(sibling->left) && __myutil_rb_tree_isBlack(sibling->right))
+            {
+                __myutil_rb_tree_setColor(sibling, RB_RED);
+                node = parent;
+                parent = RbNode_parent(node);
+                continue;
+            }
+
+            if (__myutil_rb_tree_isBlack(sibling->right))
+            {
+                __myutil_rb_tree_setColor(sibling->left, RB_BLACK);
+                __myutil_rb_tree_setColor(sibling, RB_RED);
+                __myutil_rb_tree_rotateRight(self, sibling);
+                sibling = parent->right;
+            }
+            __myutil_rb_tree_setColor(sibling, RbNode_color(parent));
+            __myutil_rb_tree_setColor(parent, RB_BLACK);
+            __myutil_rb_tree_setColor(sibling->right, RB_BLACK);
+            __myutil_rb_tree_rotateLeft(self, parent);
+        }
+        else
+        {
+            sibling = parent->left;
+            if (!__myutil_rb_tree_isBlack(sibling))
+            {
+                __myutil_rb_tree_setColor(sibling, RB_BLACK);
+                __myutil_rb_tree_setColor(parent, RB_RED);
+                __myutil_rb_tree_rotateRight(self, parent);
+                sibling = parent->left;
+            }
+
+            if (__myutil_rb_tree_isBlack(sibling->left) && __myutil_rb_tree_isBlack(sibling->right))
+            {
+                __myutil_rb_tree_setColor(sibling, RB_RED);
+                node = parent;
+                parent = RbNode_parent(node);
+                continue;
+            }
+
+            if (__myutil_rb_tree_isBlack(sibling->left))
+            {
+                __myutil_rb_tree_setColor(sibling->right, RB_BLACK);
+                __myutil_rb_tree_setColor(sibling, RB_RED);
+                __myutil_rb_tree_rotateLeft(self, sibling);
+                sibling = parent->left;
+            }
+            __myutil_rb_tree_setColor(sibling, RbNode_color(parent));
+            __myutil_rb_tree_setColor(parent, RB_BLACK);
+            __myutil_rb_tree_setColor(sibling->left, RB_BLACK);
+            __myutil_rb_tree_rotateRight(self, parent);
+        }
+
+        /* balanced */
+        node = self->root;
+        break;
+    }
+
+    if (node != NULL)
+        __myutil_rb_tree_setColor(node, RB_BLACK);
+}
+
+/**
+ * Insert a node. Duplicated keys are kept, the new one last.
+ * 
+ * @param self: the RbTree object.
+ * @param node: the node to be insert.
+ * @param key: the key of node.
+ */
+void RbTree_insert(RbTreeRef self, RbNodeRef node, void const *key)
+{
+    RbNodeRef *link = &self->root, parent = NULL;
+
+    while (*link != NULL)
+    {
+        parent = *link;
+        if (self->compare(parent, key) > 0)
+            link = &parent->left;
+        else
+            link = &parent->right;
+    }
+
+    node->parentColor = (uintptr_t)parent | RB_RED;
+    node->left = node->right = NULL;
+    *link = node;
+    self->count++;
+
+    __myutil_rb_tree_insertFixup(self, node);
+}
+
+/**
+ * Erase a node from tree.
+ * 
+ * @param self: the RbTree object.
+ * @param node: the node in tree to be erased.
+ */
+void RbTree_erase(RbTreeRef self, RbNodeRef node)
+{
+    RbNodeRef child, parent;
+    int color;
+
+    if (node->left == NULL || node->right == NULL)
+    {
+        /* at most one child, replace node by it. */
+        child = node->left != NULL ? node->left : node->right;
+        parent = RbNode_parent(node);
+        color = RbNode_color(node);
+
+        if (child != NULL)
+            __myutil_rb_tree_setParent(child, parent);
+        __myutil_rb_tree_replaceChild(self, parent, node, child);
+    }
+    else
+    {
+        /* replace node by its successor. */
+        RbNodeRef next = node->right;
+        while (next->left != NULL)
+            next = next->left;
+
+        color = RbNode_color(next);
+        child = next->right;
+        parent = RbNode_parent(next);
+
+        if (parent == node)
+        {
+            parent = next;
+        }
+        else
+        {
+            /* unlink successor */
+            if (child != NULL)
+                __myutil_rb_tree_setParent(child, parent);
+            parent->left = child;
+
+            next->right = node->right;
+            __myutil_rb_tree_setParent(node->right, next);
+        }
+
+        next->left = node->left;
+        __myutil_rb_tree_setParent(node->left, next);
+
+        __myutil_rb_tree_replaceChild(self, RbNode_parent(node), node, next);
+        next->parentColor = node->parentColor;
+    }
+
+    node->parentColor = 0;
+    node->left = node->right = NULL;
+    self->count--;
+
+    if (color == RB_BLACK)
+        __myutil_rb_tree_eraseFixup(self, child, parent);
+}
+
+/**
+ * Find a node with equal key.
+ * 
+ * @param self: the RbTree object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if not found.
+ */
+RbNodeRef RbTree_find(RbTreeRef self, void const *key)
+{
+    RbNodeRef node = RbTree_lowerBound(self, key);
+    if (node != NULL && self->compare(node, key) == 0)
+        return node;
+    return NULL;
+}
+
+/**
+ * Find the first node whose key is not less than key.
+ * 
+ * @param self: the RbTree object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if all keys are less.
+ */
+RbNodeRef RbTree_lowerBound(RbTreeRef self, void const *key)
+{
+    RbNodeRef node = self->root, found = NULL;
+
+    while (node != NULL)
+    {
+        if (self->compare(node, key) >= 0)
+        {
+            found = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+    return found;
+}
+
+/**
+ * Get the first node.
+ * 
+ * @param self: the RbTree object.
+ * @return the node with the least key, or NULL if empty.
+ */
+RbNodeRef RbTree_first(RbTreeRef self)
+{
+    RbNodeRef node = self->root;
+    if (node != NULL)
+    {
+        while (node->left != NULL)
+            node = node->left;
+    }
+    return node;
+}
+
+/**
+ * Get the last node.
+ * 
+ * @param self: the RbTree object.
+ * @return the node with the greatest key, or NULL if empty.
+ */
+RbNodeRef RbTree_last(RbTreeRef self)
+{
+    RbNodeRef node = self->root;
+    if (node != NULL)
+    {
+        while (node->right != NULL)
+            node = node->right;
+    }
+    return node;
+}
+
+/* ---------------------------------------------------------------------------
+ *  RbTreeIter implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Move iterator to next node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a booean, false for iterator reaches the end, otherwise true.
+ */
+bool RbTreeIter_next(RbTreeIterRef self)
+{
+    RbNodeRef next;
+
+    if (self->current == NULL)
+    {
+        /* initial status */
+        self->current = self->next;
+        return self->current != NULL;
+    }
+
+    next = RbNode_next(self->current);
+    if (next == NULL)
+    {
+        /* end, keep current */
+        return false;
+    }
+
+    self->current = next;
+    return true;
+}
+
+/**
+ * Move iterator to previous node.
+ * 
+ * @param self: the RbTreeIter object pointer.
+ * @return a booean, false for iterator reaches the head, otherwise true.
+ */
+bool RbTreeIter_prev(RbTreeIterRef self)
+{
+    RbNodeRef prev;
+
+    if (self->current == NULL)
+    {
+        /* initial status */
+        self->current = self->prev;
+        return self->current != NULL;
+    }
+
+    prev = RbNode_prev(self->current);
+    if (prev == NULL)
+    {
+        /* head, keep current */
+        return false;
+    }
+
+    self->current = prev;
+    return true;
+}
@@ -0,0 +1,140 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rcu.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <sched.h>
+
+/**
+ * Init RCU domain.
+ * 
+ * @param self: the Rcu object to be init.
+ */
+void Rcu_init(RcuRef self)
+{
+    self->epoch = 1;
+    self->readers = NULL;
+    self->callbacks = NULL;
+}
+
+/**
+ * Register a reader to RCU domain.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader to be registered.
+ */
+void Rcu_register(RcuRef self, RcuReaderRef reader)
+{
+    reader->epoch = 0;
+    reader->nesting = 0;
+    reader->super.next = self->readers;
+    self->readers = &reader->super;
+}
+
+/**
+ * Unregister a reader from RCU domain. The reader should be offline.
+ * 
+ * @param self: the Rcu object.
+ * @param reader: the reader to be unregistered.
+ */
+void Rcu_unregister(RcuRef self, RcuReaderRef reader)
+{
+    ListIter it = ListIter_new(self->readers);
+    while (ListIter_next(&it))
+    {
+        if (ListIter_current(&it) == &reader->super)
+        {
+            ListIter_remove(&it, &self->readers);
+            return;
+        }
+    }
+}
+
+/**
+ * Wait for a grace period.
+ * 
+ * Should not be called inside a read section of the same thread.
+ * 
+ * @param self: the Rcu object.
+ */
+void Rcu_synchronize(RcuRef self)
+{
+    /* removals must be visible before the new epoch. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t target = self->epoch + 1;
+    __atomic_store_n(&self->epoch, target, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    /* wait for readers which entered before the new epoch. */
+    ListIter it = ListIter_new(self->readers);
+    while (ListIter_next(&it))
+    {
+        RcuReaderRef reader = ListIter_curObj(it, RcuReader);
+        uint64_t epoch;
+        while ((epoch = __atomic_load_n(&reader->epoch, __ATOMIC_ACQUIRE)) != 0 && epoch < target)
+            sched_yield();
+    }
+}
+
+/**
+ * Queue a callback to be run after next grace period.
+ * 
+ * @param self: the Rcu object.
+ * @param head: the reclaim record embedded in removed object.
+ * @param func: the callback.
+ */
+void Rcu_call(RcuRef self, RcuHeadRef head, RcuCallback func)
+{
+    head->func = func;
+    head->super.next = self->callbacks;
+    self->callbacks = &head->super;
+}
+
+/**
+ * Wait one grace period for all queued callbacks, then run them.
+ * 
+ * @param self: the Rcu object.
+ * @return the count of callbacks run.
+ */
+size_t Rcu_reclaim(RcuRef self)
+{
+    ListRef node = self->callbacks;
+    size_t count = 0;
+
+    if (node == NULL)
+        return 0;
+
+    /* detach pending callbacks, callbacks may queue new ones. */
+    self->callbacks = NULL;
+    Rcu_synchronize(self);
+
+    while (node != NULL)
+    {
+        RcuHeadRef head = DOWN_CAST(node, RcuHead);
+        /* callback may free the node. */
+        node = node->next;
+        head->func(head);
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,359 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file rope.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  RopeChunk implements
+ * ------------------------------------------------------------------------ */
+
+/** refcounted memory, bytes follow the header for owned chunks */
+typedef struct _RopeChunk
+{
+    uint32_t refs;                          /**< segments referencing it */
+    uint8_t *data;                          /**< the memory */
+    size_t size;                            /**< bytes of memory */
+    size_t used;                            /**< bytes filled */
+    RopeRelease release;                    /**< release of external memory */
+    void *arg;                              /**< argument of release */
+    AllocatorRef allocator;                 /**< allocator of chunk */
+} RopeChunk;
+
+/** a range of chunk */
+typedef struct _RopeSegment
+{
+    List super;
+    RopeChunk *chunk;                       /**< the chunk */
+    size_t offset;                          /**< the first byte in chunk */
+    size_t length;                          /**< bytes of range */
+} RopeSegment;
+
+static RopeChunk *__myutil_rope_newChunk(AllocatorRef allocator, size_t size)
+{
+    /* keep the next allocation pointer aligned, allocator only rounds to 4. */
+    RopeChunk *chunk = (RopeChunk *)Allocator_alloc(allocator, sizeof(RopeChunk) + ALIGN(size, sizeof(void *)));
+    if (chunk != NULL)
+    {
+        chunk->refs = 1;
+        chunk->data = (uint8_t *)(chunk + 1);
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->release = NULL;
+        chunk->arg = NULL;
+        chunk->allocator = allocator;
+    }
+    return chunk;
+}
+
+static void __myutil_rope_releaseChunk(RopeChunk *chunk)
+{
+    if (__atomic_sub_fetch(&chunk->refs, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        if (chunk->release != NULL)
+            chunk->release(chunk->data, chunk->arg);
+        Allocator_free(chunk->allocator, chunk);
+    }
+}
+
+/* the chunk could be filled by the segment: owned, not shared, and the
+ * segment ends at the filled end. */
+static size_t __myutil_rope_room(RopeSegment *segment)
+{
+    RopeChunk *chunk = segment->chunk;
+    if (chunk->data != (uint8_t *)(chunk + 1) ||
+        __atomic_load_n(&chunk->refs, __ATOMIC_ACQUIRE) != 1 ||
+        segment->offset + segment->length != chunk->used)
+        return 0;
+    return chunk->size - chunk->used;
+}
+
+/* ---------------------------------------------------------------------------
+ *  Rope implements
+ * ------------------------------------------------------------------------ */
+
+static RopeSegment *__myutil_rope_newSegment(RopeRef self, RopeChunk *chunk, size_t offset, size_t length)
+{
+    RopeSegment *segment = (RopeSegment *)Allocator_alloc(self->allocator, sizeof(RopeSegment));
+    if (segment != NULL)
+    {
+        segment->super.next = NULL;
+        segment->chunk = chunk;
+        segment->offset = offset;
+        segment->length = length;
+    }
+    return segment;
+}
+
+static void __myutil_rope_freeSegment(RopeRef self, RopeSegment *segment)
+{
+    __myutil_rope_releaseChunk(segment->chunk);
+    Allocator_free(self->allocator, segment);
+}
+
+static void __myutil_rope_link(RopeRef self, RopeSegment *segment)
+{
+    if (self->tail != NULL)
+        self->tail->next = &segment->super;
+    else
+        self->head = &segment->super;
+    self->tail = &segment->super;
+    self->count++;
+    self->length += segment->length;
+}
+
+/* drop segments after tail, NULL to drop all. */
+static void __myutil_rope_truncate(RopeRef self, ListRef tail)
+{
+    ListRef node = tail == NULL ? self->head : tail->next;
+    while (node != NULL)
+    {
+        RopeSegment *segment = DOWN_CAST(node, RopeSegment);
+        node = node->next;
+        self->count--;
+        self->length -= segment->length;
+        __myutil_rope_freeSegment(self, segment);
+    }
+    if (tail == NULL)
+        self->head = NULL;
+    else
+        tail->next = NULL;
+    self->tail = tail;
+}
+
+/**
+ * Drop all segments, the rope is empty after.
+ * 
+ * @param self: the Rope object.
+ */
+void Rope_clear(RopeRef self)
+{
+    __myutil_rope_truncate(self, NULL);
+}
+
+/**
+ * Append a copy of bytes.
+ * 
+ * @param self: the Rope object.
+ * @param data: the bytes.
+ * @param len: the length of bytes.
+ * @return false if allocation failed and the rope is unchanged.
+ */
+bool Rope_append(RopeRef self, void const *data, size_t len)
+{
+    RopeSegment *tail = self->tail == NULL ? NULL : DOWN_CAST(self->tail, RopeSegment);
+    RopeSegment *segment = NULL;
+    RopeChunk *chunk = NULL;
+    size_t room = tail == NULL ? 0 : __myutil_rope_room(tail);
+
+    /* allocate first, so failure changes nothing. */
+    if (len > room)
+    {
+        chunk = __myutil_rope_newChunk(self->allocator, MAX(len - room, ROPE_CHUNK_SIZE - sizeof(RopeChunk)));
+        if (chunk == NULL)
+            return false;
+        segment = __myutil_rope_newSegment(self, chunk, 0, 0);
+        if (segment == NULL)
+        {
+            Allocator_free(self->allocator, chunk);
+            return false;
+        }
+    }
+
+    room = MIN(room, len);
+    if (room > 0)
+    {
+        memcpy(tail->chunk->data + tail->chunk->used, data, room);
+        tail->chunk->used += room;
+        tail->length += room;
+        self->length += room;
+    }
+
+    if (segment != NULL)
+    {
+        memcpy(chunk->data, (uint8_t const *)data + room, len - room);
+        chunk->used = segment->length = len - room;
+        __myutil_rope_link(self, segment);
+    }
+    return true;
+}
+
+/**
+ * Append existing memory without copy, O(1).
+ * 
+ * @param self: the Rope object.
+ * @param data: the memory, unchanged until released.
+ * @param len: the length of memory.
+ * @param release: called when no rope uses the memory, or NULL.
+ * @param arg: the argument of release.
+ * @return false if allocation failed, the memory is not released then.
+ */
+bool Rope_appendRef(RopeRef self, void const *data, size_t len, RopeRelease release, void *arg)
+{
+    RopeChunk *chunk = __myutil_rope_newChunk(self->allocator, 0);
+    RopeSegment *segment;
+
+    if (chunk == NULL)
+        return false;
+    segment = __myutil_rope_newSegment(self, chunk, 0, len);
+    if (segment == NULL)
+    {
+        Allocator_free(self->allocator, chunk);
+        return false;
+    }
+
+    chunk->data = (uint8_t *)data;
+    chunk->size = chunk->used = len;
+    chunk->release = release;
+    chunk->arg = arg;
+    __myutil_rope_link(self, segment);
+    return true;
+}
+
+/**
+ * Append a range of another rope without copy, sharing its chunks.
+ * 
+ * @param self: the Rope object to append to.
+ * @param src: the source rope, could not be self.
+ * @param offset: the first byte of range.
+ * @param len: the length of range, clamped to the end of src.
+ * @return false if allocation failed and the rope is unchanged.
+ */
+bool Rope_slice(RopeRef self, RopeRef src, size_t offset, size_t len)
+{
+    ListRef tail = self->tail;
+    ListRef node;
+
+    if (offset >= src->length)
+        return true;
+    len = MIN(len, src->length - offset);
+
+    for (node = src->head; node != NULL && len > 0; node = node->next)
+    {
+        RopeSegment *from = DOWN_CAST(node, RopeSegment), *segment;
+        size_t n;
+
+        if (offset >= from->length)
+        {
+            offset -= from->length;
+            continue;
+        }
+
+        n = MIN(from->length - offset, len);
+        segment = __myutil_rope_newSegment(self, from->chunk, from->offset + offset, n);
+        if (segment == NULL)
+        {
+            __myutil_rope_truncate(self, tail);
+            return false;
+        }
+        __atomic_add_fetch(&from->chunk->refs, 1, __ATOMIC_RELAXED);
+        __myutil_rope_link(self, segment);
+        len -= n;
+        offset = 0;
+    }
+    return true;
+}
+
+/**
+ * Drop bytes from the front, e.g. what writev has written.
+ * 
+ * @param self: the Rope object.
+ * @param len: the bytes to drop, clamped to length.
+ */
+void Rope_consume(RopeRef self, size_t len)
+{
+    while (len > 0 && self->head != NULL)
+    {
+        RopeSegment *segment = DOWN_CAST(self->head, RopeSegment);
+        if (len < segment->length)
+        {
+            segment->offset += len;
+            segment->length -= len;
+            self->length -= len;
+            return;
+        }
+
+        len -= segment->length;
+        self->head = segment->super.next;
+        if (self->head == NULL)
+            self->tail = NULL;
+        self->count--;
+        self->length -= segment->length;
+        __myutil_rope_freeSegment(self, segment);
+    }
+}
+
+/**
+ * Export the first segments as iovec entries.
+ * 
+ * @param self: the Rope object.
+ * @param iov: the iovec array.
+ * @param max: the size of iovec array.
+ * @return the count of entries filled.
+ */
+size_t Rope_iovec(RopeRef self, struct iovec *iov, size_t max)
+{
+    ListRef node;
+    size_t n = 0;
+
+    for (node = self->head; node != NULL && n < max; node = node->next, n++)
+    {
+        RopeSegment *segment = DOWN_CAST(node, RopeSegment);
+        iov[n].iov_base = segment->chunk->data + segment->offset;
+        iov[n].iov_len = segment->length;
+    }
+    return n;
+}
+
+/**
+ * Copy bytes out.
+ * 
+ * @param self: the Rope object.
+ * @param offset: the first byte to copy.
+ * @param buf: the buffer.
+ * @param len: the buffer size.
+ * @return the bytes copied.
+ */
+size_t Rope_copy(RopeRef self, size_t offset, void *buf, size_t len)
+{
+    uint8_t *p = (uint8_t *)buf;
+    ListRef node;
+
+    for (node = self->head; node != NULL && len > 0; node = node->next)
+    {
+        RopeSegment *segment = DOWN_CAST(node, RopeSegment);
+        size_t n;
+
+        if (offset >= segment->length)
+        {
+            offset -= segment->length;
+            continue;
+        }
+
+        n = MIN(segment->length - offset, len);
+        memcpy(p, segment->chunk->data + segment->offset + offset, n);
+        p += n;
+        len -= n;
+        offset = 0;
+    }
+    return p - (uint8_t *)buf;
+}
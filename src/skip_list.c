@@ -0,0 +1,217 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file skip_list.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  SkipList implements
+ * ------------------------------------------------------------------------ */
+
+/* get the link of level after prev, head link if prev is NULL. */
+static inline SkipNodeRef *__myutil_skip_list_link(SkipListRef self, SkipNodeRef prev, uint32_t level)
+{
+    return prev == NULL ? &self->heads[level] : &prev->next[level];
+}
+
+/* random height with branching factor 4. */
+static uint32_t __myutil_skip_list_randomHeight(SkipListRef self)
+{
+    uint64_t r = __atomic_add_fetch(&self->seed, 0x9e3779b97f4a7c15ull, __ATOMIC_RELAXED);
+    uint32_t height = 1;
+
+    /* splitmix64 */
+    r = (r ^ (r >> 30)) * 0xbf58476d1ce4e5b9ull;
+    r = (r ^ (r >> 27)) * 0x94d049bb133111ebull;
+    r ^= r >> 31;
+
+    while (height < SKIP_LIST_MAX_HEIGHT && (r & 3) == 0)
+    {
+        height++;
+        r >>= 2;
+    }
+    return height;
+}
+
+/* find the first node not less than key, record the last node less than key of each level. */
+static SkipNodeRef __myutil_skip_list_search(SkipListRef self, void const *key, SkipNodeRef *prevs)
+{
+    uint32_t level = __atomic_load_n(&self->height, __ATOMIC_ACQUIRE) - 1;
+    SkipNodeRef prev = NULL;
+
+    for (;;)
+    {
+        SkipNodeRef next = __atomic_load_n(__myutil_skip_list_link(self, prev, level), __ATOMIC_ACQUIRE);
+        if (next != NULL && self->compare(next, key) < 0)
+        {
+            /* move forward */
+            prev = next;
+            continue;
+        }
+
+        if (prevs != NULL)
+            prevs[level] = prev;
+        if (level == 0)
+            return next;
+
+        /* move down */
+        level--;
+    }
+}
+
+/**
+ * Init skip list.
+ * 
+ * @param self: the SkipList object to be init.
+ * @param compare: the key compare function.
+ */
+void SkipList_init(SkipListRef self, SkipNodeCompare compare)
+{
+    memset(self->heads, 0, sizeof(self->heads));
+    self->height = 1;
+    self->seed = (uint64_t)(size_t)self;
+    self->compare = compare;
+}
+
+/**
+ * Allocate an object embedded skip node, with a random tower height.
+ * 
+ * @param self: the SkipList object.
+ * @param allocator: the allocator, should be thread safe if called
+ *      concurrently.
+ * @param size: the object size.
+ * @param offset: the offset of skip node in object, should be the last one.
+ * @return the object pointer, or NULL if allocation failed.
+ */
+void *SkipList_alloc(SkipListRef self, AllocatorRef allocator, size_t size, size_t offset)
+{
+    uint32_t height = __myutil_skip_list_randomHeight(self);
+    size_t tower = offset + sizeof(SkipNode) + (height - 1) * sizeof(SkipNodeRef);
+
+    uint8_t *obj = (uint8_t *)Allocator_alloc(allocator, MAX(size, tower));
+    if (obj == NULL)
+        return NULL;
+
+    SkipNodeRef node = (SkipNodeRef)(obj + offset);
+    node->height = height;
+    memset(node->next, 0, height * sizeof(SkipNodeRef));
+    return obj;
+}
+
+/**
+ * Insert a node, lock-free. Duplicated keys are kept, the new one first.
+ * 
+ * @param self: the SkipList object.
+ * @param node: the node to be insert.
+ * @param key: the key of node.
+ */
+void SkipList_insert(SkipListRef self, SkipNodeRef node, void const *key)
+{
+    SkipNodeRef prevs[SKIP_LIST_MAX_HEIGHT];
+    uint32_t height = node->height, level;
+
+    /* raise list height, new levels start from heads. */
+    uint32_t maxHeight = __atomic_load_n(&self->height, __ATOMIC_RELAXED);
+    while (height > maxHeight && 
+        !__atomic_compare_exchange_n(&self->height, &maxHeight, height, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    __myutil_skip_list_search(self, key, prevs);
+
+    /* link from bottom to top, node becomes visible at level 0 first. */
+    for (level = 0; level < height; level++)
+    {
+        SkipNodeRef prev = prevs[level];
+        for (;;)
+        {
+            SkipNodeRef *link = __myutil_skip_list_link(self, prev, level);
+            SkipNodeRef next = __atomic_load_n(link, __ATOMIC_ACQUIRE);
+            if (next != NULL && self->compare(next, key) < 0)
+            {
+                /* others inserted before key, move forward */
+                prev = next;
+                continue;
+            }
+
+            __atomic_store_n(&node->next[level], next, __ATOMIC_RELAXED);
+            if (__atomic_compare_exchange_n(link, &next, node, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+                break;
+        }
+    }
+}
+
+/**
+ * Find the first node whose key is not less than key, lock-free.
+ * 
+ * @param self: the SkipList object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if all keys are less.
+ */
+SkipNodeRef SkipList_lowerBound(SkipListRef self, void const *key)
+{
+    return __myutil_skip_list_search(self, key, NULL);
+}
+
+/**
+ * Find a node with equal key, lock-free.
+ * 
+ * @param self: the SkipList object.
+ * @param key: the key to be find.
+ * @return the node, or NULL if not found.
+ */
+SkipNodeRef SkipList_find(SkipListRef self, void const *key)
+{
+    SkipNodeRef node = __myutil_skip_list_search(self, key, NULL);
+    if (node != NULL && self->compare(node, key) == 0)
+        return node;
+    return NULL;
+}
+
+/**
+ * Remove a node from list, should be exclusive to all other operations.
+ * 
+ * @param self: the SkipList object.
+ * @param node: the node to be removed.
+ * @param key: the key of node.
+ * @return true if removed, false if not found.
+ */
+bool SkipList_remove(SkipListRef self, SkipNodeRef node, void const *key)
+{
+    SkipNodeRef prevs[SKIP_LIST_MAX_HEIGHT];
+    SkipNodeRef found = __myutil_skip_list_search(self, key, prevs);
+    uint32_t level;
+
+    /* node may be any one of duplicated keys. */
+    while (found != NULL && found != node && self->compare(found, key) == 0)
+        found = found->next[0];
+    if (found != node)
+        return false;
+
+    for (level = 0; level < node->height; level++)
+    {
+        SkipNodeRef *link = __myutil_skip_list_link(self, prevs[level], level);
+        while (*link != node)
+            link = &(*link)->next[level];
+        __atomic_store_n(link, node->next[level], __ATOMIC_RELEASE);
+    }
+    return true;
+}
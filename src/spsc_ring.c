@@ -0,0 +1,125 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file spsc_ring.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  SpscRing implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Init ring, allocate slots.
+ * 
+ * @param self: the SpscRing object to be init.
+ * @param allocator: the allocator of slots.
+ * @param capacity: the min count of items, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool SpscRing_init(SpscRingRef self, AllocatorRef allocator, size_t capacity)
+{
+    size_t size = 2;
+
+    while (size < capacity)
+        size <<= 1;
+
+    self->slots = (void **)Allocator_alloc(allocator, sizeof(void *) * size);
+    if (self->slots == NULL)
+        return false;
+
+    self->mask = size - 1;
+    self->allocator = allocator;
+    self->head = self->tailCache = 0;
+    self->tail = self->headCache = 0;
+    return true;
+}
+
+/**
+ * Release slots, the ring must not be used by any thread.
+ * 
+ * @param self: the SpscRing object.
+ */
+void SpscRing_destroy(SpscRingRef self)
+{
+    Allocator_free(self->allocator, self->slots);
+    self->slots = NULL;
+}
+
+/**
+ * Enqueue up to n items, producer only.
+ * 
+ * Items are published together by one index update.
+ * 
+ * @param self: the SpscRing object.
+ * @param items: the item pointers.
+ * @param n: the count of items.
+ * @return the count of enqueued items, from the start of items.
+ */
+size_t SpscRing_pushN(SpscRingRef self, void *const items[], size_t n)
+{
+    size_t head = __atomic_load_n(&self->head, __ATOMIC_RELAXED);
+    size_t size = self->mask + 1, first;
+
+    if (size - (head - self->tailCache) < n)
+        self->tailCache = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+    n = MIN(n, size - (head - self->tailCache));
+    if (n == 0)
+        return 0;
+
+    /* copy in two runs if wrapped */
+    first = MIN(n, size - (head & self->mask));
+    memcpy(&self->slots[head & self->mask], items, sizeof(void *) * first);
+    memcpy(self->slots, items + first, sizeof(void *) * (n - first));
+
+    __atomic_store_n(&self->head, head + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/**
+ * Dequeue up to n items, consumer only.
+ * 
+ * Slots are released together by one index update.
+ * 
+ * @param self: the SpscRing object.
+ * @param items: the array to store item pointers.
+ * @param n: the max count of items.
+ * @return the count of dequeued items.
+ */
+size_t SpscRing_popN(SpscRingRef self, void *items[], size_t n)
+{
+    size_t tail = __atomic_load_n(&self->tail, __ATOMIC_RELAXED);
+    size_t size = self->mask + 1, first;
+
+    if (self->headCache - tail < n)
+        self->headCache = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+    n = MIN(n, self->headCache - tail);
+    if (n == 0)
+        return 0;
+
+    first = MIN(n, size - (tail & self->mask));
+    memcpy(items, &self->slots[tail & self->mask], sizeof(void *) * first);
+    memcpy(items + first, self->slots, sizeof(void *) * (n - first));
+
+    __atomic_store_n(&self->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
@@ -0,0 +1,292 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file string_pool.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  StringPool implements
+ * ------------------------------------------------------------------------ */
+
+#define __MYUTIL_STRING_POOL_MIN_SLOTS 16
+/* strings hashed and prefetched ahead by StringPool_internBatch */
+#define __MYUTIL_STRING_POOL_BATCH 16
+/* bytes before string: hash and length */
+#define __MYUTIL_STRING_POOL_PREFIX (sizeof(uint32_t) * 2)
+
+/** index slot, str is NULL for empty */
+typedef struct _StringPoolSlot
+{
+    uint32_t hash;                          /**< hash of string */
+    cstr_t str;                             /**< interned string */
+} StringPoolSlot;
+
+/** arena chunk, string bytes follow */
+typedef struct _StringChunk
+{
+    List super;
+    size_t used;                            /**< bytes used */
+    size_t size;                            /**< bytes of data */
+} StringChunk;
+
+static StringPoolSlot *__myutil_string_pool_lookup(StringPoolRef self, void const *data, size_t len,
+    uint32_t hash)
+{
+    size_t i = hash & self->mask;
+    for (;;)
+    {
+        StringPoolSlot *slot = &self->slots[i];
+        if (slot->str == NULL ||
+            (slot->hash == hash && StringPool_length(slot->str) == len && memcmp(slot->str, data, len) == 0))
+            return slot;
+        i = (i + 1) & self->mask;
+    }
+}
+
+/* rebuild index with more slots, strings are not touched. */
+static bool __myutil_string_pool_grow(StringPoolRef self, size_t slots)
+{
+    StringPoolSlot *old = self->slots;
+    size_t i, count = self->slots == NULL ? 0 : self->mask + 1;
+
+    self->slots = (StringPoolSlot *)Allocator_alloc(self->allocator, sizeof(StringPoolSlot) * slots);
+    if (self->slots == NULL)
+    {
+        self->slots = old;
+        return false;
+    }
+    memset(self->slots, 0, sizeof(StringPoolSlot) * slots);
+    self->mask = slots - 1;
+
+    for (i = 0; i < count; i++)
+    {
+        if (old[i].str != NULL)
+        {
+            size_t j = old[i].hash & self->mask;
+            while (self->slots[j].str != NULL)
+                j = (j + 1) & self->mask;
+            self->slots[j] = old[i];
+        }
+    }
+    if (old != NULL)
+        Allocator_free(self->allocator, old);
+    return true;
+}
+
+/* grow index so count strings stay under 3/4 load. */
+static bool __myutil_string_pool_reserve(StringPoolRef self, size_t count)
+{
+    size_t slots = self->mask + 1;
+    if (count <= slots - slots / 4)
+        return true;
+    while (count > slots - slots / 4)
+        slots *= 2;
+    return __myutil_string_pool_grow(self, slots);
+}
+
+/* copy string into arena, with hash and length before it. */
+static cstr_t __myutil_string_pool_store(StringPoolRef self, void const *data, size_t len, uint32_t hash)
+{
+    StringChunk *chunk = self->chunks == NULL ? NULL : DOWN_CAST(self->chunks, StringChunk);
+    size_t need = __MYUTIL_STRING_POOL_PREFIX + len + 1;
+    size_t offset = chunk == NULL ? 0 : ALIGN(chunk->used, sizeof(uint32_t));
+    uint8_t *p;
+
+    if (chunk == NULL || offset + need > chunk->size)
+    {
+        size_t size = MAX(self->chunkSize, sizeof(StringChunk) + need);
+        StringChunk *fresh = (StringChunk *)Allocator_alloc(self->allocator, size);
+        if (fresh == NULL)
+            return NULL;
+
+        fresh->used = 0;
+        fresh->size = size - sizeof(StringChunk);
+        /* an oversized string gets its own chunk, the current one is kept
+         * for following strings. */
+        if (chunk != NULL && size > self->chunkSize)
+        {
+            fresh->super.next = chunk->super.next;
+            chunk->super.next = &fresh->super;
+        }
+        else
+        {
+            fresh->super.next = self->chunks;
+            self->chunks = &fresh->super;
+        }
+        chunk = fresh;
+        offset = 0;
+    }
+
+    p = (uint8_t *)(chunk + 1) + offset;
+    ((uint32_t *)p)[0] = hash;
+    ((uint32_t *)p)[1] = (uint32_t)len;
+    p += __MYUTIL_STRING_POOL_PREFIX;
+    memcpy(p, data, len);
+    p[len] = '\0';
+    chunk->used = offset + need;
+    return (cstr_t)p;
+}
+
+static cstr_t __myutil_string_pool_intern(StringPoolRef self, void const *data, size_t len, uint32_t hash)
+{
+    StringPoolSlot *slot;
+    size_t mask;
+    cstr_t str;
+
+    if ((uint64_t)len > UINT32_MAX)
+        return NULL;
+
+    slot = __myutil_string_pool_lookup(self, data, len, hash);
+    if (slot->str != NULL)
+        return slot->str;
+
+    mask = self->mask;
+    if (!__myutil_string_pool_reserve(self, self->count + 1))
+        return NULL;
+    if (self->mask != mask)
+        slot = __myutil_string_pool_lookup(self, data, len, hash);
+
+    str = __myutil_string_pool_store(self, data, len, hash);
+    if (str == NULL)
+        return NULL;
+
+    slot->hash = hash;
+    slot->str = str;
+    self->count++;
+    return str;
+}
+
+/**
+ * Init pool.
+ * 
+ * @param self: the StringPool object to be init.
+ * @param allocator: the allocator of index and chunks.
+ * @param chunkSize: the bytes of arena chunks, 0 for STRING_POOL_CHUNK_SIZE.
+ * @return false if allocation failed.
+ */
+bool StringPool_init(StringPoolRef self, AllocatorRef allocator, size_t chunkSize)
+{
+    self->slots = NULL;
+    self->mask = 0;
+    self->count = 0;
+    self->chunks = NULL;
+    self->chunkSize = chunkSize == 0 ? STRING_POOL_CHUNK_SIZE : chunkSize;
+    self->allocator = allocator;
+    return __myutil_string_pool_grow(self, __MYUTIL_STRING_POOL_MIN_SLOTS);
+}
+
+/**
+ * Release index and all strings, handles become invalid.
+ * 
+ * @param self: the StringPool object.
+ */
+void StringPool_destroy(StringPoolRef self)
+{
+    while (self->chunks != NULL)
+    {
+        ListRef chunk = self->chunks;
+        self->chunks = chunk->next;
+        Allocator_free(self->allocator, chunk);
+    }
+    if (self->slots != NULL)
+        Allocator_free(self->allocator, self->slots);
+    self->slots = NULL;
+    self->mask = 0;
+    self->count = 0;
+}
+
+/**
+ * Intern bytes as a zero terminated string.
+ * 
+ * @param self: the StringPool object.
+ * @param data: the bytes.
+ * @param len: the length of bytes.
+ * @return the handle, or NULL if allocation failed.
+ */
+cstr_t StringPool_internBytes(StringPoolRef self, void const *data, size_t len)
+{
+    return __myutil_string_pool_intern(self, data, len, Hash_bytes(data, len));
+}
+
+/**
+ * Intern a zero terminated string.
+ * 
+ * @param self: the StringPool object.
+ * @param str: the string.
+ * @return the handle, or NULL if allocation failed.
+ */
+cstr_t StringPool_intern(StringPoolRef self, cstr_t str)
+{
+    return StringPool_internBytes(self, str, strlen(str));
+}
+
+/**
+ * Intern many strings.
+ * 
+ * The index grows once for all strings, and the slots of following
+ * strings are prefetched while interning.
+ * 
+ * @param self: the StringPool object.
+ * @param strs: the zero terminated strings.
+ * @param n: the count of strings.
+ * @param handles: output the handles, NULL for allocation failures.
+ * @return the count of strings interned.
+ */
+size_t StringPool_internBatch(StringPoolRef self, cstr_t const *strs, size_t n, cstr_t *handles)
+{
+    size_t lens[__MYUTIL_STRING_POOL_BATCH];
+    uint32_t hashes[__MYUTIL_STRING_POOL_BATCH];
+    size_t i, j, m, done = 0;
+
+    /* all may be new, it is fine to fail, interning grows on demand. */
+    __myutil_string_pool_reserve(self, self->count + n);
+
+    for (i = 0; i < n; i += m)
+    {
+        m = MIN(n - i, (size_t)__MYUTIL_STRING_POOL_BATCH);
+        for (j = 0; j < m; j++)
+        {
+            lens[j] = strlen(strs[i + j]);
+            hashes[j] = Hash_bytes(strs[i + j], lens[j]);
+            PREFETCH(&self->slots[hashes[j] & self->mask]);
+        }
+        for (j = 0; j < m; j++)
+        {
+            handles[i + j] = __myutil_string_pool_intern(self, strs[i + j], lens[j], hashes[j]);
+            done += handles[i + j] != NULL;
+        }
+    }
+    return done;
+}
+
+/**
+ * Find the handle of a string without interning it.
+ * 
+ * @param self: the StringPool object.
+ * @param str: the string.
+ * @return the handle, or NULL if not interned.
+ */
+cstr_t StringPool_find(StringPoolRef self, cstr_t str)
+{
+    size_t len = strlen(str);
+    return __myutil_string_pool_lookup(self, str, len, Hash_bytes(str, len))->str;
+}
@@ -0,0 +1,454 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file task_scheduler.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+/* ---------------------------------------------------------------------------
+ *  WsDeque implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Init deque, allocate slots.
+ * 
+ * @param self: the WsDeque object to be init.
+ * @param allocator: the allocator of slots.
+ * @param capacity: the min count of items, rounded up to power of 2.
+ * @return true if success, false if allocation failed.
+ */
+bool WsDeque_init(WsDequeRef self, AllocatorRef allocator, size_t capacity)
+{
+    size_t size = 2;
+
+    while (size < capacity)
+        size <<= 1;
+
+    self->slots = (void **)Allocator_alloc(allocator, sizeof(void *) * size);
+    if (self->slots == NULL)
+        return false;
+
+    self->mask = (int64_t)size - 1;
+    self->allocator = allocator;
+    self->top = self->bottom = 0;
+    return true;
+}
+
+/**
+ * Release slots, the deque must not be used by any thread.
+ * 
+ * @param self: the WsDeque object.
+ */
+void WsDeque_destroy(WsDequeRef self)
+{
+    Allocator_free(self->allocator, self->slots);
+    self->slots = NULL;
+}
+
+/**
+ * Push an item at bottom, owner only.
+ * 
+ * @param self: the WsDeque object.
+ * @param item: the item pointer, not NULL.
+ * @return true if success, false if deque is full.
+ */
+bool WsDeque_push(WsDequeRef self, void *item)
+{
+    int64_t bottom = __atomic_load_n(&self->bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&self->top, __ATOMIC_ACQUIRE);
+
+    if (bottom - top > self->mask)
+        return false;
+
+    __atomic_store_n(&self->slots[bottom & self->mask], item, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Take the last pushed item, owner only.
+ * 
+ * @param self: the WsDeque object.
+ * @return the item pointer, or NULL if empty.
+ */
+void *WsDeque_take(WsDequeRef self)
+{
+    int64_t bottom = __atomic_load_n(&self->bottom, __ATOMIC_RELAXED) - 1;
+    int64_t top;
+    void *item = NULL;
+
+    /* claim the bottom slot before looking at top, thieves do the reverse. */
+    __atomic_store_n(&self->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&self->top, __ATOMIC_RELAXED);
+
+    if (top <= bottom)
+    {
+        item = __atomic_load_n(&self->slots[bottom & self->mask], __ATOMIC_RELAXED);
+        if (top != bottom)
+            return item;
+
+        /* the last item, race with thieves */
+        if (!__atomic_compare_exchange_n(&self->top, &top, top + 1, false,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            item = NULL;
+    }
+
+    __atomic_store_n(&self->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return item;
+}
+
+/**
+ * Steal the first pushed item, any thread.
+ * 
+ * @param self: the WsDeque object.
+ * @return the item pointer, or NULL if empty or another thread won it.
+ */
+void *WsDeque_steal(WsDequeRef self)
+{
+    int64_t top = __atomic_load_n(&self->top, __ATOMIC_ACQUIRE);
+    int64_t bottom;
+    void *item;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&self->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom)
+        return NULL;
+
+    /* the slot may be reused once top moves, so read it first. */
+    item = __atomic_load_n(&self->slots[top & self->mask], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&self->top, &top, top + 1, false,
+            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL;
+    return item;
+}
+
+/* ---------------------------------------------------------------------------
+ *  TaskScheduler implements
+ * ------------------------------------------------------------------------ */
+
+/** private part of TaskScheduler */
+typedef struct _TaskSchedulerCore
+{
+    pthread_mutex_t lock;       /**< protects active and stop for sleeping */
+    pthread_cond_t wake;        /**< signaled when a run starts or stops */
+    bool active;                /**< a root task is running */
+    bool stop;                  /**< threads quit */
+    size_t workers;             /**< worker count */
+    TaskWorkerRef worker;       /**< worker array */
+    pthread_t threads[1];       /**< threads of worker 1 ~ workers - 1 */
+} TaskSchedulerCore;
+
+/* get a record, local free list first, then returned ones, then arena. */
+static TaskRef __myutil_task_scheduler_alloc(TaskWorkerRef self)
+{
+    ListRef node;
+
+    if (self->free == NULL)
+        self->free = __atomic_exchange_n(&self->remote, NULL, __ATOMIC_ACQUIRE);
+
+    node = self->free;
+    if (node != NULL)
+    {
+        self->free = node->next;
+        return DOWN_CAST(node, Task);
+    }
+    return Allocator_new(self->arena, Task);
+}
+
+/* give a record back to its owner, others push to the remote list. */
+static void __myutil_task_scheduler_release(TaskWorkerRef self, TaskRef task)
+{
+    TaskWorkerRef owner = task->owner;
+
+    if (owner == self)
+    {
+        task->super.next = self->free;
+        self->free = &task->super;
+        return;
+    }
+
+    task->super.next = __atomic_load_n(&owner->remote, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&owner->remote, &task->super.next, &task->super,
+            true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void __myutil_task_scheduler_execute(TaskWorkerRef self, TaskRef task)
+{
+    TaskGroupRef group = task->group;
+    TaskFunc func = task->func;
+    void *arg = task->arg;
+
+    /* record is reusable once copied, children may take it */
+    __myutil_task_scheduler_release(self, task);
+    func(self, arg);
+    __atomic_fetch_sub(&group->pending, 1, __ATOMIC_RELEASE);
+}
+
+/* run one own or stolen task, return false if none found. */
+static bool __myutil_task_scheduler_runOne(TaskWorkerRef self)
+{
+    TaskSchedulerCore *core = self->core;
+    TaskRef task = (TaskRef)WsDeque_take(&self->deque);
+    size_t i, victim;
+
+    if (task == NULL && core->workers > 1)
+    {
+        /* xorshift, start from a random victim other than self */
+        self->seed ^= self->seed << 13;
+        self->seed ^= self->seed >> 7;
+        self->seed ^= self->seed << 17;
+        victim = self->seed % (core->workers - 1);
+
+        for (i = 0; i < core->workers - 1 && task == NULL; i++)
+        {
+            size_t index = (victim + i) % (core->workers - 1);
+            index += index >= self->index ? 1 : 0;
+            task = (TaskRef)WsDeque_steal(&core->worker[index].deque);
+        }
+    }
+
+    if (task == NULL)
+        return false;
+    __myutil_task_scheduler_execute(self, task);
+    return true;
+}
+
+static void *__myutil_task_scheduler_thread(void *arg)
+{
+    TaskWorkerRef self = (TaskWorkerRef)arg;
+    TaskSchedulerCore *core = self->core;
+
+    while (true)
+    {
+        if (!__atomic_load_n(&core->active, __ATOMIC_ACQUIRE))
+        {
+            bool stop;
+
+            pthread_mutex_lock(&core->lock);
+            while (!core->active && !core->stop)
+                pthread_cond_wait(&core->wake, &core->lock);
+            stop = core->stop;
+            pthread_mutex_unlock(&core->lock);
+            if (stop)
+                break;
+        }
+
+        if (!__myutil_task_scheduler_runOne(self))
+            sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * Fork a task into a group.
+ * 
+ * The task is pushed to the worker deque, to be run by itself or stolen by
+ * others. It runs inline if no record is available.
+ * 
+ * @param self: the current TaskWorker.
+ * @param group: the group to join.
+ * @param func: the task function.
+ * @param arg: the argument of func.
+ */
+void TaskWorker_fork(TaskWorkerRef self, TaskGroupRef group, TaskFunc func, void *arg)
+{
+    TaskRef task = __myutil_task_scheduler_alloc(self);
+
+    if (task == NULL)
+    {
+        func(self, arg);
+        return;
+    }
+
+    task->func = func;
+    task->arg = arg;
+    task->group = group;
+    task->owner = self;
+    __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+
+    if (!WsDeque_push(&self->deque, task))
+        __myutil_task_scheduler_execute(self, task);
+}
+
+/**
+ * Wait until all tasks of group are done, run own or stolen tasks meanwhile.
+ * 
+ * A task must join all its forked tasks before it returns.
+ * 
+ * @param self: the current TaskWorker.
+ * @param group: the group to join.
+ */
+void TaskWorker_join(TaskWorkerRef self, TaskGroupRef group)
+{
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0)
+    {
+        if (!__myutil_task_scheduler_runOne(self))
+            sched_yield();
+    }
+}
+
+/* stop and join the first count threads, release arenas and core. */
+static void __myutil_task_scheduler_stop(TaskSchedulerRef self, size_t count)
+{
+    TaskSchedulerCore *core = self->core;
+    size_t i;
+
+    pthread_mutex_lock(&core->lock);
+    core->stop = true;
+    pthread_cond_broadcast(&core->wake);
+    pthread_mutex_unlock(&core->lock);
+
+    for (i = 0; i < count; i++)
+        pthread_join(core->threads[i], NULL);
+
+    pthread_cond_destroy(&core->wake);
+    pthread_mutex_destroy(&core->lock);
+
+    for (i = 0; i < core->workers; i++)
+    {
+        if (core->worker[i].arena != NULL)
+            Allocator_free(self->allocator, core->worker[i].arena);
+    }
+    Allocator_free(self->allocator, core->worker);
+    Allocator_free(self->allocator, core);
+    self->core = NULL;
+}
+
+/**
+ * Init scheduler and start worker threads.
+ * 
+ * Every worker owns an arena of task records and its deque slots, carved
+ * from allocator.
+ * 
+ * @param self: the TaskScheduler object to be init.
+ * @param allocator: the allocator of core and arenas.
+ * @param workers: the worker count including caller, at least 1.
+ * @param tasks: the max count of outstanding records per worker.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool TaskScheduler_init(TaskSchedulerRef self, AllocatorRef allocator, size_t workers, size_t tasks)
+{
+    TaskSchedulerCore *core;
+    size_t i, slots = 2, size;
+
+    workers = MAX(workers, 1);
+    tasks = MAX(tasks, 1);
+    while (slots < tasks)
+        slots <<= 1;
+    /* allocator header, deque slots and records */
+    size = 64 + sizeof(void *) * slots + ALIGN(sizeof(Task), 4) * tasks;
+
+    self->allocator = allocator;
+    self->workers = workers;
+    self->core = core = (TaskSchedulerCore *)Allocator_alloc(allocator,
+        sizeof(TaskSchedulerCore) + sizeof(pthread_t) * (workers - 1));
+    if (core == NULL)
+        return false;
+
+    core->worker = (TaskWorkerRef)Allocator_alloc(allocator, sizeof(TaskWorker) * workers);
+    if (core->worker == NULL)
+    {
+        Allocator_free(allocator, core);
+        self->core = NULL;
+        return false;
+    }
+
+    pthread_mutex_init(&core->lock, NULL);
+    pthread_cond_init(&core->wake, NULL);
+    core->active = false;
+    core->stop = false;
+    core->workers = workers;
+
+    for (i = 0; i < workers; i++)
+    {
+        TaskWorkerRef worker = &core->worker[i];
+        void *block = Allocator_alloc(allocator, size);
+
+        worker->arena = block == NULL ? NULL : StaticAllocator(size, block);
+        if (worker->arena == NULL || !WsDeque_init(&worker->deque, worker->arena, slots))
+        {
+            for (; i < workers; i++)
+                core->worker[i].arena = NULL;
+            if (block != NULL)
+                Allocator_free(allocator, block);
+            __myutil_task_scheduler_stop(self, 0);
+            return false;
+        }
+
+        worker->free = worker->remote = NULL;
+        worker->core = core;
+        worker->index = i;
+        worker->seed = Hash_uint64(i) | 1;
+    }
+
+    for (i = 1; i < workers; i++)
+    {
+        if (pthread_create(&core->threads[i - 1], NULL, __myutil_task_scheduler_thread, &core->worker[i]) != 0)
+        {
+            /* roll back started threads */
+            __myutil_task_scheduler_stop(self, i - 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stop worker threads and release core.
+ * 
+ * @param self: the TaskScheduler object.
+ */
+void TaskScheduler_destroy(TaskSchedulerRef self)
+{
+    if (self->core == NULL)
+        return;
+
+    __myutil_task_scheduler_stop(self, self->workers - 1);
+}
+
+/**
+ * Run a root task in the caller thread as worker 0, return when it is done.
+ * 
+ * Other workers steal while it runs and sleep after. Only one thread may
+ * run at a time.
+ * 
+ * @param self: the TaskScheduler object.
+ * @param func: the root task function.
+ * @param arg: the argument of func.
+ */
+void TaskScheduler_run(TaskSchedulerRef self, TaskFunc func, void *arg)
+{
+    TaskSchedulerCore *core = self->core;
+
+    pthread_mutex_lock(&core->lock);
+    __atomic_store_n(&core->active, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&core->wake);
+    pthread_mutex_unlock(&core->lock);
+
+    func(&core->worker[0], arg);
+
+    pthread_mutex_lock(&core->lock);
+    __atomic_store_n(&core->active, false, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&core->lock);
+}
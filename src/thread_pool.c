@@ -0,0 +1,375 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file thread_pool.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  ThreadPool implements
+ * ------------------------------------------------------------------------ */
+
+/** private part of ThreadPool */
+typedef struct _ThreadPoolCore
+{
+    ListRef incoming;           /**< lock-free stack of submitted works, newest first */
+    uint32_t wake;              /**< futex word, bumped to wake parked workers */
+    uint32_t done;              /**< futex word, bumped when a group is done */
+    uint32_t sleepers;          /**< count of parked workers */
+    uint32_t waiters;           /**< count of parked group waiters */
+    pthread_mutex_t lock;       /**< protects ready queue among workers */
+    ListRef head;               /**< first ready work */
+    size_t ready;               /**< count of ready works */
+    bool stop;                  /**< workers quit on empty queue */
+    pthread_t threads[1];       /**< worker threads */
+} ThreadPoolCore;
+
+/* park on a futex word while it equals value, may return spuriously. */
+static void __myutil_thread_pool_futexWait(uint32_t *word, uint32_t value)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    if (__atomic_load_n(word, __ATOMIC_ACQUIRE) == value)
+        sched_yield();
+#endif
+}
+
+/* bump a futex word and wake up to count threads parked on it. */
+static void __myutil_thread_pool_futexWake(uint32_t *word, int count)
+{
+    __atomic_fetch_add(word, 1, __ATOMIC_SEQ_CST);
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#endif
+}
+
+/* pop the first ready work, refill ready queue from submitted stack if
+ * empty. */
+static ThreadWorkRef __myutil_thread_pool_next(ThreadPoolCore *core)
+{
+    ListRef node;
+    size_t ready;
+
+    pthread_mutex_lock(&core->lock);
+    ready = core->ready;
+    if (core->head == NULL && __atomic_load_n(&core->incoming, __ATOMIC_SEQ_CST) != NULL)
+    {
+        /* reverse into submission order */
+        ListRef stack = __atomic_exchange_n(&core->incoming, NULL, __ATOMIC_ACQUIRE);
+        while (stack != NULL)
+        {
+            ListRef next = stack->next;
+            stack->next = core->head;
+            core->head = stack;
+            stack = next;
+            ready++;
+        }
+    }
+
+    /* one work at a time, so a slow work never holds back the others */
+    node = core->head;
+    if (node != NULL)
+    {
+        core->head = node->next;
+        ready--;
+    }
+    /* parking workers check ready without the lock */
+    __atomic_store_n(&core->ready, ready, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&core->lock);
+
+    /* hand the rest to a parked worker */
+    if (ready != 0 && __atomic_load_n(&core->sleepers, __ATOMIC_SEQ_CST) != 0)
+        __myutil_thread_pool_futexWake(&core->wake, 1);
+    return node == NULL ? NULL : DOWN_CAST(node, ThreadWork);
+}
+
+static void *__myutil_thread_pool_worker(void *arg)
+{
+    ThreadPoolCore *core = (ThreadPoolCore *)arg;
+
+    while (true)
+    {
+        ThreadWorkRef work = __myutil_thread_pool_next(core);
+        if (work == NULL)
+        {
+            if (__atomic_load_n(&core->stop, __ATOMIC_SEQ_CST))
+                break;
+
+            /* announce parking before the last check, submitters check
+             * sleepers after pushing, so one side always sees the other. */
+            uint32_t wake = __atomic_load_n(&core->wake, __ATOMIC_SEQ_CST);
+            __atomic_fetch_add(&core->sleepers, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&core->incoming, __ATOMIC_SEQ_CST) == NULL &&
+                __atomic_load_n(&core->ready, __ATOMIC_SEQ_CST) == 0 &&
+                !__atomic_load_n(&core->stop, __ATOMIC_SEQ_CST))
+                __myutil_thread_pool_futexWait(&core->wake, wake);
+            __atomic_fetch_sub(&core->sleepers, 1, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        /* work may be released by its group waiter after done */
+        ThreadGroupRef group = work->group;
+        work->func(work->arg);
+
+        if (group != NULL && __atomic_fetch_sub(&group->pending, 1, __ATOMIC_SEQ_CST) == 1 &&
+            __atomic_load_n(&core->waiters, __ATOMIC_SEQ_CST) != 0)
+            __myutil_thread_pool_futexWake(&core->done, INT_MAX);
+    }
+    return NULL;
+}
+
+/* stop and join the first count workers. */
+static void __myutil_thread_pool_stop(ThreadPoolCore *core, size_t count)
+{
+    size_t i;
+
+    __atomic_store_n(&core->stop, true, __ATOMIC_SEQ_CST);
+    __myutil_thread_pool_futexWake(&core->wake, INT_MAX);
+
+    for (i = 0; i < count; i++)
+        pthread_join(core->threads[i], NULL);
+
+    pthread_mutex_destroy(&core->lock);
+}
+
+/**
+ * Init thread pool and start workers.
+ * 
+ * @param self: the ThreadPool object to be init.
+ * @param allocator: the allocator of pool core.
+ * @param threads: the worker count, at least 1.
+ * @return true if success, false if allocation or thread creation failed.
+ */
+bool ThreadPool_init(ThreadPoolRef self, AllocatorRef allocator, size_t threads)
+{
+    ThreadPoolCore *core;
+    size_t i;
+
+    threads = MAX(threads, 1);
+    self->allocator = allocator;
+    self->threads = threads;
+    self->core = core = (ThreadPoolCore *)Allocator_alloc(allocator,
+        sizeof(ThreadPoolCore) + sizeof(pthread_t) * (threads - 1));
+    if (core == NULL)
+        return false;
+
+    pthread_mutex_init(&core->lock, NULL);
+    core->incoming = NULL;
+    core->wake = core->done = 0;
+    core->sleepers = core->waiters = 0;
+    core->head = NULL;
+    core->ready = 0;
+    core->stop = false;
+
+    for (i = 0; i < threads; i++)
+    {
+        if (pthread_create(&core->threads[i], NULL, __myutil_thread_pool_worker, core) != 0)
+        {
+            /* roll back started workers */
+            __myutil_thread_pool_stop(core, i);
+            Allocator_free(allocator, core);
+            self->core = NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stop workers after queued works are done, and release pool core.
+ * 
+ * @param self: the ThreadPool object.
+ */
+void ThreadPool_destroy(ThreadPoolRef self)
+{
+    if (self->core == NULL)
+        return;
+
+    __myutil_thread_pool_stop(self->core, self->threads);
+    Allocator_free(self->allocator, self->core);
+    self->core = NULL;
+}
+
+/**
+ * Submit a work.
+ * 
+ * @param self: the ThreadPool object.
+ * @param work: the work item.
+ * @param func: the work function.
+ * @param arg: the argument of func.
+ * @param group: the group to join, or NULL.
+ */
+void ThreadPool_submit(ThreadPoolRef self, ThreadWorkRef work, ThreadFunc func, void *arg, ThreadGroupRef group)
+{
+    ThreadPoolCore *core = self->core;
+
+    work->func = func;
+    work->arg = arg;
+    work->group = group;
+    if (group != NULL)
+        __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+
+    work->super.next = __atomic_load_n(&core->incoming, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&core->incoming, &work->super.next, &work->super,
+            true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    if (__atomic_load_n(&core->sleepers, __ATOMIC_SEQ_CST) != 0)
+        __myutil_thread_pool_futexWake(&core->wake, 1);
+}
+
+/**
+ * Wait until all works of group are done.
+ * 
+ * @param self: the ThreadPool object.
+ * @param group: the group to wait for.
+ */
+void ThreadPool_wait(ThreadPoolRef self, ThreadGroupRef group)
+{
+    ThreadPoolCore *core = self->core;
+
+    while (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) != 0)
+    {
+        uint32_t done = __atomic_load_n(&core->done, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&core->waiters, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) != 0)
+            __myutil_thread_pool_futexWait(&core->done, done);
+        __atomic_fetch_sub(&core->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ *  Parallel implements
+ * ------------------------------------------------------------------------ */
+
+#define __MYUTIL_PARALLEL_MARKS (PARALLEL_MAX_SEGMENTS * 4)
+
+/** a segment of parallel travel */
+typedef struct _ParallelSegment
+{
+    ThreadWork work;            /**< pool work item */
+    DbListRef head;             /**< head of segment ring */
+    size_t index;               /**< segment index */
+    DbListSegmentFunc func;     /**< segment function */
+    void *arg;                  /**< argument of func */
+} ParallelSegment;
+
+static void __myutil_thread_pool_runSegment(void *arg)
+{
+    ParallelSegment *segment = (ParallelSegment *)arg;
+    segment->func(segment->head, segment->index, segment->arg);
+}
+
+/**
+ * Travel a double list in parallel.
+ * 
+ * The list is cut into rings of nearly equal length by one walk, which
+ * marks every stride-th node, then each cut steps less than a stride from
+ * its nearest mark. Each ring is run as a work on the pool, then rings are
+ * linked back in order. The list must not be touched by others during the
+ * call.
+ * 
+ * @param head: the head of double list.
+ * @param pool: the ThreadPool to run segments.
+ * @param segments: the segment count, up to PARALLEL_MAX_SEGMENTS, or 0
+ *      for worker count.
+ * @param func: the segment function.
+ * @param reduce: the reduce function called in caller thread, or NULL.
+ * @param arg: the argument of func and reduce.
+ * @return the count of segments run.
+ */
+size_t DbList_parallelForEach(DbListRef head, ThreadPoolRef pool, size_t segments,
+    DbListSegmentFunc func, DbListReduceFunc reduce, void *arg)
+{
+    ParallelSegment parts[PARALLEL_MAX_SEGMENTS];
+    DbListRef marks[__MYUTIL_PARALLEL_MARKS];
+    ThreadGroup group;
+    DbListRef node, ring;
+    size_t length = 0, count = 0, stride = 1, i;
+
+    if (head == NULL)
+        return 0;
+
+    /* mark every stride-th node, double stride when marks are full */
+    DBLIST_FOREACH(node, head)
+    {
+        if ((length & (stride - 1)) == 0 && count == __MYUTIL_PARALLEL_MARKS)
+        {
+            for (i = 0; i < count / 2; i++)
+                marks[i] = marks[i * 2];
+            count /= 2;
+            stride *= 2;
+        }
+        if ((length & (stride - 1)) == 0)
+            marks[count++] = node;
+        length++;
+    }
+    if (segments == 0)
+        segments = ThreadPool_threads(pool);
+    segments = MIN(segments, (size_t)PARALLEL_MAX_SEGMENTS, length);
+
+    /* cut rings at i * length / segments, from the nearest mark before */
+    ring = head;
+    for (i = 0; i < segments; i++)
+    {
+        parts[i].head = ring;
+        if (i + 1 < segments)
+        {
+            size_t end = (i + 1) * length / segments;
+            size_t pos = end & ~(stride - 1);
+
+            for (node = marks[pos / stride]; pos < end; pos++)
+                node = node->next;
+            ring = DbList_splitAt(node, &parts[i].head);
+        }
+    }
+
+    ThreadGroup_init(&group);
+    for (i = 0; i < segments; i++)
+    {
+        parts[i].index = i;
+        parts[i].func = func;
+        parts[i].arg = arg;
+        ThreadPool_submit(pool, &parts[i].work, __myutil_thread_pool_runSegment, &parts[i], &group);
+    }
+    ThreadPool_wait(pool, &group);
+
+    /* link rings back, head is unchanged */
+    ring = parts[0].head;
+    for (i = 1; i < segments; i++)
+        DbList_concat(&ring, &parts[i].head);
+
+    if (reduce != NULL)
+    {
+        for (i = 0; i < segments; i++)
+            reduce(i, arg);
+    }
+    return segments;
+}
@@ -0,0 +1,242 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file timer_wheel.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/* ---------------------------------------------------------------------------
+ *  TimerWheel implements
+ * ------------------------------------------------------------------------ */
+
+/* link timer to the slot by its expiry, level is chosen by ticks ahead.
+ * a timer out of range waits in the top level, and is linked again by cascade. */
+static void __myutil_timer_wheel_link(TimerWheelRef self, TimerRef timer)
+{
+    uint64_t expires = timer->expires;
+    uint64_t delta;
+    int level = 0, index;
+
+    /* already expired, run on next tick */
+    if ((int64_t)(expires - self->now) < 0)
+        expires = self->now;
+    delta = expires - self->now;
+
+    if (delta >= TIMER_WHEEL_RANGE)
+    {
+        delta = TIMER_WHEEL_RANGE - 1;
+        expires = self->now + delta;
+    }
+    while (delta >= (1ull << (TIMER_WHEEL_BITS * (level + 1))))
+        level++;
+
+    index = (expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    timer->slot = &self->slots[level][index];
+    DbList_addToTail(&timer->super, timer->slot);
+    self->bitmap[level] |= 1ull << index;
+}
+
+/* unlink timer from its slot, the slot may be a detached list. */
+static void __myutil_timer_wheel_unlink(TimerWheelRef self, TimerRef timer)
+{
+    uintptr_t offset = ((uintptr_t)timer->slot - (uintptr_t)self->slots) / sizeof(DbListRef);
+
+    DbList_removeFrom(&timer->super, timer->slot);
+    if (offset < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS && *timer->slot == NULL)
+        self->bitmap[offset >> TIMER_WHEEL_BITS] &= ~(1ull << (offset & TIMER_WHEEL_MASK));
+}
+
+/* get the next tick from now, which has a slot to run or to cascade. */
+static uint64_t __myutil_timer_wheel_nextTick(TimerWheelRef self)
+{
+    uint64_t next = UINT64_MAX;
+    int level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        int shift = TIMER_WHEEL_BITS * level;
+        uint64_t bitmap = self->bitmap[level];
+        uint64_t base = self->now & ~((1ull << (shift + TIMER_WHEEL_BITS)) - 1);
+        int index = (self->now >> shift) & TIMER_WHEEL_MASK;
+        uint64_t ahead, tick;
+
+        if (bitmap == 0)
+            continue;
+
+        /* slot of current index is done, unless now is on its boundary. */
+        if ((self->now & ((1ull << shift) - 1)) != 0)
+            index++;
+        ahead = index < TIMER_WHEEL_SLOTS ? bitmap & (~0ull << index) : 0;
+
+        if (ahead != 0)
+            tick = base + ((uint64_t)__builtin_ctzll(ahead) << shift);
+        else
+            tick = base + ((uint64_t)(TIMER_WHEEL_SLOTS + __builtin_ctzll(bitmap)) << shift);
+
+        if (tick < next)
+            next = tick;
+    }
+    return next;
+}
+
+/* move timers of the slot to lower levels, return the slot index. */
+static int __myutil_timer_wheel_cascade(TimerWheelRef self, int level)
+{
+    int index = (self->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    DbListRef *slot = &self->slots[level][index];
+
+    DbListRef list = *slot;
+
+    *slot = NULL;
+    self->bitmap[level] &= ~(1ull << index);
+    while (list != NULL)
+    {
+        TimerRef timer = DOWN_CAST(list, Timer);
+        DbList_removeFrom(&timer->super, &list);
+        __myutil_timer_wheel_link(self, timer);
+    }
+    return index;
+}
+
+/**
+ * Init timer wheel.
+ * 
+ * @param self: the TimerWheel object to be init.
+ * @param now: current tick.
+ */
+void TimerWheel_init(TimerWheelRef self, uint64_t now)
+{
+    memset(self->slots, 0, sizeof(self->slots));
+    memset(self->bitmap, 0, sizeof(self->bitmap));
+    self->now = now;
+    self->count = 0;
+}
+
+/**
+ * Schedule a timer, a pending timer is rescheduled.
+ * 
+ * A timer expired before now runs on next tick. A timer later than
+ * TIMER_WHEEL_RANGE ticks is cascaded once more per range.
+ * 
+ * @param self: the TimerWheel object.
+ * @param timer: the timer.
+ * @param expires: the expiry tick.
+ * @param callback: the expiry callback.
+ */
+void TimerWheel_schedule(TimerWheelRef self, TimerRef timer, uint64_t expires, TimerCallback callback)
+{
+    if (timer->slot != NULL)
+        __myutil_timer_wheel_unlink(self, timer);
+    else
+        self->count++;
+
+    timer->expires = expires;
+    timer->callback = callback;
+    __myutil_timer_wheel_link(self, timer);
+}
+
+/**
+ * Cancel a timer.
+ * 
+ * @param self: the TimerWheel object.
+ * @param timer: the timer.
+ * @return true if the timer was pending.
+ */
+bool TimerWheel_cancel(TimerWheelRef self, TimerRef timer)
+{
+    if (timer->slot == NULL)
+        return false;
+
+    __myutil_timer_wheel_unlink(self, timer);
+    timer->slot = NULL;
+    self->count--;
+    return true;
+}
+
+/**
+ * Move wheel forward, run callbacks of expired timers.
+ * 
+ * Callbacks could schedule or cancel any timer.
+ * 
+ * @param self: the TimerWheel object.
+ * @param now: the new current tick.
+ * @return the count of expired timers.
+ */
+size_t TimerWheel_advance(TimerWheelRef self, uint64_t now)
+{
+    size_t expired = 0;
+
+    while ((int64_t)(now - self->now) >= 0)
+    {
+        int index = self->now & TIMER_WHEEL_MASK;
+        DbListRef work, *slot;
+        uint64_t next;
+        int level;
+
+        /* lower level wrapped, bring down timers of next round. */
+        if (index == 0)
+        {
+            for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+            {
+                if (__myutil_timer_wheel_cascade(self, level) != 0)
+                    break;
+            }
+        }
+
+        /* detach the slot, so timers scheduled by callbacks wait for next tick. */
+        slot = &self->slots[0][index];
+        work = *slot;
+        *slot = NULL;
+        self->bitmap[0] &= ~(1ull << index);
+        self->now++;
+
+        if (work != NULL)
+        {
+            DbListIter it = DbListIter_new(work);
+            while (DbListIter_next(&it))
+                DbListIter_curObj(it, Timer)->slot = &work;
+        }
+
+        while (work != NULL)
+        {
+            TimerRef timer = DOWN_CAST(work, Timer);
+            DbList_removeFrom(&timer->super, &work);
+            timer->slot = NULL;
+            self->count--;
+            expired++;
+            timer->callback(timer);
+        }
+
+        /* skip empty ticks */
+        next = __myutil_timer_wheel_nextTick(self);
+        if (next > now)
+        {
+            self->now = now + 1;
+            break;
+        }
+        if (next > self->now)
+            self->now = next;
+    }
+    return expired;
+}
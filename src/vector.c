@@ -0,0 +1,65 @@
+/* Copyright (C) 2020 Eason Wang, talktoeason@gmail.com
+ * This file is part of the MyUtil Library.
+ * 
+ * MyUtil library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU GENERAL PUBLIC LICENSE as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ * 
+ * The MyUtil Library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU GENERAL PUBLIC LICENSE
+ * for more details.
+ * 
+ * You should have received a copy of the GNU GENERAL PUBLIC LICENSE along
+ * with the MyUtil Library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file vector.c
+ * @author Eason Wang, talktoeason@gmail.com
+ */
+
+#include "myutil.h"
+
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+ *  Vector implements
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Grow vector storage to hold at least need elements, used by VECTOR_DEFINE.
+ * 
+ * Capacity is doubled until enough, elements are moved to the new block
+ * and the old heap block is freed.
+ * 
+ * @param allocator: the allocator of heap block.
+ * @param heap: the pointer to heap block, NULL for inline storage.
+ * @param small: the inline storage.
+ * @param capacity: the pointer to element capacity.
+ * @param count: the count of elements to move.
+ * @param need: the min capacity.
+ * @param size: the element size.
+ * @return true if success, false if allocation failed and nothing changed.
+ */
+bool Vector_grow(AllocatorRef allocator, void **heap, void *small, size_t *capacity,
+    size_t count, size_t need, size_t size)
+{
+    size_t grown = MAX(*capacity, 1);
+    void *block;
+
+    while (grown < need)
+        grown *= 2;
+
+    block = Allocator_alloc(allocator, grown * size);
+    if (block == NULL)
+        return false;
+
+    memcpy(block, *heap != NULL ? *heap : small, count * size);
+    if (*heap != NULL)
+        Allocator_free(allocator, *heap);
+    *heap = block;
+    *capacity = grown;
+    return true;
+}
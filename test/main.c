@@ -1,6 +1,6 @@
 #include "myutil.h"
 
-TEST_MAIN(types, macros, allocator, list, double_list)
+TEST_MAIN(types, macros, allocator, list, double_list, rcu, hash_table, lru_cache, skip_list, rb_tree, timer_wheel, pairing_heap, thread_pool, offset_list, spsc_ring, task_scheduler, art, bitset, vector, flat_map, bp_tree, bloom_filter, string_pool, rope, async_log, bin_log)
 {
 
 }
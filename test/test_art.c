@@ -0,0 +1,290 @@
+#include "myutil.h"
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct _IntArt
+{
+    ArtLeaf super;
+    uint8_t key[8];
+    uint64_t value;
+} IntArt, *IntArtRef;
+
+typedef struct _StrArt
+{
+    ArtLeaf super;
+    char key[48];
+} StrArt, *StrArtRef;
+
+#define TEST_ART_HEAP_SIZE 0x400000
+#define TEST_ART_BATCH 10000
+
+static uint32_t __heap[TEST_ART_HEAP_SIZE / 4];
+
+/* a permutation of 0 ~ TEST_ART_BATCH - 1 */
+static int shuffle(int i)
+{
+    return (int)(((uint64_t)i * 7919) % TEST_ART_BATCH);
+}
+
+static void initInt(IntArtRef item, uint64_t value)
+{
+    item->value = value;
+    Art_encodeUint64(item->key, value);
+    ArtLeaf_init(&item->super, item->key, 8);
+}
+
+static IntArtRef findInt(ArtTreeRef tree, uint64_t value)
+{
+    uint8_t key[8];
+    Art_encodeUint64(key, value);
+    ArtLeafRef leaf = ArtTree_find(tree, key, 8);
+    return leaf == NULL ? NULL : DOWN_CAST(leaf, IntArt);
+}
+
+/* values are spread to build every node type */
+static uint64_t spread(int i)
+{
+    return (uint64_t)i * 0x10001 + ((uint64_t)(i % 7) << 40);
+}
+
+/* increasing values over 3 bytes */
+static uint64_t step(int i)
+{
+    return (uint64_t)i * 0x10001;
+}
+
+static void verifyTree(ArtTreeRef tree)
+{
+    ArtIter it;
+    size_t count = 0;
+    uint64_t last = 0;
+
+    ArtIter_init(&it, tree);
+    while (ArtIter_next(&it))
+    {
+        uint64_t value = ArtIter_curObj(it, IntArt)->value;
+        EXPECT_TRUE(count == 0 || last < value);
+        last = value;
+        count++;
+    }
+    EXPECT_EQ(count, ArtTree_count(tree));
+}
+
+TEST_CASE(insert_find)
+{
+    static IntArt items[TEST_ART_BATCH];
+    IntArt other;
+    ArtTree tree;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    ArtTree_init(&tree, alloc);
+    EXPECT_NULL(ArtTree_first(&tree));
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_ART_BATCH; i++)
+    {
+        initInt(&items[i], spread(shuffle(i)));
+        EXPECT_EQ(ArtTree_insert(&tree, &items[i].super), &items[i].super);
+        if (i % 997 == 0)
+            verifyTree(&tree);
+    }
+    EXPECT_EQ(ArtTree_count(&tree), TEST_ART_BATCH);
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_ART_BATCH; i++)
+        EXPECT_EQ(findInt(&tree, spread(i))->value, spread(i));
+    EXPECT_NULL(findInt(&tree, spread(TEST_ART_BATCH)));
+    EXPECT_NULL(findInt(&tree, 1));
+    EXPECT_EQ(DOWN_CAST(ArtTree_first(&tree), IntArt)->value, 0);
+
+    /* same key keeps the existing leaf */
+    initInt(&other, spread(5));
+    EXPECT_EQ(ArtTree_insert(&tree, &other.super), &findInt(&tree, spread(5))->super);
+    EXPECT_EQ(ArtTree_count(&tree), TEST_ART_BATCH);
+
+    /* the leaf already in the tree is a no-op */
+    EXPECT_EQ(ArtTree_insert(&tree, &items[5].super), &items[5].super);
+    EXPECT_EQ(ArtTree_count(&tree), TEST_ART_BATCH);
+
+    ArtTree_destroy(&tree);
+}
+
+TEST_CASE(remove)
+{
+    static IntArt items[TEST_ART_BATCH];
+    ArtTree tree;
+    uint8_t key[8];
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    ArtTree_init(&tree, alloc);
+
+    for (i = 0; i < TEST_ART_BATCH; i++)
+    {
+        initInt(&items[i], spread(shuffle(i)));
+        ArtTree_insert(&tree, &items[i].super);
+    }
+
+    for (i = 0; i < TEST_ART_BATCH; i += 2)
+        EXPECT_EQ(ArtTree_remove(&tree, items[i].key, 8), &items[i].super);
+    EXPECT_NULL(ArtTree_remove(&tree, items[0].key, 8));
+    Art_encodeUint64(key, 1);
+    EXPECT_NULL(ArtTree_remove(&tree, key, 8));
+    EXPECT_EQ(ArtTree_count(&tree), TEST_ART_BATCH / 2);
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_ART_BATCH; i++)
+    {
+        if (i % 2 == 0)
+            EXPECT_NULL(findInt(&tree, items[i].value));
+        else
+            EXPECT_EQ(findInt(&tree, items[i].value), &items[i]);
+    }
+
+    for (i = 1; i < TEST_ART_BATCH; i += 2)
+        EXPECT_EQ(ArtTree_remove(&tree, items[i].key, 8), &items[i].super);
+    EXPECT_EQ(ArtTree_count(&tree), 0);
+    EXPECT_NULL(tree.root);
+}
+
+TEST_CASE(node_types)
+{
+    static IntArt items[256];
+    ArtTree tree;
+    int i, n;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    ArtTree_init(&tree, alloc);
+
+    /* one node gets all 256 children, then shrinks back to a leaf */
+    for (i = 0; i < 256; i++)
+    {
+        initInt(&items[i], 0x1234567800ull + i);
+        ArtTree_insert(&tree, &items[i].super);
+    }
+    verifyTree(&tree);
+
+    for (n = 256; n > 0; n--)
+    {
+        i = shuffle(n) % 256;
+        while (findInt(&tree, items[i].value) == NULL)
+            i = (i + 1) % 256;
+        EXPECT_EQ(ArtTree_remove(&tree, items[i].key, 8), &items[i].super);
+        if (n % 8 == 0 || n < 40)
+        {
+            verifyTree(&tree);
+            EXPECT_NULL(findInt(&tree, items[i].value));
+        }
+    }
+    EXPECT_NULL(tree.root);
+}
+
+TEST_CASE(strings)
+{
+    static StrArt items[1000];
+    StrArt bad;
+    ArtTree tree;
+    ArtIter it;
+    char key[48];
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    ArtTree_init(&tree, alloc);
+
+    /* long shared prefixes, beyond the stored prefix bytes */
+    for (i = 0; i < 1000; i++)
+    {
+        int v = (int)(((uint64_t)i * 7919) % 1000);
+        snprintf(items[i].key, sizeof(items[i].key), "service/user/profile/%c/%04d", "abc"[v % 3], v);
+        ArtLeaf_init(&items[i].super, items[i].key, strlen(items[i].key) + 1);
+        EXPECT_EQ(ArtTree_insert(&tree, &items[i].super), &items[i].super);
+    }
+
+    for (i = 0; i < 1000; i++)
+    {
+        ArtLeafRef leaf = ArtTree_find(&tree, items[i].key, strlen(items[i].key) + 1);
+        EXPECT_EQ(leaf, &items[i].super);
+    }
+    EXPECT_NULL(ArtTree_find(&tree, "service/user/profile/a", 23));
+    EXPECT_NULL(ArtTree_find(&tree, "service/user/profile/a/0000", 27));
+    EXPECT_NULL(ArtTree_find(&tree, "service/user/profiles/a/0000", 29));
+
+    /* a key without '\0' is a prefix of others */
+    ArtLeaf_init(&bad.super, "service/user/profile/b", 22);
+    EXPECT_NULL(ArtTree_insert(&tree, &bad.super));
+    EXPECT_EQ(ArtTree_count(&tree), 1000);
+
+    /* range of prefix "b/" in order */
+    ArtIter_seek(&it, &tree, "service/user/profile/b/", 23);
+    key[0] = '\0';
+    for (i = 0; i < 333 && ArtIter_next(&it); i++)
+    {
+        StrArtRef item = ArtIter_curObj(it, StrArt);
+        EXPECT_EQ(strncmp(item->key, "service/user/profile/b/", 23), 0);
+        EXPECT_GT(strcmp(item->key, key), 0);
+        strcpy(key, item->key);
+    }
+    EXPECT_EQ(i, 333);
+    EXPECT_TRUE(ArtIter_next(&it));
+    EXPECT_EQ(strncmp(ArtIter_curObj(it, StrArt)->key, "service/user/profile/c/", 23), 0);
+
+    ArtTree_destroy(&tree);
+}
+
+TEST_CASE(seek)
+{
+    static IntArt items[TEST_ART_BATCH];
+    ArtTree tree;
+    ArtIter it;
+    uint8_t key[8];
+    uint64_t i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    ArtTree_init(&tree, alloc);
+
+    /* even values only */
+    for (i = 0; i < TEST_ART_BATCH; i++)
+    {
+        initInt(&items[i], step(shuffle(i)) * 2);
+        ArtTree_insert(&tree, &items[i].super);
+    }
+
+    for (i = 0; i < TEST_ART_BATCH - 1; i += 37)
+    {
+        Art_encodeUint64(key, step(i) * 2 + 1);
+        ArtIter_seek(&it, &tree, key, 8);
+        EXPECT_TRUE(ArtIter_next(&it));
+        EXPECT_EQ(ArtIter_curObj(it, IntArt)->value, step(i + 1) * 2);
+
+        Art_encodeUint64(key, step(i) * 2);
+        ArtIter_seek(&it, &tree, key, 8);
+        EXPECT_TRUE(ArtIter_next(&it));
+        EXPECT_EQ(ArtIter_curObj(it, IntArt)->value, step(i) * 2);
+        EXPECT_TRUE(ArtIter_next(&it));
+        EXPECT_EQ(ArtIter_curObj(it, IntArt)->value, step(i + 1) * 2);
+    }
+
+    /* before the first and after the last */
+    Art_encodeUint64(key, 0);
+    ArtIter_seek(&it, &tree, key, 1);
+    EXPECT_TRUE(ArtIter_next(&it));
+    EXPECT_EQ(ArtIter_curObj(it, IntArt)->value, 0);
+
+    Art_encodeUint64(key, step(TEST_ART_BATCH - 1) * 2 + 1);
+    ArtIter_seek(&it, &tree, key, 8);
+    EXPECT_FALSE(ArtIter_next(&it));
+    EXPECT_NULL(ArtIter_current(&it));
+
+    ArtTree_destroy(&tree);
+}
+
+TEST_SUITE(art)
+{
+    TEST_RUN_CASE(insert_find);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(node_types);
+    TEST_RUN_CASE(strings);
+    TEST_RUN_CASE(seek);
+}
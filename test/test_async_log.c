@@ -0,0 +1,223 @@
+#define LOG_LEVEL LOG_INFO
+#define LOG_ASYNC
+#include "myutil.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_ASYNC_LOG_HEAP_SIZE 0x40000
+#define TEST_ASYNC_LOG_BATCH 1000
+#define TEST_ASYNC_LOG_THREADS 4
+
+static uint32_t __heap[TEST_ASYNC_LOG_HEAP_SIZE / 4];
+
+/** collects sink output, written by the flusher thread only */
+typedef struct _LogCapture
+{
+    char text[0x10000];
+    size_t len;
+    size_t writes;
+    int gate;                   /**< sink spins while non zero */
+    int next[TEST_ASYNC_LOG_THREADS];
+    int misordered;
+    int lines;
+} LogCapture;
+
+static LogCapture __capture;
+
+static void captureSink(void const *data, size_t len, void *arg)
+{
+    LogCapture *capture = (LogCapture *)arg;
+
+    while (__atomic_load_n(&capture->gate, __ATOMIC_ACQUIRE))
+        sched_yield();
+
+    len = MIN(len, sizeof(capture->text) - capture->len);
+    memcpy(capture->text + capture->len, data, len);
+    capture->len += len;
+    capture->writes++;
+}
+
+/* check "<thread> <seq>" lines are in order per thread. */
+static void orderSink(void const *data, size_t len, void *arg)
+{
+    LogCapture *capture = (LogCapture *)arg;
+    char const *p = (char const *)data, *end = p + len;
+
+    while (p < end)
+    {
+        char *next;
+        int thread = (int)strtol(p, &next, 10);
+        int seq = (int)strtol(next, &next, 10);
+
+        if (thread < 0 || thread >= TEST_ASYNC_LOG_THREADS || capture->next[thread] != seq)
+            capture->misordered++;
+        else
+            capture->next[thread]++;
+        capture->lines++;
+        p = (char const *)memchr(next, '\n', end - next) + 1;
+    }
+}
+
+static void resetCapture(void)
+{
+    memset(&__capture, 0, sizeof(__capture));
+}
+
+TEST_CASE(write_flush)
+{
+    AsyncLog log;
+    char expect[32];
+    size_t pos = 0;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(AsyncLog_init(&log, alloc, 100, ASYNC_LOG_BLOCK, captureSink, &__capture));
+    EXPECT_EQ(log.capacity, 128);
+
+    for (i = 0; i < TEST_ASYNC_LOG_BATCH; i++)
+        EXPECT_TRUE(AsyncLog_write(&log, "[T] ", "message %d", i));
+    AsyncLog_flush(&log);
+
+    for (i = 0; i < TEST_ASYNC_LOG_BATCH; i++)
+    {
+        snprintf(expect, sizeof(expect), "[T] message %d\n", i);
+        if (strncmp(__capture.text + pos, expect, strlen(expect)) != 0)
+            break;
+        pos += strlen(expect);
+    }
+    EXPECT_EQ(i, TEST_ASYNC_LOG_BATCH);
+    EXPECT_EQ(pos, __capture.len);
+
+    /* messages are batched into fewer sink writes */
+    EXPECT_LE(__capture.writes, TEST_ASYNC_LOG_BATCH);
+    EXPECT_GE(__capture.writes, TEST_ASYNC_LOG_BATCH / ASYNC_LOG_BATCH);
+    EXPECT_EQ(AsyncLog_dropped(&log), 0);
+
+    AsyncLog_destroy(&log);
+    EXPECT_NULL(log.core);
+}
+
+TEST_CASE(truncate)
+{
+    static char text[ASYNC_LOG_SLOT_SIZE * 2];
+    AsyncLog log;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(AsyncLog_init(&log, alloc, 4, ASYNC_LOG_BLOCK, captureSink, &__capture));
+
+    memset(text, 'x', sizeof(text) - 1);
+    EXPECT_TRUE(AsyncLog_write(&log, NULL, "%s", text));
+    EXPECT_TRUE(AsyncLog_write(&log, NULL, "%s", ""));
+    AsyncLog_flush(&log);
+
+    /* the message keeps its newline, the next one is intact. */
+    EXPECT_LT(__capture.len, ASYNC_LOG_SLOT_SIZE);
+    EXPECT_GT(__capture.len, ASYNC_LOG_SLOT_SIZE - 32);
+    EXPECT_EQ(__capture.text[__capture.len - 2], '\n');
+    EXPECT_EQ(__capture.text[__capture.len - 3], 'x');
+    EXPECT_EQ(__capture.text[__capture.len - 1], '\n');
+
+    /* destroy writes what is queued */
+    EXPECT_TRUE(AsyncLog_write(&log, NULL, "last"));
+    AsyncLog_destroy(&log);
+    EXPECT_EQ(strncmp(__capture.text + __capture.len - 5, "last\n", 5), 0);
+}
+
+TEST_CASE(drop)
+{
+    AsyncLog log;
+    int i, written = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(AsyncLog_init(&log, alloc, 8, ASYNC_LOG_DROP, captureSink, &__capture));
+
+    /* a stalled sink never stalls producers */
+    __capture.gate = 1;
+    for (i = 0; i < TEST_ASYNC_LOG_BATCH; i++)
+        written += AsyncLog_write(&log, NULL, "%d", i) ? 1 : 0;
+    EXPECT_GE(written, 8);
+    EXPECT_LE(written, 8 + ASYNC_LOG_BATCH);
+    EXPECT_EQ(AsyncLog_dropped(&log), TEST_ASYNC_LOG_BATCH - written);
+
+    __atomic_store_n(&__capture.gate, 0, __ATOMIC_RELEASE);
+    AsyncLog_flush(&log);
+    EXPECT_TRUE(AsyncLog_write(&log, NULL, "after"));
+    AsyncLog_destroy(&log);
+    EXPECT_EQ(strncmp(__capture.text + __capture.len - 6, "after\n", 6), 0);
+}
+
+static void *writeThread(void *arg)
+{
+    AsyncLogRef log = (AsyncLogRef)((void **)arg)[0];
+    int thread = (int)(intptr_t)((void **)arg)[1];
+    int i;
+
+    for (i = 0; i < TEST_ASYNC_LOG_BATCH; i++)
+        AsyncLog_write(log, NULL, "%d %d", thread, i);
+    return NULL;
+}
+
+TEST_CASE(block)
+{
+    pthread_t threads[TEST_ASYNC_LOG_THREADS];
+    void *args[TEST_ASYNC_LOG_THREADS][2];
+    AsyncLog log;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(AsyncLog_init(&log, alloc, 16, ASYNC_LOG_BLOCK, orderSink, &__capture));
+
+    for (i = 0; i < TEST_ASYNC_LOG_THREADS; i++)
+    {
+        args[i][0] = &log;
+        args[i][1] = (void *)(intptr_t)i;
+        pthread_create(&threads[i], NULL, writeThread, args[i]);
+    }
+    for (i = 0; i < TEST_ASYNC_LOG_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    AsyncLog_flush(&log);
+
+    /* nothing lost, each thread in its own order */
+    EXPECT_EQ(AsyncLog_dropped(&log), 0);
+    EXPECT_EQ(__capture.lines, TEST_ASYNC_LOG_THREADS * TEST_ASYNC_LOG_BATCH);
+    EXPECT_EQ(__capture.misordered, 0);
+    AsyncLog_destroy(&log);
+}
+
+TEST_CASE(log_macros)
+{
+    AsyncLog log;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(AsyncLog_init(&log, alloc, 16, ASYNC_LOG_BLOCK, captureSink, &__capture));
+
+    AsyncLog_setDefault(&log);
+    LOGE("error %d", 1);
+    LOGW("warning");
+    LOGI("info %s", "text");
+    LOGD("debug is above level");
+    AsyncLog_flush(&log);
+    __capture.text[__capture.len] = '\0';
+    EXPECT_EQ_S(__capture.text, "[E] error 1\n[W] warning\n[I] info text\n");
+
+    /* destroy resets the default */
+    AsyncLog_destroy(&log);
+    LOGI("async_log - printed without default");
+}
+
+TEST_SUITE(async_log)
+{
+    TEST_RUN_CASE(write_flush);
+    TEST_RUN_CASE(truncate);
+    TEST_RUN_CASE(drop);
+    TEST_RUN_CASE(block);
+    TEST_RUN_CASE(log_macros);
+}
@@ -0,0 +1,238 @@
+#include "myutil.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BIN_LOG_HEAP_SIZE 0x40000
+#define TEST_BIN_LOG_BATCH 1000
+#define TEST_BIN_LOG_THREADS 4
+
+static uint32_t __heap[TEST_BIN_LOG_HEAP_SIZE / 4];
+
+/** collects formatted text, lines without time prefix */
+typedef struct _BinLogCapture
+{
+    char text[0x10000];
+    size_t len;
+    int lines;
+    int last[TEST_BIN_LOG_THREADS];
+    int misordered;
+} BinLogCapture;
+
+static BinLogCapture __capture;
+
+static void captureSink(void const *data, size_t len, void *arg)
+{
+    BinLogCapture *capture = (BinLogCapture *)arg;
+    char const *p = (char const *)data, *end = p + len;
+
+    while (p < end)
+    {
+        char const *eol = (char const *)memchr(p, '\n', end - p);
+        char const *msg = strstr(p, "] ") + 2;
+        size_t n = MIN((size_t)(eol + 1 - msg), sizeof(capture->text) - 1 - capture->len);
+
+        memcpy(capture->text + capture->len, msg, n);
+        capture->len += n;
+        capture->text[capture->len] = '\0';
+        capture->lines++;
+        p = eol + 1;
+    }
+}
+
+/* check "<thread> <seq>" lines are increasing per thread. */
+static void orderSink(void const *data, size_t len, void *arg)
+{
+    BinLogCapture *capture = (BinLogCapture *)arg;
+    char const *p = (char const *)data, *end = p + len;
+
+    while (p < end)
+    {
+        char *next;
+        int thread = (int)strtol(strstr(p, "] ") + 2, &next, 10);
+        int seq = (int)strtol(next, &next, 10);
+
+        if (thread < 0 || thread >= TEST_BIN_LOG_THREADS || seq <= capture->last[thread])
+            capture->misordered++;
+        else
+            capture->last[thread] = seq;
+        capture->lines++;
+        p = (char const *)memchr(next, '\n', end - next) + 1;
+    }
+}
+
+static void resetCapture(void)
+{
+    int i;
+
+    memset(&__capture, 0, sizeof(__capture));
+    for (i = 0; i < TEST_BIN_LOG_THREADS; i++)
+        __capture.last[i] = -1;
+}
+
+TEST_CASE(format)
+{
+    BinLog log;
+    BinLogWriter writer;
+    char name[] = "stack";
+    char const *none = NULL;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(BinLog_init(&log, alloc));
+    EXPECT_TRUE(BinLog_attach(&log, &writer, 4096));
+
+    BIN_LOG(&writer, "no arguments");
+    BIN_LOG(&writer, "int %d uint %u long %ld hex %#x char %c", -5, 7u, -1L, 255, 'z');
+    BIN_LOG(&writer, "double %.2f %g, 100%%", 3.14159, 0.5f);
+    BIN_LOG(&writer, "[%5d|%-4s|%s]", 42, "ab", name);
+    BIN_LOG(&writer, "null %s, pointer %p", none, (void *)0x1234);
+    BIN_LOG(&writer, "%llu %hhd %zu", 18446744073709551615ull, (signed char)-3, sizeof(int));
+
+    /* the string is copied at the call */
+    strcpy(name, "later");
+    EXPECT_EQ(BinLog_format(&log, captureSink, &__capture), 6);
+    EXPECT_EQ(BinLog_format(&log, captureSink, &__capture), 0);
+    EXPECT_EQ_S(__capture.text,
+        "no arguments\n"
+        "int -5 uint 7 long -1 hex 0xff char z\n"
+        "double 3.14 0.5, 100%\n"
+        "[   42|ab  |stack]\n"
+        "null (null), pointer 0x1234\n"
+        "18446744073709551615 -3 4\n");
+
+    BinLog_destroy(&log);
+}
+
+TEST_CASE(time_order)
+{
+    BinLog log;
+    BinLogWriter a, b;
+    char expect[32];
+    size_t pos = 0;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(BinLog_init(&log, alloc));
+    EXPECT_TRUE(BinLog_attach(&log, &a, 0x4000));
+    EXPECT_TRUE(BinLog_attach(&log, &b, 0x4000));
+
+    /* records of writers are merged by time */
+    for (i = 0; i < 100; i++)
+    {
+        if (i % 3 == 0)
+            BIN_LOG(&a, "a %d", i);
+        else
+            BIN_LOG(&b, "b %d", i);
+    }
+    EXPECT_EQ(BinLog_format(&log, captureSink, &__capture), 100);
+
+    for (i = 0; i < 100; i++)
+    {
+        snprintf(expect, sizeof(expect), "%c %d\n", i % 3 == 0 ? 'a' : 'b', i);
+        if (strncmp(__capture.text + pos, expect, strlen(expect)) != 0)
+            break;
+        pos += strlen(expect);
+    }
+    EXPECT_EQ(i, 100);
+
+    BinLog_destroy(&log);
+}
+
+TEST_CASE(wrap_drop)
+{
+    BinLog log;
+    BinLogWriter writer;
+    int i, j, written = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(BinLog_init(&log, alloc));
+    EXPECT_TRUE(BinLog_attach(&log, &writer, 0));
+    EXPECT_EQ(writer.mask + 1, 256);
+
+    /* 32 bytes a record, full after 8 */
+    for (i = 0; i < 10; i++)
+        BIN_LOG(&writer, "0 %d", i);
+    EXPECT_EQ(BinLog_dropped(&log), 2);
+    EXPECT_EQ(BinLog_format(&log, orderSink, &__capture), 8);
+
+    /* records never straddle the buffer end */
+    for (i = 10; i < TEST_BIN_LOG_BATCH; i += 5)
+    {
+        for (j = 0; j < 5; j++)
+            BIN_LOG(&writer, "0 %d %s", i + j, j % 2 ? "odd" : "even");
+        written += 5;
+        EXPECT_EQ(BinLog_format(&log, orderSink, &__capture), 5);
+    }
+    EXPECT_EQ(__capture.lines, 8 + written);
+    EXPECT_EQ(__capture.misordered, 0);
+    EXPECT_EQ(__capture.last[0], TEST_BIN_LOG_BATCH - 1);
+    EXPECT_EQ(BinLog_dropped(&log), 2);
+
+    BinLog_destroy(&log);
+}
+
+typedef struct _BinLogTestContext
+{
+    BinLog log;
+    BinLogWriter writers[TEST_BIN_LOG_THREADS];
+    int running;
+} BinLogTestContext;
+
+static BinLogTestContext __context;
+
+static void *writeThread(void *arg)
+{
+    int thread = (int)(intptr_t)arg;
+    int i;
+
+    for (i = 0; i < TEST_BIN_LOG_BATCH; i++)
+        BIN_LOG(&__context.writers[thread], "%d %d", thread, i);
+    __atomic_fetch_sub(&__context.running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *formatThread(void *arg)
+{
+    (void)arg;
+    while (__atomic_load_n(&__context.running, __ATOMIC_ACQUIRE) != 0)
+        BinLog_format(&__context.log, orderSink, &__capture);
+    BinLog_format(&__context.log, orderSink, &__capture);
+    return NULL;
+}
+
+TEST_CASE(concurrent)
+{
+    pthread_t threads[TEST_BIN_LOG_THREADS], consumer;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    resetCapture();
+    EXPECT_TRUE(BinLog_init(&__context.log, alloc));
+    for (i = 0; i < TEST_BIN_LOG_THREADS; i++)
+        EXPECT_TRUE(BinLog_attach(&__context.log, &__context.writers[i], 0x1000));
+    __context.running = TEST_BIN_LOG_THREADS;
+
+    pthread_create(&consumer, NULL, formatThread, NULL);
+    for (i = 0; i < TEST_BIN_LOG_THREADS; i++)
+        pthread_create(&threads[i], NULL, writeThread, (void *)(intptr_t)i);
+    for (i = 0; i < TEST_BIN_LOG_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    pthread_join(consumer, NULL);
+
+    /* every record is either formatted in order or counted as dropped */
+    EXPECT_EQ(__capture.misordered, 0);
+    EXPECT_EQ(__capture.lines + BinLog_dropped(&__context.log), TEST_BIN_LOG_THREADS * TEST_BIN_LOG_BATCH);
+    BinLog_destroy(&__context.log);
+}
+
+TEST_SUITE(bin_log)
+{
+    TEST_RUN_CASE(format);
+    TEST_RUN_CASE(time_order);
+    TEST_RUN_CASE(wrap_drop);
+    TEST_RUN_CASE(concurrent);
+}
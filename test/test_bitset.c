@@ -0,0 +1,181 @@
+#include "myutil.h"
+
+#define TEST_BITSET_HEAP_SIZE 0x10000
+#define TEST_BITSET_BITS 5000
+
+static uint32_t __heap[TEST_BITSET_HEAP_SIZE / 4];
+
+/* a pseudo random pattern */
+static bool pattern(size_t i, uint64_t seed)
+{
+    return (Hash_uint64(i ^ seed) & 3) == 0;
+}
+
+TEST_CASE(set_clear)
+{
+    Bitset set;
+    size_t i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(Bitset_init(&set, alloc, TEST_BITSET_BITS));
+    EXPECT_EQ(Bitset_size(&set), TEST_BITSET_BITS);
+    EXPECT_EQ(Bitset_count(&set), 0);
+    EXPECT_EQ(Bitset_findFirstSet(&set, 0), BITSET_NONE);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 0), 0);
+
+    for (i = 0; i < TEST_BITSET_BITS; i += 3)
+        Bitset_set(&set, i);
+    for (i = 0; i < TEST_BITSET_BITS; i++)
+        EXPECT_EQ(Bitset_test(&set, i), i % 3 == 0);
+    EXPECT_EQ(Bitset_count(&set), (TEST_BITSET_BITS + 2) / 3);
+
+    Bitset_clear(&set, 0);
+    Bitset_clear(&set, 0);
+    EXPECT_FALSE(Bitset_test(&set, 0));
+    EXPECT_EQ(Bitset_count(&set), (TEST_BITSET_BITS + 2) / 3 - 1);
+
+    /* fill keeps bits beyond size clear */
+    Bitset_fill(&set, true);
+    EXPECT_EQ(Bitset_count(&set), TEST_BITSET_BITS);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 0), BITSET_NONE);
+    Bitset_fill(&set, false);
+    EXPECT_EQ(Bitset_count(&set), 0);
+
+    Bitset_destroy(&set);
+
+    EXPECT_TRUE(Bitset_init(&set, alloc, 0));
+    Bitset_fill(&set, true);
+    EXPECT_EQ(Bitset_count(&set), 0);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 0), BITSET_NONE);
+
+    /* allocation failure */
+    alloc = StaticAllocator(64, __heap);
+    EXPECT_FALSE(Bitset_init(&set, alloc, TEST_BITSET_BITS));
+}
+
+TEST_CASE(find)
+{
+    Bitset set;
+    size_t i, next;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(Bitset_init(&set, alloc, TEST_BITSET_BITS));
+
+    for (i = 0; i < TEST_BITSET_BITS; i++)
+    {
+        if (pattern(i, 1))
+            Bitset_set(&set, i);
+    }
+
+    /* walk set bits and zero bits, compare with a linear scan */
+    for (i = 0, next = 0; i < TEST_BITSET_BITS; i++)
+    {
+        if (pattern(i, 1))
+        {
+            EXPECT_EQ(Bitset_findFirstSet(&set, next), i);
+            next = i + 1;
+        }
+    }
+    EXPECT_EQ(Bitset_findFirstSet(&set, next), BITSET_NONE);
+
+    Bitset_fill(&set, true);
+    Bitset_clear(&set, 100);
+    Bitset_clear(&set, TEST_BITSET_BITS - 1);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 0), 100);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 100), 100);
+    EXPECT_EQ(Bitset_findFirstZero(&set, 101), TEST_BITSET_BITS - 1);
+    EXPECT_EQ(Bitset_findFirstZero(&set, TEST_BITSET_BITS), BITSET_NONE);
+    EXPECT_EQ(Bitset_findFirstSet(&set, TEST_BITSET_BITS - 1), BITSET_NONE);
+
+    Bitset_destroy(&set);
+}
+
+TEST_CASE(bulk)
+{
+    Bitset a, b, c;
+    size_t i, count;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(Bitset_init(&a, alloc, TEST_BITSET_BITS));
+    EXPECT_TRUE(Bitset_init(&b, alloc, TEST_BITSET_BITS));
+    EXPECT_TRUE(Bitset_init(&c, alloc, TEST_BITSET_BITS));
+
+    for (i = 0; i < TEST_BITSET_BITS; i++)
+    {
+        if (pattern(i, 1))
+            Bitset_set(&a, i);
+        if (pattern(i, 2))
+            Bitset_set(&b, i);
+    }
+
+#define TEST_BITSET_BULK(op, expr) do { \
+        Bitset_fill(&c, false); \
+        Bitset_or(&c, &a); \
+        op(&c, &b); \
+        for (i = 0, count = 0; i < TEST_BITSET_BITS; i++) \
+        { \
+            bool x = pattern(i, 1), y = pattern(i, 2); \
+            EXPECT_EQ(Bitset_test(&c, i), (expr)); \
+            count += (expr); \
+        } \
+        EXPECT_EQ(Bitset_count(&c), count); \
+    } while (0)
+
+    TEST_BITSET_BULK(Bitset_and, x && y);
+    TEST_BITSET_BULK(Bitset_or, x || y);
+    TEST_BITSET_BULK(Bitset_xor, x != y);
+    TEST_BITSET_BULK(Bitset_andNot, x && !y);
+
+    Bitset_destroy(&c);
+    Bitset_destroy(&b);
+    Bitset_destroy(&a);
+}
+
+TEST_CASE(rank_select)
+{
+    Bitset set;
+    size_t i, rank;
+    int indexed;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(Bitset_init(&set, alloc, TEST_BITSET_BITS));
+    for (i = 0; i < TEST_BITSET_BITS; i++)
+    {
+        if (pattern(i, 3))
+            Bitset_set(&set, i);
+    }
+
+    /* same results without and with index */
+    for (indexed = 0; indexed < 2; indexed++)
+    {
+        if (indexed)
+            EXPECT_TRUE(Bitset_buildRank(&set));
+
+        for (i = 0, rank = 0; i < TEST_BITSET_BITS; i++)
+        {
+            EXPECT_EQ(Bitset_rank(&set, i), rank);
+            if (pattern(i, 3))
+            {
+                EXPECT_EQ(Bitset_select(&set, rank), i);
+                rank++;
+            }
+        }
+        EXPECT_EQ(Bitset_rank(&set, TEST_BITSET_BITS), rank);
+        EXPECT_EQ(Bitset_select(&set, rank), BITSET_NONE);
+    }
+
+    /* rebuild after change */
+    Bitset_clear(&set, Bitset_select(&set, 0));
+    EXPECT_TRUE(Bitset_buildRank(&set));
+    EXPECT_EQ(Bitset_rank(&set, TEST_BITSET_BITS), rank - 1);
+
+    Bitset_destroy(&set);
+}
+
+TEST_SUITE(bitset)
+{
+    TEST_RUN_CASE(set_clear);
+    TEST_RUN_CASE(find);
+    TEST_RUN_CASE(bulk);
+    TEST_RUN_CASE(rank_select);
+}
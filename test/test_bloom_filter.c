@@ -0,0 +1,146 @@
+#include "myutil.h"
+
+#include <string.h>
+
+#define TEST_BLOOM_HEAP_SIZE 0x40000
+#define TEST_BLOOM_KEYS 10000
+#define TEST_BLOOM_PROBES 100000
+
+static uint32_t __heap[TEST_BLOOM_HEAP_SIZE / 4];
+static uint8_t __buf[TEST_BLOOM_HEAP_SIZE / 2];
+
+/* keys added are even, probes of absent keys are odd. */
+static uint64_t keyOf(int i)
+{
+    return (uint64_t)i * 2;
+}
+
+TEST_CASE(sizing)
+{
+    size_t blocks;
+
+    EXPECT_EQ_F(BloomFilter_fpr(0, 1), 0);
+    EXPECT_LT_F(BloomFilter_fpr(1000, 100), BloomFilter_fpr(1000, 50));
+    EXPECT_LT_F(BloomFilter_fpr(1000, 50), BloomFilter_fpr(2000, 50));
+    EXPECT_GT_F(BloomFilter_fpr(100000, 1), 0.99);
+
+    blocks = BloomFilter_blocksFor(TEST_BLOOM_KEYS, 0.01);
+    EXPECT_LE_F(BloomFilter_fpr(TEST_BLOOM_KEYS, blocks), 0.01);
+    EXPECT_GT_F(BloomFilter_fpr(TEST_BLOOM_KEYS, blocks - 1), 0.01);
+
+    /* a few more bits per key than a classic bloom filter, 9.6 bits. */
+    EXPECT_GT(blocks * 512, TEST_BLOOM_KEYS * 9);
+    EXPECT_LT(blocks * 512, TEST_BLOOM_KEYS * 14);
+    EXPECT_EQ(BloomFilter_blocksFor(0, 0.01), 1);
+}
+
+TEST_CASE(add_contains)
+{
+    BloomFilter filter;
+    size_t blocks = BloomFilter_blocksFor(TEST_BLOOM_KEYS, 0.01);
+    int i, positives = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(BloomFilter_init(&filter, alloc, blocks));
+    EXPECT_EQ(BloomFilter_blocks(&filter), blocks);
+    EXPECT_EQ((uintptr_t)filter.blocks % BLOOM_FILTER_BLOCK_SIZE, 0);
+    EXPECT_FALSE(BloomFilter_contains(&filter, 0));
+
+    for (i = 0; i < TEST_BLOOM_KEYS; i++)
+        BloomFilter_add(&filter, keyOf(i));
+
+    /* no false negatives */
+    for (i = 0; i < TEST_BLOOM_KEYS; i++)
+        EXPECT_TRUE(BloomFilter_contains(&filter, keyOf(i)));
+
+    /* measured rate is close to the estimate. */
+    for (i = 0; i < TEST_BLOOM_PROBES; i++)
+        positives += BloomFilter_contains(&filter, keyOf(i) + 1);
+    EXPECT_GT(positives, TEST_BLOOM_PROBES / 100 / 2);
+    EXPECT_LT(positives, TEST_BLOOM_PROBES / 100 * 2);
+
+    BloomFilter_clear(&filter);
+    EXPECT_FALSE(BloomFilter_contains(&filter, keyOf(0)));
+    BloomFilter_destroy(&filter);
+
+    /* allocation failure */
+    alloc = StaticAllocator(BLOOM_FILTER_BLOCK_SIZE * 4, __heap);
+    EXPECT_FALSE(BloomFilter_init(&filter, alloc, 16));
+    EXPECT_FALSE(BloomFilter_init(&filter, alloc, 0));
+}
+
+TEST_CASE(batch)
+{
+    static uint64_t keys[TEST_BLOOM_KEYS];
+    static uint8_t results[TEST_BLOOM_KEYS];
+    BloomFilter filter;
+    size_t found, expected = 0;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(BloomFilter_init(&filter, alloc, BloomFilter_blocksFor(TEST_BLOOM_KEYS / 2, 0.05)));
+    for (i = 0; i < TEST_BLOOM_KEYS / 2; i++)
+        BloomFilter_add(&filter, keyOf(i));
+
+    /* half present, half absent, an odd count for the tail. */
+    for (i = 0; i < TEST_BLOOM_KEYS; i++)
+        keys[i] = i;
+    found = BloomFilter_containsBatch(&filter, keys, TEST_BLOOM_KEYS - 3, results);
+    for (i = 0; i < TEST_BLOOM_KEYS - 3; i++)
+    {
+        EXPECT_EQ(results[i], BloomFilter_contains(&filter, keys[i]));
+        expected += results[i];
+    }
+    EXPECT_EQ(found, expected);
+    EXPECT_GE(found, (TEST_BLOOM_KEYS - 3) / 2);
+    EXPECT_EQ(BloomFilter_containsBatch(&filter, keys, TEST_BLOOM_KEYS - 3, NULL), found);
+
+    BloomFilter_destroy(&filter);
+}
+
+TEST_CASE(serialize)
+{
+    BloomFilter filter, copy;
+    size_t size;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(BloomFilter_init(&filter, alloc, 100));
+    for (i = 0; i < 1000; i++)
+        BloomFilter_add(&filter, keyOf(i));
+
+    size = BloomFilter_serializedSize(&filter);
+    EXPECT_EQ(size, BLOOM_FILTER_HEADER_SIZE + 100 * BLOOM_FILTER_BLOCK_SIZE);
+    EXPECT_EQ(BloomFilter_serialize(&filter, __buf, size - 1), 0);
+    EXPECT_EQ(BloomFilter_serialize(&filter, __buf, sizeof(__buf)), size);
+
+    /* header is little endian */
+    EXPECT_EQ(__buf[0], 'M');
+    EXPECT_EQ(__buf[3], 'F');
+    EXPECT_EQ(__buf[4], BLOOM_FILTER_BLOCK_WORDS);
+    EXPECT_EQ(__buf[8], 100);
+
+    EXPECT_TRUE(BloomFilter_deserialize(&copy, alloc, __buf, size));
+    EXPECT_EQ(BloomFilter_blocks(&copy), 100);
+    EXPECT_EQ(memcmp(copy.blocks, filter.blocks, 100 * BLOOM_FILTER_BLOCK_SIZE), 0);
+    for (i = 0; i < 1000; i++)
+        EXPECT_TRUE(BloomFilter_contains(&copy, keyOf(i)));
+    BloomFilter_destroy(&copy);
+
+    /* malformed data */
+    EXPECT_FALSE(BloomFilter_deserialize(&copy, alloc, __buf, size - 1));
+    EXPECT_FALSE(BloomFilter_deserialize(&copy, alloc, __buf, 8));
+    __buf[0] = 0;
+    EXPECT_FALSE(BloomFilter_deserialize(&copy, alloc, __buf, size));
+    BloomFilter_destroy(&copy);
+
+    BloomFilter_destroy(&filter);
+}
+
+TEST_SUITE(bloom_filter)
+{
+    TEST_RUN_CASE(sizing);
+    TEST_RUN_CASE(add_contains);
+    TEST_RUN_CASE(batch);
+    TEST_RUN_CASE(serialize);
+}
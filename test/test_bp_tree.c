@@ -0,0 +1,200 @@
+#include "myutil.h"
+
+#define TEST_BP_HEAP_SIZE 0x100000
+#define TEST_BP_BATCH 10000
+
+static uint32_t __heap[TEST_BP_HEAP_SIZE / 4];
+
+/* a permutation of 0 ~ TEST_BP_BATCH - 1 */
+static uint64_t shuffle(int i)
+{
+    return ((uint64_t)i * 7919) % TEST_BP_BATCH;
+}
+
+static ref_t valueOf(uint64_t key)
+{
+    return (ref_t)(uintptr_t)(key + 1);
+}
+
+/* walk the leaf chain, keys must be increasing with their own values. */
+static void verifyTree(BpTreeRef tree)
+{
+    BpTreeIter it;
+    size_t count = 0;
+    uint64_t last = 0;
+
+    BpTreeIter_init(&it, tree);
+    while (BpTreeIter_next(&it))
+    {
+        if (count > 0)
+            EXPECT_LT(last, BpTreeIter_key(&it));
+        EXPECT_EQ(BpTreeIter_value(&it), valueOf(BpTreeIter_key(&it)));
+        last = BpTreeIter_key(&it);
+        count++;
+    }
+    EXPECT_EQ(count, BpTree_count(tree));
+}
+
+TEST_CASE(insert_find)
+{
+    BpTree tree;
+    ref_t value;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    BpTree_init(&tree, alloc);
+    EXPECT_FALSE(BpTree_find(&tree, 0, NULL));
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+    {
+        EXPECT_TRUE(BpTree_insert(&tree, shuffle(i) * 2, valueOf(shuffle(i) * 2)));
+        if (i % 997 == 0)
+            verifyTree(&tree);
+    }
+    EXPECT_EQ(BpTree_count(&tree), TEST_BP_BATCH);
+    EXPECT_GE(tree.height, 3);
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+    {
+        EXPECT_TRUE(BpTree_find(&tree, i * 2, &value));
+        EXPECT_EQ(value, valueOf(i * 2));
+        EXPECT_FALSE(BpTree_find(&tree, i * 2 + 1, NULL));
+    }
+
+    /* same key replaces the value. */
+    EXPECT_TRUE(BpTree_insert(&tree, 10, NULL));
+    EXPECT_TRUE(BpTree_find(&tree, 10, &value));
+    EXPECT_NULL(value);
+    EXPECT_EQ(BpTree_count(&tree), TEST_BP_BATCH);
+
+    BpTree_destroy(&tree);
+    EXPECT_EQ(BpTree_count(&tree), 0);
+    EXPECT_NULL(tree.root);
+}
+
+TEST_CASE(range)
+{
+    BpTree tree;
+    BpTreeIter it;
+    uint64_t key;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    BpTree_init(&tree, alloc);
+
+    /* empty tree */
+    BpTreeIter_seek(&it, &tree, 0);
+    EXPECT_FALSE(BpTreeIter_next(&it));
+
+    /* even keys only */
+    for (i = 0; i < TEST_BP_BATCH; i++)
+        BpTree_insert(&tree, shuffle(i) * 2, valueOf(shuffle(i) * 2));
+
+    /* every seek between keys scans on across leaves. */
+    for (key = 1; key < TEST_BP_BATCH * 2; key += 37)
+    {
+        BpTreeIter_seek(&it, &tree, key);
+        for (i = 0; i < 20 && ALIGN(key, 2) + i * 2 < TEST_BP_BATCH * 2; i++)
+        {
+            EXPECT_TRUE(BpTreeIter_next(&it));
+            EXPECT_EQ(BpTreeIter_key(&it), ALIGN(key, 2) + i * 2);
+        }
+    }
+
+    BpTreeIter_seek(&it, &tree, 100);
+    EXPECT_TRUE(BpTreeIter_next(&it));
+    EXPECT_EQ(BpTreeIter_key(&it), 100);
+
+    BpTreeIter_seek(&it, &tree, TEST_BP_BATCH * 2 - 2);
+    EXPECT_TRUE(BpTreeIter_next(&it));
+    EXPECT_FALSE(BpTreeIter_next(&it));
+    BpTreeIter_seek(&it, &tree, UINT64_MAX);
+    EXPECT_FALSE(BpTreeIter_next(&it));
+
+    BpTree_destroy(&tree);
+}
+
+TEST_CASE(remove)
+{
+    BpTree tree;
+    ref_t value;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    BpTree_init(&tree, alloc);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+        BpTree_insert(&tree, shuffle(i), valueOf(shuffle(i)));
+
+    /* a contiguous range empties whole leaves and inner nodes. */
+    for (i = 1000; i < 6000; i++)
+    {
+        EXPECT_TRUE(BpTree_remove(&tree, i, &value));
+        EXPECT_EQ(value, valueOf(i));
+    }
+    EXPECT_FALSE(BpTree_remove(&tree, 1000, NULL));
+    verifyTree(&tree);
+
+    /* then every other key of the rest, in shuffled order. */
+    for (i = 0; i < TEST_BP_BATCH; i++)
+    {
+        uint64_t key = shuffle(i);
+        if ((key < 1000 || key >= 6000) && key % 2 == 0)
+            EXPECT_TRUE(BpTree_remove(&tree, key, NULL));
+    }
+    EXPECT_EQ(BpTree_count(&tree), (TEST_BP_BATCH - 5000) / 2);
+    verifyTree(&tree);
+    for (i = 0; i < TEST_BP_BATCH; i++)
+        EXPECT_EQ(BpTree_find(&tree, i, NULL), (i < 1000 || i >= 6000) && i % 2 == 1);
+
+    /* removed ranges can be filled again. */
+    for (i = 1000; i < 6000; i++)
+        EXPECT_TRUE(BpTree_insert(&tree, i, valueOf(i)));
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+        BpTree_remove(&tree, shuffle(i), NULL);
+    EXPECT_EQ(BpTree_count(&tree), 0);
+    EXPECT_NULL(tree.root);
+    EXPECT_NULL(tree.leaves);
+    EXPECT_EQ(tree.height, 0);
+
+    BpTree_destroy(&tree);
+}
+
+TEST_CASE(alloc_failure)
+{
+    BpTree tree;
+    int i, inserted = 0;
+
+    /* room for a few nodes only */
+    AllocatorRef alloc = StaticAllocator(BP_TREE_NODE_SIZE * 8 + 64, __heap);
+    BpTree_init(&tree, alloc);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+    {
+        if (BpTree_insert(&tree, shuffle(i), valueOf(shuffle(i))))
+            inserted++;
+    }
+    EXPECT_GT(inserted, 0);
+    EXPECT_LT(inserted, TEST_BP_BATCH);
+    EXPECT_EQ(BpTree_count(&tree), inserted);
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_BP_BATCH; i++)
+    {
+        if (BpTree_find(&tree, shuffle(i), NULL))
+            inserted--;
+    }
+    EXPECT_EQ(inserted, 0);
+}
+
+TEST_SUITE(bp_tree)
+{
+    TEST_RUN_CASE(insert_find);
+    TEST_RUN_CASE(range);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(alloc_failure);
+}
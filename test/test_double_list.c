@@ -186,10 +186,178 @@ TEST_CASE(remove_middle)
     verifyList(il);
 }
 
+TEST_CASE(foreach)
+{
+    IntDbList il[TEST_LIST_BATCH0];
+    DbListRef head = &il[0].super, node, batch[5];
+    IntDbListRef obj;
+    DbListIter it;
+    int i = 0;
+    size_t count, total = 0;
+
+    initList(il, TEST_LIST_BATCH0);
+
+    DBLIST_FOREACH(node, head)
+    {
+        EXPECT_EQ(DOWN_CAST(node, IntDbList)->i, i);
+        i++;
+    }
+    EXPECT_EQ(i, TEST_LIST_BATCH0);
+
+    i = 0;
+    DBLIST_FOREACH_OBJ(obj, head, IntDbList)
+        EXPECT_EQ(obj->i, i++);
+    EXPECT_EQ(i, TEST_LIST_BATCH0);
+
+    /* empty list */
+    head = NULL;
+    DBLIST_FOREACH(node, head)
+        EXPECT_TRUE(false);
+
+    /* batches, the last one is partial */
+    it = DbListIter_new(&il[0].super);
+    while ((count = DbListIter_nextN(&it, batch, 5)) > 0)
+    {
+        for (i = 0; (size_t)i < count; i++)
+            EXPECT_EQ(DOWN_CAST(batch[i], IntDbList)->i, total + i);
+        EXPECT_EQ(DbListIter_current(&it), batch[count - 1]);
+        total += count;
+    }
+    EXPECT_EQ(total, TEST_LIST_BATCH0);
+
+    /* iterator is still able to move back */
+    EXPECT_TRUE(DbListIter_prev(&it));
+    EXPECT_EQ(DbListIter_current(&it), &il[TEST_LIST_BATCH0 - 2].super);
+}
+
+/* check a ring holds keys from first to last, both directions. */
+static void verifyRange(DbListRef head, int first, int last)
+{
+    DbListIter it = DbListIter_new(head);
+    int i = first;
+
+    while (DbListIter_next(&it))
+        EXPECT_EQ(DbListIter_curObj(it, IntDbList)->i, i++);
+    EXPECT_EQ(i, last + 1);
+
+    if (head != NULL)
+    {
+        EXPECT_EQ(DOWN_CAST(head->prev, IntDbList)->i, last);
+        EXPECT_EQ(head->prev->next, head);
+    }
+}
+
+TEST_CASE(splice)
+{
+    IntDbList il[TEST_LIST_BATCH0];
+    DbListRef head = NULL, other = NULL, rest;
+    int i;
+
+    initNode(il, TEST_LIST_BATCH0);
+    for (i = 0; i < 10; i++)
+        DbList_addToTail(&il[i].super, &head);
+
+    /* split in the middle, at the last one and at the head */
+    rest = DbList_splitAt(&il[5].super, &head);
+    verifyRange(head, 0, 4);
+    verifyRange(rest, 5, 9);
+    other = DbList_splitAt(&il[9].super, &rest);
+    verifyRange(rest, 5, 8);
+    verifyRange(other, 9, 9);
+    EXPECT_EQ(DbList_splitAt(&il[9].super, &other), &il[9].super);
+    EXPECT_NULL(other);
+
+    /* concat back, with empty lists on either side */
+    DbList_concat(&head, &other);
+    verifyRange(head, 0, 4);
+    DbList_concat(&head, &rest);
+    EXPECT_NULL(rest);
+    verifyRange(head, 0, 8);
+    DbList_concat(&other, &head);
+    EXPECT_NULL(head);
+    verifyRange(other, 0, 8);
+
+    /* single node list */
+    DbList_init(&il[9].super);
+    rest = &il[9].super;
+    DbList_concat(&other, &rest);
+    verifyRange(other, 0, 9);
+
+    /* splice into the middle */
+    for (i = 10; i < TEST_LIST_BATCH0; i++)
+        DbList_addToTail(&il[i].super, &head);
+    rest = DbList_splitAt(&il[5].super, &other);
+    DbList_concat(&head, &rest);
+    verifyRange(other, 0, 4);
+    DbList_splice(&other, &il[5].super);
+    EXPECT_NULL(other);
+    DbList_splice(&other, &il[5].super);
+    EXPECT_NULL(DbList_splitAt(&il[0].super, &other));
+    EXPECT_NULL(other);
+    rest = DbList_splitAt(&il[0].super, &head);
+    verifyRange(rest, 0, 9);
+    verifyRange(head, 10, TEST_LIST_BATCH0 - 1);
+}
+
+/* check the copy, then poison the old node. */
+static void onRelocate(DbListRef from, DbListRef to, void *arg)
+{
+    EXPECT_EQ(DOWN_CAST(from, IntDbList)->i, DOWN_CAST(to, IntDbList)->i);
+    DOWN_CAST(from, IntDbList)->i = -1;
+    from->next = from->prev = NULL;
+    (*(int *)arg)++;
+}
+
+TEST_CASE(compact)
+{
+    static uint32_t heap[TEST_LIST_BATCH0 * 6 + 16];
+    IntDbList il[TEST_LIST_BATCH0];
+    DbListRef head = NULL, node;
+    int i, relocated = 0;
+
+    /* scattered, backward in memory */
+    initNode(il, TEST_LIST_BATCH0);
+    for (i = 0; i < TEST_LIST_BATCH0; i++)
+    {
+        il[i].i = TEST_LIST_BATCH0 - 1 - i;
+        DbList_addToHead(&il[i].super, &head);
+    }
+
+    AllocatorRef alloc = StaticAllocator(sizeof(heap), heap);
+    EXPECT_TRUE(DbList_compact(&head, alloc, sizeof(IntDbList), onRelocate, &relocated));
+    EXPECT_EQ(relocated, TEST_LIST_BATCH0);
+    verifyRange(head, 0, TEST_LIST_BATCH0 - 1);
+
+    /* sequential in memory */
+    i = 0;
+    DBLIST_FOREACH(node, head)
+    {
+        EXPECT_EQ((uint8_t *)node, (uint8_t *)head + i * ALIGN(sizeof(IntDbList), sizeof(void *)));
+        i++;
+    }
+
+    /* allocation failure keeps the list */
+    node = head;
+    EXPECT_FALSE(DbList_compact(&head, alloc, sizeof(IntDbList), NULL, NULL));
+    EXPECT_EQ(head, node);
+
+    /* single node */
+    head = NULL;
+    DbList_addToTail(&il[0].super, &head);
+    alloc = StaticAllocator(sizeof(heap), heap);
+    EXPECT_TRUE(DbList_compact(&head, alloc, sizeof(IntDbList), NULL, NULL));
+    EXPECT_NE(head, &il[0].super);
+    EXPECT_EQ(head->next, head);
+    EXPECT_EQ(head->prev, head);
+}
+
 TEST_SUITE(double_list)
 {
     TEST_RUN_CASE(travel);
     TEST_RUN_CASE(insert);
     TEST_RUN_CASE(remove_middle);
     TEST_RUN_CASE(remove_all);
+    TEST_RUN_CASE(foreach);
+    TEST_RUN_CASE(splice);
+    TEST_RUN_CASE(compact);
 }
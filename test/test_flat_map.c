@@ -0,0 +1,217 @@
+#include "myutil.h"
+
+#include <string.h>
+
+#define TEST_FLAT_HEAP_SIZE 0x40000
+#define TEST_FLAT_BATCH 1000
+
+static uint32_t __heap[TEST_FLAT_HEAP_SIZE / 4];
+
+static inline bool intEqual(int a, int b)
+{
+    return a == b;
+}
+
+static inline bool strEqual(cstr_t a, cstr_t b)
+{
+    return strcmp(a, b) == 0;
+}
+
+/* only 8 home slots, every key collides, runs wrap around the table. */
+static inline uint32_t badHash(int key)
+{
+    return (uint32_t)(key % 8) * 5 + 240 + ((uint32_t)key << 25);
+}
+
+FLAT_MAP_DEFINE(IntMap, int, int, Hash_uint64, intEqual)
+FLAT_MAP_DEFINE(BadMap, int, int, badHash, intEqual)
+FLAT_MAP_DEFINE(StrMap, cstr_t, int, Hash_string, strEqual)
+
+/* a permutation of 0 ~ TEST_FLAT_BATCH - 1 */
+static int shuffle(int i)
+{
+    return (int)(((uint64_t)i * 7919) % TEST_FLAT_BATCH);
+}
+
+TEST_CASE(group_match)
+{
+    uint8_t ctrl[FLAT_MAP_GROUP];
+    int round, i;
+
+    for (round = 0; round < 100; round++)
+    {
+        uint8_t tag = (uint8_t)(Hash_uint64(round) & 0x7f);
+        uint32_t match = 0, empty = 0;
+
+        for (i = 0; i < FLAT_MAP_GROUP; i++)
+        {
+            uint32_t r = Hash_uint64(round * FLAT_MAP_GROUP + i);
+            ctrl[i] = r % 3 == 0 ? FLAT_MAP_EMPTY : (r % 3 == 1 ? tag : (uint8_t)(r >> 8) & 0x7f);
+            if (ctrl[i] == tag)
+                match |= 1u << i;
+            if (ctrl[i] == FLAT_MAP_EMPTY)
+                empty |= 1u << i;
+        }
+
+        /* false positives are allowed, misses are not. */
+        EXPECT_EQ(FlatMap_match(ctrl, tag) & match, match);
+        EXPECT_EQ(FlatMap_match(ctrl, tag) & empty, 0);
+        EXPECT_EQ(FlatMap_matchEmpty(ctrl), empty);
+    }
+
+    EXPECT_EQ(FlatMap_slotsFor(0), FLAT_MAP_GROUP);
+    EXPECT_EQ(FlatMap_slotsFor(14), 16);
+    EXPECT_EQ(FlatMap_slotsFor(15), 32);
+    EXPECT_EQ(FlatMap_slotsFor(1000), 2048);
+}
+
+TEST_CASE(put_find)
+{
+    IntMap map;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(IntMap_init(&map, alloc, 0));
+    EXPECT_EQ(map.mask + 1, FLAT_MAP_GROUP);
+    EXPECT_NULL(IntMap_find(&map, 0));
+
+    for (i = 0; i < TEST_FLAT_BATCH; i++)
+        EXPECT_TRUE(IntMap_put(&map, shuffle(i), shuffle(i) * 10));
+    EXPECT_EQ(IntMap_count(&map), TEST_FLAT_BATCH);
+    EXPECT_EQ(map.mask + 1, FlatMap_slotsFor(TEST_FLAT_BATCH));
+
+    for (i = 0; i < TEST_FLAT_BATCH; i++)
+    {
+        int *value = IntMap_find(&map, i);
+        EXPECT_NOT_NULL(value);
+        EXPECT_EQ(*value, i * 10);
+    }
+    EXPECT_NULL(IntMap_find(&map, -1));
+    EXPECT_NULL(IntMap_find(&map, TEST_FLAT_BATCH));
+
+    /* same key replaces the value. */
+    EXPECT_TRUE(IntMap_put(&map, 7, -7));
+    EXPECT_EQ(*IntMap_find(&map, 7), -7);
+    EXPECT_EQ(IntMap_count(&map), TEST_FLAT_BATCH);
+
+    IntMap_destroy(&map);
+    EXPECT_EQ(IntMap_count(&map), 0);
+    EXPECT_NULL(IntMap_find(&map, 7));
+}
+
+TEST_CASE(remove)
+{
+    static bool present[TEST_FLAT_BATCH];
+    BadMap map;
+    int i, j, value;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(BadMap_init(&map, alloc, 200));
+    memset(present, 0, sizeof(present));
+
+    /* clustered keys, mixed puts and removes, checked against a bitmap. */
+    for (i = 0; i < TEST_FLAT_BATCH * 4; i++)
+    {
+        int key = (int)(Hash_uint64(i) % 200);
+        if (Hash_uint64(i + TEST_FLAT_BATCH * 4) % 3 == 0)
+        {
+            EXPECT_EQ(BadMap_remove(&map, key, &value), present[key]);
+            if (present[key])
+                EXPECT_EQ(value, key + 1);
+            present[key] = false;
+        }
+        else
+        {
+            EXPECT_TRUE(BadMap_put(&map, key, key + 1));
+            present[key] = true;
+        }
+
+        if (i % 37 == 0)
+        {
+            size_t count = 0;
+            for (j = 0; j < 200; j++)
+            {
+                EXPECT_EQ(BadMap_find(&map, j) != NULL, present[j]);
+                count += present[j];
+            }
+            EXPECT_EQ(BadMap_count(&map), count);
+        }
+    }
+
+    for (j = 0; j < 200; j++)
+        BadMap_remove(&map, j, NULL);
+    EXPECT_EQ(BadMap_count(&map), 0);
+
+    /* no tombstones left, every control byte is empty again. */
+    for (j = 0; (size_t)j < map.mask + 1 + FLAT_MAP_GROUP; j++)
+        EXPECT_EQ(map.ctrl[j], FLAT_MAP_EMPTY);
+    BadMap_destroy(&map);
+}
+
+TEST_CASE(string_keys)
+{
+    static char keys[TEST_FLAT_BATCH][16];
+    char probe[16];
+    StrMap map;
+    StrMapEntry *entry;
+    size_t pos = 0;
+    int i, sum = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(StrMap_init(&map, alloc, TEST_FLAT_BATCH));
+    EXPECT_EQ(map.mask + 1, FlatMap_slotsFor(TEST_FLAT_BATCH));
+
+    for (i = 0; i < TEST_FLAT_BATCH; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+        EXPECT_TRUE(StrMap_put(&map, keys[i], i));
+    }
+    /* no growth after reserved. */
+    EXPECT_EQ(map.mask + 1, FlatMap_slotsFor(TEST_FLAT_BATCH));
+
+    /* keys compared by content, not by address. */
+    for (i = 0; i < TEST_FLAT_BATCH; i += 11)
+    {
+        snprintf(probe, sizeof(probe), "key%d", i);
+        EXPECT_EQ(*StrMap_find(&map, probe), i);
+    }
+    EXPECT_NULL(StrMap_find(&map, "key"));
+
+    while ((entry = StrMap_next(&map, &pos)) != NULL)
+        sum += entry->value;
+    EXPECT_EQ(sum, TEST_FLAT_BATCH * (TEST_FLAT_BATCH - 1) / 2);
+    EXPECT_EQ(pos, map.mask + 1);
+
+    StrMap_destroy(&map);
+}
+
+TEST_CASE(alloc_failure)
+{
+    IntMap map;
+    int i;
+
+    /* room for the first table only. */
+    AllocatorRef alloc = StaticAllocator(sizeof(IntMapEntry) * 16 + 32 + 64, __heap);
+    EXPECT_TRUE(IntMap_init(&map, alloc, 0));
+
+    for (i = 0; i < 14; i++)
+        EXPECT_TRUE(IntMap_put(&map, i, i));
+    EXPECT_FALSE(IntMap_put(&map, 14, 14));
+    EXPECT_TRUE(IntMap_put(&map, 0, 100));
+
+    EXPECT_EQ(IntMap_count(&map), 14);
+    EXPECT_EQ(map.mask + 1, FLAT_MAP_GROUP);
+    for (i = 1; i < 14; i++)
+        EXPECT_EQ(*IntMap_find(&map, i), i);
+    EXPECT_EQ(*IntMap_find(&map, 0), 100);
+    IntMap_destroy(&map);
+}
+
+TEST_SUITE(flat_map)
+{
+    TEST_RUN_CASE(group_match);
+    TEST_RUN_CASE(put_find);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(string_keys);
+    TEST_RUN_CASE(alloc_failure);
+}
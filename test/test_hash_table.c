@@ -0,0 +1,158 @@
+#include "myutil.h"
+
+typedef struct _IntHash
+{
+    HashNode super;
+    int key;
+} IntHash, *IntHashRef;
+
+#define TEST_HASH_HEAP_SIZE 0x10000
+#define TEST_HASH_BATCH 1000
+
+static uint32_t __heap[TEST_HASH_HEAP_SIZE / 4];
+
+static bool intEqual(HashNodeRef node, void const *key)
+{
+    return DOWN_CAST(node, IntHash)->key == *(int const *)key;
+}
+
+static IntHashRef findInt(HashTableRef table, int key)
+{
+    HashNodeRef node = HashTable_find(table, Hash_uint64(key), &key, intEqual);
+    return node == NULL ? NULL : DOWN_CAST(node, IntHash);
+}
+
+static IntHashRef removeInt(HashTableRef table, int key)
+{
+    HashNodeRef node = HashTable_remove(table, Hash_uint64(key), &key, intEqual);
+    return node == NULL ? NULL : DOWN_CAST(node, IntHash);
+}
+
+TEST_CASE(hash)
+{
+    EXPECT_EQ(Hash_bytes("", 0), 2166136261u);
+    EXPECT_EQ(Hash_bytes("abc", 3), Hash_string("abc"));
+    EXPECT_NE(Hash_string("abc"), Hash_string("abd"));
+    EXPECT_NE(Hash_uint64(1), Hash_uint64(2));
+    EXPECT_EQ(Hash_uint64(12345), Hash_uint64(12345));
+}
+
+TEST_CASE(insert_find)
+{
+    static IntHash items[TEST_HASH_BATCH];
+    HashTable table;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(HashTable_init(&table, alloc, 3));
+    EXPECT_EQ(table.mask, 3);
+
+    for (i = 0; i < TEST_HASH_BATCH; i++)
+    {
+        items[i].key = i;
+        HashTable_insert(&table, &items[i].super, Hash_uint64(i));
+
+        /* every entry is reachable, even while resizing. */
+        if (i % 97 == 0)
+        {
+            int j;
+            for (j = 0; j <= i; j++)
+                EXPECT_EQ(findInt(&table, j), &items[j]);
+        }
+    }
+
+    EXPECT_EQ(HashTable_count(&table), TEST_HASH_BATCH);
+    EXPECT_GE(table.mask + 1, TEST_HASH_BATCH / 2);
+    for (i = 0; i < TEST_HASH_BATCH; i++)
+        EXPECT_EQ(findInt(&table, i), &items[i]);
+    EXPECT_NULL(findInt(&table, -1));
+    EXPECT_NULL(findInt(&table, TEST_HASH_BATCH));
+
+    HashTable_destroy(&table);
+}
+
+TEST_CASE(remove)
+{
+    static IntHash items[TEST_HASH_BATCH];
+    HashTable table;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(HashTable_init(&table, alloc, 16));
+
+    for (i = 0; i < TEST_HASH_BATCH; i++)
+    {
+        items[i].key = i;
+        HashTable_insert(&table, &items[i].super, Hash_uint64(i));
+    }
+
+    for (i = 0; i < TEST_HASH_BATCH; i += 2)
+        EXPECT_EQ(removeInt(&table, i), &items[i]);
+    EXPECT_NULL(removeInt(&table, 0));
+
+    for (i = 1; i < TEST_HASH_BATCH; i += 4)
+        EXPECT_TRUE(HashTable_removeNode(&table, &items[i].super));
+    EXPECT_FALSE(HashTable_removeNode(&table, &items[1].super));
+
+    EXPECT_EQ(HashTable_count(&table), TEST_HASH_BATCH / 4);
+    for (i = 0; i < TEST_HASH_BATCH; i++)
+    {
+        if (i % 4 == 3)
+            EXPECT_EQ(findInt(&table, i), &items[i]);
+        else
+            EXPECT_NULL(findInt(&table, i));
+    }
+
+    HashTable_destroy(&table);
+}
+
+TEST_CASE(rehash)
+{
+    static IntHash items[TEST_HASH_BATCH];
+    HashTable table;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(HashTable_init(&table, alloc, 64));
+
+    for (i = 0; i <= 64; i++)
+    {
+        items[i].key = i;
+        HashTable_insert(&table, &items[i].super, Hash_uint64(i));
+    }
+
+    /* growth started by the 65th insert, only a few buckets migrated. */
+    EXPECT_TRUE(HashTable_isRehashing(&table));
+    EXPECT_EQ(table.mask, 127);
+    EXPECT_EQ(table.rehashIndex, HASH_TABLE_REHASH_STEP);
+
+    /* finish the resize explicitly. */
+    EXPECT_FALSE(HashTable_rehash(&table, (size_t)-1));
+    EXPECT_FALSE(HashTable_isRehashing(&table));
+    for (i = 0; i <= 64; i++)
+        EXPECT_EQ(findInt(&table, i), &items[i]);
+
+    /* allocation failure keeps the table working without growing. */
+    HashTable_destroy(&table);
+    alloc = StaticAllocator(sizeof(ListRef) * 8 + 64, __heap);
+    EXPECT_TRUE(HashTable_init(&table, alloc, 8));
+    for (i = 0; i < 100; i++)
+    {
+        items[i].key = i;
+        HashTable_insert(&table, &items[i].super, Hash_uint64(i));
+    }
+    EXPECT_FALSE(HashTable_isRehashing(&table));
+    EXPECT_EQ(table.mask, 7);
+    for (i = 0; i < 100; i++)
+        EXPECT_EQ(findInt(&table, i), &items[i]);
+
+    HashTable_destroy(&table);
+}
+
+TEST_SUITE(hash_table)
+{
+    TEST_RUN_CASE(hash);
+    TEST_RUN_CASE(insert_find);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(rehash);
+}
@@ -269,6 +269,104 @@ TEST_CASE(remove_all)
     EXPECT_EQ(head, NULL);
 }
 
+TEST_CASE(foreach)
+{
+    IntList il[TEST_LIST_BATCH1];
+    ListRef node, batch[16];
+    IntListRef obj;
+    ListIter it;
+    size_t i = 0, count, total = 0;
+
+    initList(il, TEST_LIST_BATCH1);
+
+    LIST_FOREACH(node, &il[0].super)
+    {
+        EXPECT_EQ(DOWN_CAST(node, IntList)->i, i);
+        i++;
+    }
+    EXPECT_EQ(i, TEST_LIST_BATCH1);
+
+    i = 0;
+    LIST_FOREACH_OBJ(obj, &il[0].super, IntList)
+        EXPECT_EQ(obj->i, i++);
+    EXPECT_EQ(i, TEST_LIST_BATCH1);
+
+    /* empty list */
+    LIST_FOREACH(node, NULL)
+        EXPECT_TRUE(false);
+
+    /* batches, the last one is partial */
+    it = ListIter_new(&il[0].super);
+    while ((count = ListIter_nextN(&it, batch, 16)) > 0)
+    {
+        for (i = 0; i < count; i++)
+            EXPECT_EQ(DOWN_CAST(batch[i], IntList)->i, total + i);
+        EXPECT_EQ(ListIter_current(&it), batch[count - 1]);
+        total += count;
+    }
+    EXPECT_EQ(total, TEST_LIST_BATCH1);
+    EXPECT_EQ(ListIter_nextN(&it, batch, 16), 0);
+
+    /* mixed with single step */
+    it = ListIter_new(&il[0].super);
+    EXPECT_TRUE(ListIter_next(&it));
+    EXPECT_EQ(ListIter_nextN(&it, batch, 2), 2);
+    EXPECT_EQ(batch[0], &il[1].super);
+    EXPECT_TRUE(ListIter_next(&it));
+    EXPECT_EQ(ListIter_current(&it), &il[3].super);
+    EXPECT_EQ(ListIter_remove(&it, NULL), &il[3].super);
+    EXPECT_EQ(il[2].super.next, &il[4].super);
+}
+
+static int __relocated = 0;
+
+/* check the copy, then poison the old node. */
+static void onRelocate(ListRef from, ListRef to, void *arg)
+{
+    EXPECT_EQ(DOWN_CAST(from, IntList)->i, DOWN_CAST(to, IntList)->i);
+    DOWN_CAST(from, IntList)->i = -1;
+    from->next = NULL;
+    (*(int *)arg)++;
+}
+
+TEST_CASE(compact)
+{
+    static uint32_t heap[TEST_LIST_BATCH1 * 4 + 16];
+    IntList il[TEST_LIST_BATCH1];
+    ListRef head = NULL, node;
+    size_t i = 0;
+
+    /* scattered, backward in memory */
+    for (i = 0; i < TEST_LIST_BATCH1; i++)
+    {
+        il[i].i = TEST_LIST_BATCH1 - 1 - i;
+        il[i].super.next = head;
+        head = &il[i].super;
+    }
+
+    AllocatorRef alloc = StaticAllocator(sizeof(heap), heap);
+    EXPECT_TRUE(List_compact(&head, alloc, sizeof(IntList), onRelocate, &__relocated));
+    EXPECT_EQ(__relocated, TEST_LIST_BATCH1);
+    verifyList(head);
+
+    /* sequential in memory */
+    i = 0;
+    LIST_FOREACH(node, head)
+    {
+        EXPECT_EQ((uint8_t *)node, (uint8_t *)head + i * ALIGN(sizeof(IntList), sizeof(void *)));
+        i++;
+    }
+
+    /* allocation failure keeps the list */
+    node = head;
+    EXPECT_FALSE(List_compact(&head, alloc, sizeof(IntList), NULL, NULL));
+    EXPECT_EQ(head, node);
+
+    head = NULL;
+    EXPECT_TRUE(List_compact(&head, alloc, sizeof(IntList), NULL, NULL));
+    EXPECT_NULL(head);
+}
+
 TEST_SUITE(list)
 {
     TEST_RUN_CASE(travel);
@@ -279,4 +377,6 @@ TEST_SUITE(list)
     TEST_RUN_CASE(remove_middle);
     TEST_RUN_CASE(remove_tail);
     TEST_RUN_CASE(remove_all);
+    TEST_RUN_CASE(foreach);
+    TEST_RUN_CASE(compact);
 }
@@ -0,0 +1,295 @@
+#include "myutil.h"
+
+#include <pthread.h>
+
+typedef struct _IntLru
+{
+    LruNode super;
+    int key;
+    int evicted;
+} IntLru, *IntLruRef;
+
+#define TEST_LRU_HEAP_SIZE 0x40000
+#define TEST_LRU_BATCH 64
+#define TEST_LRU_CAPACITY 16
+#define TEST_LRU_THREADS 4
+#define TEST_LRU_ROUNDS 20000
+#define TEST_LRU_SHARD_CAPACITY 2048
+#define TEST_LRU_SHARD_KEYS 3000
+
+static uint32_t __heap[TEST_LRU_HEAP_SIZE / 4];
+
+static bool intEqual(HashNodeRef node, void const *key)
+{
+    return DOWN_CAST(node, IntLru)->key == *(int const *)key;
+}
+
+static void onEvict(LruNodeRef node, void *arg)
+{
+    DOWN_CAST(node, IntLru)->evicted++;
+    (*(int *)arg)++;
+}
+
+static void putInt(LruCacheRef cache, IntLruRef item, size_t charge)
+{
+    LruCache_put(cache, &item->super, Hash_uint64(item->key), &item->key, charge);
+}
+
+static IntLruRef getInt(LruCacheRef cache, int key)
+{
+    LruNodeRef node = LruCache_get(cache, Hash_uint64(key), &key);
+    return node == NULL ? NULL : DOWN_CAST(node, IntLru);
+}
+
+static void initItems(IntLruRef items, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        items[i].key = i;
+        items[i].evicted = 0;
+    }
+}
+
+TEST_CASE(evict_items)
+{
+    IntLru items[TEST_LRU_BATCH];
+    LruCache cache;
+    int i, evicted = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(LruCache_init(&cache, alloc, TEST_LRU_CAPACITY, LRU_CACHE_UNLOCKED, intEqual));
+    LruCache_setEvict(&cache, onEvict, &evicted);
+    initItems(items, TEST_LRU_BATCH);
+
+    for (i = 0; i < TEST_LRU_CAPACITY; i++)
+        putInt(&cache, &items[i], 1);
+    EXPECT_EQ(LruCache_count(&cache), TEST_LRU_CAPACITY);
+    EXPECT_EQ(evicted, 0);
+
+    /* touch the oldest one, so item 1 becomes the least recently used. */
+    EXPECT_EQ(getInt(&cache, 0), &items[0]);
+    putInt(&cache, &items[TEST_LRU_CAPACITY], 1);
+    EXPECT_EQ(evicted, 1);
+    EXPECT_EQ(items[1].evicted, 1);
+    EXPECT_NULL(getInt(&cache, 1));
+    EXPECT_EQ(getInt(&cache, 0), &items[0]);
+
+    /* the rest are evicted in insertion order. */
+    for (i = TEST_LRU_CAPACITY + 1; i < TEST_LRU_BATCH; i++)
+    {
+        putInt(&cache, &items[i], 1);
+        EXPECT_EQ(items[i - TEST_LRU_CAPACITY + 1].evicted, 1);
+        EXPECT_EQ(getInt(&cache, 0), &items[0]);
+    }
+    EXPECT_EQ(LruCache_count(&cache), TEST_LRU_CAPACITY);
+    EXPECT_EQ(LruCache_size(&cache), TEST_LRU_CAPACITY);
+
+    LruCache_clear(&cache);
+    EXPECT_EQ(LruCache_count(&cache), 0);
+    EXPECT_EQ(evicted, TEST_LRU_BATCH);
+    LruCache_destroy(&cache);
+}
+
+TEST_CASE(evict_bytes)
+{
+    IntLru items[TEST_LRU_BATCH];
+    LruCache cache;
+    int evicted = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(LruCache_init(&cache, alloc, 1000, LRU_CACHE_UNLOCKED, intEqual));
+    LruCache_setEvict(&cache, onEvict, &evicted);
+    initItems(items, TEST_LRU_BATCH);
+
+    putInt(&cache, &items[0], 400);
+    putInt(&cache, &items[1], 400);
+    EXPECT_EQ(LruCache_size(&cache), 800);
+
+    /* needs both old entries to be evicted. */
+    putInt(&cache, &items[2], 900);
+    EXPECT_EQ(evicted, 2);
+    EXPECT_EQ(LruCache_size(&cache), 900);
+
+    /* an entry larger than capacity is kept alone. */
+    putInt(&cache, &items[3], 2000);
+    EXPECT_EQ(evicted, 3);
+    EXPECT_EQ(LruCache_count(&cache), 1);
+    EXPECT_EQ(getInt(&cache, 3), &items[3]);
+
+    LruCache_destroy(&cache);
+}
+
+TEST_CASE(replace_remove)
+{
+    IntLru items[TEST_LRU_BATCH];
+    IntLru other;
+    LruCache cache;
+    int evicted = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(LruCache_init(&cache, alloc, TEST_LRU_CAPACITY, LRU_CACHE_UNLOCKED, intEqual));
+    LruCache_setEvict(&cache, onEvict, &evicted);
+    initItems(items, TEST_LRU_BATCH);
+
+    putInt(&cache, &items[5], 1);
+    putInt(&cache, &items[6], 1);
+
+    /* same key, another entry */
+    other.key = 5;
+    other.evicted = 0;
+    putInt(&cache, &other, 1);
+    EXPECT_EQ(items[5].evicted, 1);
+    EXPECT_EQ(getInt(&cache, 5), &other);
+    EXPECT_EQ(LruCache_count(&cache), 2);
+
+    /* same entry again */
+    putInt(&cache, &other, 3);
+    EXPECT_EQ(other.evicted, 0);
+    EXPECT_EQ(LruCache_size(&cache), 4);
+
+    EXPECT_EQ(LruCache_remove(&cache, Hash_uint64(6), &items[6].key), &items[6].super);
+    EXPECT_NULL(LruCache_remove(&cache, Hash_uint64(6), &items[6].key));
+    EXPECT_EQ(items[6].evicted, 0);
+    EXPECT_EQ(LruCache_count(&cache), 1);
+    EXPECT_EQ(LruCache_size(&cache), 3);
+
+    LruCache_destroy(&cache);
+}
+
+typedef struct _LruTestContext
+{
+    LruCache cache;
+    IntLru items[TEST_LRU_THREADS][TEST_LRU_BATCH];
+    int evicted;
+} LruTestContext;
+
+static LruTestContext __context;
+
+static void onEvictAtomic(LruNodeRef node, void *arg)
+{
+    (void)node;
+    __atomic_fetch_add((int *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void *workerThread(void *arg)
+{
+    IntLruRef items = (IntLruRef)arg;
+    int round;
+
+    /* every thread owns its keys, so entries are never shared. */
+    for (round = 0; round < TEST_LRU_ROUNDS; round++)
+    {
+        IntLruRef item = &items[round % TEST_LRU_BATCH];
+        LruCache_remove(&__context.cache, Hash_uint64(item->key), &item->key);
+        putInt(&__context.cache, item, 1);
+    }
+    return NULL;
+}
+
+TEST_CASE(sharded)
+{
+    pthread_t threads[TEST_LRU_THREADS];
+    int i, j;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(LruCache_init(&__context.cache, alloc, TEST_LRU_THREADS * TEST_LRU_BATCH * 4, 8, intEqual));
+    EXPECT_EQ(__context.cache.shardMask, 7);
+    LruCache_setEvict(&__context.cache, onEvictAtomic, &__context.evicted);
+    __context.evicted = 0;
+
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+    {
+        for (j = 0; j < TEST_LRU_BATCH; j++)
+            __context.items[i][j].key = i * TEST_LRU_BATCH + j;
+        pthread_create(&threads[i], NULL, workerThread, __context.items[i]);
+    }
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    /* capacity is large enough, nothing evicted. */
+    EXPECT_EQ(__context.evicted, 0);
+    EXPECT_EQ(LruCache_count(&__context.cache), TEST_LRU_THREADS * TEST_LRU_BATCH);
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+    {
+        for (j = 0; j < TEST_LRU_BATCH; j++)
+            EXPECT_EQ(getInt(&__context.cache, __context.items[i][j].key), &__context.items[i][j]);
+    }
+
+    LruCache_destroy(&__context.cache);
+}
+
+typedef struct _LruEvictContext
+{
+    LruCache cache;
+    IntLru items[TEST_LRU_THREADS][TEST_LRU_SHARD_KEYS];
+    int evicted;
+} LruEvictContext;
+
+static LruEvictContext __evictContext;
+
+static void *evictThread(void *arg)
+{
+    IntLruRef items = (IntLruRef)arg;
+    int round, i;
+
+    /* cycle keys over capacity, every put evicts once the shard is full. */
+    for (round = 0; round < 2; round++)
+    {
+        for (i = 0; i < TEST_LRU_SHARD_KEYS; i++)
+            putInt(&__evictContext.cache, &items[i], 1);
+    }
+    return NULL;
+}
+
+TEST_CASE(sharded_evict)
+{
+    pthread_t threads[TEST_LRU_THREADS];
+    size_t filled[TEST_LRU_THREADS] = {0};
+    int key, i;
+
+    /* shard capacity is over initial index size, so indexes grow in parallel. */
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(LruCache_init(&__evictContext.cache, alloc,
+        TEST_LRU_THREADS * TEST_LRU_SHARD_CAPACITY, TEST_LRU_THREADS, intEqual));
+    LruCache_setEvict(&__evictContext.cache, onEvictAtomic, &__evictContext.evicted);
+    __evictContext.evicted = 0;
+
+    /* give every thread the keys of its own shard */
+    for (key = 0, i = 0; i < TEST_LRU_THREADS; key++)
+    {
+        size_t shard = (Hash_uint64(key) >> 16) & (TEST_LRU_THREADS - 1);
+        if (filled[shard] < TEST_LRU_SHARD_KEYS)
+        {
+            __evictContext.items[shard][filled[shard]].key = key;
+            if (++filled[shard] == TEST_LRU_SHARD_KEYS)
+                i++;
+        }
+    }
+
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+        pthread_create(&threads[i], NULL, evictThread, __evictContext.items[i]);
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    EXPECT_EQ(__evictContext.evicted, TEST_LRU_THREADS * (TEST_LRU_SHARD_KEYS * 2 - TEST_LRU_SHARD_CAPACITY));
+    EXPECT_EQ(LruCache_count(&__evictContext.cache), TEST_LRU_THREADS * TEST_LRU_SHARD_CAPACITY);
+    EXPECT_EQ(LruCache_size(&__evictContext.cache), TEST_LRU_THREADS * TEST_LRU_SHARD_CAPACITY);
+    for (i = 0; i < TEST_LRU_THREADS; i++)
+    {
+        EXPECT_NULL(getInt(&__evictContext.cache, __evictContext.items[i][0].key));
+        EXPECT_EQ(getInt(&__evictContext.cache, __evictContext.items[i][TEST_LRU_SHARD_KEYS - 1].key),
+            &__evictContext.items[i][TEST_LRU_SHARD_KEYS - 1]);
+    }
+
+    LruCache_destroy(&__evictContext.cache);
+}
+
+TEST_SUITE(lru_cache)
+{
+    TEST_RUN_CASE(evict_items);
+    TEST_RUN_CASE(evict_bytes);
+    TEST_RUN_CASE(replace_remove);
+    TEST_RUN_CASE(sharded);
+    TEST_RUN_CASE(sharded_evict);
+}
@@ -84,6 +84,8 @@ TEST_CASE(args)
     EXPECT_EQ(s, (1 + 2 + 3 + 4 + 1));
     cstr_t ss = ARG_LIST(STR, 1, 2, 3, 4, 5, 6);
     EXPECT_EQ_S(ss, "123456");
+    s = ARG_LIST(ADD) 1;
+    EXPECT_EQ(s, 1);
     
     /* test ARG_RECUR */
 #define ADD2(a, b) (a + b)
@@ -0,0 +1,179 @@
+#include "myutil.h"
+
+typedef struct _IntOffList
+{
+    OffList super;
+    int i;
+} IntOffList, *IntOffListRef;
+
+typedef struct _IntOffDbList
+{
+    OffDbList super;
+    int i;
+} IntOffDbList, *IntOffDbListRef;
+
+#define TEST_OFF_HEAP_SIZE 0x4000
+#define TEST_OFF_BATCH 100
+
+static uint32_t __heap[TEST_OFF_HEAP_SIZE / 4];
+
+static void verifyList(OffArenaRef arena, OffListRef head, int count, int step)
+{
+    OffListIter it = OffListIter_new(arena, head);
+    int i = 0;
+
+    while (OffListIter_next(&it))
+    {
+        EXPECT_EQ(OffListIter_curObj(it, IntOffList)->i, i);
+        i += step;
+    }
+    EXPECT_EQ(i, count * step);
+}
+
+static void verifyDbList(OffArenaRef arena, OffDbListRef head, int count, int step)
+{
+    OffDbListIter it = OffDbListIter_new(arena, head);
+    int i = 0;
+
+    while (OffDbListIter_next(&it))
+    {
+        EXPECT_EQ(OffDbListIter_curObj(it, IntOffDbList)->i, i);
+        i += step;
+    }
+    EXPECT_EQ(i, count * step);
+
+    /* and backward */
+    while (OffDbListIter_prev(&it))
+    {
+        i -= step;
+        EXPECT_EQ(OffDbListIter_curObj(it, IntOffDbList)->i, i - step);
+    }
+}
+
+TEST_CASE(arena)
+{
+    OffArena arena;
+    void *p;
+
+    EXPECT_EQ(sizeof(OffList), 4);
+    EXPECT_EQ(sizeof(OffDbList), 8);
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(OffArena_init(&arena, alloc, 256));
+    EXPECT_EQ(OffArena_offset(&arena, NULL), OFF_NULL);
+    EXPECT_NULL(OffArena_ptr(&arena, OFF_NULL));
+
+    p = OffArena_alloc(&arena, 16);
+    EXPECT_NOT_NULL(p);
+    EXPECT_NE(OffArena_offset(&arena, p), OFF_NULL);
+    EXPECT_EQ(OffArena_ptr(&arena, OffArena_offset(&arena, p)), p);
+
+    /* a small arena is full soon */
+    EXPECT_NULL(OffArena_alloc(&arena, 256));
+    OffArena_destroy(&arena);
+
+    EXPECT_FALSE(OffArena_init(&arena, alloc, TEST_OFF_HEAP_SIZE));
+}
+
+TEST_CASE(list)
+{
+    OffArena arena;
+    OffListRef head = NULL;
+    OffListIter it;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(OffArena_init(&arena, alloc, TEST_OFF_HEAP_SIZE / 2));
+
+    /* insert at head, backward */
+    for (i = TEST_OFF_BATCH - 1; i >= 0; i--)
+    {
+        IntOffListRef item = OffArena_new(&arena, IntOffList);
+        item->i = i;
+        OffList_setNext(&item->super, &arena, head);
+        head = &item->super;
+    }
+    verifyList(&arena, head, TEST_OFF_BATCH, 1);
+
+    /* remove odd ones, head included after a shift */
+    it = OffListIter_new(&arena, head);
+    while (OffListIter_next(&it))
+    {
+        if (OffListIter_curObj(it, IntOffList)->i % 2 == 1)
+        {
+            EXPECT_NOT_NULL(OffListIter_remove(&it, &head));
+            EXPECT_TRUE(OffListIter_current(&it) == NULL || OffListIter_curObj(it, IntOffList)->i % 2 == 0);
+        }
+    }
+    verifyList(&arena, head, TEST_OFF_BATCH / 2, 2);
+
+    OffListRef first = head;
+    it = OffListIter_new(&arena, head);
+    EXPECT_EQ(OffListIter_remove(&it, &head), first);
+    EXPECT_EQ(OffListIter_curObj(it, IntOffList)->i, 2);
+    EXPECT_EQ(head, OffListIter_current(&it));
+
+    /* insert a new head */
+    IntOffListRef zero = OffArena_new(&arena, IntOffList);
+    zero->i = 0;
+    it = OffListIter_new(&arena, head);
+    EXPECT_EQ(OffListIter_insert(&it, &zero->super, &head), &zero->super);
+    EXPECT_EQ(head, &zero->super);
+    verifyList(&arena, head, TEST_OFF_BATCH / 2, 2);
+
+    OffArena_destroy(&arena);
+}
+
+TEST_CASE(double_list)
+{
+    IntOffDbListRef items[TEST_OFF_BATCH];
+    OffArena arena;
+    OffDbListRef head = NULL;
+    OffDbListIter it;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(OffArena_init(&arena, alloc, TEST_OFF_HEAP_SIZE / 2));
+
+    for (i = 0; i < TEST_OFF_BATCH; i++)
+    {
+        items[i] = OffArena_new(&arena, IntOffDbList);
+        items[i]->i = i;
+    }
+
+    /* tail and head */
+    for (i = 1; i < TEST_OFF_BATCH; i++)
+        OffDbList_addToTail(&items[i]->super, &arena, &head);
+    OffDbList_addToHead(&items[0]->super, &arena, &head);
+    verifyDbList(&arena, head, TEST_OFF_BATCH, 1);
+
+    /* remove odd ones */
+    for (i = 1; i < TEST_OFF_BATCH; i += 2)
+        OffDbList_removeFrom(&items[i]->super, &arena, &head);
+    verifyDbList(&arena, head, TEST_OFF_BATCH / 2, 2);
+
+    /* remove by iterator, head first */
+    it = OffDbListIter_new(&arena, head);
+    EXPECT_EQ(OffDbListIter_remove(&it, &head), &items[0]->super);
+    EXPECT_EQ(head, &items[2]->super);
+    while (OffDbListIter_remove(&it, &head) != NULL);
+    EXPECT_NULL(head);
+
+    /* insert by iterator, into empty list and before head */
+    OffDbListIter_init(&it, &arena, NULL);
+    for (i = 1; i < TEST_OFF_BATCH; i++)
+        OffDbListIter_insert(&it, &items[i]->super, NULL);
+    head = OffDbListIter_head(&it);
+    OffDbListIter_init(&it, &arena, head);
+    OffDbListIter_insert(&it, &items[0]->super, &head);
+    verifyDbList(&arena, head, TEST_OFF_BATCH, 1);
+
+    OffArena_destroy(&arena);
+}
+
+TEST_SUITE(offset_list)
+{
+    TEST_RUN_CASE(arena);
+    TEST_RUN_CASE(list);
+    TEST_RUN_CASE(double_list);
+}
@@ -0,0 +1,161 @@
+#include "myutil.h"
+
+typedef struct _IntHeap
+{
+    PairNode super;
+    int key;
+} IntHeap, *IntHeapRef;
+
+#define TEST_HEAP_BATCH 1000
+
+static int intCompare(PairNodeRef a, PairNodeRef b)
+{
+    int x = DOWN_CAST(a, IntHeap)->key, y = DOWN_CAST(b, IntHeap)->key;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* a permutation of 0 ~ TEST_HEAP_BATCH - 1 */
+static int shuffle(int i)
+{
+    return (int)(((uint64_t)i * 7919) % TEST_HEAP_BATCH);
+}
+
+/* check heap order and links, return node count of subtree. */
+static size_t checkNode(PairNodeRef node, PairNodeRef parent)
+{
+    size_t count = 0;
+    PairNodeRef prev = parent;
+
+    for (; node != NULL; prev = node, node = node->next)
+    {
+        if (node->prev != prev || intCompare(node, parent) < 0)
+            return 0;
+        count += 1 + checkNode(node->child, node);
+    }
+    return count;
+}
+
+static void verifyHeap(PairHeapRef heap)
+{
+    if (heap->root == NULL)
+    {
+        EXPECT_EQ(PairHeap_count(heap), 0);
+        return;
+    }
+    EXPECT_NULL(heap->root->next);
+    EXPECT_NULL(heap->root->prev);
+    EXPECT_EQ(1 + checkNode(heap->root->child, heap->root), PairHeap_count(heap));
+}
+
+/* pop all, keys must come out in order. */
+static void popAll(PairHeapRef heap, int first, int step)
+{
+    PairNodeRef node;
+    int key = first;
+
+    while ((node = PairHeap_pop(heap)) != NULL)
+    {
+        EXPECT_EQ(DOWN_CAST(node, IntHeap)->key, key);
+        key += step;
+    }
+    EXPECT_EQ(PairHeap_count(heap), 0);
+}
+
+TEST_CASE(insert_pop)
+{
+    static IntHeap items[TEST_HEAP_BATCH];
+    PairHeap heap;
+    int i;
+
+    PairHeap_init(&heap, intCompare);
+    EXPECT_NULL(PairHeap_min(&heap));
+    EXPECT_NULL(PairHeap_pop(&heap));
+
+    for (i = 0; i < TEST_HEAP_BATCH; i++)
+    {
+        items[i].key = shuffle(i);
+        PairHeap_insert(&heap, &items[i].super);
+    }
+    verifyHeap(&heap);
+    EXPECT_EQ(PairHeap_count(&heap), TEST_HEAP_BATCH);
+    EXPECT_EQ(DOWN_CAST(PairHeap_min(&heap), IntHeap)->key, 0);
+
+    /* the first pop restructures the whole heap */
+    EXPECT_EQ(DOWN_CAST(PairHeap_pop(&heap), IntHeap)->key, 0);
+    verifyHeap(&heap);
+    popAll(&heap, 1, 1);
+}
+
+TEST_CASE(decrease)
+{
+    static IntHeap items[TEST_HEAP_BATCH];
+    PairHeap heap;
+    int i;
+
+    PairHeap_init(&heap, intCompare);
+    for (i = 0; i < TEST_HEAP_BATCH; i++)
+    {
+        items[i].key = shuffle(i) + TEST_HEAP_BATCH;
+        PairHeap_insert(&heap, &items[i].super);
+    }
+    PairHeap_pop(&heap);
+    PairHeap_insert(&heap, &items[0].super);
+
+    /* every key is moved down by TEST_HEAP_BATCH, in a shuffled order. */
+    for (i = 0; i < TEST_HEAP_BATCH; i++)
+    {
+        IntHeapRef item = &items[shuffle(i)];
+        item->key -= TEST_HEAP_BATCH;
+        PairHeap_decrease(&heap, &item->super);
+        if (i % 97 == 0)
+            verifyHeap(&heap);
+    }
+    verifyHeap(&heap);
+    popAll(&heap, 0, 1);
+}
+
+TEST_CASE(merge_remove)
+{
+    static IntHeap items[TEST_HEAP_BATCH];
+    PairHeap heap, other;
+    int i;
+
+    /* even keys in one heap, odd keys in the other */
+    PairHeap_init(&heap, intCompare);
+    PairHeap_init(&other, intCompare);
+    for (i = 0; i < TEST_HEAP_BATCH; i++)
+    {
+        items[i].key = shuffle(i);
+        PairHeap_insert(items[i].key % 2 == 0 ? &heap : &other, &items[i].super);
+    }
+    PairHeap_pop(&heap);
+    PairHeap_pop(&other);
+    PairHeap_insert(&heap, &items[0].super);
+
+    PairHeap_merge(&heap, &other);
+    EXPECT_NULL(PairHeap_min(&other));
+    EXPECT_EQ(PairHeap_count(&other), 0);
+    EXPECT_EQ(PairHeap_count(&heap), TEST_HEAP_BATCH - 1);
+    verifyHeap(&heap);
+
+    /* remove all odd keys, then the root */
+    for (i = 0; i < TEST_HEAP_BATCH; i++)
+    {
+        if (items[i].key % 2 == 1 && items[i].key != 1)
+            PairHeap_remove(&heap, &items[i].super);
+    }
+    verifyHeap(&heap);
+    EXPECT_EQ(DOWN_CAST(PairHeap_min(&heap), IntHeap)->key, 0);
+    PairHeap_remove(&heap, PairHeap_min(&heap));
+    verifyHeap(&heap);
+
+    EXPECT_EQ(PairHeap_count(&heap), TEST_HEAP_BATCH / 2 - 1);
+    popAll(&heap, 2, 2);
+}
+
+TEST_SUITE(pairing_heap)
+{
+    TEST_RUN_CASE(insert_pop);
+    TEST_RUN_CASE(decrease);
+    TEST_RUN_CASE(merge_remove);
+}
@@ -0,0 +1,188 @@
+#include "myutil.h"
+
+typedef struct _IntRb
+{
+    RbNode super;
+    int key;
+} IntRb, *IntRbRef;
+
+#define TEST_RB_BATCH 1000
+
+static int intCompare(RbNodeRef node, void const *key)
+{
+    int a = DOWN_CAST(node, IntRb)->key, b = *(int const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* a permutation of 0 ~ TEST_RB_BATCH - 1 */
+static int shuffle(int i)
+{
+    return (int)(((uint64_t)i * 7919) % TEST_RB_BATCH);
+}
+
+/* check red-black properties, return black height, or -1 if broken. */
+static int checkNode(RbNodeRef node, RbNodeRef parent)
+{
+    if (node == NULL)
+        return 1;
+
+    if (RbNode_parent(node) != parent)
+        return -1;
+    if (RbNode_color(node) == RB_RED &&
+        ((node->left != NULL && RbNode_color(node->left) == RB_RED) ||
+         (node->right != NULL && RbNode_color(node->right) == RB_RED)))
+        return -1;
+
+    int left = checkNode(node->left, node);
+    int right = checkNode(node->right, node);
+    if (left < 0 || left != right)
+        return -1;
+    return left + (RbNode_color(node) == RB_BLACK ? 1 : 0);
+}
+
+static void verifyTree(RbTreeRef tree)
+{
+    RbTreeIter it = RbTreeIter_new(tree);
+    size_t count = 0;
+    int last = 0;
+
+    EXPECT_TRUE(tree->root == NULL || RbNode_color(tree->root) == RB_BLACK);
+    EXPECT_GT(checkNode(tree->root, NULL), 0);
+
+    while (RbTreeIter_next(&it))
+    {
+        int key = RbTreeIter_curObj(it, IntRb)->key;
+        EXPECT_LE(last, key);
+        last = key;
+        count++;
+    }
+    EXPECT_EQ(count, RbTree_count(tree));
+}
+
+TEST_CASE(node_size)
+{
+    EXPECT_EQ(sizeof(RbNode), sizeof(void *) * 3);
+}
+
+TEST_CASE(insert_find)
+{
+    static IntRb items[TEST_RB_BATCH];
+    RbTree tree;
+    int i;
+
+    RbTree_init(&tree, intCompare);
+    EXPECT_NULL(RbTree_first(&tree));
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_RB_BATCH; i++)
+    {
+        items[i].key = shuffle(i);
+        RbTree_insert(&tree, &items[i].super, &items[i].key);
+        if (i % 97 == 0)
+            verifyTree(&tree);
+    }
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_RB_BATCH; i++)
+    {
+        RbNodeRef node = RbTree_find(&tree, &i);
+        EXPECT_NOT_NULL(node);
+        EXPECT_EQ(DOWN_CAST(node, IntRb)->key, i);
+    }
+    i = TEST_RB_BATCH;
+    EXPECT_NULL(RbTree_find(&tree, &i));
+    EXPECT_NULL(RbTree_lowerBound(&tree, &i));
+    EXPECT_EQ(DOWN_CAST(RbTree_first(&tree), IntRb)->key, 0);
+    EXPECT_EQ(DOWN_CAST(RbTree_last(&tree), IntRb)->key, TEST_RB_BATCH - 1);
+}
+
+TEST_CASE(erase)
+{
+    static IntRb items[TEST_RB_BATCH];
+    RbTree tree;
+    int i;
+
+    RbTree_init(&tree, intCompare);
+
+    /* every key twice */
+    for (i = 0; i < TEST_RB_BATCH; i++)
+    {
+        items[i].key = shuffle(i) / 2;
+        RbTree_insert(&tree, &items[i].super, &items[i].key);
+    }
+    verifyTree(&tree);
+
+    for (i = 0; i < TEST_RB_BATCH; i += 2)
+    {
+        RbTree_erase(&tree, &items[i].super);
+        if (i % 50 == 0)
+            verifyTree(&tree);
+    }
+    verifyTree(&tree);
+    EXPECT_EQ(RbTree_count(&tree), TEST_RB_BATCH / 2);
+
+    for (i = 1; i < TEST_RB_BATCH; i += 2)
+        EXPECT_NOT_NULL(RbTree_find(&tree, &items[i].key));
+
+    for (i = 1; i < TEST_RB_BATCH; i += 2)
+        RbTree_erase(&tree, &items[i].super);
+    verifyTree(&tree);
+    EXPECT_NULL(tree.root);
+}
+
+TEST_CASE(iterator)
+{
+    static IntRb items[TEST_RB_BATCH];
+    RbTree tree;
+    RbTreeIter it;
+    int i, key;
+
+    RbTree_init(&tree, intCompare);
+
+    /* even keys only */
+    for (i = 0; i < TEST_RB_BATCH; i++)
+    {
+        items[i].key = shuffle(i) * 2;
+        RbTree_insert(&tree, &items[i].super, &items[i].key);
+    }
+
+    /* backward from the end */
+    it = RbTreeIter_new(&tree);
+    i = TEST_RB_BATCH * 2;
+    while (RbTreeIter_prev(&it))
+    {
+        i -= 2;
+        EXPECT_EQ(RbTreeIter_curObj(it, IntRb)->key, i);
+    }
+    EXPECT_EQ(i, 0);
+
+    /* seek between keys */
+    key = 101;
+    RbTreeIter_seek(&it, &tree, &key);
+    EXPECT_TRUE(RbTreeIter_hasNext(&it));
+    EXPECT_TRUE(RbTreeIter_next(&it));
+    EXPECT_EQ(RbTreeIter_curObj(it, IntRb)->key, 102);
+    EXPECT_TRUE(RbTreeIter_prev(&it));
+    EXPECT_EQ(RbTreeIter_curObj(it, IntRb)->key, 100);
+
+    RbTreeIter_seek(&it, &tree, &key);
+    EXPECT_TRUE(RbTreeIter_prev(&it));
+    EXPECT_EQ(RbTreeIter_curObj(it, IntRb)->key, 100);
+
+    /* seek after the last key */
+    key = TEST_RB_BATCH * 2;
+    RbTreeIter_seek(&it, &tree, &key);
+    EXPECT_FALSE(RbTreeIter_hasNext(&it));
+    EXPECT_FALSE(RbTreeIter_next(&it));
+    EXPECT_TRUE(RbTreeIter_prev(&it));
+    EXPECT_EQ(RbTreeIter_curObj(it, IntRb)->key, TEST_RB_BATCH * 2 - 2);
+    EXPECT_FALSE(RbTreeIter_next(&it));
+}
+
+TEST_SUITE(rb_tree)
+{
+    TEST_RUN_CASE(node_size);
+    TEST_RUN_CASE(insert_find);
+    TEST_RUN_CASE(erase);
+    TEST_RUN_CASE(iterator);
+}
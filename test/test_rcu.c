@@ -0,0 +1,223 @@
+#include "myutil.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+typedef struct _IntRcuList
+{
+    DbList super;
+    RcuHead rcu;
+    int i;
+} IntRcuList, *IntRcuListRef;
+
+#define TEST_RCU_BATCH 16
+#define TEST_RCU_READERS 4
+#define TEST_RCU_ROUNDS 2000
+#define TEST_RCU_POISON (-1)
+
+static void initList(DbListRef sentinel, IntRcuListRef il, size_t size)
+{
+    size_t i;
+    DbList_init(sentinel);
+    for (i = 0; i < size; i++)
+    {
+        il[i].i = i;
+        DbList_rcuInsert(&il[i].super, sentinel);
+    }
+}
+
+static int countList(DbListRef sentinel)
+{
+    DbListIter it;
+    int count = 0;
+    DbListIter_rcuInit(&it, sentinel);
+    while (DbListIter_rcuNext(&it))
+        count++;
+    return count;
+}
+
+TEST_CASE(travel)
+{
+    DbList sentinel;
+    IntRcuList il[TEST_RCU_BATCH];
+    DbListIter it;
+    int i = 0;
+
+    DbList_init(&sentinel);
+    EXPECT_EQ(countList(&sentinel), 0);
+
+    initList(&sentinel, il, TEST_RCU_BATCH);
+    DbListIter_rcuInit(&it, &sentinel);
+    while (DbListIter_rcuNext(&it))
+    {
+        EXPECT_EQ(DbListIter_curObj(it, IntRcuList)->i, i);
+        i++;
+    }
+    EXPECT_EQ(i, TEST_RCU_BATCH);
+}
+
+TEST_CASE(remove)
+{
+    DbList sentinel;
+    IntRcuList il[TEST_RCU_BATCH];
+    DbListIter it;
+
+    initList(&sentinel, il, TEST_RCU_BATCH);
+
+    /* a reader standing on the removed node can still move forward. */
+    DbListIter_rcuInit(&it, &sentinel);
+    DbListIter_rcuNext(&it);
+    DbListIter_rcuNext(&it);
+    EXPECT_EQ(DbListIter_current(&it), &il[1].super);
+
+    DbList_rcuRemove(&il[1].super);
+    DbList_rcuRemove(&il[0].super);
+    DbList_rcuRemove(&il[TEST_RCU_BATCH - 1].super);
+    EXPECT_EQ(countList(&sentinel), TEST_RCU_BATCH - 3);
+
+    EXPECT_TRUE(DbListIter_rcuNext(&it));
+    EXPECT_EQ(DbListIter_current(&it), &il[2].super);
+
+    /* insert back */
+    DbList_rcuInsert(&il[0].super, &il[2].super);
+    EXPECT_EQ(sentinel.next, &il[0].super);
+    EXPECT_EQ(countList(&sentinel), TEST_RCU_BATCH - 2);
+}
+
+static size_t __reclaimed = 0;
+
+static void reclaimCount(RcuHeadRef head)
+{
+    IntRcuListRef node = DOWN_CAST_FROM(head, IntRcuList, rcu);
+    node->i = TEST_RCU_POISON;
+    __reclaimed++;
+}
+
+TEST_CASE(reclaim)
+{
+    Rcu rcu;
+    RcuReader reader;
+    DbList sentinel;
+    IntRcuList il[TEST_RCU_BATCH];
+    int i;
+
+    Rcu_init(&rcu);
+    Rcu_register(&rcu, &reader);
+    initList(&sentinel, il, TEST_RCU_BATCH);
+
+    /* nested read section */
+    Rcu_readLock(&rcu, &reader);
+    Rcu_readLock(&rcu, &reader);
+    EXPECT_NE(reader.epoch, 0);
+    Rcu_readUnlock(&rcu, &reader);
+    EXPECT_NE(reader.epoch, 0);
+    Rcu_readUnlock(&rcu, &reader);
+    EXPECT_EQ(reader.epoch, 0);
+
+    EXPECT_EQ(Rcu_reclaim(&rcu), 0);
+
+    __reclaimed = 0;
+    for (i = 0; i < TEST_RCU_BATCH; i += 2)
+    {
+        DbList_rcuRemove(&il[i].super);
+        Rcu_call(&rcu, &il[i].rcu, reclaimCount);
+    }
+    EXPECT_EQ(__reclaimed, 0);
+    EXPECT_EQ(Rcu_reclaim(&rcu), TEST_RCU_BATCH / 2);
+    EXPECT_EQ(__reclaimed, TEST_RCU_BATCH / 2);
+    EXPECT_EQ(il[0].i, TEST_RCU_POISON);
+    EXPECT_EQ(il[1].i, 1);
+    EXPECT_EQ(countList(&sentinel), TEST_RCU_BATCH / 2);
+
+    Rcu_unregister(&rcu, &reader);
+    EXPECT_NULL(rcu.readers);
+}
+
+typedef struct _RcuTestContext
+{
+    Rcu rcu;
+    DbList sentinel;
+    IntRcuList il[TEST_RCU_BATCH];
+    RcuReader readers[TEST_RCU_READERS];
+    bool stop;
+    size_t poisoned;
+} RcuTestContext;
+
+static RcuTestContext __context;
+
+static void *readerThread(void *arg)
+{
+    RcuReaderRef reader = (RcuReaderRef)arg;
+    size_t poisoned = 0;
+    DbListIter it;
+
+    while (!__atomic_load_n(&__context.stop, __ATOMIC_RELAXED))
+    {
+        Rcu_readLock(&__context.rcu, reader);
+        DbListIter_rcuInit(&it, &__context.sentinel);
+        while (DbListIter_rcuNext(&it))
+        {
+            if (__atomic_load_n(&DbListIter_curObj(it, IntRcuList)->i, __ATOMIC_RELAXED) == TEST_RCU_POISON)
+                poisoned++;
+        }
+        Rcu_readUnlock(&__context.rcu, reader);
+
+        /* let the writer run on a busy or single cpu. */
+        sched_yield();
+    }
+
+    __atomic_fetch_add(&__context.poisoned, poisoned, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void reclaimPoison(RcuHeadRef head)
+{
+    IntRcuListRef node = DOWN_CAST_FROM(head, IntRcuList, rcu);
+    __atomic_store_n(&node->i, TEST_RCU_POISON, __ATOMIC_RELAXED);
+}
+
+TEST_CASE(concurrent)
+{
+    pthread_t threads[TEST_RCU_READERS];
+    int i, round;
+
+    Rcu_init(&__context.rcu);
+    initList(&__context.sentinel, __context.il, TEST_RCU_BATCH);
+    __context.stop = false;
+    __context.poisoned = 0;
+
+    for (i = 0; i < TEST_RCU_READERS; i++)
+    {
+        Rcu_register(&__context.rcu, &__context.readers[i]);
+        pthread_create(&threads[i], NULL, readerThread, &__context.readers[i]);
+    }
+
+    /* writer: remove, reclaim (poison) and reuse nodes. */
+    for (round = 0; round < TEST_RCU_ROUNDS; round++)
+    {
+        IntRcuListRef node = &__context.il[round % TEST_RCU_BATCH];
+        DbList_rcuRemove(&node->super);
+        Rcu_call(&__context.rcu, &node->rcu, reclaimPoison);
+        EXPECT_EQ(Rcu_reclaim(&__context.rcu), 1);
+        EXPECT_EQ(node->i, TEST_RCU_POISON);
+
+        /* reuse node after grace period. */
+        __atomic_store_n(&node->i, round, __ATOMIC_RELAXED);
+        DbList_rcuInsert(&node->super, &__context.sentinel);
+    }
+
+    __atomic_store_n(&__context.stop, true, __ATOMIC_RELAXED);
+    for (i = 0; i < TEST_RCU_READERS; i++)
+        pthread_join(threads[i], NULL);
+
+    EXPECT_EQ(__context.poisoned, 0);
+    EXPECT_EQ(countList(&__context.sentinel), TEST_RCU_BATCH);
+}
+
+TEST_SUITE(rcu)
+{
+    TEST_RUN_CASE(travel);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(reclaim);
+    TEST_RUN_CASE(concurrent);
+}
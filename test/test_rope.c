@@ -0,0 +1,245 @@
+#include "myutil.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_ROPE_HEAP_SIZE 0x40000
+
+static uint32_t __heap[TEST_ROPE_HEAP_SIZE / 4];
+
+static void onRelease(void *data, void *arg)
+{
+    (void)data;
+    (*(int *)arg)++;
+}
+
+/* the byte at offset of the test pattern */
+static uint8_t pattern(size_t i)
+{
+    return (uint8_t)(i * 31 + 7);
+}
+
+TEST_CASE(append_copy)
+{
+    static uint8_t data[ROPE_CHUNK_SIZE * 3], out[ROPE_CHUNK_SIZE * 3];
+    Rope rope;
+    size_t i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    Rope_init(&rope, alloc);
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = pattern(i);
+
+    /* small appends fill the same chunk. */
+    for (i = 0; i < 100; i++)
+        EXPECT_TRUE(Rope_append(&rope, data + i * 10, 10));
+    EXPECT_EQ(Rope_length(&rope), 1000);
+    EXPECT_EQ(Rope_segments(&rope), 1);
+
+    /* a large one fills the rest, and spills into a new chunk. */
+    EXPECT_TRUE(Rope_append(&rope, data + 1000, sizeof(data) - 1000));
+    EXPECT_EQ(Rope_length(&rope), sizeof(data));
+    EXPECT_EQ(Rope_segments(&rope), 2);
+    EXPECT_TRUE(Rope_append(&rope, data, 0));
+    EXPECT_EQ(Rope_segments(&rope), 2);
+
+    EXPECT_EQ(Rope_copy(&rope, 0, out, sizeof(out)), sizeof(data));
+    EXPECT_EQ(memcmp(out, data, sizeof(data)), 0);
+    EXPECT_EQ(Rope_copy(&rope, 4000, out, 200), 200);
+    EXPECT_EQ(memcmp(out, data + 4000, 200), 0);
+    EXPECT_EQ(Rope_copy(&rope, sizeof(data) - 5, out, 100), 5);
+    EXPECT_EQ(Rope_copy(&rope, sizeof(data), out, 100), 0);
+
+    Rope_destroy(&rope);
+    EXPECT_EQ(Rope_length(&rope), 0);
+    EXPECT_NULL(rope.head);
+}
+
+TEST_CASE(append_ref)
+{
+    static char const hello[] = "hello, ", world[] = "world";
+    char out[16] = {0};
+    Rope rope;
+    int released = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    Rope_init(&rope, alloc);
+
+    EXPECT_TRUE(Rope_appendRef(&rope, hello, 7, onRelease, &released));
+    EXPECT_TRUE(Rope_appendRef(&rope, world, 5, onRelease, &released));
+    EXPECT_EQ(Rope_segments(&rope), 2);
+
+    /* copies never go into external memory. */
+    EXPECT_TRUE(Rope_append(&rope, "!", 1));
+    EXPECT_EQ(Rope_segments(&rope), 3);
+    EXPECT_EQ(Rope_copy(&rope, 0, out, sizeof(out)), 13);
+    EXPECT_EQ_S(out, "hello, world!");
+
+    Rope_consume(&rope, 3);
+    EXPECT_EQ(released, 0);
+    Rope_consume(&rope, 5);
+    EXPECT_EQ(released, 1);
+    EXPECT_EQ(Rope_length(&rope), 5);
+    memset(out, 0, sizeof(out));
+    Rope_copy(&rope, 0, out, sizeof(out));
+    EXPECT_EQ_S(out, "orld!");
+
+    Rope_destroy(&rope);
+    EXPECT_EQ(released, 2);
+}
+
+TEST_CASE(slice)
+{
+    static char const text[] = "the quick brown fox";
+    char out[32] = {0};
+    Rope rope, part;
+    int released = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    Rope_init(&rope, alloc);
+    Rope_init(&part, alloc);
+
+    EXPECT_TRUE(Rope_append(&rope, text, 10));
+    EXPECT_TRUE(Rope_appendRef(&rope, text + 10, 9, onRelease, &released));
+
+    /* "quick brown" across both segments, no bytes copied. */
+    EXPECT_TRUE(Rope_slice(&part, &rope, 4, 11));
+    EXPECT_EQ(Rope_length(&part), 11);
+    EXPECT_EQ(Rope_segments(&part), 2);
+    Rope_copy(&part, 0, out, sizeof(out));
+    EXPECT_EQ_S(out, "quick brown");
+
+    /* the shared chunk is not written by appends of either rope. */
+    EXPECT_TRUE(Rope_append(&part, "!", 1));
+    EXPECT_EQ(Rope_segments(&part), 3);
+    Rope_clear(&rope);
+    EXPECT_TRUE(Rope_append(&rope, "?", 1));
+    memset(out, 0, sizeof(out));
+    Rope_copy(&part, 0, out, sizeof(out));
+    EXPECT_EQ_S(out, "quick brown!");
+
+    /* external memory is released after the last rope. */
+    EXPECT_EQ(released, 0);
+    Rope_clear(&part);
+    EXPECT_EQ(released, 1);
+
+    /* clamped to the end, and empty beyond it. */
+    EXPECT_TRUE(Rope_slice(&part, &rope, 0, 100));
+    EXPECT_EQ(Rope_length(&part), 1);
+    EXPECT_TRUE(Rope_slice(&part, &rope, 1, 100));
+    EXPECT_EQ(Rope_length(&part), 1);
+
+    Rope_destroy(&part);
+    Rope_destroy(&rope);
+}
+
+TEST_CASE(iovec)
+{
+    static uint8_t data[ROPE_CHUNK_SIZE * 2];
+    struct iovec iov[4];
+    Rope rope;
+    int fds[2];
+    size_t i, total;
+    ssize_t n;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    Rope_init(&rope, alloc);
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = pattern(i);
+
+    EXPECT_TRUE(Rope_append(&rope, data, 100));
+    EXPECT_TRUE(Rope_appendRef(&rope, data + 100, 1000, NULL, NULL));
+    EXPECT_TRUE(Rope_append(&rope, data + 1100, sizeof(data) - 1100));
+    EXPECT_EQ(Rope_segments(&rope), 3);
+
+    EXPECT_EQ(Rope_iovec(&rope, iov, 2), 2);
+    EXPECT_EQ(Rope_iovec(&rope, iov, 4), 3);
+    for (i = 0, total = 0; i < 3; i++)
+    {
+        EXPECT_EQ(memcmp(iov[i].iov_base, data + total, iov[i].iov_len), 0);
+        total += iov[i].iov_len;
+    }
+    EXPECT_EQ(total, sizeof(data));
+
+    /* gather write, then drop what was written. */
+    EXPECT_EQ(pipe(fds), 0);
+    n = writev(fds[1], iov, 3);
+    EXPECT_EQ(n, sizeof(data));
+    Rope_consume(&rope, n);
+    EXPECT_EQ(Rope_length(&rope), 0);
+    EXPECT_EQ(Rope_iovec(&rope, iov, 4), 0);
+    EXPECT_EQ(read(fds[0], data, sizeof(data)), sizeof(data));
+    for (i = 0; i < sizeof(data); i++)
+    {
+        if (data[i] != pattern(i))
+            break;
+    }
+    EXPECT_EQ(i, sizeof(data));
+    close(fds[0]);
+    close(fds[1]);
+
+    Rope_destroy(&rope);
+}
+
+TEST_CASE(odd_sizes)
+{
+    static uint8_t data[ROPE_CHUNK_SIZE * 2 + 3], out[ROPE_CHUNK_SIZE * 2 + 3];
+    Rope rope;
+    ListRef node;
+    size_t i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    Rope_init(&rope, alloc);
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = pattern(i);
+
+    /* an odd sized chunk, then segments and chunks allocated after it */
+    EXPECT_TRUE(Rope_append(&rope, data, ROPE_CHUNK_SIZE + 3));
+    EXPECT_TRUE(Rope_appendRef(&rope, data + ROPE_CHUNK_SIZE + 3, 5, NULL, NULL));
+    EXPECT_TRUE(Rope_append(&rope, data + ROPE_CHUNK_SIZE + 8, sizeof(data) - ROPE_CHUNK_SIZE - 8));
+    EXPECT_EQ(Rope_segments(&rope), 3);
+    for (node = rope.head; node != NULL; node = node->next)
+        EXPECT_EQ((uintptr_t)node % sizeof(void *), 0);
+
+    EXPECT_EQ(Rope_copy(&rope, 0, out, sizeof(out)), sizeof(data));
+    EXPECT_EQ(memcmp(out, data, sizeof(data)), 0);
+    Rope_consume(&rope, ROPE_CHUNK_SIZE + 4);
+    EXPECT_EQ(Rope_segments(&rope), 2);
+
+    Rope_destroy(&rope);
+}
+
+TEST_CASE(out_of_memory)
+{
+    char out[8] = {0};
+    Rope rope, part;
+    int released = 0;
+
+    AllocatorRef alloc = StaticAllocator(ROPE_CHUNK_SIZE + 80, __heap);
+    Rope_init(&rope, alloc);
+    Rope_init(&part, alloc);
+
+    EXPECT_TRUE(Rope_append(&rope, "abc", 3));
+    EXPECT_FALSE(Rope_appendRef(&rope, "defgh", 5, onRelease, &released));
+
+    /* a new chunk is needed, nothing is written. */
+    EXPECT_FALSE(Rope_append(&rope, out, ROPE_CHUNK_SIZE));
+    EXPECT_EQ(Rope_length(&rope), 3);
+    EXPECT_EQ(Rope_segments(&rope), 1);
+    EXPECT_EQ(released, 0);
+
+    Rope_copy(&rope, 0, out, sizeof(out));
+    EXPECT_EQ_S(out, "abc");
+    Rope_destroy(&rope);
+    Rope_destroy(&part);
+}
+
+TEST_SUITE(rope)
+{
+    TEST_RUN_CASE(append_copy);
+    TEST_RUN_CASE(append_ref);
+    TEST_RUN_CASE(slice);
+    TEST_RUN_CASE(iovec);
+    TEST_RUN_CASE(odd_sizes);
+    TEST_RUN_CASE(out_of_memory);
+}
@@ -0,0 +1,194 @@
+#include "myutil.h"
+
+#include <pthread.h>
+
+typedef struct _IntSkip
+{
+    int key;
+    SkipNode super;
+} IntSkip, *IntSkipRef;
+
+#define TEST_SKIP_HEAP_SIZE 0x40000
+#define TEST_SKIP_BATCH 1000
+#define TEST_SKIP_THREADS 4
+
+static uint32_t __heap[TEST_SKIP_HEAP_SIZE / 4];
+
+static int intCompare(SkipNodeRef node, void const *key)
+{
+    int a = DOWN_CAST(node, IntSkip)->key, b = *(int const *)key;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/* a permutation of 0 ~ TEST_SKIP_BATCH - 1 */
+static int shuffle(int i)
+{
+    return (int)(((uint64_t)i * 7919) % TEST_SKIP_BATCH);
+}
+
+static IntSkipRef newInt(SkipListRef list, AllocatorRef alloc, int key)
+{
+    IntSkipRef item = SkipList_new(list, alloc, IntSkip);
+    if (item != NULL)
+        item->key = key;
+    return item;
+}
+
+static void verifyList(SkipListRef list, int count)
+{
+    SkipListIter it;
+    int i = 0;
+
+    SkipListIter_init(&it, list);
+    while (SkipListIter_next(&it))
+    {
+        EXPECT_EQ(SkipListIter_curObj(it, IntSkip)->key, i);
+        i++;
+    }
+    EXPECT_EQ(i, count);
+}
+
+TEST_CASE(insert_find)
+{
+    SkipList list;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    SkipList_init(&list, intCompare);
+
+    for (i = 0; i < TEST_SKIP_BATCH; i++)
+    {
+        IntSkipRef item = newInt(&list, alloc, shuffle(i));
+        EXPECT_NOT_NULL(item);
+        EXPECT_GE(item->super.height, 1);
+        EXPECT_LE(item->super.height, SKIP_LIST_MAX_HEIGHT);
+        SkipList_insert(&list, &item->super, &item->key);
+    }
+    EXPECT_GT(list.height, 1);
+
+    verifyList(&list, TEST_SKIP_BATCH);
+    for (i = 0; i < TEST_SKIP_BATCH; i++)
+    {
+        SkipNodeRef node = SkipList_find(&list, &i);
+        EXPECT_NOT_NULL(node);
+        EXPECT_EQ(DOWN_CAST(node, IntSkip)->key, i);
+    }
+    i = TEST_SKIP_BATCH;
+    EXPECT_NULL(SkipList_find(&list, &i));
+    EXPECT_NULL(SkipList_lowerBound(&list, &i));
+    i = -1;
+    EXPECT_NULL(SkipList_find(&list, &i));
+    EXPECT_EQ(DOWN_CAST(SkipList_lowerBound(&list, &i), IntSkip)->key, 0);
+}
+
+TEST_CASE(range)
+{
+    SkipList list;
+    SkipListIter it;
+    int i, key;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    SkipList_init(&list, intCompare);
+
+    /* even keys only */
+    for (i = 0; i < TEST_SKIP_BATCH; i++)
+    {
+        IntSkipRef item = newInt(&list, alloc, shuffle(i) * 2);
+        SkipList_insert(&list, &item->super, &item->key);
+    }
+
+    key = 101;
+    SkipListIter_seek(&it, &list, &key);
+    for (i = 102; i < 200; i += 2)
+    {
+        EXPECT_TRUE(SkipListIter_next(&it));
+        EXPECT_EQ(SkipListIter_curObj(it, IntSkip)->key, i);
+    }
+
+    key = TEST_SKIP_BATCH * 2 - 2;
+    SkipListIter_seek(&it, &list, &key);
+    EXPECT_TRUE(SkipListIter_next(&it));
+    EXPECT_FALSE(SkipListIter_next(&it));
+}
+
+TEST_CASE(remove)
+{
+    static IntSkipRef items[TEST_SKIP_BATCH];
+    SkipList list;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    SkipList_init(&list, intCompare);
+
+    /* every key twice */
+    for (i = 0; i < TEST_SKIP_BATCH; i++)
+    {
+        items[i] = newInt(&list, alloc, shuffle(i) / 2);
+        SkipList_insert(&list, &items[i]->super, &items[i]->key);
+    }
+
+    for (i = 0; i < TEST_SKIP_BATCH; i += 2)
+        EXPECT_TRUE(SkipList_remove(&list, &items[i]->super, &items[i]->key));
+    EXPECT_FALSE(SkipList_remove(&list, &items[0]->super, &items[0]->key));
+
+    verifyList(&list, TEST_SKIP_BATCH / 2);
+    for (i = 1; i < TEST_SKIP_BATCH; i += 2)
+        EXPECT_TRUE(SkipList_remove(&list, &items[i]->super, &items[i]->key));
+
+    verifyList(&list, 0);
+}
+
+typedef struct _SkipTestContext
+{
+    SkipList list;
+    IntSkipRef items[TEST_SKIP_THREADS][TEST_SKIP_BATCH];
+    int missed;
+} SkipTestContext;
+
+static SkipTestContext __context;
+
+static void *insertThread(void *arg)
+{
+    IntSkipRef *items = (IntSkipRef *)arg;
+    int i, missed = 0;
+    for (i = 0; i < TEST_SKIP_BATCH; i++)
+    {
+        SkipList_insert(&__context.list, &items[i]->super, &items[i]->key);
+        if (SkipList_find(&__context.list, &items[i]->key) != &items[i]->super)
+            missed++;
+    }
+    __atomic_fetch_add(&__context.missed, missed, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+TEST_CASE(concurrent)
+{
+    pthread_t threads[TEST_SKIP_THREADS];
+    int i, j;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    SkipList_init(&__context.list, intCompare);
+
+    /* static allocator is not thread safe, allocate first. */
+    for (i = 0; i < TEST_SKIP_THREADS; i++)
+    {
+        for (j = 0; j < TEST_SKIP_BATCH; j++)
+            __context.items[i][j] = newInt(&__context.list, alloc, shuffle(j) * TEST_SKIP_THREADS + i);
+    }
+
+    for (i = 0; i < TEST_SKIP_THREADS; i++)
+        pthread_create(&threads[i], NULL, insertThread, __context.items[i]);
+    for (i = 0; i < TEST_SKIP_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    EXPECT_EQ(__context.missed, 0);
+    verifyList(&__context.list, TEST_SKIP_THREADS * TEST_SKIP_BATCH);
+}
+
+TEST_SUITE(skip_list)
+{
+    TEST_RUN_CASE(insert_find);
+    TEST_RUN_CASE(range);
+    TEST_RUN_CASE(remove);
+    TEST_RUN_CASE(concurrent);
+}
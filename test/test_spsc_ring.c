@@ -0,0 +1,175 @@
+#include "myutil.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define TEST_RING_HEAP_SIZE 0x1000
+#define TEST_RING_ITEMS 200000
+#define TEST_RING_BATCH 7
+
+static uint32_t __heap[TEST_RING_HEAP_SIZE / 4];
+
+TEST_CASE(layout)
+{
+    EXPECT_EQ(offsetof(SpscRing, head) % CACHE_LINE_SIZE, 0);
+    EXPECT_EQ(offsetof(SpscRing, tail) % CACHE_LINE_SIZE, 0);
+    EXPECT_GE(offsetof(SpscRing, tail) - offsetof(SpscRing, head), CACHE_LINE_SIZE);
+}
+
+TEST_CASE(push_pop)
+{
+    SpscRing ring;
+    void *item = NULL;
+    uintptr_t i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(SpscRing_init(&ring, alloc, 5));
+    EXPECT_EQ(SpscRing_capacity(&ring), 8);
+    EXPECT_FALSE(SpscRing_pop(&ring, &item));
+
+    /* wrap around several times */
+    for (i = 0; i < 100; i++)
+    {
+        EXPECT_TRUE(SpscRing_push(&ring, (void *)(i * 2 + 1)));
+        EXPECT_TRUE(SpscRing_push(&ring, (void *)(i * 2 + 2)));
+        EXPECT_EQ(SpscRing_count(&ring), 2);
+        EXPECT_TRUE(SpscRing_pop(&ring, &item));
+        EXPECT_EQ(item, (void *)(i * 2 + 1));
+        EXPECT_TRUE(SpscRing_pop(&ring, &item));
+        EXPECT_EQ(item, (void *)(i * 2 + 2));
+    }
+
+    for (i = 0; i < 8; i++)
+        EXPECT_TRUE(SpscRing_push(&ring, (void *)i));
+    EXPECT_FALSE(SpscRing_push(&ring, (void *)i));
+    EXPECT_EQ(SpscRing_count(&ring), 8);
+    for (i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(SpscRing_pop(&ring, &item));
+        EXPECT_EQ(item, (void *)i);
+    }
+    EXPECT_FALSE(SpscRing_pop(&ring, &item));
+
+    SpscRing_destroy(&ring);
+
+    /* allocation failure */
+    alloc = StaticAllocator(64, __heap);
+    EXPECT_FALSE(SpscRing_init(&ring, alloc, 1024));
+}
+
+TEST_CASE(batch)
+{
+    void *in[TEST_RING_BATCH], *out[16];
+    SpscRing ring;
+    uintptr_t i, next = 0, expect = 0;
+    size_t n, j;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(SpscRing_init(&ring, alloc, 16));
+
+    /* odd batch size, so copies are split at the end of slots. */
+    for (i = 0; i < 50; i++)
+    {
+        for (j = 0; j < TEST_RING_BATCH; j++)
+            in[j] = (void *)(next + j);
+        n = SpscRing_pushN(&ring, in, TEST_RING_BATCH);
+        EXPECT_EQ(n, TEST_RING_BATCH);
+        next += n;
+
+        n = SpscRing_popN(&ring, out, 5);
+        EXPECT_EQ(n, 5);
+        for (j = 0; j < n; j++)
+            EXPECT_EQ(out[j], (void *)expect++);
+
+        /* drain when nearly full */
+        if (SpscRing_count(&ring) > 16 - TEST_RING_BATCH)
+        {
+            n = SpscRing_popN(&ring, out, 16);
+            for (j = 0; j < n; j++)
+                EXPECT_EQ(out[j], (void *)expect++);
+        }
+    }
+
+    /* partial push on a full ring */
+    n = SpscRing_popN(&ring, out, 16);
+    for (j = 0; j < n; j++)
+        EXPECT_EQ(out[j], (void *)expect++);
+    EXPECT_EQ(expect, next);
+    EXPECT_EQ(SpscRing_pushN(&ring, out, 16), 16);
+    EXPECT_EQ(SpscRing_pushN(&ring, in, TEST_RING_BATCH), 0);
+    EXPECT_EQ(SpscRing_popN(&ring, out, 3), 3);
+    EXPECT_EQ(SpscRing_pushN(&ring, in, TEST_RING_BATCH), 3);
+    EXPECT_EQ(SpscRing_popN(&ring, out, 16), 16);
+    EXPECT_EQ(SpscRing_popN(&ring, out, 16), 0);
+
+    SpscRing_destroy(&ring);
+}
+
+static SpscRing __ring;
+
+static void *producerThread(void *arg)
+{
+    void *batch[TEST_RING_BATCH];
+    uintptr_t i = 0;
+    size_t j, n;
+
+    (void)arg;
+
+    /* mix single and batch pushes */
+    while (i < TEST_RING_ITEMS)
+    {
+        if (i % 3 == 0)
+        {
+            while (!SpscRing_push(&__ring, (void *)i))
+                sched_yield();
+            i++;
+            continue;
+        }
+
+        n = MIN(TEST_RING_BATCH, TEST_RING_ITEMS - i);
+        for (j = 0; j < n; j++)
+            batch[j] = (void *)(i + j);
+        j = SpscRing_pushN(&__ring, batch, n);
+        while (j < n)
+        {
+            sched_yield();
+            j += SpscRing_pushN(&__ring, batch + j, n - j);
+        }
+        i += n;
+    }
+    return NULL;
+}
+
+TEST_CASE(concurrent)
+{
+    void *out[TEST_RING_BATCH * 2];
+    pthread_t thread;
+    uintptr_t expect = 0, mismatched = 0;
+    size_t j, n;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(SpscRing_init(&__ring, alloc, 64));
+    pthread_create(&thread, NULL, producerThread, NULL);
+
+    while (expect < TEST_RING_ITEMS)
+    {
+        n = SpscRing_popN(&__ring, out, sizeof(out) / sizeof(out[0]));
+        if (n == 0)
+            sched_yield();
+        for (j = 0; j < n; j++, expect++)
+            mismatched += out[j] != (void *)expect;
+    }
+    pthread_join(thread, NULL);
+
+    EXPECT_EQ(mismatched, 0);
+    EXPECT_EQ(SpscRing_count(&__ring), 0);
+    SpscRing_destroy(&__ring);
+}
+
+TEST_SUITE(spsc_ring)
+{
+    TEST_RUN_CASE(layout);
+    TEST_RUN_CASE(push_pop);
+    TEST_RUN_CASE(batch);
+    TEST_RUN_CASE(concurrent);
+}
@@ -0,0 +1,151 @@
+#include "myutil.h"
+
+#include <string.h>
+
+#define TEST_POOL_HEAP_SIZE 0x100000
+#define TEST_POOL_BATCH 10000
+
+static uint32_t __heap[TEST_POOL_HEAP_SIZE / 4];
+static char __names[TEST_POOL_BATCH][16];
+
+static void initNames(void)
+{
+    int i;
+    for (i = 0; i < TEST_POOL_BATCH; i++)
+        snprintf(__names[i], sizeof(__names[i]), "name.%d", i);
+}
+
+TEST_CASE(intern)
+{
+    StringPool pool;
+    char buf[16];
+    cstr_t a, b, first;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(StringPool_init(&pool, alloc, 1024));
+    initNames();
+
+    /* same content, same handle, wherever it comes from. */
+    strcpy(buf, "hello");
+    a = StringPool_intern(&pool, "hello");
+    b = StringPool_intern(&pool, buf);
+    EXPECT_NOT_NULL(a);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, buf);
+    EXPECT_EQ_S(a, "hello");
+    EXPECT_EQ(StringPool_length(a), 5);
+    EXPECT_EQ(StringPool_hash(a), Hash_string("hello"));
+    EXPECT_EQ(StringPool_internBytes(&pool, "hello world", 5), a);
+    EXPECT_NE(StringPool_intern(&pool, "hello!"), a);
+    EXPECT_EQ(StringPool_count(&pool), 2);
+
+    /* the empty string is a string too. */
+    a = StringPool_intern(&pool, "");
+    EXPECT_NOT_NULL(a);
+    EXPECT_EQ(StringPool_length(a), 0);
+    EXPECT_EQ(StringPool_intern(&pool, ""), a);
+
+    /* handles are stable while index and arena grow. */
+    first = StringPool_intern(&pool, __names[0]);
+    for (i = 1; i < TEST_POOL_BATCH; i++)
+        EXPECT_NOT_NULL(StringPool_intern(&pool, __names[i]));
+    EXPECT_EQ(StringPool_count(&pool), TEST_POOL_BATCH + 3);
+    EXPECT_EQ(StringPool_intern(&pool, __names[0]), first);
+    EXPECT_EQ_S(first, __names[0]);
+
+    for (i = 0; i < TEST_POOL_BATCH; i += 7)
+    {
+        cstr_t handle = StringPool_find(&pool, __names[i]);
+        EXPECT_EQ_S(handle, __names[i]);
+        EXPECT_EQ(StringPool_intern(&pool, __names[i]), handle);
+    }
+    EXPECT_NULL(StringPool_find(&pool, "name."));
+    EXPECT_EQ(StringPool_count(&pool), TEST_POOL_BATCH + 3);
+
+    StringPool_destroy(&pool);
+    EXPECT_EQ(StringPool_count(&pool), 0);
+}
+
+TEST_CASE(long_strings)
+{
+    static char big[3000];
+    StringPool pool;
+    cstr_t small, large, after;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(StringPool_init(&pool, alloc, 256));
+    memset(big, 'x', sizeof(big) - 1);
+
+    /* larger than a chunk, it goes to a chunk of its own. */
+    small = StringPool_intern(&pool, "small");
+    large = StringPool_intern(&pool, big);
+    after = StringPool_intern(&pool, "after");
+    EXPECT_NOT_NULL(large);
+    EXPECT_EQ(StringPool_length(large), sizeof(big) - 1);
+    EXPECT_EQ(StringPool_intern(&pool, big), large);
+
+    /* following strings still fill the current chunk. */
+    EXPECT_EQ(after, small + ALIGN(sizeof("small"), 4) + sizeof(uint32_t) * 2);
+    EXPECT_EQ_S(after, "after");
+
+    StringPool_destroy(&pool);
+}
+
+TEST_CASE(batch)
+{
+    static cstr_t strs[TEST_POOL_BATCH];
+    static cstr_t handles[TEST_POOL_BATCH];
+    StringPool pool;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(StringPool_init(&pool, alloc, 0));
+    initNames();
+
+    /* every name twice */
+    for (i = 0; i < TEST_POOL_BATCH; i++)
+        strs[i] = __names[i / 2];
+    EXPECT_EQ(StringPool_internBatch(&pool, strs, TEST_POOL_BATCH, handles), TEST_POOL_BATCH);
+    EXPECT_EQ(StringPool_count(&pool), TEST_POOL_BATCH / 2);
+    for (i = 0; i < TEST_POOL_BATCH; i += 2)
+    {
+        EXPECT_EQ(handles[i], handles[i + 1]);
+        EXPECT_EQ_S(handles[i], __names[i / 2]);
+        EXPECT_EQ(StringPool_find(&pool, __names[i / 2]), handles[i]);
+    }
+
+    StringPool_destroy(&pool);
+}
+
+TEST_CASE(alloc_failure)
+{
+    StringPool pool;
+    int i, interned = 0;
+
+    AllocatorRef alloc = StaticAllocator(4096, __heap);
+    EXPECT_TRUE(StringPool_init(&pool, alloc, 1024));
+    initNames();
+
+    for (i = 0; i < TEST_POOL_BATCH; i++)
+    {
+        if (StringPool_intern(&pool, __names[i]) != NULL)
+            interned++;
+    }
+    EXPECT_GT(interned, 0);
+    EXPECT_LT(interned, TEST_POOL_BATCH);
+    EXPECT_EQ(StringPool_count(&pool), interned);
+
+    /* what was interned is still there. */
+    for (i = 0; i < interned; i++)
+        EXPECT_EQ_S(StringPool_find(&pool, __names[i]), __names[i]);
+    EXPECT_NULL(StringPool_find(&pool, __names[interned]));
+}
+
+TEST_SUITE(string_pool)
+{
+    TEST_RUN_CASE(intern);
+    TEST_RUN_CASE(long_strings);
+    TEST_RUN_CASE(batch);
+    TEST_RUN_CASE(alloc_failure);
+}
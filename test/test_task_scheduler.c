@@ -0,0 +1,248 @@
+#include "myutil.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define TEST_TASK_HEAP_SIZE 0x40000
+#define TEST_TASK_ITEMS 20000
+#define TEST_TASK_THIEVES 3
+#define TEST_TASK_WORKERS 4
+#define TEST_TASK_ARRAY 100000
+
+static uint32_t __heap[TEST_TASK_HEAP_SIZE / 4];
+
+TEST_CASE(deque)
+{
+    static int items[16];
+    WsDeque deque;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(WsDeque_init(&deque, alloc, 5));
+    EXPECT_NULL(WsDeque_take(&deque));
+    EXPECT_NULL(WsDeque_steal(&deque));
+
+    for (i = 0; i < 8; i++)
+        EXPECT_TRUE(WsDeque_push(&deque, &items[i]));
+    EXPECT_FALSE(WsDeque_push(&deque, &items[8]));
+    EXPECT_EQ(WsDeque_count(&deque), 8);
+
+    /* owner takes the last, thieves steal the first. */
+    EXPECT_EQ(WsDeque_take(&deque), &items[7]);
+    EXPECT_EQ(WsDeque_steal(&deque), &items[0]);
+    EXPECT_EQ(WsDeque_steal(&deque), &items[1]);
+    EXPECT_EQ(WsDeque_take(&deque), &items[6]);
+    EXPECT_EQ(WsDeque_count(&deque), 4);
+
+    /* wrap around */
+    for (i = 8; i < 12; i++)
+        EXPECT_TRUE(WsDeque_push(&deque, &items[i]));
+    EXPECT_FALSE(WsDeque_push(&deque, &items[12]));
+    for (i = 2; i < 6; i++)
+        EXPECT_EQ(WsDeque_steal(&deque), &items[i]);
+    for (i = 11; i >= 8; i--)
+        EXPECT_EQ(WsDeque_take(&deque), &items[i]);
+    EXPECT_NULL(WsDeque_take(&deque));
+    EXPECT_EQ(WsDeque_count(&deque), 0);
+
+    WsDeque_destroy(&deque);
+}
+
+typedef struct _DequeTestContext
+{
+    WsDeque deque;
+    uint8_t seen[TEST_TASK_ITEMS];
+    bool done;
+    int duplicated;
+} DequeTestContext;
+
+static DequeTestContext __context;
+
+static void visit(uintptr_t item)
+{
+    if (__atomic_fetch_add(&__context.seen[item - 1], 1, __ATOMIC_RELAXED) != 0)
+        __atomic_fetch_add(&__context.duplicated, 1, __ATOMIC_RELAXED);
+}
+
+static void *thiefThread(void *arg)
+{
+    (void)arg;
+    while (!__atomic_load_n(&__context.done, __ATOMIC_ACQUIRE))
+    {
+        void *item = WsDeque_steal(&__context.deque);
+        if (item != NULL)
+            visit((uintptr_t)item);
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+TEST_CASE(deque_concurrent)
+{
+    pthread_t threads[TEST_TASK_THIEVES];
+    uintptr_t i;
+    void *item;
+    int missed = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(WsDeque_init(&__context.deque, alloc, 64));
+    __context.done = false;
+    __context.duplicated = 0;
+
+    for (i = 0; i < TEST_TASK_THIEVES; i++)
+        pthread_create(&threads[i], NULL, thiefThread, NULL);
+
+    /* owner pushes two and takes one, thieves race for the rest. */
+    for (i = 1; i <= TEST_TASK_ITEMS; i++)
+    {
+        while (!WsDeque_push(&__context.deque, (void *)i))
+        {
+            item = WsDeque_take(&__context.deque);
+            if (item != NULL)
+                visit((uintptr_t)item);
+        }
+        if (i % 2 == 0 && (item = WsDeque_take(&__context.deque)) != NULL)
+            visit((uintptr_t)item);
+    }
+    while ((item = WsDeque_take(&__context.deque)) != NULL)
+        visit((uintptr_t)item);
+
+    __atomic_store_n(&__context.done, true, __ATOMIC_RELEASE);
+    for (i = 0; i < TEST_TASK_THIEVES; i++)
+        pthread_join(threads[i], NULL);
+
+    for (i = 0; i < TEST_TASK_ITEMS; i++)
+        missed += __context.seen[i] == 0;
+    EXPECT_EQ(missed, 0);
+    EXPECT_EQ(__context.duplicated, 0);
+    WsDeque_destroy(&__context.deque);
+}
+
+typedef struct _Fib
+{
+    int n;
+    int result;
+} Fib;
+
+static void fibTask(TaskWorkerRef worker, void *arg)
+{
+    Fib *fib = (Fib *)arg;
+    Fib a, b;
+    TaskGroup group;
+
+    if (fib->n < 2)
+    {
+        fib->result = fib->n;
+        return;
+    }
+
+    a.n = fib->n - 1;
+    b.n = fib->n - 2;
+    TaskGroup_init(&group);
+    TaskWorker_fork(worker, &group, fibTask, &a);
+    fibTask(worker, &b);
+    TaskWorker_join(worker, &group);
+    fib->result = a.result + b.result;
+}
+
+TEST_CASE(fork_join)
+{
+    TaskScheduler scheduler;
+    Fib fib;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(TaskScheduler_init(&scheduler, alloc, TEST_TASK_WORKERS, 64));
+    EXPECT_EQ(TaskScheduler_workers(&scheduler), TEST_TASK_WORKERS);
+
+    fib.n = 20;
+    TaskScheduler_run(&scheduler, fibTask, &fib);
+    EXPECT_EQ(fib.result, 6765);
+
+    /* run again after workers slept */
+    fib.n = 15;
+    TaskScheduler_run(&scheduler, fibTask, &fib);
+    EXPECT_EQ(fib.result, 610);
+
+    TaskScheduler_destroy(&scheduler);
+}
+
+typedef struct _Range
+{
+    uint32_t *array;
+    size_t begin;
+    size_t end;
+    uint64_t sum;
+} Range;
+
+static void sumTask(TaskWorkerRef worker, void *arg)
+{
+    Range *range = (Range *)arg;
+    Range parts[4];
+    TaskGroup group;
+    size_t i, step;
+
+    if (range->end - range->begin <= 1000)
+    {
+        range->sum = 0;
+        for (i = range->begin; i < range->end; i++)
+            range->sum += range->array[i];
+        return;
+    }
+
+    /* wide fork, more tasks in flight than records */
+    TaskGroup_init(&group);
+    step = (range->end - range->begin + 3) / 4;
+    for (i = 0; i < 4; i++)
+    {
+        parts[i].array = range->array;
+        parts[i].begin = MIN(range->begin + step * i, range->end);
+        parts[i].end = MIN(range->begin + step * (i + 1), range->end);
+        TaskWorker_fork(worker, &group, sumTask, &parts[i]);
+    }
+    TaskWorker_join(worker, &group);
+
+    range->sum = 0;
+    for (i = 0; i < 4; i++)
+        range->sum += parts[i].sum;
+}
+
+TEST_CASE(few_records)
+{
+    static uint32_t array[TEST_TASK_ARRAY];
+    TaskScheduler scheduler;
+    Range range;
+    size_t i;
+
+    for (i = 0; i < TEST_TASK_ARRAY; i++)
+        array[i] = (uint32_t)i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(TaskScheduler_init(&scheduler, alloc, TEST_TASK_WORKERS, 3));
+
+    range.array = array;
+    range.begin = 0;
+    range.end = TEST_TASK_ARRAY;
+    TaskScheduler_run(&scheduler, sumTask, &range);
+    EXPECT_EQ(range.sum, (uint64_t)TEST_TASK_ARRAY * (TEST_TASK_ARRAY - 1) / 2);
+    TaskScheduler_destroy(&scheduler);
+
+    /* a single worker runs everything in caller thread */
+    alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(TaskScheduler_init(&scheduler, alloc, 1, 16));
+    TaskScheduler_run(&scheduler, sumTask, &range);
+    EXPECT_EQ(range.sum, (uint64_t)TEST_TASK_ARRAY * (TEST_TASK_ARRAY - 1) / 2);
+    TaskScheduler_destroy(&scheduler);
+
+    /* allocation failure */
+    alloc = StaticAllocator(256, __heap);
+    EXPECT_FALSE(TaskScheduler_init(&scheduler, alloc, TEST_TASK_WORKERS, 64));
+}
+
+TEST_SUITE(task_scheduler)
+{
+    TEST_RUN_CASE(deque);
+    TEST_RUN_CASE(deque_concurrent);
+    TEST_RUN_CASE(fork_join);
+    TEST_RUN_CASE(few_records);
+}
@@ -0,0 +1,227 @@
+#include "myutil.h"
+
+#include <string.h>
+#include <time.h>
+
+typedef struct _IntDbList
+{
+    DbList super;
+    int i;
+} IntDbList, *IntDbListRef;
+
+#define TEST_POOL_HEAP_SIZE 0x1000
+#define TEST_POOL_THREADS 4
+#define TEST_POOL_WORKS 1000
+#define TEST_POOL_NODES 10000
+
+static uint32_t __heap[TEST_POOL_HEAP_SIZE / 4];
+
+static void addOne(void *arg)
+{
+    __atomic_fetch_add((int *)arg, 1, __ATOMIC_RELAXED);
+}
+
+TEST_CASE(submit_wait)
+{
+    static ThreadWork works[TEST_POOL_WORKS];
+    ThreadPool pool;
+    ThreadGroup group, other;
+    int count = 0, otherCount = 0, i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(ThreadPool_init(&pool, alloc, TEST_POOL_THREADS));
+    EXPECT_EQ(ThreadPool_threads(&pool), TEST_POOL_THREADS);
+
+    /* two groups, waited separately */
+    ThreadGroup_init(&group);
+    ThreadGroup_init(&other);
+    for (i = 0; i < TEST_POOL_WORKS; i++)
+    {
+        if (i % 4 == 0)
+            ThreadPool_submit(&pool, &works[i], addOne, &otherCount, &other);
+        else
+            ThreadPool_submit(&pool, &works[i], addOne, &count, &group);
+    }
+    ThreadPool_wait(&pool, &group);
+    EXPECT_EQ(__atomic_load_n(&count, __ATOMIC_RELAXED), TEST_POOL_WORKS / 4 * 3);
+    ThreadPool_wait(&pool, &other);
+    EXPECT_EQ(__atomic_load_n(&otherCount, __ATOMIC_RELAXED), TEST_POOL_WORKS / 4);
+
+    /* empty group returns at once */
+    ThreadPool_wait(&pool, &group);
+
+    /* queued works without group still run before destroy returns */
+    count = 0;
+    for (i = 0; i < TEST_POOL_WORKS; i++)
+        ThreadPool_submit(&pool, &works[i], addOne, &count, NULL);
+    ThreadPool_destroy(&pool);
+    EXPECT_EQ(count, TEST_POOL_WORKS);
+}
+
+TEST_CASE(park_wake)
+{
+    static ThreadWork works[TEST_POOL_THREADS * 2];
+    struct timespec idle = {0, 10000000};
+    ThreadPool pool;
+    ThreadGroup group;
+    int count = 0, round, i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(ThreadPool_init(&pool, alloc, TEST_POOL_THREADS));
+    ThreadGroup_init(&group);
+
+    /* let all workers park on an empty queue, then wake them by submit */
+    for (round = 1; round <= 4; round++)
+    {
+        nanosleep(&idle, NULL);
+        for (i = 0; i < round; i++)
+            ThreadPool_submit(&pool, &works[i], addOne, &count, &group);
+        ThreadPool_wait(&pool, &group);
+    }
+    EXPECT_EQ(__atomic_load_n(&count, __ATOMIC_RELAXED), 1 + 2 + 3 + 4);
+
+    /* more works than one, the rest is handed to parked workers */
+    nanosleep(&idle, NULL);
+    for (i = 0; i < TEST_POOL_THREADS * 2; i++)
+        ThreadPool_submit(&pool, &works[i], addOne, &count, &group);
+    ThreadPool_wait(&pool, &group);
+    EXPECT_EQ(__atomic_load_n(&count, __ATOMIC_RELAXED), 10 + TEST_POOL_THREADS * 2);
+
+    ThreadPool_destroy(&pool);
+}
+
+typedef struct _SlowContext
+{
+    int count;                  /**< count of short works done */
+    bool seen;                  /**< if slow work saw all short works done */
+} SlowContext;
+
+static void slowWork(void *arg)
+{
+    SlowContext *ctx = (SlowContext *)arg;
+    struct timespec step = {0, 1000000};
+    int i;
+
+    /* short works behind must run on other workers meanwhile, give up after 1s */
+    for (i = 0; i < 1000 && !ctx->seen; i++)
+    {
+        ctx->seen = __atomic_load_n(&ctx->count, __ATOMIC_SEQ_CST) == TEST_POOL_THREADS * 4;
+        if (!ctx->seen)
+            nanosleep(&step, NULL);
+    }
+}
+
+TEST_CASE(slow_work)
+{
+    static ThreadWork works[TEST_POOL_THREADS * 4 + 1];
+    SlowContext ctx = {0, false};
+    ThreadPool pool;
+    ThreadGroup group;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(ThreadPool_init(&pool, alloc, TEST_POOL_THREADS));
+    ThreadGroup_init(&group);
+
+    /* a slow work followed by short works, short ones finish on idle workers */
+    ThreadPool_submit(&pool, &works[0], slowWork, &ctx, &group);
+    for (i = 1; i <= TEST_POOL_THREADS * 4; i++)
+        ThreadPool_submit(&pool, &works[i], addOne, &ctx.count, &group);
+    ThreadPool_wait(&pool, &group);
+    EXPECT_TRUE(ctx.seen);
+    EXPECT_EQ(ctx.count, TEST_POOL_THREADS * 4);
+
+    ThreadPool_destroy(&pool);
+}
+
+typedef struct _SumContext
+{
+    uint64_t sums[PARALLEL_MAX_SEGMENTS];
+    size_t counts[PARALLEL_MAX_SEGMENTS];
+    uint64_t total;
+    size_t count;
+} SumContext;
+
+static void sumSegment(DbListRef segment, size_t index, void *arg)
+{
+    SumContext *ctx = (SumContext *)arg;
+    IntDbListRef obj;
+
+    ctx->sums[index] = 0;
+    ctx->counts[index] = 0;
+    DBLIST_FOREACH_OBJ(obj, segment, IntDbList)
+    {
+        ctx->sums[index] += obj->i;
+        ctx->counts[index]++;
+    }
+}
+
+static void sumReduce(size_t index, void *arg)
+{
+    SumContext *ctx = (SumContext *)arg;
+    ctx->total += ctx->sums[index];
+    ctx->count += ctx->counts[index];
+}
+
+TEST_CASE(parallel_for_each)
+{
+    static IntDbList items[TEST_POOL_NODES];
+    DbListRef head = NULL;
+    DbListIter it;
+    ThreadPool pool;
+    SumContext ctx;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    EXPECT_TRUE(ThreadPool_init(&pool, alloc, TEST_POOL_THREADS));
+
+    EXPECT_EQ(DbList_parallelForEach(NULL, &pool, 0, sumSegment, sumReduce, &ctx), 0);
+
+    for (i = 0; i < TEST_POOL_NODES; i++)
+    {
+        items[i].i = i;
+        DbList_addToTail(&items[i].super, &head);
+    }
+
+    /* a segment per worker */
+    memset(&ctx, 0, sizeof(ctx));
+    EXPECT_EQ(DbList_parallelForEach(head, &pool, 0, sumSegment, sumReduce, &ctx), TEST_POOL_THREADS);
+    EXPECT_EQ(ctx.count, TEST_POOL_NODES);
+    EXPECT_EQ(ctx.total, (uint64_t)TEST_POOL_NODES * (TEST_POOL_NODES - 1) / 2);
+    for (i = 0; i < TEST_POOL_THREADS; i++)
+        EXPECT_EQ(ctx.counts[i], TEST_POOL_NODES / TEST_POOL_THREADS);
+
+    /* more segments than workers, uneven length */
+    memset(&ctx, 0, sizeof(ctx));
+    EXPECT_EQ(DbList_parallelForEach(head, &pool, 7, sumSegment, sumReduce, &ctx), 7);
+    EXPECT_EQ(ctx.count, TEST_POOL_NODES);
+    for (i = 0; i < 7; i++)
+        EXPECT_EQ(ctx.counts[i], (size_t)((i + 1) * TEST_POOL_NODES / 7 - i * TEST_POOL_NODES / 7));
+
+    /* list is linked back in order */
+    it = DbListIter_new(head);
+    i = 0;
+    while (DbListIter_next(&it))
+        EXPECT_EQ(DbListIter_curObj(it, IntDbList)->i, i++);
+    EXPECT_EQ(i, TEST_POOL_NODES);
+    EXPECT_EQ(head->prev, &items[TEST_POOL_NODES - 1].super);
+
+    /* fewer nodes than segments */
+    head = NULL;
+    for (i = 0; i < 3; i++)
+        DbList_addToTail(&items[i].super, &head);
+    memset(&ctx, 0, sizeof(ctx));
+    EXPECT_EQ(DbList_parallelForEach(head, &pool, PARALLEL_MAX_SEGMENTS, sumSegment, NULL, &ctx), 3);
+    EXPECT_EQ(ctx.sums[2], 2);
+    EXPECT_EQ(ctx.count, 0);
+
+    ThreadPool_destroy(&pool);
+}
+
+TEST_SUITE(thread_pool)
+{
+    TEST_RUN_CASE(submit_wait);
+    TEST_RUN_CASE(park_wake);
+    TEST_RUN_CASE(slow_work);
+    TEST_RUN_CASE(parallel_for_each);
+}
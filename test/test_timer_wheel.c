@@ -0,0 +1,138 @@
+#include "myutil.h"
+
+typedef struct _IntTimer
+{
+    Timer super;
+    uint64_t fired;         /* tick when fired */
+    int count;
+} IntTimer, *IntTimerRef;
+
+#define TEST_TIMER_BATCH 1000
+
+static TimerWheel __wheel;
+
+static void onExpire(TimerRef timer)
+{
+    IntTimerRef item = DOWN_CAST(timer, IntTimer);
+    item->fired = __wheel.now - 1;
+    item->count++;
+}
+
+/* reschedule itself 3 times, 10 ticks apart. */
+static void onRepeat(TimerRef timer)
+{
+    IntTimerRef item = DOWN_CAST(timer, IntTimer);
+    item->count++;
+    if (item->count < 3)
+        TimerWheel_schedule(&__wheel, timer, __wheel.now + 9, onRepeat);
+}
+
+static void initItems(IntTimerRef items, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        Timer_init(&items[i].super);
+        items[i].fired = 0;
+        items[i].count = 0;
+    }
+}
+
+/* a spread of distances crossing every level. */
+static uint64_t distance(int i)
+{
+    return (Hash_uint64(i) % (1ull << (TIMER_WHEEL_BITS * (i % TIMER_WHEEL_LEVELS + 1)))) + 1;
+}
+
+TEST_CASE(expire)
+{
+    static IntTimer items[TEST_TIMER_BATCH];
+    uint64_t start = 1000, last = 0;
+    int i;
+
+    TimerWheel_init(&__wheel, start);
+    initItems(items, TEST_TIMER_BATCH);
+
+    for (i = 0; i < TEST_TIMER_BATCH; i++)
+    {
+        uint64_t expires = start + distance(i);
+        TimerWheel_schedule(&__wheel, &items[i].super, expires, onExpire);
+        EXPECT_TRUE(Timer_isPending(&items[i].super));
+        if (expires > last)
+            last = expires;
+    }
+    EXPECT_EQ(TimerWheel_count(&__wheel), TEST_TIMER_BATCH);
+
+    /* nothing expires before its tick. */
+    EXPECT_EQ(TimerWheel_advance(&__wheel, start), 0);
+
+    /* move forward in uneven steps, every timer fires exactly on time. */
+    while (__wheel.now <= last)
+        TimerWheel_advance(&__wheel, __wheel.now + (__wheel.now % 7) * 100);
+
+    EXPECT_EQ(TimerWheel_count(&__wheel), 0);
+    for (i = 0; i < TEST_TIMER_BATCH; i++)
+    {
+        EXPECT_FALSE(Timer_isPending(&items[i].super));
+        EXPECT_EQ(items[i].count, 1);
+        EXPECT_EQ(items[i].fired, items[i].super.expires);
+    }
+}
+
+TEST_CASE(cancel)
+{
+    static IntTimer items[TEST_TIMER_BATCH];
+    int i;
+
+    TimerWheel_init(&__wheel, 0);
+    initItems(items, TEST_TIMER_BATCH);
+
+    for (i = 0; i < TEST_TIMER_BATCH; i++)
+        TimerWheel_schedule(&__wheel, &items[i].super, distance(i), onExpire);
+
+    for (i = 0; i < TEST_TIMER_BATCH; i += 2)
+        EXPECT_TRUE(TimerWheel_cancel(&__wheel, &items[i].super));
+    EXPECT_FALSE(TimerWheel_cancel(&__wheel, &items[0].super));
+    EXPECT_EQ(TimerWheel_count(&__wheel), TEST_TIMER_BATCH / 2);
+
+    /* reschedule a pending timer */
+    TimerWheel_schedule(&__wheel, &items[1].super, 5, onExpire);
+    EXPECT_EQ(TimerWheel_count(&__wheel), TEST_TIMER_BATCH / 2);
+
+    EXPECT_EQ(TimerWheel_advance(&__wheel, TIMER_WHEEL_RANGE), TEST_TIMER_BATCH / 2);
+    for (i = 0; i < TEST_TIMER_BATCH; i++)
+        EXPECT_EQ(items[i].count, i % 2);
+    EXPECT_EQ(items[1].fired, 5);
+}
+
+TEST_CASE(callback)
+{
+    IntTimer items[3];
+
+    TimerWheel_init(&__wheel, 100);
+    initItems(items, 3);
+
+    /* overdue timer runs on next tick */
+    TimerWheel_schedule(&__wheel, &items[0].super, 10, onExpire);
+    EXPECT_EQ(TimerWheel_advance(&__wheel, 100), 1);
+    EXPECT_EQ(items[0].fired, 100);
+
+    /* timer out of range still fires on time */
+    TimerWheel_schedule(&__wheel, &items[1].super, TIMER_WHEEL_RANGE + 200, onExpire);
+    EXPECT_EQ(TimerWheel_advance(&__wheel, TIMER_WHEEL_RANGE + 199), 0);
+    EXPECT_EQ(TimerWheel_advance(&__wheel, TIMER_WHEEL_RANGE + 300), 1);
+    EXPECT_EQ(items[1].fired, TIMER_WHEEL_RANGE + 200);
+
+    /* callback reschedules itself */
+    TimerWheel_schedule(&__wheel, &items[2].super, __wheel.now + 10, onRepeat);
+    EXPECT_EQ(TimerWheel_advance(&__wheel, __wheel.now + 100), 3);
+    EXPECT_EQ(items[2].count, 3);
+    EXPECT_EQ(TimerWheel_count(&__wheel), 0);
+}
+
+TEST_SUITE(timer_wheel)
+{
+    TEST_RUN_CASE(expire);
+    TEST_RUN_CASE(cancel);
+    TEST_RUN_CASE(callback);
+}
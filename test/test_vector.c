@@ -0,0 +1,129 @@
+#include "myutil.h"
+
+typedef struct _Point
+{
+    int x;
+    int y;
+} Point;
+
+VECTOR_DEFINE(IntVector, int)
+VECTOR_DEFINE(PointVector, Point)
+
+#define TEST_VECTOR_HEAP_SIZE 0x40000
+#define TEST_VECTOR_BATCH 10000
+
+static uint32_t __heap[TEST_VECTOR_HEAP_SIZE / 4];
+
+TEST_CASE(small)
+{
+    IntVector v;
+    int i, value = 0;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    size_t available = Allocator_available(alloc);
+
+    IntVector_init(&v, alloc);
+    EXPECT_EQ(IntVector_capacity(&v), VECTOR_INLINE_BYTES / sizeof(int));
+    EXPECT_FALSE(IntVector_pop(&v, &value));
+
+    /* the inline buffer needs no allocation */
+    for (i = 0; i < (int)(VECTOR_INLINE_BYTES / sizeof(int)); i++)
+        EXPECT_TRUE(IntVector_push(&v, i));
+    EXPECT_EQ(Allocator_available(alloc), available);
+    EXPECT_EQ(IntVector_data(&v), v.small);
+
+    /* moved by copy */
+    IntVector copy = v;
+    EXPECT_EQ(*IntVector_at(&copy, 3), 3);
+    EXPECT_EQ(IntVector_data(&copy), copy.small);
+
+    for (i = VECTOR_INLINE_BYTES / sizeof(int) - 1; i >= 0; i--)
+    {
+        EXPECT_TRUE(IntVector_pop(&v, &value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(IntVector_count(&v), 0);
+    IntVector_destroy(&v);
+
+    EXPECT_EQ(VECTOR_INLINE_COUNT(char[100]), 1);
+}
+
+TEST_CASE(grow)
+{
+    IntVector v;
+    size_t capacity;
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    IntVector_init(&v, alloc);
+
+    capacity = IntVector_capacity(&v);
+    for (i = 0; i < TEST_VECTOR_BATCH; i++)
+    {
+        EXPECT_TRUE(IntVector_push(&v, i));
+
+        /* geometric growth */
+        if (IntVector_capacity(&v) != capacity)
+        {
+            EXPECT_EQ(IntVector_capacity(&v), capacity * 2);
+            capacity = IntVector_capacity(&v);
+        }
+    }
+    EXPECT_EQ(IntVector_count(&v), TEST_VECTOR_BATCH);
+    EXPECT_NE(IntVector_data(&v), v.small);
+    for (i = 0; i < TEST_VECTOR_BATCH; i++)
+        EXPECT_EQ(*IntVector_at(&v, i), i);
+
+    IntVector_clear(&v);
+    EXPECT_EQ(IntVector_count(&v), 0);
+    EXPECT_EQ(IntVector_capacity(&v), capacity);
+
+    IntVector_destroy(&v);
+    EXPECT_EQ(IntVector_capacity(&v), VECTOR_INLINE_BYTES / sizeof(int));
+}
+
+TEST_CASE(reserve_append)
+{
+    static Point points[TEST_VECTOR_BATCH];
+    PointVector v;
+    Point p = {0, 0};
+    int i;
+
+    AllocatorRef alloc = StaticAllocator(sizeof(__heap), __heap);
+    PointVector_init(&v, alloc);
+
+    for (i = 0; i < TEST_VECTOR_BATCH; i++)
+    {
+        points[i].x = i;
+        points[i].y = -i;
+    }
+
+    EXPECT_TRUE(PointVector_reserve(&v, 1000));
+    EXPECT_GE(PointVector_capacity(&v), 1000);
+    size_t available = Allocator_available(alloc);
+
+    /* fits the reserved block */
+    EXPECT_TRUE(PointVector_append(&v, points, 1000));
+    EXPECT_EQ(Allocator_available(alloc), available);
+
+    EXPECT_TRUE(PointVector_append(&v, points + 1000, TEST_VECTOR_BATCH - 1000));
+    EXPECT_EQ(PointVector_count(&v), TEST_VECTOR_BATCH);
+    for (i = 0; i < TEST_VECTOR_BATCH; i++)
+        EXPECT_EQ(PointVector_at(&v, i)->y, -i);
+
+    /* allocation failure keeps the content */
+    EXPECT_FALSE(PointVector_reserve(&v, TEST_VECTOR_HEAP_SIZE));
+    EXPECT_FALSE(PointVector_append(&v, points, TEST_VECTOR_BATCH));
+    EXPECT_EQ(PointVector_count(&v), TEST_VECTOR_BATCH);
+    EXPECT_TRUE(PointVector_pop(&v, &p));
+    EXPECT_EQ(p.x, TEST_VECTOR_BATCH - 1);
+
+    PointVector_destroy(&v);
+}
+
+TEST_SUITE(vector)
+{
+    TEST_RUN_CASE(small);
+    TEST_RUN_CASE(grow);
+    TEST_RUN_CASE(reserve_append);
+}